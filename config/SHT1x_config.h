@@ -44,7 +44,9 @@ extern "C"
  *         - 0: Disable Fahrenheit measurement function
  *         - 1: Enable Fahrenheit measurement function
  */
-#define SHT1X_CONFIG_FAHRENHEIT_MEASUREMENT     0
+#ifndef SHT1X_CONFIG_FAHRENHEIT_MEASUREMENT
+  #define SHT1X_CONFIG_FAHRENHEIT_MEASUREMENT   0
+#endif
 
 /**
  * @brief  High resolution measurement option
@@ -52,7 +54,9 @@ extern "C"
  *         - 0: Disable High resolution measurement
  *         - 1: Enable High resolution measurement
  */
-#define SHT1X_CONFIG_RESOLUTION_CONTROL         0
+#ifndef SHT1X_CONFIG_RESOLUTION_CONTROL
+  #define SHT1X_CONFIG_RESOLUTION_CONTROL       0
+#endif
 
 /**
  * @brief  Determine how to measure the supply voltage
@@ -60,14 +64,116 @@ extern "C"
  *         - 1: The power supply voltage is constant at 3.3 volts
  *         - 2: The power supply voltage is constant at 5 volts
  */
-#define SHT1X_CONFIG_POWER_VOLTAGE_CONTROL      0
+#ifndef SHT1X_CONFIG_POWER_VOLTAGE_CONTROL
+  #define SHT1X_CONFIG_POWER_VOLTAGE_CONTROL    0
+#endif
 
 /**
  * @brief  Internal heater control option
  *         - 0: Disable internal heater control
  *         - 1: Enable internal heater control
  */
-#define SHT1X_CONFIG_INTERNAL_HEATER_CONTROL    0
+#ifndef SHT1X_CONFIG_INTERNAL_HEATER_CONTROL
+  #define SHT1X_CONFIG_INTERNAL_HEATER_CONTROL  0
+#endif
+
+/**
+ * @brief  Instrumentation option (per-phase timing and error counters)
+ * @note   When enabled, GetTime of the handler must be initialized.
+ *         - 0: Disable instrumentation (compiles to nothing)
+ *         - 1: Enable instrumentation
+ */
+#ifndef SHT1X_CONFIG_INSTRUMENTATION
+  #define SHT1X_CONFIG_INSTRUMENTATION          0
+#endif
+
+/**
+ * @brief  Sample timestamps option
+ * @note   When enabled, GetTime of the handler must be initialized. Every
+ *         sample of SHT1x_ReadSample gets the command issue, conversion complete
+ *         and readout complete time, and the command-to-data time is counted in
+ *         a log2 histogram of the handler.
+ *         - 0: Disable sample timestamps (compiles to nothing)
+ *         - 1: Enable sample timestamps and latency histogram
+ */
+#ifndef SHT1X_CONFIG_TIMESTAMPS
+  #define SHT1X_CONFIG_TIMESTAMPS               0
+#endif
+
+/**
+ * @brief  CRC check option
+ * @note   When disabled, every transfer ends with a NACK right after the last
+ *         data byte, so the CRC byte is never clocked out.
+ *         - 0: Skip the CRC
+ *         - 1: Read and check the CRC of every result and status register read
+ */
+#ifndef SHT1X_CONFIG_CRC_CHECK
+  #define SHT1X_CONFIG_CRC_CHECK                0
+#endif
+
+/**
+ * @brief  Streaming option
+ * @note   SHT1x_StreamStart issues the next measurement command right after
+ *         each readout and hands the raw results to a sink or a buffer until
+ *         SHT1x_StreamStop.
+ *         - 0: Disable streaming functions
+ *         - 1: Enable streaming functions
+ */
+#ifndef SHT1X_CONFIG_STREAM
+  #define SHT1X_CONFIG_STREAM                   0
+#endif
+
+/**
+ * @brief  Report-by-exception option
+ * @note   SHT1x_ReportCheck compares the raw values of a sample with the last
+ *         reported ones and tells whether the sample must be sent: when a
+ *         deadband is exceeded or the heartbeat interval has expired.
+ *         - 0: Disable report-by-exception functions
+ *         - 1: Enable report-by-exception functions
+ */
+#ifndef SHT1X_CONFIG_REPORT
+  #define SHT1X_CONFIG_REPORT                   0
+#endif
+
+/**
+ * @brief  Bus speed tuning option
+ * @note   The SCK half period of every handler is chosen at runtime from
+ *         SHT1X_BUS_LEVELS steps. The bus speeds up one step after a run of
+ *         clean transfers and slows down on a NACK, a CRC error or an
+ *         implausible result. Requires SHT1X_CONFIG_CRC_CHECK. Precompiled
+ *         waveforms keep the fixed timing.
+ *         - 0: Fixed 4 us half periods
+ *         - 1: Tune the half period of every handler
+ */
+#ifndef SHT1X_CONFIG_BUS_TUNING
+  #define SHT1X_CONFIG_BUS_TUNING               0
+#endif
+
+/**
+ * @brief  Waveform option
+ * @note   Every transaction is compiled into a buffer of SCK/DATA steps and
+ *         played by the EmitWaveform function of the port in one call, with
+ *         the read bits sampled at marked steps. Ports without EmitWaveform
+ *         keep driving the pins one by one.
+ *         - 0: Drive the pins one by one
+ *         - 1: Use EmitWaveform of the port if it has one
+ */
+#ifndef SHT1X_CONFIG_WAVEFORM
+  #define SHT1X_CONFIG_WAVEFORM                 0
+#endif
+
+/**
+ * @brief  Port binding option
+ * @note   In static mode SHT1x.c includes SHT1x_platform.h and calls its
+ *         static inline SHT1x_Port_xxx functions, so the compiler can inline
+ *         every pin access. The callbacks of the handler are removed and only
+ *         one sensor (the pins of SHT1x_platform.h) can be used.
+ *         - 0: Runtime binding through the function pointers of the handler
+ *         - 1: Static binding to SHT1x_Port_xxx functions of SHT1x_platform.h
+ */
+#ifndef SHT1X_CONFIG_STATIC_PORT
+  #define SHT1X_CONFIG_STATIC_PORT              0
+#endif
 
 
 
@@ -0,0 +1,155 @@
+/**
+ **********************************************************************************
+ * @file   main.cpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  example code for SHT1x C++ Driver (for ATmega32)
+ *         Built twice by the makefile: with sht1x::Sensor (default) and with
+ *         the C driver (SHT1X_EXAMPLE_C_DRIVER=1), so both firmwares print
+ *         the CPU cycles of the same operations.
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include "Retarget.h"
+
+#ifndef SHT1X_EXAMPLE_C_DRIVER
+  #define SHT1X_EXAMPLE_C_DRIVER  0
+#endif
+
+#if (SHT1X_EXAMPLE_C_DRIVER)
+  #include "SHT1x.h"
+  #include "SHT1x_platform.h"
+#else
+  #include "SHT1x.hpp"
+  #include "SHT1x_platform.hpp"
+
+  using Sensor = sht1x::Sensor<sht1x::avr::DefaultPins,
+                               sht1x::Resolution::High, 5000>;
+#endif
+
+
+/**
+ * @brief  Cycle counter: Timer1 without prescaler, extended by its overflow.
+ */
+static volatile uint16_t CycleOverflows = 0;
+
+ISR(TIMER1_OVF_vect)
+{
+  CycleOverflows++;
+}
+
+static void
+Cycles_Init(void)
+{
+  TCCR1A = 0;
+  TCCR1B = (1<<CS10);
+  TIMSK |= (1<<TOIE1);
+  sei();
+}
+
+static uint32_t
+Cycles_Now(void)
+{
+  uint16_t Overflows;
+  uint16_t Count;
+
+  cli();
+  Count = TCNT1;
+  Overflows = CycleOverflows;
+  if ((TIFR & (1<<TOV1)) && Count < 0x8000)
+    Overflows++;
+  sei();
+
+  return ((uint32_t)Overflows << 16) | Count;
+}
+
+
+int main(void)
+{
+  uint32_t Start;
+  uint32_t StatusCycles;
+  uint32_t SampleCycles;
+  uint8_t  Result;
+  float    TempCelsius;
+  float    HumidityPercent;
+#if (SHT1X_EXAMPLE_C_DRIVER)
+  SHT1x_Handler_t    Handler = {};
+  SHT1x_Sample_t     Sample = {};
+  SHT1x_Resolution_t Resolution;
+#else
+  sht1x::Sample Sample = {};
+  uint8_t       StatusReg;
+#endif
+
+  Retarget_Init(F_CPU, 9600);
+#if (SHT1X_EXAMPLE_C_DRIVER)
+  printf("SHT1x Driver Example (C driver)\r\n\r\n");
+  SHT1x_Platform_Init(&Handler);
+  SHT1x_Init(&Handler);
+#else
+  printf("SHT1x Driver Example (C++ driver)\r\n\r\n");
+  Sensor::Init();
+#endif
+
+  Cycles_Init();
+
+  while (1)
+  {
+    // Status register read: bus activity and call overhead only
+    Start = Cycles_Now();
+#if (SHT1X_EXAMPLE_C_DRIVER)
+    SHT1x_GetResolution(&Handler, &Resolution);
+#else
+    Sensor::ReadStatusRegister(StatusReg);
+#endif
+    StatusCycles = Cycles_Now() - Start;
+
+    Start = Cycles_Now();
+#if (SHT1X_EXAMPLE_C_DRIVER)
+    Result = SHT1x_ReadSample(&Handler, &Sample);
+    TempCelsius = Sample.TempCelsius;
+    HumidityPercent = Sample.HumidityPercent;
+#else
+    Result = (uint8_t)Sensor::ReadSample(Sample);
+    TempCelsius = Sample.TempCelsius;
+    HumidityPercent = Sample.HumidityPercent;
+#endif
+    SampleCycles = Cycles_Now() - Start;
+
+    printf("Result: %u\r\n"
+           "Temperature: %f°C\r\n"
+           "Humidity: %f%%\r\n"
+           "Cycles: status read %lu, sample %lu\r\n\r\n",
+           Result, TempCelsius, HumidityPercent,
+           (unsigned long)StatusCycles, (unsigned long)SampleCycles);
+
+    _delay_ms(1000);
+  }
+
+  return 0;
+}
@@ -0,0 +1,272 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  adaptive sampling example for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <stdio.h>
+#include <math.h>
+#include "SHT1x.h"
+#include "SHT1x_sched.h"
+#include "SHT1x_adapt.h"
+#include "SHT1x_platform.h"
+
+
+#define RUN_S           86400
+#define MIN_PERIOD_MS   10000
+#define MAX_PERIOD_MS   (5 * 60 * 1000UL)
+#define WINDOW_S        (14 * 3600)
+#define SHOWER_S        (7 * 3600)
+#define TRANSIENT_S     (900 + 1200)    // shower and window time
+
+
+static SHT1x_Sim_t         Sim;
+static SHT1x_Handler_t     Handler;
+static SHT1x_SchedSensor_t Sensor;
+static SHT1x_Sched_t       Sched;
+static SHT1x_Adapt_t       Adapt;
+static uint8_t             Adaptive;
+static uint32_t            TransientSamples;
+static uint32_t            LastSampleS;
+static uint32_t            StartMs;
+static uint32_t            Rand = 12345;
+
+
+static uint32_t
+GetTimeMs(void)
+{
+  return (uint32_t)(SHT1x_Sim_Now(&Sim) / 1000000);
+}
+
+/**
+ * @brief  Uniform noise in [-Amplitude, Amplitude]
+ */
+static double
+Noise(double Amplitude)
+{
+  Rand = Rand * 1103515245 + 12345;
+  return Amplitude * (((Rand >> 8) & 0xFFFF) / 32767.5 - 1.0);
+}
+
+/**
+ * @brief  A room with a small daily swing: a shower raises the humidity in the
+ *         morning and a window is open for 20 minutes in the afternoon.
+ */
+static void
+Environment(double TimeS, double *TempC, double *HumP)
+{
+  const double Phase = 2 * 3.14159265358979 * TimeS / 86400.0;
+  double Window = 0, Shower = 0;
+
+  if (TimeS >= WINDOW_S && TimeS < WINDOW_S + 1200)
+    Window = 1 - exp(-(TimeS - WINDOW_S) / 180.0);
+  else if (TimeS >= WINDOW_S + 1200)
+    Window = (1 - exp(-1200 / 180.0)) * exp(-(TimeS - WINDOW_S - 1200) / 900.0);
+
+  if (TimeS >= SHOWER_S && TimeS < SHOWER_S + 900)
+    Shower = 1 - exp(-(TimeS - SHOWER_S) / 120.0);
+  else if (TimeS >= SHOWER_S + 900)
+    Shower = (1 - exp(-900 / 120.0)) * exp(-(TimeS - SHOWER_S - 900) / 1200.0);
+
+  *TempC = 21.5 + 0.3 * sin(Phase) - 5 * Window + Shower;
+  *HumP = 45 - 2 * sin(Phase) + 20 * Window + 30 * Shower;
+}
+
+static uint8_t
+InTransient(uint32_t TimeS)
+{
+  return (TimeS >= SHOWER_S && TimeS < SHOWER_S + 900) ||
+         (TimeS >= WINDOW_S && TimeS < WINDOW_S + 1200);
+}
+
+/**
+ * @brief  No sample has been taken since the shower or the window started, a
+ *         sampler cannot know of it yet. With the adaptive period this lasts up
+ *         to MAX_PERIOD_MS and its error depends on where the event falls
+ *         between two samples, so it is counted apart from the estimate error.
+ */
+static uint8_t
+IsBlind(uint32_t TimeS)
+{
+  return (TimeS >= SHOWER_S && LastSampleS < SHOWER_S && InTransient(TimeS)) ||
+         (TimeS >= WINDOW_S && LastSampleS < WINDOW_S && InTransient(TimeS));
+}
+
+static void
+OnSample(uint8_t Index, SHT1x_SchedSensor_t *Sensor)
+{
+  const uint32_t Now = GetTimeMs();
+
+  LastSampleS = (Now - StartMs) / 1000;
+  if (InTransient(LastSampleS))
+    TransientSamples++;
+  if (!Adaptive)
+    return;
+
+  SHT1x_Sched_SetPeriod(&Sched, Index,
+                        SHT1x_Adapt_Update(&Adapt, Sensor->Result == SHT1x_OK ?
+                                           &Sensor->Sample : NULL, Now));
+}
+
+/**
+ * @brief  Sample the room for a day and compare the latest value with the
+ *         environment every second: the last sample with a fixed period, the
+ *         filtered estimate with the adaptive one.
+ * @retval Number of failed checks
+ */
+static uint32_t
+Run(uint8_t Mode)
+{
+  SHT1x_Sample_t Sample;
+  double   TempC, HumP, ErrT, ErrH;
+  double   SumT = 0, SumH = 0, MaxT = 0, MaxH = 0;
+  uint32_t Seconds = 0, Outside = 0, Failures = 0, LongestMs = 0, Blind = 0;
+  uint32_t Now, Idle, NextEvalMs;
+  uint32_t TempVar, HumVar;
+
+  Adaptive = Mode;
+  TransientSamples = 0;
+  LastSampleS = 0;
+  Sensor.Handler = &Handler;
+  Sensor.PeriodMs = MIN_PERIOD_MS;
+  SHT1x_Sched_Init(&Sched, &Sensor, 1, GetTimeMs);
+  Sched.OnSample = OnSample;
+  Failures += SHT1x_Adapt_Init(&Adapt, &Handler, MIN_PERIOD_MS, MAX_PERIOD_MS) != SHT1x_OK;
+  Failures += SHT1x_Adapt_Estimate(&Adapt, 0, &Sample, NULL, NULL) != SHT1x_FAIL;
+
+  StartMs = GetTimeMs();
+  NextEvalMs = 1000;
+  for (Now = 0; Now < RUN_S * 1000UL; Now = GetTimeMs() - StartMs)
+  {
+    Environment(Now / 1000.0, &TempC, &HumP);
+    Sim.AmbientC = (float)(TempC + Noise(0.05));
+    Sim.HumidityP = (float)(HumP + Noise(0.3));
+
+    SHT1x_Sched_Poll(&Sched);
+    if (Adapt.PeriodMs > LongestMs)
+      LongestMs = Adapt.PeriodMs;
+
+    for (; NextEvalMs <= Now && Sensor.Samples; NextEvalMs += 1000)
+    {
+      if (IsBlind(NextEvalMs / 1000))
+      {
+        Blind++;
+        continue;
+      }
+
+      Environment(NextEvalMs / 1000.0, &TempC, &HumP);
+      if (Mode)
+      {
+        SHT1x_Adapt_Estimate(&Adapt, StartMs + NextEvalMs, &Sample, &TempVar, &HumVar);
+        // the environment is within 3 sigma of the prediction
+        ErrT = (Sample.TempCelsius - TempC) / 0.01;
+        ErrH = (Sample.HumidityPercent - HumP) / 0.0405;
+        if (ErrT * ErrT > 9 * (TempVar / 256.0 + 1) ||
+            ErrH * ErrH > 9 * (HumVar / 256.0 + 1))
+          Outside++;
+      }
+      else
+      {
+        Sample = Sensor.Sample;
+      }
+
+      ErrT = fabs(Sample.TempCelsius - TempC);
+      ErrH = fabs(Sample.HumidityPercent - HumP);
+      SumT += ErrT * ErrT;
+      SumH += ErrH * ErrH;
+      if (ErrT > MaxT)
+        MaxT = ErrT;
+      if (ErrH > MaxH)
+        MaxH = ErrH;
+      Seconds++;
+    }
+
+    Idle = SHT1x_Sched_IdleTime(&Sched);
+    if (Idle == 0)
+      Idle = 1;
+    if (Idle > 1000)
+      Idle = 1000;
+    SHT1x_Sim_Advance(&Sim, Idle * 1000000ULL);
+  }
+
+  printf("%-9s %7u %10u %9.3f %9.3f %9.2f %9.2f %5u s",
+         Mode ? "adaptive" : "fixed", (unsigned)Sensor.Samples,
+         (unsigned)TransientSamples, sqrt(SumT / Seconds), MaxT,
+         sqrt(SumH / Seconds), MaxH, (unsigned)Blind);
+  if (Mode)
+    printf("  %5u s  %.1f%%", (unsigned)(LongestMs / 1000), 100.0 * Outside / Seconds);
+  printf("\r\n");
+
+  // the adaptive estimate stays within the default limits of 0.1 C and 1 %RH,
+  // and each event is seen within the longest period
+  if (Mode && (sqrt(SumT / Seconds) > 0.1 || sqrt(SumH / Seconds) > 1.0 ||
+               Blind > 2 * MAX_PERIOD_MS / 1000 ||
+               Outside * 50 > Seconds))
+    Failures++;
+
+  Failures += Sensor.Errors;
+  return Failures;
+}
+
+
+int main(void)
+{
+  uint32_t FixedSamples, Failures = 0;
+
+  printf("SHT1x Adaptive Sampling Example\r\n\r\n");
+  printf("A day of a room with a shower at 07:00 and an open window at 14:00\r\n");
+  printf("Fixed period %u s, adaptive period %u s to %lu s\r\n\r\n",
+         MIN_PERIOD_MS / 1000, MIN_PERIOD_MS / 1000, MAX_PERIOD_MS / 1000);
+
+  SHT1x_Sim_Init(&Sim, NULL);
+  Sim.ActiveRiseC = 0;    // compare with the environment, not with self-heating
+  SHT1x_Sim_Attach(&Sim, &Handler);
+  SHT1x_Init(&Handler);
+
+  printf("mode      samples  in events  rms temp  max temp   rms hum   max hum"
+         "    blind  longest  outside 3s\r\n");
+  Failures += Run(0);
+  FixedSamples = Sensor.Samples;
+  Failures += Run(1);
+
+  printf("\r\n%u samples outside of the prediction; a sample every %u s during the\r\n"
+         "shower and the window, every %u s on average\r\n", (unsigned)Adapt.Transients,
+         (unsigned)(TRANSIENT_S / TransientSamples), (unsigned)(RUN_S / Sensor.Samples));
+
+  // a tenth of the samples or less, and four times the rate during transients
+  if (Sensor.Samples * 10 > FixedSamples ||
+      TransientSamples * RUN_S < 4 * TRANSIENT_S * Sensor.Samples)
+    Failures++;
+
+  printf("\r\nProtocol violations: %u\r\n", (unsigned)SHT1x_Sim_Violations(&Sim));
+  Failures += SHT1x_Sim_Violations(&Sim);
+
+  SHT1x_DeInit(&Handler);
+  printf("%s\r\n", Failures ? "FAILED" : "OK");
+  return Failures ? 1 : 0;
+}
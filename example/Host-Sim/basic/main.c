@@ -0,0 +1,191 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  example code for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include "SHT1x.h"
+#include "SHT1x_platform.h"
+
+
+#if (SHT1X_CONFIG_INSTRUMENTATION || SHT1X_CONFIG_TIMESTAMPS)
+static uint32_t
+GetTimeUs(void)
+{
+  return (uint32_t)(SHT1x_Sim_Now(SHT1x_Platform_GetSim()) / 1000);
+}
+#endif
+
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+
+static void
+PrintStats(SHT1x_Handler_t *Handler)
+{
+  static const char *const Names[SHT1x_PhaseCount] = {"command", "wait", "readout"};
+  SHT1x_Stats_t Stats;
+  uint32_t Min, Max, Mean;
+
+  SHT1x_GetStats(Handler, &Stats);
+  printf("\r\nNACKs: %u, timeouts: %u, poll iterations: %u, edge waits: %u\r\n",
+         (unsigned)Stats.Nacks, (unsigned)Stats.Timeouts,
+         (unsigned)Stats.PollIterations, (unsigned)Stats.EdgeWaits);
+
+  for (uint8_t i = 0; i < SHT1x_PhaseCount; i++)
+  {
+    if (SHT1x_GetLatency(Handler, (SHT1x_Phase_t)i, &Min, &Max, &Mean) == SHT1x_OK)
+      printf("  %-8s min %6u us, max %6u us, mean %6u us\r\n",
+             Names[i], (unsigned)Min, (unsigned)Max, (unsigned)Mean);
+  }
+}
+#endif
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+static void
+PrintHistogram(SHT1x_Handler_t *Handler)
+{
+  uint32_t Histogram[SHT1X_HISTOGRAM_BUCKETS];
+  uint32_t P50, P99;
+
+  SHT1x_GetHistogram(Handler, Histogram);
+  printf("\r\nCommand-to-data latency:\r\n");
+  for (uint8_t i = 1; i < SHT1X_HISTOGRAM_BUCKETS; i++)
+  {
+    if (Histogram[i])
+      printf("  %7lu .. %7lu us: %u\r\n", 1UL << (i - 1), (1UL << i) - 1,
+             (unsigned)Histogram[i]);
+  }
+  if (SHT1x_GetLatencyPercentile(Handler, 50, &P50) == SHT1x_OK &&
+      SHT1x_GetLatencyPercentile(Handler, 99, &P99) == SHT1x_OK)
+    printf("  p50 < %u us, p99 < %u us\r\n", (unsigned)P50 + 1, (unsigned)P99 + 1);
+}
+#endif
+
+static void
+PrintViolations(SHT1x_Sim_t *Sim)
+{
+  for (uint8_t i = 0; i < SHT1x_Sim_ViolationCount; i++)
+  {
+    if (Sim->Stats.Violations[i])
+      printf("  violation %s: %u\r\n",
+             SHT1x_Sim_ViolationName((SHT1x_Sim_Violation_t)i),
+             (unsigned)Sim->Stats.Violations[i]);
+  }
+}
+
+
+int main(void)
+{
+  SHT1x_Handler_t Handler = {0};
+  SHT1x_Sample_t  Sample = {0};
+  SHT1x_Sim_t     *Sim;
+  SHT1x_Result_t  Result;
+  uint64_t        Start;
+
+  printf("SHT1x Driver Example\r\n\r\n");
+
+  Sim = SHT1x_Platform_GetSim();
+  Sim->AmbientC = 23.5f;
+  Sim->HumidityP = 41.0f;
+
+  SHT1x_Platform_Init(&Handler);
+#if (SHT1X_CONFIG_INSTRUMENTATION || SHT1X_CONFIG_TIMESTAMPS)
+  Handler.GetTime = GetTimeUs;
+#endif
+  SHT1x_Init(&Handler);
+
+  for (int i = 0; i < 3; i++)
+  {
+    Start = SHT1x_Sim_Now(Sim);
+    Result = SHT1x_ReadSample(&Handler, &Sample);
+    printf("Result: %d, Temperature: %f°C, Humidity: %f%%, took %.1f ms\r\n",
+           Result, Sample.TempCelsius, Sample.HumidityPercent,
+           (SHT1x_Sim_Now(Sim) - Start) / 1e6);
+#if (SHT1X_CONFIG_TIMESTAMPS)
+    printf("  command %u us, conversion complete %u us, readout complete %u us\r\n",
+           (unsigned)Sample.CommandTime, (unsigned)Sample.ConversionTime,
+           (unsigned)Sample.ReadoutTime);
+#endif
+  }
+
+#if (SHT1X_CONFIG_RESOLUTION_CONTROL)
+  SHT1x_SetResolution(&Handler, SHT1x_LowResolution);
+  Start = SHT1x_Sim_Now(Sim);
+  Result = SHT1x_ReadSample(&Handler, &Sample);
+  printf("Low resolution: %d, Temperature: %f°C, Humidity: %f%%, took %.1f ms\r\n",
+         Result, Sample.TempCelsius, Sample.HumidityPercent,
+         (SHT1x_Sim_Now(Sim) - Start) / 1e6);
+  SHT1x_SetResolution(&Handler, SHT1x_HighResolution);
+#endif
+
+#if (SHT1X_CONFIG_INTERNAL_HEATER_CONTROL)
+  SHT1x_SetInternalHeater(&Handler, SHT1x_HeaterOn);
+  SHT1x_Sim_Advance(Sim, 30000000000ULL);
+  Result = SHT1x_ReadSample(&Handler, &Sample);
+  printf("Heater on for 30 s: %d, Temperature: %f°C, Humidity: %f%%\r\n",
+         Result, Sample.TempCelsius, Sample.HumidityPercent);
+  SHT1x_SetInternalHeater(&Handler, SHT1x_HeaterOff);
+#endif
+
+  printf("\r\nFault injection\r\n");
+
+  Sim->Faults.DropAck = 1;
+  Result = SHT1x_ReadSample(&Handler, &Sample);
+  printf("  missing ACK: %d\r\n", Result);
+
+  Sim->Faults.HangConversion = 1;
+  Result = SHT1x_ReadSample(&Handler, &Sample);
+  printf("  conversion hang: %d\r\n", Result);
+  SHT1x_Sim_PowerCycle(Sim);
+  SHT1x_Sim_Advance(Sim, 20000000ULL);
+
+  Sim->Faults.FlipMask = 0x04;
+  Result = SHT1x_ReadSample(&Handler, &Sample);
+  printf("  flipped bit: %d, Humidity raw: %u\r\n", Result, Sample.HumRaw);
+
+  Sim->Faults.StuckData = SHT1x_Sim_StuckLow;
+  Result = SHT1x_ReadSample(&Handler, &Sample);
+  printf("  stuck DATA: %d\r\n", Result);
+  Sim->Faults.StuckData = SHT1x_Sim_StuckNone;
+
+  Result = SHT1x_ReadSample(&Handler, &Sample);
+  printf("  recovery: %d, Temperature: %f°C\r\n", Result, Sample.TempCelsius);
+
+  printf("\r\nVirtual time: %.3f s, commands: %u, SCK edges: %u, faults: %u\r\n",
+         SHT1x_Sim_Now(Sim) / 1e9, (unsigned)Sim->Stats.Commands,
+         (unsigned)Sim->Stats.SckEdges, (unsigned)Sim->Stats.FaultsInjected);
+  PrintViolations(Sim);
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+  PrintStats(&Handler);
+#endif
+#if (SHT1X_CONFIG_TIMESTAMPS)
+  PrintHistogram(&Handler);
+#endif
+
+  SHT1x_DeInit(&Handler);
+  return 0;
+}
@@ -0,0 +1,522 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Bus path benchmark for SHT1x Driver (for host simulator)
+ *         Counts the callbacks and the requested delay of every API call and
+ *         reports the results as a table or as JSON lines.
+ *
+ *         Usage: output [--json] [--iterations N] [--baseline FILE] [--check]
+ *         --check exits with 1 if a transaction exceeds its SCK edge or DATA
+ *         direction budget, fails or violates the protocol.
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "SHT1x.h"
+#include "SHT1x_platform.h"
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct Counters_s
+{
+  uint32_t DataConfigDir;
+  uint32_t DataWrite;
+  uint32_t DataRead;
+  uint32_t SckWrite;
+  uint32_t DelayUs;
+  uint32_t DelayMs;
+  uint32_t WaitDataLow;
+  uint64_t RequestedDelayUs;
+} Counters_t;
+
+typedef struct Result_s
+{
+  char     Name[32];
+  double   DataConfigDir;
+  double   DataWrite;
+  double   DataRead;
+  double   SckWrite;
+  double   DelayUs;
+  double   DelayMs;
+  double   WaitDataLow;
+  double   RequestedDelayUs;
+  double   SckEdges;
+  double   VirtualUs;
+  double   WallNs;
+  double   SamplesPerSecond;
+  uint32_t Failures;
+} Result_t;
+
+typedef struct Budget_s
+{
+  const char *Name;
+  double      SckEdges;
+  double      DataConfigDir;
+} Budget_t;
+
+typedef SHT1x_Result_t (*Operation_t)(SHT1x_Handler_t *Handler);
+
+
+/* Private Constants ------------------------------------------------------------*/
+/**
+ * @brief  SCK edges per call of each transaction type. A transfer costs 4 edges
+ *         for the start sequence, 16 per byte and 2 per ACK or NACK clock:
+ *         - measurement: start, command, ACK, MSB, ACK, LSB, NACK = 58
+ *           (+18 for ACK and CRC byte with SHT1X_CONFIG_CRC_CHECK)
+ *         - status read: start, command, ACK, status, NACK = 40 (+18)
+ *         - status write: start, command, ACK, status, ACK = 40
+ *         and DATA direction writes per call. A measurement releases DATA for
+ *         the ACK, takes it for each ACK it sends, releases it for the next
+ *         byte and takes it for the NACK: 4 (+2 with CRC). DATA stays an output
+ *         after the NACK, so only the first command after a reset or a failure
+ *         claims it (+1).
+ */
+static const Budget_t Budgets[] =
+{
+#if (SHT1X_CONFIG_CRC_CHECK)
+  {"ReadSample_High",   2 * 76,  2 * 6 + 1},
+  {"ReadSample_Low",    2 * 76,  2 * 6 + 1},
+  {"ReadSample_Wait",   2 * 76,  2 * 6 + 1},
+  {"SetResolution",     58 + 40, 4 + 4 + 1},
+  {"GetResolution",     58,      4 + 1},
+  {"SetInternalHeater", 58 + 40, 4 + 4 + 1},
+#else
+  {"ReadSample_High",   2 * 58,  2 * 4 + 1},
+  {"ReadSample_Low",    2 * 58,  2 * 4 + 1},
+  {"ReadSample_Wait",   2 * 58,  2 * 4 + 1},
+  {"SetResolution",     40 + 40, 2 + 4 + 1},
+  {"GetResolution",     40,      2 + 1},
+  {"SetInternalHeater", 40 + 40, 2 + 4 + 1},
+#endif
+  {"SoftReset",         22,      2},
+};
+
+
+/* Private Variables ------------------------------------------------------------*/
+static SHT1x_Handler_t Inner;
+static Counters_t Count;
+static SHT1x_Sample_t Sample;
+
+#define MAX_BASELINE 32
+static Result_t Baseline[MAX_BASELINE];
+static int BaselineCount = 0;
+
+
+
+/**
+ ==================================================================================
+                             ##### Counting shim #####
+ ==================================================================================
+ */
+
+static void
+Shim_DataConfigDir(uint8_t Dir)
+{
+  Count.DataConfigDir++;
+  Inner.DataConfigDir(Dir);
+}
+
+static void
+Shim_DataWrite(uint8_t Level)
+{
+  Count.DataWrite++;
+  Inner.DataWrite(Level);
+}
+
+static uint8_t
+Shim_DataRead(void)
+{
+  Count.DataRead++;
+  return Inner.DataRead();
+}
+
+static void
+Shim_SckWrite(uint8_t Level)
+{
+  Count.SckWrite++;
+  Inner.SckWrite(Level);
+}
+
+static void
+Shim_DelayMs(uint8_t Delay)
+{
+  Count.DelayMs++;
+  Count.RequestedDelayUs += Delay * 1000U;
+  Inner.DelayMs(Delay);
+}
+
+static void
+Shim_DelayUs(uint8_t Delay)
+{
+  Count.DelayUs++;
+  Count.RequestedDelayUs += Delay;
+  Inner.DelayUs(Delay);
+}
+
+// the time slept in the hook counts as requested delay
+static uint8_t
+Shim_WaitDataLow(uint16_t TimeoutMs)
+{
+  SHT1x_Sim_t *Sim = SHT1x_Platform_GetSim();
+  const uint64_t Before = SHT1x_Sim_Now(Sim);
+  uint8_t Low;
+
+  Count.WaitDataLow++;
+  Low = Inner.WaitDataLow(TimeoutMs);
+  Count.RequestedDelayUs += (SHT1x_Sim_Now(Sim) - Before) / 1000;
+  return Low;
+}
+
+static void
+Shim_Attach(SHT1x_Handler_t *Handler)
+{
+  Inner = *Handler;
+  Handler->DataConfigDir = Shim_DataConfigDir;
+  Handler->DataWrite = Shim_DataWrite;
+  Handler->DataRead = Shim_DataRead;
+  Handler->SckWrite = Shim_SckWrite;
+  Handler->DelayMs = Shim_DelayMs;
+  Handler->DelayUs = Shim_DelayUs;
+  Handler->WaitDataLow = Inner.WaitDataLow ? Shim_WaitDataLow : NULL;
+}
+
+
+
+/**
+ ==================================================================================
+                              ##### Operations #####
+ ==================================================================================
+ */
+
+static SHT1x_Result_t
+Op_ReadSample(SHT1x_Handler_t *Handler)
+{
+  return SHT1x_ReadSample(Handler, &Sample);
+}
+
+static SHT1x_Result_t
+Op_SoftReset(SHT1x_Handler_t *Handler)
+{
+  return SHT1x_SoftReset(Handler);
+}
+
+#if (SHT1X_CONFIG_RESOLUTION_CONTROL)
+static SHT1x_Result_t
+Op_SetResolutionHigh(SHT1x_Handler_t *Handler)
+{
+  return SHT1x_SetResolution(Handler, SHT1x_HighResolution);
+}
+
+static SHT1x_Result_t
+Op_GetResolution(SHT1x_Handler_t *Handler)
+{
+  SHT1x_Resolution_t Resolution;
+  return SHT1x_GetResolution(Handler, &Resolution);
+}
+#endif
+
+#if (SHT1X_CONFIG_INTERNAL_HEATER_CONTROL)
+static SHT1x_Result_t
+Op_SetHeaterOff(SHT1x_Handler_t *Handler)
+{
+  return SHT1x_SetInternalHeater(Handler, SHT1x_HeaterOff);
+}
+#endif
+
+
+
+/**
+ ==================================================================================
+                              ##### Benchmark #####
+ ==================================================================================
+ */
+
+static uint64_t
+WallNs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+Measure(SHT1x_Handler_t *Handler, SHT1x_Sim_t *Sim, const char *Name,
+        Operation_t Operation, uint32_t Iterations, uint8_t IsSample,
+        Result_t *Result)
+{
+  const uint32_t EdgesBefore = Sim->Stats.SckEdges;
+  const uint64_t VirtualBefore = SHT1x_Sim_Now(Sim);
+  uint64_t WallBefore;
+  uint64_t WallTotal;
+  double n = Iterations;
+
+  memset(&Count, 0, sizeof(Count));
+  memset(Result, 0, sizeof(*Result));
+  snprintf(Result->Name, sizeof(Result->Name), "%s", Name);
+
+  WallBefore = WallNs();
+  for (uint32_t i = 0; i < Iterations; i++)
+  {
+    // Scripted environment: slow ramp so every sample differs
+    Sim->AmbientC = 20.0f + (i % 100) * 0.05f;
+    Sim->HumidityP = 40.0f + (i % 50) * 0.2f;
+
+    if (Operation(Handler) != SHT1x_OK)
+      Result->Failures++;
+  }
+  WallTotal = WallNs() - WallBefore;
+
+  Result->DataConfigDir = Count.DataConfigDir / n;
+  Result->DataWrite = Count.DataWrite / n;
+  Result->DataRead = Count.DataRead / n;
+  Result->SckWrite = Count.SckWrite / n;
+  Result->DelayUs = Count.DelayUs / n;
+  Result->DelayMs = Count.DelayMs / n;
+  Result->WaitDataLow = Count.WaitDataLow / n;
+  Result->RequestedDelayUs = Count.RequestedDelayUs / n;
+  Result->SckEdges = (Sim->Stats.SckEdges - EdgesBefore) / n;
+  Result->VirtualUs = (SHT1x_Sim_Now(Sim) - VirtualBefore) / 1000.0 / n;
+  Result->WallNs = WallTotal / n;
+  if (IsSample && Result->VirtualUs > 0)
+    Result->SamplesPerSecond = 1e6 / Result->VirtualUs;
+}
+
+static const Result_t *
+FindBaseline(const char *Name)
+{
+  for (int i = 0; i < BaselineCount; i++)
+  {
+    if (!strcmp(Baseline[i].Name, Name))
+      return &Baseline[i];
+  }
+
+  return NULL;
+}
+
+static const Budget_t *
+FindBudget(const char *Name)
+{
+  static const Budget_t None = {NULL, 0, 0};
+
+  for (size_t i = 0; i < sizeof(Budgets) / sizeof(Budgets[0]); i++)
+  {
+    if (!strcmp(Budgets[i].Name, Name))
+      return &Budgets[i];
+  }
+
+  return &None;
+}
+
+static int
+OverBudget(const Result_t *r)
+{
+  const Budget_t *Budget = FindBudget(r->Name);
+
+  return r->SckEdges > Budget->SckEdges || r->DataConfigDir > Budget->DataConfigDir;
+}
+
+static void
+LoadBaseline(const char *Path)
+{
+  char Line[512];
+  FILE *f = fopen(Path, "r");
+
+  if (!f)
+  {
+    fprintf(stderr, "cannot open baseline %s\n", Path);
+    return;
+  }
+
+  while (BaselineCount < MAX_BASELINE && fgets(Line, sizeof(Line), f))
+  {
+    Result_t *r = &Baseline[BaselineCount];
+    if (sscanf(Line,
+               "{\"api\":\"%31[^\"]\",\"sck_write\":%lf,\"data_write\":%lf,"
+               "\"data_read\":%lf,\"data_config_dir\":%lf,\"delay_us_calls\":%lf,"
+               "\"delay_ms_calls\":%lf,\"requested_delay_us\":%lf,\"sck_edges\":%lf,"
+               "\"virtual_us\":%lf,\"wall_ns\":%lf",
+               r->Name, &r->SckWrite, &r->DataWrite, &r->DataRead,
+               &r->DataConfigDir, &r->DelayUs, &r->DelayMs,
+               &r->RequestedDelayUs, &r->SckEdges, &r->VirtualUs,
+               &r->WallNs) == 11)
+      BaselineCount++;
+  }
+
+  fclose(f);
+}
+
+static void
+PrintJson(const Result_t *r)
+{
+  printf("{\"api\":\"%s\",\"sck_write\":%.2f,\"data_write\":%.2f,"
+         "\"data_read\":%.2f,\"data_config_dir\":%.2f,\"delay_us_calls\":%.2f,"
+         "\"delay_ms_calls\":%.2f,\"requested_delay_us\":%.2f,\"sck_edges\":%.2f,"
+         "\"virtual_us\":%.2f,\"wall_ns\":%.1f,\"samples_per_s\":%.3f,"
+         "\"failures\":%u,\"wait_calls\":%.2f}\n",
+         r->Name, r->SckWrite, r->DataWrite, r->DataRead, r->DataConfigDir,
+         r->DelayUs, r->DelayMs, r->RequestedDelayUs, r->SckEdges, r->VirtualUs,
+         r->WallNs, r->SamplesPerSecond, (unsigned)r->Failures, r->WaitDataLow);
+}
+
+// deterministic columns only, so tables of two commits can be compared with diff
+static void
+PrintTableRow(const char *Config, const Result_t *r)
+{
+  printf("%-12s %-18s %9.1f %7.1f %10.1f %11.1f%s\n", Config, r->Name,
+         r->SckWrite + r->DataWrite + r->DataRead + r->DataConfigDir +
+         r->DelayUs + r->DelayMs + r->WaitDataLow,
+         r->SckEdges, r->RequestedDelayUs, r->VirtualUs,
+         r->Failures ? "  FAILED" : "");
+}
+
+static void
+PrintRow(const Result_t *r)
+{
+  const Result_t *b = FindBaseline(r->Name);
+  const Budget_t *Budget = FindBudget(r->Name);
+
+  printf("%-22s %7.1f %7.0f %7.1f %7.1f %7.1f %7.1f %7.1f %7.1f %7.1f %10.1f %11.1f %9.1f %8.3f",
+         r->Name, r->SckEdges, Budget->SckEdges, r->SckWrite, r->DataWrite, r->DataRead, r->DataConfigDir,
+         r->DelayUs, r->DelayMs, r->WaitDataLow, r->RequestedDelayUs, r->VirtualUs, r->WallNs,
+         r->SamplesPerSecond);
+  if (b)
+    printf("  (edges %+.1f, delay %+.1f us, wall %+.1f%%)",
+           r->SckEdges - b->SckEdges, r->RequestedDelayUs - b->RequestedDelayUs,
+           b->WallNs > 0 ? 100.0 * (r->WallNs - b->WallNs) / b->WallNs : 0.0);
+  if (r->SckEdges > Budget->SckEdges)
+    printf("  OVER BUDGET (%.0f edges)", Budget->SckEdges);
+  if (r->DataConfigDir > Budget->DataConfigDir)
+    printf("  OVER BUDGET (%.0f direction writes)", Budget->DataConfigDir);
+  if (r->Failures)
+    printf("  FAILED %u", (unsigned)r->Failures);
+  printf("\n");
+}
+
+
+int main(int argc, char **argv)
+{
+  SHT1x_Handler_t Handler = {0};
+  SHT1x_Sim_t     *Sim;
+  Result_t        Results[9];
+  int             ResultCount = 0;
+  uint32_t        Iterations = 200;
+  uint8_t         Json = 0;
+  const char      *Table = NULL;
+  uint8_t         Check = 0;
+  int             Errors = 0;
+  uint8_t         (*WaitDataLow)(uint16_t TimeoutMs);
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--json"))
+      Json = 1;
+    else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+      Iterations = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--baseline") && i + 1 < argc)
+      LoadBaseline(argv[++i]);
+    else if (!strcmp(argv[i], "--check"))
+      Check = 1;
+    else if (!strcmp(argv[i], "--table") && i + 1 < argc)
+      Table = argv[++i];
+  }
+  if (!Iterations)
+    Iterations = 1;
+
+  Sim = SHT1x_Platform_GetSim();
+  SHT1x_Platform_Init(&Handler);
+  Shim_Attach(&Handler);
+  SHT1x_Init(&Handler);
+
+  // the polling path of every port without WaitDataLow, then with the hook
+  WaitDataLow = Handler.WaitDataLow;
+  Handler.WaitDataLow = NULL;
+  Measure(&Handler, Sim, "ReadSample_High", Op_ReadSample, Iterations, 1,
+          &Results[ResultCount++]);
+  if (WaitDataLow)
+  {
+    Handler.WaitDataLow = WaitDataLow;
+    Measure(&Handler, Sim, "ReadSample_Wait", Op_ReadSample, Iterations, 1,
+            &Results[ResultCount++]);
+    Handler.WaitDataLow = NULL;
+  }
+#if (SHT1X_CONFIG_RESOLUTION_CONTROL)
+  SHT1x_SetResolution(&Handler, SHT1x_LowResolution);
+  Measure(&Handler, Sim, "ReadSample_Low", Op_ReadSample, Iterations, 1,
+          &Results[ResultCount++]);
+  Measure(&Handler, Sim, "SetResolution", Op_SetResolutionHigh, Iterations, 0,
+          &Results[ResultCount++]);
+  Measure(&Handler, Sim, "GetResolution", Op_GetResolution, Iterations, 0,
+          &Results[ResultCount++]);
+#endif
+#if (SHT1X_CONFIG_INTERNAL_HEATER_CONTROL)
+  Measure(&Handler, Sim, "SetInternalHeater", Op_SetHeaterOff, Iterations, 0,
+          &Results[ResultCount++]);
+#endif
+  Measure(&Handler, Sim, "SoftReset", Op_SoftReset, Iterations, 0,
+          &Results[ResultCount++]);
+
+  if (Json)
+  {
+    for (int i = 0; i < ResultCount; i++)
+      PrintJson(&Results[i]);
+  }
+  else if (Table)
+  {
+    for (int i = 0; i < ResultCount; i++)
+    {
+      PrintTableRow(Table, &Results[i]);
+      Errors += Results[i].Failures ? 1 : 0;
+    }
+  }
+  else
+  {
+    printf("%-22s %7s %7s %7s %7s %7s %7s %7s %7s %7s %10s %11s %9s %8s\n",
+           "api (per call)", "edges", "budget", "sck", "dwrite", "dread", "dir", "us", "ms",
+           "wait", "delay[us]", "virtual[us]", "wall[ns]", "sample/s");
+    for (int i = 0; i < ResultCount; i++)
+      PrintRow(&Results[i]);
+    printf("\nprotocol violations: %u\n", (unsigned)SHT1x_Sim_Violations(Sim));
+  }
+
+  if (Check)
+  {
+    for (int i = 0; i < ResultCount; i++)
+    {
+      if (OverBudget(&Results[i]) || Results[i].Failures)
+        Errors++;
+    }
+    if (SHT1x_Sim_Violations(Sim))
+      Errors++;
+    printf("edge budget check: %s\n", Errors ? "FAILED" : "passed");
+  }
+
+  SHT1x_DeInit(&Handler);
+  return Errors ? 1 : 0;
+}
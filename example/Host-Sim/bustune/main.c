@@ -0,0 +1,291 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  bus speed tuning example for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "SHT1x.h"
+#include "SHT1x_sched.h"
+#include "SHT1x_platform.h"
+
+
+#define SAMPLES         200
+#define RESTART_SAMPLES 50
+#define BURST_SAMPLES   20
+#define RECOVER_SAMPLES 400
+
+
+/**
+ * @brief  Boards with longer cables. The line capacitance delays the rise of
+ *         DATA, which shows up as a longer output delay (tV) of the sensor.
+ */
+static const struct
+{
+  const char *Name;
+  uint32_t DataValidNs;
+} Boards[] =
+{
+  {"short traces", 250},
+  {"3 m cable",    2500},
+  {"10 m cable",   8000},
+};
+
+
+static SHT1x_Sim_t         Sim;
+static SHT1x_Handler_t     Handler;
+static SHT1x_SchedSensor_t Sensor;
+static SHT1x_Sched_t       Sched;
+static uint8_t             Halves[RECOVER_SAMPLES];
+
+
+/**
+ * @brief  Read one sample with the non-blocking API, so the time of the
+ *         transfers can be told apart from the conversions. Like
+ *         SHT1x_ReadSample, a transfer that failed and slowed the bus down is
+ *         done once more, after the conversion a failed command may have
+ *         started.
+ * @param  BusNs: Pointer to add the time of the transfers to
+ * @retval SHT1x_Result_t
+ */
+static SHT1x_Result_t
+ReadSample(SHT1x_Sample_t *Sample, uint64_t *BusNs)
+{
+  const SHT1x_Measurement_t Order[2] = {SHT1x_MeasureHumidity, SHT1x_MeasureTemperature};
+  uint16_t *Raw[2] = {&Sample->HumRaw, &Sample->TempRaw};
+  SHT1x_Result_t Result;
+  uint64_t Start;
+  uint8_t  HalfUs;
+
+  for (int i = 0, Retry = 0; i < 2; i++)
+  {
+    Start = SHT1x_Sim_Now(&Sim);
+    HalfUs = SHT1x_BusHalfPeriod(&Handler);
+    Result = SHT1x_StartMeasurement(&Handler, Order[i]);
+    *BusNs += SHT1x_Sim_Now(&Sim) - Start;
+    if (Result != SHT1x_OK)
+    {
+      if (Retry++ || SHT1x_BusHalfPeriod(&Handler) == HalfUs)
+        return SHT1x_FAIL;
+      SHT1x_Sim_Advance(&Sim, 400000000ULL);
+      i--;
+      continue;
+    }
+
+    if (Sim.DoneAt > SHT1x_Sim_Now(&Sim))
+      SHT1x_Sim_Advance(&Sim, Sim.DoneAt - SHT1x_Sim_Now(&Sim));
+    if (!SHT1x_IsResultReady(&Handler))
+      return SHT1x_TIME_OUT;
+
+    Start = SHT1x_Sim_Now(&Sim);
+    HalfUs = SHT1x_BusHalfPeriod(&Handler);
+    Result = SHT1x_ReadResult(&Handler, Raw[i]);
+    *BusNs += SHT1x_Sim_Now(&Sim) - Start;
+    if (Result != SHT1x_OK)
+    {
+      if (Retry++ || SHT1x_BusHalfPeriod(&Handler) == HalfUs)
+        return SHT1x_FAIL;
+      i--;
+    }
+  }
+
+  return SHT1x_ConvertSample(&Handler, Sample);
+}
+
+static uint32_t
+GetTimeMs(void)
+{
+  return (uint32_t)(SHT1x_Sim_Now(&Sim) / 1000000);
+}
+
+/**
+ * @brief  Start a handler on a new board.
+ */
+static void
+Attach(uint32_t DataValidNs)
+{
+  SHT1x_Sim_Init(&Sim, NULL);
+  Sim.Timing.DataValidNs = DataValidNs;
+  Sim.ActiveRiseC = 0;
+  SHT1x_Sim_Attach(&Sim, &Handler);
+  SHT1x_Init(&Handler);
+}
+
+/**
+ * @brief  Read samples and count the failed ones and the wrong values that
+ *         passed the checks.
+ * @param  Trace: Pointer to store the half period after every sample, or NULL
+ * @retval Bus time of the last sample (ns)
+ */
+static uint64_t
+Run(uint32_t Count, uint32_t *Failed, uint32_t *Wrong, uint8_t *Trace)
+{
+  SHT1x_Sample_t Sample;
+  uint64_t BusNs = 0;
+
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    BusNs = 0;
+    if (ReadSample(&Sample, &BusNs) != SHT1x_OK)
+    {
+      // a started conversion ends before the next sample
+      SHT1x_Sim_Advance(&Sim, 400000000ULL);
+      (*Failed)++;
+    }
+    else if (fabsf(Sample.TempCelsius - Sim.AmbientC) > 0.5f ||
+             fabsf(Sample.HumidityPercent - Sim.HumidityP) > 3.0f)
+    {
+      (*Wrong)++;
+    }
+
+    if (Trace)
+      Trace[i] = SHT1x_BusHalfPeriod(&Handler);
+  }
+
+  return BusNs;
+}
+
+int main(void)
+{
+  SHT1x_BusTuning_t Stored, Invalid;
+  uint64_t TunedNs, RestartNs;
+  SHT1x_Sample_t Sample;
+  uint32_t Failed, FixedFailed, Wrong, Settled, RestartFailed, Probes, Failures = 0;
+  char     Fixed[16];
+  uint8_t  Tuned;
+
+  printf("SHT1x Bus Tuning Example\r\n\r\n");
+  printf("%d samples per board, starting at the fixed 4 us half period. Levels\r\n"
+         "that are too fast fail once and are tried again less and less often.\r\n\r\n",
+         SAMPLES);
+  printf("board           tV ns  half us  settled  failed  wrong  probe viol"
+         "  bus us/sample   restart\r\n");
+
+  for (unsigned b = 0; b < sizeof(Boards) / sizeof(Boards[0]); b++)
+  {
+    Attach(Boards[b].DataValidNs);
+
+    Failed = Wrong = 0;
+    snprintf(Fixed, sizeof(Fixed), "%.1f", Run(1, &Failed, &Wrong, Halves) / 1e3);
+    FixedFailed = Failed;
+    if (Failed)
+      snprintf(Fixed, sizeof(Fixed), "fails");
+    TunedNs = Run(SAMPLES - 1, &Failed, &Wrong, &Halves[1]);
+    Tuned = SHT1x_BusHalfPeriod(&Handler);
+    for (Settled = 0; Halves[Settled] != Tuned; Settled++)
+      ;
+    Probes = SHT1x_Sim_Violations(&Sim);
+
+    // restart with the stored settings: the tuned level at once, no errors
+    SHT1x_BusTuningGet(&Handler, &Stored);
+    SHT1x_DeInit(&Handler);
+    SHT1x_Init(&Handler);
+    Failures += SHT1x_BusTuningSet(&Handler, &Stored) != SHT1x_OK;
+    Failures += SHT1x_BusHalfPeriod(&Handler) != Tuned;
+    RestartFailed = 0;
+    Run(1, &RestartFailed, &Wrong, Halves);
+    RestartNs = Run(RESTART_SAMPLES - 1, &RestartFailed, &Wrong, NULL);
+
+    printf("%-14s %6u %8u %8u %7u %6u %11u   %5s -> %5.1f  %u failed\r\n",
+           Boards[b].Name, (unsigned)Boards[b].DataValidNs, (unsigned)Tuned,
+           (unsigned)Settled + 1, (unsigned)Failed, (unsigned)Wrong, (unsigned)Probes,
+           Fixed, TunedNs / 1e3, (unsigned)RestartFailed);
+
+    // misreads are caught by the checks, failed speed-ups are retried, the
+    // bus settles within the first half and a restart starts at the tuned
+    // speed without violations. The
+    // first command after SHT1x_Init configures DATA once more, so the bus
+    // time is compared after it.
+    if (Wrong || Failed > FixedFailed || Settled >= SAMPLES / 2 || RestartFailed ||
+        Halves[0] != Tuned ||
+        SHT1x_Sim_Violations(&Sim) != Probes || RestartNs > TunedNs)
+      Failures++;
+
+    SHT1x_DeInit(&Handler);
+    SHT1x_Sim_Detach(&Sim);
+  }
+
+  // bit errors slow down the bus of the short traces, which speeds up again
+  // when they stop
+  Attach(Boards[0].DataValidNs);
+  Failed = Wrong = 0;
+  Run(SAMPLES, &Failed, &Wrong, NULL);
+  Sim.Faults.BitErrorPpm = 20000;
+  Run(BURST_SAMPLES, &Failed, &Wrong, NULL);
+  Tuned = SHT1x_BusHalfPeriod(&Handler);
+  Sim.Faults.BitErrorPpm = 0;
+  Run(RECOVER_SAMPLES, &Failed, &Wrong, Halves);
+  for (Settled = 0; Halves[Settled] != 1; Settled++)
+    ;
+  printf("\r\nBit errors on short traces: %u us half period after the burst, "
+         "back to %u us after %u samples\r\n", (unsigned)Tuned,
+         (unsigned)SHT1x_BusHalfPeriod(&Handler), (unsigned)Settled + 1);
+  if (Tuned == 1 || SHT1x_BusHalfPeriod(&Handler) != 1 || Wrong)
+    Failures++;
+
+  // SHT1x_ReadSample and the scheduler retry failed speed-ups on the 3 m
+  // cable too
+  SHT1x_DeInit(&Handler);
+  SHT1x_Sim_Detach(&Sim);
+  Attach(Boards[1].DataValidNs);
+  Failed = 0;
+  for (uint32_t i = 0; i < SAMPLES; i++)
+    Failed += SHT1x_ReadSample(&Handler, &Sample) != SHT1x_OK;
+  printf("SHT1x_ReadSample on the 3 m cable: %u of %d failed, %u us half period\r\n",
+         (unsigned)Failed, SAMPLES, (unsigned)SHT1x_BusHalfPeriod(&Handler));
+  if (Failed || SHT1x_BusHalfPeriod(&Handler) != 3)
+    Failures++;
+
+  SHT1x_DeInit(&Handler);
+  SHT1x_Sim_Detach(&Sim);
+  Attach(Boards[1].DataValidNs);
+  Sensor.Handler = &Handler;
+  Sensor.PeriodMs = 1000;
+  SHT1x_Sched_Init(&Sched, &Sensor, 1, GetTimeMs);
+  while (Sensor.Samples < SAMPLES)
+  {
+    SHT1x_Sched_Poll(&Sched);
+    SHT1x_Sim_Advance(&Sim, 1000000ULL);
+  }
+  printf("SHT1x_Sched on the 3 m cable:      %u of %d failed, %u us half period\r\n",
+         (unsigned)Sensor.Errors, SAMPLES, (unsigned)SHT1x_BusHalfPeriod(&Handler));
+  if (Sensor.Errors || SHT1x_BusHalfPeriod(&Handler) != 3)
+    Failures++;
+
+  // erased or corrupted settings are not restored
+  SHT1x_BusTuningGet(&Handler, &Stored);
+  Invalid = Stored;
+  Invalid.Level++;
+  Failures += SHT1x_BusTuningSet(&Handler, &Invalid) != SHT1x_FAIL;
+  Invalid = (SHT1x_BusTuning_t){0xFF, 0xFF, 0xFFFF};
+  Failures += SHT1x_BusTuningSet(&Handler, &Invalid) != SHT1x_FAIL;
+
+  SHT1x_DeInit(&Handler);
+  printf("%s\r\n", Failures ? "FAILED" : "OK");
+  return Failures ? 1 : 0;
+}
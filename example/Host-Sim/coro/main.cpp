@@ -0,0 +1,240 @@
+/**
+ **********************************************************************************
+ * @file   main.cpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  coroutine example for SHT1x Driver (for host simulator)
+ *         Reads several simulated sensors concurrently on one thread with
+ *         co_await, resumed by timers and then by emulated DATA edge events,
+ *         and compares the samples with SHT1x_ReadSample.
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include "SHT1x.h"
+#include "SHT1x_platform.h"
+#include "SHT1x_co.hpp"
+
+
+#define SENSOR_COUNT  8
+#define SAMPLE_COUNT  5
+
+
+static SHT1x_Sim_t     Sims[SENSOR_COUNT];
+static SHT1x_Handler_t Handlers[SENSOR_COUNT];
+static SHT1x_Sample_t  Reference[SENSOR_COUNT][SAMPLE_COUNT];
+static uint32_t        Mismatches;
+static uint32_t        Failures;
+static uint32_t        HeapAllocations;
+static uint8_t         EdgeEvents;
+static sht1x::co::Executor *Exec;
+
+
+/* Count heap allocations of the whole program ----------------------------------*/
+void *
+operator new(size_t Size)
+{
+  void *Block = malloc(Size ? Size : 1);
+
+  if (!Block)
+    throw std::bad_alloc();
+  HeapAllocations++;
+  return Block;
+}
+
+void
+operator delete(void *Block) noexcept
+{
+  free(Block);
+}
+
+void
+operator delete(void *Block, size_t) noexcept
+{
+  free(Block);
+}
+
+
+/* Executor callbacks on the virtual clock --------------------------------------*/
+static uint32_t
+NowMs(void)
+{
+  return (uint32_t)(SHT1x_Sim_Now(&Sims[0]) / 1000000);
+}
+
+/**
+ * @brief  Advance the virtual clock to the time. With EdgeEvents, stop at the
+ *         first end of conversion instead and notify the executor, as the
+ *         interrupt of a DATA falling edge would.
+ */
+static void
+IdleUntil(uint32_t Ms)
+{
+  const uint64_t Now = SHT1x_Sim_Now(&Sims[0]);
+  uint64_t Target = (uint64_t)Ms * 1000000;
+
+  if (EdgeEvents)
+  {
+    for (SHT1x_Sim_t &Sim : Sims)
+    {
+      if (Sim.DoneAt && Sim.DoneAt < Target)
+        Target = Sim.DoneAt;
+    }
+  }
+  if (Target <= Now)
+    Target = Now;
+
+  for (int i = 0; i < SENSOR_COUNT; i++)
+  {
+    const uint8_t Due = EdgeEvents && Sims[i].DoneAt && Sims[i].DoneAt <= Target;
+
+    SHT1x_Sim_Advance(&Sims[i], i ? 0 : Target - Now);
+    if (Due)
+      Exec->Notify(&Handlers[i]);
+  }
+}
+
+
+/* Tasks ------------------------------------------------------------------------*/
+static sht1x::co::Task<>
+SetLowResolution(sht1x::co::Executor &Executor)
+{
+  for (int i = 1; i < SENSOR_COUNT; i += 2)
+  {
+    sht1x::co::Sensor Sensor(Handlers[i], Executor);
+
+    // completes without suspending
+    if (co_await Sensor.SetResolution(SHT1x_LowResolution) != SHT1x_OK)
+      Failures++;
+  }
+}
+
+static sht1x::co::Task<>
+Logger(sht1x::co::Executor &Executor, sht1x::co::Wake Mode, int Index)
+{
+  sht1x::co::Sensor Sensor(Handlers[Index], Executor, Mode);
+
+  for (int i = 0; i < SAMPLE_COUNT; i++)
+  {
+    const sht1x::co::Reading R = co_await Sensor.ReadSample();
+    const SHT1x_Sample_t &Ref = Reference[Index][i];
+
+    if (R.Result != SHT1x_OK)
+      Failures++;
+    else if (R.Sample.TempRaw != Ref.TempRaw || R.Sample.HumRaw != Ref.HumRaw)
+      Mismatches++;
+  }
+}
+
+/**
+ * @brief  Read every sensor concurrently.
+ * @retval Virtual time of the run (ns)
+ */
+static uint64_t
+RunConcurrent(sht1x::co::Wake Mode)
+{
+  sht1x::co::Executor Executor(NowMs, IdleUntil);
+  const uint64_t Start = SHT1x_Sim_Now(&Sims[0]);
+
+  Exec = &Executor;
+  EdgeEvents = (Mode == sht1x::co::Wake::Edge);
+
+  for (int i = 0; i < SENSOR_COUNT; i++)
+  {
+    if (!Executor.Spawn(Logger(Executor, Mode, i)))
+      Failures++;
+  }
+  Executor.Run();
+
+  return SHT1x_Sim_Now(&Sims[0]) - Start;
+}
+
+
+int main(void)
+{
+  sht1x::co::Executor Executor(NowMs, IdleUntil);
+  uint64_t Start, SequentialNs, TimerNs, EdgeNs;
+  uint32_t Heap, Violations = 0;
+  uint8_t  Ok = 1;
+
+  printf("SHT1x Coroutine Example\r\n\r\n");
+
+  for (int i = 0; i < SENSOR_COUNT; i++)
+  {
+    SHT1x_Sim_Init(&Sims[i], NULL);
+    Sims[i].AmbientC = 18.0f + i;
+    Sims[i].HumidityP = 35.0f + 3 * i;
+    Sims[i].ActiveRiseC = 0;    // no self-heating, so every run reads the same
+    SHT1x_Sim_Attach(&Sims[i], &Handlers[i]);
+    SHT1x_Init(&Handlers[i]);
+  }
+
+  // one after the other with the blocking API
+  Start = SHT1x_Sim_Now(&Sims[0]);
+  for (int i = 0; i < SENSOR_COUNT; i++)
+  {
+    if (i & 1)
+      Failures += SHT1x_SetResolution(&Handlers[i], SHT1x_LowResolution) != SHT1x_OK;
+    for (int j = 0; j < SAMPLE_COUNT; j++)
+      Failures += SHT1x_ReadSample(&Handlers[i], &Reference[i][j]) != SHT1x_OK;
+  }
+  SequentialNs = SHT1x_Sim_Now(&Sims[0]) - Start;
+
+  // the coroutine runs, with the same resolutions
+  Exec = &Executor;
+  Heap = HeapAllocations;
+  Failures += !Executor.Spawn(SetLowResolution(Executor));
+  Executor.Run();
+
+  TimerNs = RunConcurrent(sht1x::co::Wake::Timer);
+  EdgeNs = RunConcurrent(sht1x::co::Wake::Edge);
+  Heap = HeapAllocations - Heap;
+
+  printf("%d sensors x %d samples, half of them in low resolution\r\n",
+         SENSOR_COUNT, SAMPLE_COUNT);
+  printf("  SHT1x_ReadSample one by one: %9.3f ms\r\n", SequentialNs / 1e6);
+  printf("  co_await, timer wake-up:     %9.3f ms\r\n", TimerNs / 1e6);
+  printf("  co_await, edge wake-up:      %9.3f ms\r\n", EdgeNs / 1e6);
+  printf("\r\nFrames: peak %u of %u, largest %u of %u bytes, failures %u\r\n",
+         (unsigned)sht1x::co::Frames.Peak, (unsigned)SHT1X_CO_FRAMES,
+         (unsigned)sht1x::co::Frames.Largest, (unsigned)SHT1X_CO_FRAME_SIZE,
+         (unsigned)sht1x::co::Frames.Failures);
+  printf("Heap allocations: %u\r\n", (unsigned)Heap);
+
+  for (SHT1x_Sim_t &Sim : Sims)
+    Violations += SHT1x_Sim_Violations(&Sim);
+  printf("Failures: %u, mismatches: %u, protocol violations: %u\r\n",
+         (unsigned)Failures, (unsigned)Mismatches, (unsigned)Violations);
+
+  if (Failures || Mismatches || Violations || Heap || sht1x::co::Frames.Failures ||
+      sht1x::co::Frames.InUse || TimerNs >= SequentialNs || EdgeNs > TimerNs)
+    Ok = 0;
+
+  for (SHT1x_Handler_t &Handler : Handlers)
+    SHT1x_DeInit(&Handler);
+  printf("%s\r\n", Ok ? "OK" : "FAILED");
+  return Ok ? 0 : 1;
+}
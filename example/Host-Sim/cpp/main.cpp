@@ -0,0 +1,152 @@
+/**
+ **********************************************************************************
+ * @file   main.cpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  example code for SHT1x C++ Driver (for host simulator)
+ *         Runs the C driver and sht1x::Sensor against two identical simulated
+ *         sensors and compares the results and the bus activity.
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include <type_traits>
+#include "SHT1x.h"
+#include "SHT1x_platform.h"
+#include "SHT1x_platform.hpp"
+
+
+using SensorHigh = sht1x::Sensor<sht1x::sim::Pins<0>, sht1x::Resolution::High, 5000>;
+using SensorLow  = sht1x::Sensor<sht1x::sim::Pins<1>, sht1x::Resolution::Low, 3300>;
+
+static_assert(std::is_empty<SensorHigh>::value, "Sensor must not have state");
+static_assert(!std::is_polymorphic<SensorHigh>::value, "Sensor must not have a vtable");
+
+
+static void
+SetupSim(SHT1x_Sim_t *Sim)
+{
+  SHT1x_Sim_Init(Sim, nullptr);
+  Sim->AmbientC = 23.5f;
+  Sim->HumidityP = 41.0f;
+}
+
+static void
+PrintBus(const char *Name, SHT1x_Sim_t *Sim, uint64_t Ns)
+{
+  printf("  %-4s SCK edges: %5u, DATA edges: %5u, virtual time: %.3f ms, "
+         "violations: %u\r\n",
+         Name, (unsigned)Sim->Stats.SckEdges, (unsigned)Sim->Stats.DataEdges,
+         Ns / 1e6, (unsigned)SHT1x_Sim_Violations(Sim));
+}
+
+
+int main(void)
+{
+  SHT1x_Handler_t Handler = {};
+  SHT1x_Sample_t  SampleC = {};
+  sht1x::Sample   SampleCpp = {};
+  SHT1x_Sim_Clock_t ClockC = {}, ClockCpp = {}, ClockLow = {};
+  SHT1x_Sim_t     SimC, SimCpp, SimLow;
+  SHT1x_Result_t  ResultC;
+  sht1x::Result   ResultCpp;
+  uint64_t        Start;
+  int             Mismatch = 0;
+
+  printf("SHT1x C++ Driver Example\r\n\r\n");
+
+  SetupSim(&SimC);
+  SimC.Clock = &ClockC;
+  SetupSim(&SimCpp);
+  SimCpp.Clock = &ClockCpp;
+  SetupSim(&SimLow);
+  SimLow.Clock = &ClockLow;
+  SimLow.SupplyV = 3.3f;
+
+  SHT1x_Sim_Attach(&SimC, &Handler);
+  SHT1x_Init(&Handler);
+#if (SHT1X_CONFIG_POWER_VOLTAGE_CONTROL == 0)
+  SHT1x_SetPowVoltage(&Handler, 5.0f);
+#endif
+
+  sht1x::sim::Pins<0>::Attach(&SimCpp);
+  SensorHigh::Init();
+
+  printf("C driver vs sht1x::Sensor, high resolution, 5 V\r\n");
+  for (int i = 0; i < 3; i++)
+  {
+    SimC.Stats = SHT1x_Sim_Stats_t();
+    Start = SHT1x_Sim_Now(&SimC);
+    ResultC = SHT1x_ReadSample(&Handler, &SampleC);
+    PrintBus("C", &SimC, SHT1x_Sim_Now(&SimC) - Start);
+
+    SimCpp.Stats = SHT1x_Sim_Stats_t();
+    Start = SHT1x_Sim_Now(&SimCpp);
+    ResultCpp = SensorHigh::ReadSample(SampleCpp);
+    PrintBus("C++", &SimCpp, SHT1x_Sim_Now(&SimCpp) - Start);
+
+    printf("  C:   %d, raw %5u/%5u, %f°C, %f%%\r\n",
+           ResultC, SampleC.TempRaw, SampleC.HumRaw,
+           SampleC.TempCelsius, SampleC.HumidityPercent);
+    printf("  C++: %d, raw %5u/%5u, %f°C, %f%%\r\n\r\n",
+           (int)ResultCpp, SampleCpp.TempRaw, SampleCpp.HumRaw,
+           SampleCpp.TempCelsius, SampleCpp.HumidityPercent);
+
+    if (ResultC != SHT1x_OK || ResultCpp != sht1x::Result::Ok ||
+        SampleC.TempRaw != SampleCpp.TempRaw || SampleC.HumRaw != SampleCpp.HumRaw)
+      Mismatch++;
+  }
+
+  sht1x::sim::Pins<1>::Attach(&SimLow);
+  ResultCpp = SensorLow::Init();
+  printf("sht1x::Sensor, low resolution, 3.3 V: init %d\r\n", (int)ResultCpp);
+  Start = SHT1x_Sim_Now(&SimLow);
+  ResultCpp = SensorLow::ReadSample(SampleCpp);
+  printf("  %d, raw %4u/%3u, %f°C (%f°F), %f%%, took %.1f ms\r\n",
+         (int)ResultCpp, SampleCpp.TempRaw, SampleCpp.HumRaw,
+         SampleCpp.TempCelsius, SensorLow::TempConvertRawF(SampleCpp.TempRaw),
+         SampleCpp.HumidityPercent, (SHT1x_Sim_Now(&SimLow) - Start) / 1e6);
+
+  SensorLow::SetInternalHeater(sht1x::Heater::On);
+  SHT1x_Sim_Advance(&SimLow, 30000000000ULL);
+  ResultCpp = SensorLow::ReadSample(SampleCpp);
+  printf("  heater on for 30 s: %d, %f°C, %f%%\r\n",
+         (int)ResultCpp, SampleCpp.TempCelsius, SampleCpp.HumidityPercent);
+  SensorLow::SetInternalHeater(sht1x::Heater::Off);
+
+  printf("\r\nRaw mismatches: %d, violations: %u/%u/%u\r\n", Mismatch,
+         (unsigned)SHT1x_Sim_Violations(&SimC),
+         (unsigned)SHT1x_Sim_Violations(&SimCpp),
+         (unsigned)SHT1x_Sim_Violations(&SimLow));
+
+  SimLow.Faults.DropAck = 1;
+  ResultCpp = SensorLow::ReadSample(SampleCpp);
+  printf("Fault injection, missing ACK: %d\r\n", (int)ResultCpp);
+
+  SensorHigh::DeInit();
+  SensorLow::DeInit();
+  SHT1x_DeInit(&Handler);
+
+  return Mismatch ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  timer-driven engine example for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <stdio.h>
+#include "SHT1x.h"
+#include "SHT1x_engine.h"
+#include "SHT1x_platform.h"
+
+
+#define SAMPLE_COUNT  20
+
+
+static SHT1x_Sim_t     Sim;
+static SHT1x_Handler_t Handler;
+static SHT1x_Engine_t  Engine;
+
+// simulated one-shot timer, 0: stopped
+static uint64_t        TimerAt;
+
+static uint32_t        DelayUsCalls;
+static uint32_t        DelayUsTotal;
+static void          (*SimDelayUs)(uint8_t);
+
+
+static void
+CountDelayUs(uint8_t Delay)
+{
+  DelayUsCalls++;
+  DelayUsTotal += Delay;
+  SimDelayUs(Delay);
+}
+
+static void
+TimerSchedule(uint32_t DelayUs)
+{
+  TimerAt = DelayUs ? SHT1x_Sim_Now(&Sim) + DelayUs * 1000ULL : 0;
+}
+
+/**
+ * @brief  Main loop: the CPU is free until the timer fires, then the timer
+ *         interrupt runs one tick of the engine.
+ */
+static void
+RunEngine(uint64_t *FreeNs, uint64_t *IsrNs, uint32_t *Ticks)
+{
+  uint64_t Now;
+
+  while (SHT1x_Engine_IsBusy(&Engine))
+  {
+    Now = SHT1x_Sim_Now(&Sim);
+    if (TimerAt > Now)
+    {
+      *FreeNs += TimerAt - Now;
+      SHT1x_Sim_Advance(&Sim, TimerAt - Now);
+    }
+
+    Now = SHT1x_Sim_Now(&Sim);
+    SHT1x_Engine_Tick(&Engine);
+    *IsrNs += SHT1x_Sim_Now(&Sim) - Now;
+    (*Ticks)++;
+  }
+}
+
+static uint32_t
+Compare(SHT1x_Resolution_t Resolution)
+{
+  SHT1x_Sample_t Reference[SAMPLE_COUNT];
+  uint16_t       TempRaw, HumRaw;
+  uint64_t       Start, FreeNs = 0, IsrNs = 0;
+  uint32_t       Ticks = 0;
+  uint32_t       Failures = 0;
+  uint32_t       Mismatches = 0;
+  SHT1x_Resolution_t Status;
+
+  SHT1x_SetResolution(&Handler, Resolution);
+  printf("%s resolution\r\n",
+         (Resolution == SHT1x_HighResolution) ? "High" : "Low");
+
+  // blocking driver
+  DelayUsCalls = DelayUsTotal = 0;
+  Start = SHT1x_Sim_Now(&Sim);
+  for (int i = 0; i < SAMPLE_COUNT; i++)
+    SHT1x_ReadSample(&Handler, &Reference[i]);
+  printf("  SHT1x_ReadSample  %6.1f ms per sample, %5.1f DelayUs calls (%5.1f us)\r\n",
+         (SHT1x_Sim_Now(&Sim) - Start) / 1e6 / SAMPLE_COUNT,
+         (double)DelayUsCalls / SAMPLE_COUNT, (double)DelayUsTotal / SAMPLE_COUNT);
+
+  // engine, the same measurement sequence
+  DelayUsCalls = DelayUsTotal = 0;
+  Start = SHT1x_Sim_Now(&Sim);
+  for (int i = 0; i < SAMPLE_COUNT; i++)
+  {
+    SHT1x_Engine_Measure(&Engine, SHT1x_MeasureHumidity);
+    RunEngine(&FreeNs, &IsrNs, &Ticks);
+    HumRaw = Engine.Raw;
+    if (Engine.Result != SHT1x_OK)
+      Failures++;
+
+    SHT1x_Engine_Measure(&Engine, SHT1x_MeasureTemperature);
+    RunEngine(&FreeNs, &IsrNs, &Ticks);
+    TempRaw = Engine.Raw;
+    if (Engine.Result != SHT1x_OK)
+      Failures++;
+
+    if (TempRaw != Reference[i].TempRaw || HumRaw != Reference[i].HumRaw)
+      Mismatches++;
+  }
+  printf("  SHT1x_Engine      %6.1f ms per sample, %5.1f DelayUs calls, "
+         "%5.1f ticks, %5.1f us in ISR, %5.2f%% CPU free\r\n",
+         (SHT1x_Sim_Now(&Sim) - Start) / 1e6 / SAMPLE_COUNT,
+         (double)DelayUsCalls / SAMPLE_COUNT, (double)Ticks / SAMPLE_COUNT,
+         IsrNs / 1e3 / SAMPLE_COUNT,
+         100.0 * FreeNs / (SHT1x_Sim_Now(&Sim) - Start));
+
+  SHT1x_Engine_ReadStatus(&Engine);
+  RunEngine(&FreeNs, &IsrNs, &Ticks);
+  SHT1x_GetResolution(&Handler, &Status);
+  if (Engine.Result != SHT1x_OK || (Engine.Status & 0x01) != (Status == SHT1x_LowResolution))
+    Failures++;
+
+  printf("  status 0x%02X, %u failures, %u mismatches\r\n",
+         Engine.Status, (unsigned)Failures, (unsigned)Mismatches);
+
+  return Failures + Mismatches;
+}
+
+
+int main(void)
+{
+  uint32_t Errors = 0;
+
+  printf("SHT1x Timer-Driven Engine Example\r\n\r\n");
+
+  SHT1x_Sim_Init(&Sim, NULL);
+  Sim.ActiveRiseC = 0;        // no self-heating, so both drivers read the same values
+  SHT1x_Sim_Attach(&Sim, &Handler);
+  Handler.WaitDataLow = NULL; // both drivers poll DATA during conversions
+  SimDelayUs = Handler.DelayUs;
+  Handler.DelayUs = CountDelayUs;
+  SHT1x_Init(&Handler);
+  SHT1x_Engine_Init(&Engine, &Handler, TimerSchedule);
+
+  Errors += Compare(SHT1x_HighResolution);
+  Errors += Compare(SHT1x_LowResolution);
+
+  // missing ACK
+  Sim.Faults.DropAck = 1;
+  SHT1x_Engine_Measure(&Engine, SHT1x_MeasureTemperature);
+  {
+    uint64_t FreeNs = 0, IsrNs = 0;
+    uint32_t Ticks = 0;
+    RunEngine(&FreeNs, &IsrNs, &Ticks);
+  }
+  printf("\r\nMissing ACK: result %d\r\n", Engine.Result);
+  if (Engine.Result != SHT1x_FAIL)
+    Errors++;
+
+  printf("Protocol violations: %u, errors: %u\r\n",
+         (unsigned)SHT1x_Sim_Violations(&Sim), (unsigned)Errors);
+
+  SHT1x_DeInit(&Handler);
+  return Errors ? 1 : 0;
+}
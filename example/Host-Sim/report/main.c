@@ -0,0 +1,175 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  report-by-exception example for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "SHT1x.h"
+#include "SHT1x_platform.h"
+
+
+#define PERIOD_S        10
+#define DAYS            2
+#define SAMPLE_COUNT    (DAYS * 86400 / PERIOD_S)
+#define TEMP_BAND_C     0.3f
+#define HUM_BAND_P      2.0f
+#define HEARTBEAT_MS    (15 * 60 * 1000UL)
+
+
+static SHT1x_Sim_t     Sim;
+static SHT1x_Handler_t Handler;
+static uint32_t        Rand = 12345;
+
+
+/**
+ * @brief  Uniform noise in [-Amplitude, Amplitude]
+ */
+static double
+Noise(double Amplitude)
+{
+  Rand = Rand * 1103515245 + 12345;
+  return Amplitude * (((Rand >> 8) & 0xFFFF) / 32767.5 - 1.0);
+}
+
+/**
+ * @brief  A room with a small daily swing and sensor noise. On the second
+ *         afternoon a window is open for 20 minutes.
+ */
+static void
+Environment(uint32_t TimeS)
+{
+  const double Phase = 2 * 3.14159265358979 * TimeS / 86400.0;
+  const uint32_t Open = 86400 + 14 * 3600;
+  double Drop = 0;
+
+  if (TimeS >= Open && TimeS < Open + 1200)
+    Drop = 1 - exp(-(TimeS - Open) / 180.0);
+  else if (TimeS >= Open + 1200)
+    Drop = (1 - exp(-1200 / 180.0)) * exp(-(TimeS - Open - 1200) / 900.0);
+
+  Sim.AmbientC = (float)(21.5 + 0.3 * sin(Phase) - 5 * Drop + Noise(0.03));
+  Sim.HumidityP = (float)(45 - 2 * sin(Phase) + 20 * Drop + Noise(0.3));
+}
+
+/**
+ * @brief  Read two days of samples and report them by exception.
+ * @retval Number of failed checks
+ */
+static uint32_t
+Run(SHT1x_Resolution_t Resolution)
+{
+  const float TempSlack = TEMP_BAND_C + (Resolution == SHT1x_LowResolution ? 0.04f : 0.01f);
+  const float HumSlack = HUM_BAND_P + (Resolution == SHT1x_LowResolution ? 0.65f : 0.05f);
+  SHT1x_Sample_t Sample, Reported = {0};
+  uint32_t Reports = 0, Failures = 0, Errors = 0;
+  uint32_t LastMs = 0, MaxGapMs = 0, TransientReports = 0;
+  uint32_t NowMs;
+
+  Failures += SHT1x_SetResolution(&Handler, Resolution) != SHT1x_OK;
+  Failures += SHT1x_ReportConfig(&Handler, TEMP_BAND_C, HUM_BAND_P, HEARTBEAT_MS) != SHT1x_OK;
+
+  for (uint32_t i = 0; i < SAMPLE_COUNT; i++)
+  {
+    NowMs = i * PERIOD_S * 1000;
+    Environment(i * PERIOD_S);
+    if (SHT1x_ReadSample(&Handler, &Sample) != SHT1x_OK)
+    {
+      Errors++;
+      continue;
+    }
+
+    if (SHT1x_ReportCheck(&Handler, &Sample, NowMs))
+    {
+      if (Reports && NowMs - LastMs > MaxGapMs)
+        MaxGapMs = NowMs - LastMs;
+      if (NowMs >= (86400 + 14 * 3600) * 1000UL && NowMs < (86400 + 16 * 3600) * 1000UL)
+        TransientReports++;
+      Reported = Sample;
+      LastMs = NowMs;
+      Reports++;
+    }
+    else if (fabsf(Sample.TempCelsius - Reported.TempCelsius) > TempSlack ||
+             fabsf(Sample.HumidityPercent - Reported.HumidityPercent) > HumSlack)
+    {
+      // a skipped sample must stay within the deadbands of the reported one
+      Failures++;
+    }
+  }
+
+  printf("%s resolution: deadbands %u/%u counts, %u of %u samples reported (1 in %.0f)\r\n",
+         Resolution == SHT1x_LowResolution ? "Low " : "High",
+         Handler.ReportTempBand[Resolution], Handler.ReportHumBand[Resolution],
+         (unsigned)Reports, (unsigned)SAMPLE_COUNT, (double)SAMPLE_COUNT / Reports);
+  printf("  longest gap %u s, %u reports while the window was open\r\n",
+         (unsigned)(MaxGapMs / 1000), (unsigned)TransientReports);
+
+  if (Errors || MaxGapMs > HEARTBEAT_MS || TransientReports < 10 ||
+      Reports * 10 > SAMPLE_COUNT)
+    Failures++;
+
+  return Failures;
+}
+
+
+int main(void)
+{
+  SHT1x_Sample_t Sample;
+  uint32_t       Failures = 0;
+
+  printf("SHT1x Report-by-Exception Example\r\n\r\n");
+  printf("deadbands %.1f C and %.1f %%RH, heartbeat %lu s, a sample every %d s\r\n\r\n",
+         TEMP_BAND_C, HUM_BAND_P, HEARTBEAT_MS / 1000, PERIOD_S);
+
+  SHT1x_Sim_Init(&Sim, NULL);
+  SHT1x_Sim_Attach(&Sim, &Handler);
+  SHT1x_Init(&Handler);
+
+  Failures += Run(SHT1x_HighResolution);
+  Failures += Run(SHT1x_LowResolution);
+
+  // the first sample after a configuration, a reset or a change of resolution
+  // is reported
+  SHT1x_ReportConfig(&Handler, TEMP_BAND_C, HUM_BAND_P, 0);
+  SHT1x_ReadSample(&Handler, &Sample);
+  Failures += SHT1x_ReportCheck(&Handler, &Sample, 0) != 1;
+  Failures += SHT1x_ReportCheck(&Handler, &Sample, 0) != 0;
+  SHT1x_ReportReset(&Handler);
+  Failures += SHT1x_ReportCheck(&Handler, &Sample, 0) != 1;
+  SHT1x_SetResolution(&Handler, SHT1x_HighResolution);
+  SHT1x_ReadSample(&Handler, &Sample);
+  Failures += SHT1x_ReportCheck(&Handler, &Sample, 0) != 1;
+  Failures += SHT1x_ReportConfig(&Handler, -1, 0, 0) != SHT1x_FAIL;
+
+  printf("\r\nProtocol violations: %u\r\n", (unsigned)SHT1x_Sim_Violations(&Sim));
+  Failures += SHT1x_Sim_Violations(&Sim);
+
+  SHT1x_DeInit(&Handler);
+  printf("%s\r\n", Failures ? "FAILED" : "OK");
+  return Failures ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  rollup store example for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "SHT1x.h"
+#include "SHT1x_rollup.h"
+#include "SHT1x_platform.h"
+
+
+#define PERIOD_S      20
+#define DAYS          35
+#define SAMPLE_COUNT  (DAYS * 86400 / PERIOD_S)
+#define ADD_CALLS     10000000
+#define FAST_TEMP_RAW 16000
+#define FAST_HUM_RAW  3000
+
+
+static SHT1x_Sim_t     Sim;
+static SHT1x_Handler_t Handler;
+static SHT1x_Rollup_t  Rollup;
+static uint16_t        TempRaw[SAMPLE_COUNT];
+static uint16_t        HumRaw[SAMPLE_COUNT];
+
+
+static uint64_t
+NowNs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief  Aggregate the samples of the newest Buckets periods of a level
+ *         directly from the sample history.
+ */
+static void
+BruteForce(uint32_t Width, uint32_t Buckets, uint32_t Samples,
+           SHT1x_RollupSummary_t *Result)
+{
+  uint32_t Newest = ((Samples - 1) * PERIOD_S) / Width;
+  uint32_t Period;
+
+  Result->Count = Result->TempSum = Result->HumSum = 0;
+  Result->TempMin = Result->HumMin = 0xFFFF;
+  Result->TempMax = Result->HumMax = 0;
+
+  for (uint32_t i = 0; i < Samples; i++)
+  {
+    Period = (i * PERIOD_S) / Width;
+    if (Period + Buckets <= Newest)
+      continue;
+    Result->Count++;
+    Result->TempSum += TempRaw[i];
+    Result->HumSum += HumRaw[i];
+    if (TempRaw[i] < Result->TempMin) Result->TempMin = TempRaw[i];
+    if (TempRaw[i] > Result->TempMax) Result->TempMax = TempRaw[i];
+    if (HumRaw[i] < Result->HumMin) Result->HumMin = HumRaw[i];
+    if (HumRaw[i] > Result->HumMax) Result->HumMax = HumRaw[i];
+  }
+}
+
+static int
+Check(const char *Name, SHT1x_RollupLevel_t Level, uint32_t Width,
+      uint8_t Buckets, uint32_t Samples)
+{
+  SHT1x_RollupSummary_t Summary;
+  SHT1x_RollupSummary_t Expected;
+  int Match;
+
+  SHT1x_Rollup_Summary(&Rollup, Level, Buckets, &Summary);
+  BruteForce(Width, Buckets, Samples, &Expected);
+
+  Match = Summary.Count == Expected.Count &&
+          Summary.TempSum == Expected.TempSum && Summary.HumSum == Expected.HumSum &&
+          Summary.TempMin == Expected.TempMin && Summary.TempMax == Expected.TempMax &&
+          Summary.HumMin == Expected.HumMin && Summary.HumMax == Expected.HumMax &&
+          Summary.TempAvg == (Expected.TempSum + Expected.Count / 2) / Expected.Count &&
+          Summary.HumAvg == (Expected.HumSum + Expected.Count / 2) / Expected.Count;
+
+  printf("%-10s %7u samples  T %5u..%5u avg %5u  RH %4u..%4u avg %4u  %s\r\n",
+         Name, (unsigned)Summary.Count, Summary.TempMin, Summary.TempMax,
+         Summary.TempAvg, Summary.HumMin, Summary.HumMax, Summary.HumAvg,
+         Match ? "match" : "MISMATCH");
+
+  return !Match;
+}
+
+/**
+ * @brief  A month of 1 Hz samples: the merged sums exceed 32 bits.
+ */
+static int
+CheckMonthAt1Hz(void)
+{
+  SHT1x_RollupSummary_t Summary;
+  const uint32_t Seconds = SHT1X_ROLLUP_DAYS * 86400;
+  int Match;
+
+  SHT1x_Rollup_Init(&Rollup);
+  for (uint32_t t = 0; t < Seconds; t++)
+    SHT1x_Rollup_AddRaw(&Rollup, t, FAST_TEMP_RAW, FAST_HUM_RAW);
+
+  SHT1x_Rollup_Summary(&Rollup, SHT1x_RollupDay, SHT1X_ROLLUP_DAYS, &Summary);
+  Match = Summary.Count == Seconds &&
+          Summary.TempSum == (uint64_t)Seconds * FAST_TEMP_RAW &&
+          Summary.HumSum == (uint64_t)Seconds * FAST_HUM_RAW &&
+          Summary.TempAvg == FAST_TEMP_RAW && Summary.HumAvg == FAST_HUM_RAW;
+
+  printf("1 Hz month %7u samples  T sum %llu avg %5u  RH sum %llu avg %4u  %s\r\n",
+         (unsigned)Summary.Count, (unsigned long long)Summary.TempSum, Summary.TempAvg,
+         (unsigned long long)Summary.HumSum, Summary.HumAvg, Match ? "match" : "MISMATCH");
+
+  return !Match;
+}
+
+static int
+RoundTrip(const char *Name, SHT1x_RollupLevel_t Level, uint8_t Buckets)
+{
+  static uint8_t       Buffer[SHT1X_ROLLUP_SERIAL_SIZE(SHT1X_ROLLUP_MINUTES)];
+  SHT1x_RollupBucket_t Decoded[SHT1X_ROLLUP_MINUTES];
+  SHT1x_RollupBucket_t Bucket;
+  SHT1x_RollupLevel_t  DecodedLevel;
+  uint32_t             StartS, DecodedStartS;
+  uint16_t             Length;
+  uint8_t              Count;
+  uint32_t             Errors = 0;
+
+  Length = SHT1x_Rollup_Serialize(&Rollup, Level, Buckets, Buffer, sizeof(Buffer));
+  Count = SHT1x_Rollup_Deserialize(Buffer, Length, &DecodedLevel, &DecodedStartS,
+                                   Decoded, SHT1X_ROLLUP_MINUTES);
+  SHT1x_Rollup_Get(&Rollup, Level, 0, &Bucket, &StartS);
+  if (Count != Buckets || DecodedLevel != Level || DecodedStartS != StartS)
+    Errors++;
+
+  for (uint8_t Age = 0; Age < Count; Age++)
+  {
+    SHT1x_Rollup_Get(&Rollup, Level, Age, &Bucket, NULL);
+    if (Decoded[Age].Count != Bucket.Count ||
+        Decoded[Age].TempMin != Bucket.TempMin || Decoded[Age].TempMax != Bucket.TempMax ||
+        Decoded[Age].HumMin != Bucket.HumMin || Decoded[Age].HumMax != Bucket.HumMax)
+      Errors++;
+    else if (Bucket.Count &&
+             (fabs((double)Decoded[Age].TempSum - Bucket.TempSum) > Bucket.Count / 2.0 ||
+              fabs((double)Decoded[Age].HumSum - Bucket.HumSum) > Bucket.Count / 2.0))
+      Errors++;
+  }
+
+  printf("%-10s %2u buckets  %4u bytes (%4.1f per bucket, worst case %u)  round trip %s\r\n",
+         Name, Buckets, Length, (double)(Length - 6) / Buckets,
+         (unsigned)SHT1X_ROLLUP_SERIAL_SIZE(Buckets), Errors ? "FAILED" : "ok");
+
+  return Errors != 0;
+}
+
+
+int main(void)
+{
+  SHT1x_Sample_t Sample;
+  uint32_t       Failures = 0;
+  uint32_t       Rejected = 0;
+  uint32_t       Violations;
+  uint64_t       Start;
+  double         Phase;
+
+  printf("SHT1x Rollup Example\r\n\r\n");
+
+  SHT1x_Sim_Init(&Sim, NULL);
+  SHT1x_Sim_Attach(&Sim, &Handler);
+  SHT1x_Init(&Handler);
+  SHT1x_Rollup_Init(&Rollup);
+
+  // a sample every PERIOD_S seconds, daily and hourly ambient swings
+  for (uint32_t i = 0; i < SAMPLE_COUNT; i++)
+  {
+    Phase = 2 * 3.14159265358979 * (i * PERIOD_S) / 86400.0;
+    Sim.AmbientC = 22 + 6 * sin(Phase) + 0.5 * sin(24 * Phase);
+    Sim.HumidityP = 50 - 15 * sin(Phase);
+
+    if (SHT1x_ReadSample(&Handler, &Sample) != SHT1x_OK)
+      Failures++;
+    TempRaw[i] = Sample.TempRaw;
+    HumRaw[i] = Sample.HumRaw;
+    if (SHT1x_Rollup_Add(&Rollup, i * PERIOD_S, &Sample) != SHT1x_OK)
+      Rejected++;
+  }
+  printf("%u samples over %u days, %u read failures, %u rejected\r\n\r\n",
+         (unsigned)SAMPLE_COUNT, DAYS, (unsigned)Failures, (unsigned)Rejected);
+
+  Failures = 0;
+  Failures += Check("last hour", SHT1x_RollupMinute, 60, SHT1X_ROLLUP_MINUTES, SAMPLE_COUNT);
+  Failures += Check("last day", SHT1x_RollupHour, 3600, SHT1X_ROLLUP_HOURS, SAMPLE_COUNT);
+  Failures += Check("last month", SHT1x_RollupDay, 86400, SHT1X_ROLLUP_DAYS, SAMPLE_COUNT);
+
+  // a sample older than every level is rejected, one within the day level is not
+  if (SHT1x_Rollup_AddRaw(&Rollup, 0, 0, 0) != SHT1x_FAIL ||
+      SHT1x_Rollup_AddRaw(&Rollup, (DAYS - 2) * 86400, TempRaw[0], HumRaw[0]) != SHT1x_OK)
+    Failures++;
+
+  printf("\r\n");
+  Failures += RoundTrip("minutes", SHT1x_RollupMinute, SHT1X_ROLLUP_MINUTES);
+  Failures += RoundTrip("hours", SHT1x_RollupHour, SHT1X_ROLLUP_HOURS);
+  Failures += RoundTrip("days", SHT1x_RollupDay, SHT1X_ROLLUP_DAYS);
+
+  printf("\r\n");
+  Failures += CheckMonthAt1Hz();
+
+  printf("\r\nsizeof(SHT1x_Rollup_t): %u bytes\r\n", (unsigned)sizeof(SHT1x_Rollup_t));
+
+  Start = NowNs();
+  for (uint32_t i = 0; i < ADD_CALLS; i++)
+    SHT1x_Rollup_AddRaw(&Rollup, DAYS * 86400 + i, (uint16_t)i & 0x3FFF, (uint16_t)i & 0xFFF);
+  printf("SHT1x_Rollup_AddRaw: %.1f ns per sample (host)\r\n",
+         (double)(NowNs() - Start) / ADD_CALLS);
+
+  Violations = 0;
+  for (int i = 0; i < SHT1x_Sim_ViolationCount; i++)
+    Violations += Sim.Stats.Violations[i];
+  printf("\r\nProtocol violations: %u, checks failed: %u\r\n",
+         (unsigned)Violations, (unsigned)Failures);
+
+  SHT1x_DeInit(&Handler);
+  return Failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  multi-sensor scheduler example for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include "SHT1x.h"
+#include "SHT1x_sched.h"
+#include "SHT1x_platform.h"
+
+
+#define SENSOR_COUNT  12
+#define RUN_TIME_MS   10000
+
+
+static SHT1x_Sim_t         Sims[SENSOR_COUNT];
+static SHT1x_Handler_t     Handlers[SENSOR_COUNT];
+static SHT1x_SchedSensor_t Sensors[SENSOR_COUNT];
+
+
+static uint32_t
+GetTimeMs(void)
+{
+  return (uint32_t)(SHT1x_Sim_Now(&Sims[0]) / 1000000);
+}
+
+static void
+OnSample(uint8_t Index, SHT1x_SchedSensor_t *Sensor)
+{
+  if (Sensor->Result != SHT1x_OK)
+    printf("  %8u ms: sensor %2u failed: %d\r\n",
+           (unsigned)GetTimeMs(), Index, Sensor->Result);
+}
+
+
+int main(void)
+{
+  SHT1x_Sched_t  Sched;
+  SHT1x_Sample_t Sample;
+  uint64_t       Start;
+  uint32_t       Idle;
+  uint32_t       Violations = 0;
+
+  printf("SHT1x Scheduler Example\r\n\r\n");
+
+  for (int i = 0; i < SENSOR_COUNT; i++)
+  {
+    SHT1x_Sim_Init(&Sims[i], NULL);   // all sensors share one virtual clock
+    Sims[i].AmbientC = 20.0f + i;
+    Sims[i].HumidityP = 30.0f + 3 * i;
+    SHT1x_Sim_Attach(&Sims[i], &Handlers[i]);
+    SHT1x_Init(&Handlers[i]);
+  }
+
+  // one sensor after the other, each one blocks the CPU for a full conversion
+  Start = SHT1x_Sim_Now(&Sims[0]);
+  for (int i = 0; i < SENSOR_COUNT; i++)
+    SHT1x_ReadSample(&Handlers[i], &Sample);
+  printf("Sequential SHT1x_ReadSample sweep: %.1f ms\r\n",
+         (SHT1x_Sim_Now(&Sims[0]) - Start) / 1e6);
+
+  // all conversions overlap
+  for (int i = 0; i < SENSOR_COUNT; i++)
+  {
+    Sensors[i].Handler = &Handlers[i];
+    Sensors[i].PeriodMs = 0;
+  }
+  SHT1x_Sched_Init(&Sched, Sensors, SENSOR_COUNT, GetTimeMs);
+
+  Start = SHT1x_Sim_Now(&Sims[0]);
+  SHT1x_Sched_Sweep(&Sched);
+  printf("Scheduled sweep:                   %.1f ms\r\n\r\n",
+         (SHT1x_Sim_Now(&Sims[0]) - Start) / 1e6);
+
+  for (int i = 0; i < SENSOR_COUNT; i++)
+    printf("  sensor %2d: %d, Temperature: %6.2f°C, Humidity: %6.2f%%\r\n", i,
+           Sensors[i].Result, Sensors[i].Sample.TempCelsius,
+           Sensors[i].Sample.HumidityPercent);
+
+  // periodic sampling, the last two periods are shorter than a conversion
+  for (int i = 0; i < SENSOR_COUNT; i++)
+    Sensors[i].PeriodMs = 1000;
+  Sensors[SENSOR_COUNT - 2].PeriodMs = 500;
+  Sensors[SENSOR_COUNT - 1].PeriodMs = 250;
+  SHT1x_Sched_Init(&Sched, Sensors, SENSOR_COUNT, GetTimeMs);
+  Sched.OnSample = OnSample;
+
+  printf("\r\nPeriodic sampling for %u ms\r\n", RUN_TIME_MS);
+  Start = SHT1x_Sim_Now(&Sims[0]);
+  while ((SHT1x_Sim_Now(&Sims[0]) - Start) < RUN_TIME_MS * 1000000ULL)
+  {
+    SHT1x_Sched_Poll(&Sched);
+
+    // sleep until the next sample is due, or for 1 ms during conversions
+    Idle = SHT1x_Sched_IdleTime(&Sched);
+    if (Idle == 0)
+      Idle = 1;
+    if (Idle > RUN_TIME_MS)
+      Idle = RUN_TIME_MS;
+    SHT1x_Sim_Advance(&Sims[0], Idle * 1000000ULL);
+  }
+
+  for (int i = 0; i < SENSOR_COUNT; i++)
+  {
+    printf("  sensor %2d: period %4u ms, samples %3u, errors %u, missed %3u",
+           i, (unsigned)Sensors[i].PeriodMs, (unsigned)Sensors[i].Samples,
+           (unsigned)Sensors[i].Errors, (unsigned)Sensors[i].Missed);
+    if (Sensors[i].Missed)
+      printf(" (last %u ms late)", (unsigned)Sensors[i].LateMs);
+    printf("\r\n");
+  }
+
+  for (int i = 0; i < SENSOR_COUNT; i++)
+  {
+    for (int j = 0; j < SHT1x_Sim_ViolationCount; j++)
+      Violations += Sims[i].Stats.Violations[j];
+  }
+  printf("\r\nProtocol violations: %u\r\n", (unsigned)Violations);
+
+  for (int i = 0; i < SENSOR_COUNT; i++)
+    SHT1x_DeInit(&Handlers[i]);
+  return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Dispatch cost of SHT1x Driver (for host simulator)
+ *         Built by the makefile with runtime binding (handler callbacks) and
+ *         with SHT1X_CONFIG_STATIC_PORT, with and without LTO. Reports the
+ *         median and the 10th/90th percentile of the wall time per API call
+ *         over many rounds; the simulator itself is part of every call.
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "SHT1x.h"
+#include "SHT1x_platform.h"
+
+
+#if defined(MODE_NAME)
+  // set by the makefile (static+lto)
+#elif (SHT1X_CONFIG_STATIC_PORT)
+  #define MODE_NAME "static"
+#else
+  #define MODE_NAME "runtime"
+#endif
+
+
+#define MAX_ROUNDS  255
+
+
+static double
+WallNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int
+CompareDouble(const void *a, const void *b)
+{
+  const double A = *(const double *)a, B = *(const double *)b;
+  return (A > B) - (A < B);
+}
+
+// median and the spread between the 10th and the 90th percentile
+static void
+PrintRounds(const char *Name, double *Ns, uint8_t Rounds)
+{
+  qsort(Ns, Rounds, sizeof(*Ns), CompareDouble);
+  printf("%-10s %-13s median %8.1f ns, p10 %8.1f ns, p90 %8.1f ns\r\n", MODE_NAME,
+         Name, Ns[Rounds / 2], Ns[Rounds / 10], Ns[Rounds - 1 - Rounds / 10]);
+}
+
+
+int main(int argc, char *argv[])
+{
+  SHT1x_Handler_t    Handler = {0};
+  SHT1x_Sample_t     Sample = {0};
+  SHT1x_Resolution_t Resolution;
+  uint32_t           Iterations = 2000;
+  unsigned long      Rounds = 51;
+  uint32_t           Failures = 0;
+  static double      SampleNs[MAX_ROUNDS], StatusNs[MAX_ROUNDS];
+  double             Start;
+
+  if (argc > 1)
+    Iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+  if (argc > 2)
+    Rounds = strtoul(argv[2], NULL, 0);
+  if (!Iterations || !Rounds || Rounds > MAX_ROUNDS)
+  {
+    fprintf(stderr, "usage: %s [iterations > 0] [rounds 1..%u]\n", argv[0],
+            (unsigned)MAX_ROUNDS);
+    return 2;
+  }
+
+  SHT1x_Platform_Init(&Handler);
+  SHT1x_Init(&Handler);
+
+  // many short rounds; the median filters out scheduling noise
+  for (uint8_t Round = 0; Round < Rounds; Round++)
+  {
+    Start = WallNs();
+    for (uint32_t i = 0; i < Iterations; i++)
+      Failures += (SHT1x_ReadSample(&Handler, &Sample) != SHT1x_OK);
+    SampleNs[Round] = (WallNs() - Start) / Iterations;
+
+    Start = WallNs();
+    for (uint32_t i = 0; i < Iterations; i++)
+      Failures += (SHT1x_GetResolution(&Handler, &Resolution) != SHT1x_OK);
+    StatusNs[Round] = (WallNs() - Start) / Iterations;
+  }
+
+  PrintRounds("ReadSample", SampleNs, (uint8_t)Rounds);
+  PrintRounds("GetResolution", StatusNs, (uint8_t)Rounds);
+  printf("%-10s failures %u, violations %u\r\n", MODE_NAME, (unsigned)Failures,
+         (unsigned)SHT1x_Sim_Violations(SHT1x_Platform_GetSim()));
+
+  SHT1x_DeInit(&Handler);
+
+  return Failures ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  streaming example for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include "SHT1x.h"
+#include "SHT1x_platform.h"
+
+
+#define SAMPLE_COUNT  20      // temperature/humidity pairs
+#define BUFFER_SIZE   16
+
+
+typedef struct Counters_s
+{
+  uint64_t Start;
+  uint32_t SckEdges;
+  uint32_t DataEdges;
+  uint32_t Commands;
+  uint32_t Dirs;
+} Counters_t;
+
+typedef struct Collector_s
+{
+  uint16_t TempRaw[SAMPLE_COUNT];
+  uint16_t HumRaw[SAMPLE_COUNT];
+  uint32_t Temps;
+  uint32_t Hums;
+  uint32_t Limit;
+} Collector_t;
+
+
+static SHT1x_Sim_t     Sim;
+static SHT1x_Handler_t Handler;
+static uint32_t        DirCalls;
+static void          (*SimDataConfigDir)(uint8_t);
+
+
+static void
+CountDataConfigDir(uint8_t Dir)
+{
+  DirCalls++;
+  SimDataConfigDir(Dir);
+}
+
+static void
+CountersStart(Counters_t *Counters)
+{
+  Counters->Start = SHT1x_Sim_Now(&Sim);
+  Counters->SckEdges = Sim.Stats.SckEdges;
+  Counters->DataEdges = Sim.Stats.DataEdges;
+  Counters->Commands = Sim.Stats.Commands;
+  Counters->Dirs = DirCalls;
+}
+
+static void
+CountersPrint(const char *Name, Counters_t *Counters)
+{
+  uint32_t Commands = Sim.Stats.Commands - Counters->Commands;
+
+  printf("%-26s %5.1f ms  %6.1f sck  %5.1f data  %5.1f dir  (per conversion)\r\n",
+         Name, (SHT1x_Sim_Now(&Sim) - Counters->Start) / 1e6 / Commands,
+         (double)(Sim.Stats.SckEdges - Counters->SckEdges) / Commands,
+         (double)(Sim.Stats.DataEdges - Counters->DataEdges) / Commands,
+         (double)(DirCalls - Counters->Dirs) / Commands);
+}
+
+static void
+Collect(void *Context, SHT1x_Measurement_t Measurement, uint16_t Raw)
+{
+  Collector_t *Collector = (Collector_t *)Context;
+
+  if (Measurement == SHT1x_MeasureTemperature)
+    Collector->TempRaw[Collector->Temps++] = Raw;
+  else
+    Collector->HumRaw[Collector->Hums++] = Raw;
+
+  if (Collector->Temps + Collector->Hums >= Collector->Limit)
+    SHT1x_StreamStop(&Handler);
+}
+
+
+int main(void)
+{
+  SHT1x_Sample_t       Sample;
+  SHT1x_Sample_t       Reference[SAMPLE_COUNT];
+  Collector_t          Collector = {0};
+  SHT1x_StreamBuffer_t Buffer;
+  uint16_t             Raw[BUFFER_SIZE];
+  Counters_t           Counters;
+  uint32_t             Mismatches = 0;
+  uint32_t             Violations;
+  SHT1x_Result_t       Result;
+
+  printf("SHT1x Streaming Example\r\n\r\n");
+
+  SHT1x_Sim_Init(&Sim, NULL);
+  Sim.ActiveRiseC = 0;        // no self-heating, so both loops read the same values
+  SHT1x_Sim_Attach(&Sim, &Handler);
+  SimDataConfigDir = Handler.DataConfigDir;
+  Handler.DataConfigDir = CountDataConfigDir;
+  SHT1x_Init(&Handler);
+
+  // tight loop of blocking reads
+  CountersStart(&Counters);
+  for (int i = 0; i < SAMPLE_COUNT; i++)
+    SHT1x_ReadSample(&Handler, &Reference[i]);
+  CountersPrint("SHT1x_ReadSample loop", &Counters);
+
+  // sink, commands issued back to back
+  Collector.Limit = 2 * SAMPLE_COUNT;
+  CountersStart(&Counters);
+  SHT1x_StreamStart(&Handler, Collect, &Collector, SHT1x_StreamAlternate);
+  Result = SHT1x_StreamRun(&Handler);
+  CountersPrint("SHT1x_StreamRun, sink", &Counters);
+
+  for (int i = 0; i < SAMPLE_COUNT; i++)
+  {
+    if (Collector.TempRaw[i] != Reference[i].TempRaw ||
+        Collector.HumRaw[i] != Reference[i].HumRaw)
+      Mismatches++;
+  }
+  printf("  result %d, %u temperature and %u humidity results, %u mismatches\r\n",
+         Result, (unsigned)Collector.Temps, (unsigned)Collector.Hums,
+         (unsigned)Mismatches);
+
+  // caller buffer, temperature only
+  Buffer.Raw = Raw;
+  Buffer.Size = BUFFER_SIZE;
+  Buffer.Count = 0;
+  CountersStart(&Counters);
+  SHT1x_StreamStart(&Handler, NULL, &Buffer, SHT1x_StreamTemperature);
+  Result = SHT1x_StreamRun(&Handler);
+  CountersPrint("SHT1x_StreamRun, buffer", &Counters);
+  printf("  result %d, %u results:", Result, (unsigned)Buffer.Count);
+  for (uint32_t i = 0; i < Buffer.Count; i++)
+    printf(" %u", Raw[i]);
+  printf("\r\n");
+
+  // non-blocking, stopped from outside the sink
+  Collector.Temps = Collector.Hums = 0;
+  Collector.Limit = 0xFFFFFFFF;
+  SHT1x_StreamStart(&Handler, Collect, &Collector, SHT1x_StreamAlternate);
+  while (Collector.Temps < 3)
+  {
+    SHT1x_StreamPoll(&Handler);
+    SHT1x_Sim_Advance(&Sim, 1000000);
+  }
+  Result = SHT1x_StreamStop(&Handler);
+  printf("\r\nSHT1x_StreamPoll: %u results, stop %d, streaming %u\r\n",
+         (unsigned)(Collector.Temps + Collector.Hums), Result,
+         SHT1x_IsStreaming(&Handler));
+
+  Result = SHT1x_ReadSample(&Handler, &Sample);
+  printf("SHT1x_ReadSample after stop: %d, raw %u/%u\r\n",
+         Result, Sample.TempRaw, Sample.HumRaw);
+
+  Violations = 0;
+  for (int i = 0; i < SHT1x_Sim_ViolationCount; i++)
+    Violations += Sim.Stats.Violations[i];
+  printf("\r\nProtocol violations: %u\r\n", (unsigned)Violations);
+
+  SHT1x_DeInit(&Handler);
+  return 0;
+}
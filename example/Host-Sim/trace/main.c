@@ -0,0 +1,143 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Bus waveform capture example for SHT1x Driver (for host simulator)
+ *
+ *         Usage: output [VCD_FILE BIN_FILE]
+ *                output --convert BIN_FILE VCD_FILE
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SHT1x.h"
+#include "SHT1x_trace.h"
+#include "SHT1x_platform.h"
+
+
+#define TRACE_EVENTS  2048
+
+static uint32_t TraceBuffer[TRACE_EVENTS];
+static FILE *Output;
+
+
+static uint32_t
+GetTimeNs(void)
+{
+  return (uint32_t)SHT1x_Sim_Now(SHT1x_Platform_GetSim());
+}
+
+static void
+WriteFile(const uint8_t *Data, uint16_t Len)
+{
+  fwrite(Data, 1, Len, Output);
+}
+
+static int
+Convert(const char *BinPath, const char *VcdPath)
+{
+  uint8_t *Data;
+  long Len;
+  FILE *f = fopen(BinPath, "rb");
+
+  if (!f)
+    return 1;
+  fseek(f, 0, SEEK_END);
+  Len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  Data = malloc(Len);
+  if (!Data || fread(Data, 1, Len, f) != (size_t)Len)
+  {
+    fclose(f);
+    free(Data);
+    return 1;
+  }
+  fclose(f);
+
+  Output = fopen(VcdPath, "w");
+  if (!Output)
+  {
+    free(Data);
+    return 1;
+  }
+
+  if (SHT1x_Trace_BinaryToVcd(Data, (uint32_t)Len, WriteFile) != SHT1x_OK)
+    printf("%s is not a valid trace\r\n", BinPath);
+
+  fclose(Output);
+  free(Data);
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  SHT1x_Handler_t Handler = {0};
+  SHT1x_Sample_t  Sample = {0};
+  const char      *VcdPath = "build/trace.vcd";
+  const char      *BinPath = "build/trace.bin";
+  uint32_t        Lost;
+
+  if (argc == 4 && !strcmp(argv[1], "--convert"))
+    return Convert(argv[2], argv[3]);
+  if (argc == 3)
+  {
+    VcdPath = argv[1];
+    BinPath = argv[2];
+  }
+
+  SHT1x_Platform_Init(&Handler);
+  SHT1x_Trace_Attach(&Handler, TraceBuffer, TRACE_EVENTS, GetTimeNs, SHT1x_TraceStop);
+  SHT1x_Init(&Handler);
+
+  SHT1x_ReadSample(&Handler, &Sample);
+  printf("Temperature: %f°C, Humidity: %f%%\r\n",
+         Sample.TempCelsius, Sample.HumidityPercent);
+  printf("Events: %u, lost: ", SHT1x_Trace_Count(&Lost));
+  printf("%u\r\n", (unsigned)Lost);
+
+  // GetTime counts nanoseconds: 1000 ps per tick
+  Output = fopen(VcdPath, "w");
+  if (Output)
+  {
+    SHT1x_Trace_DumpVcd(WriteFile, 1000);
+    fclose(Output);
+  }
+
+  Output = fopen(BinPath, "wb");
+  if (Output)
+  {
+    SHT1x_Trace_DumpBinary(WriteFile, 1000);
+    fclose(Output);
+  }
+
+  printf("Wrote %s and %s\r\n", VcdPath, BinPath);
+
+  SHT1x_Trace_Detach(&Handler);
+  SHT1x_DeInit(&Handler);
+  return 0;
+}
@@ -0,0 +1,239 @@
+/**
+ **********************************************************************************
+ * @file   main.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  waveform example for SHT1x Driver (for host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <time.h>
+#include "SHT1x.h"
+#include "SHT1x_platform.h"
+
+
+#define SAMPLE_COUNT  20
+#define CALL_COUNT    200
+
+
+static SHT1x_Sim_t     Sim;
+static SHT1x_Handler_t Handler;
+static SHT1x_Handler_t Inner;     // callbacks of the simulator
+static uint32_t        Calls;
+
+
+/* Callbacks that count the calls of the driver ---------------------------------*/
+static void
+CountDataConfigDir(uint8_t Dir)
+{
+  Calls++;
+  Inner.DataConfigDir(Dir);
+}
+
+static void
+CountDataWrite(uint8_t Level)
+{
+  Calls++;
+  Inner.DataWrite(Level);
+}
+
+static uint8_t
+CountDataRead(void)
+{
+  Calls++;
+  return Inner.DataRead();
+}
+
+static void
+CountSckWrite(uint8_t Level)
+{
+  Calls++;
+  Inner.SckWrite(Level);
+}
+
+static void
+CountDelayUs(uint8_t Delay)
+{
+  Calls++;
+  Inner.DelayUs(Delay);
+}
+
+static void
+CountDelayMs(uint8_t Delay)
+{
+  Calls++;
+  Inner.DelayMs(Delay);
+}
+
+static uint8_t
+CountWaitDataLow(uint16_t TimeoutMs)
+{
+  Calls++;
+  return Inner.WaitDataLow(TimeoutMs);
+}
+
+static void
+CountEmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count, uint8_t *Samples)
+{
+  Calls++;
+  Inner.EmitWaveform(Steps, Count, Samples);
+}
+
+
+static double
+HostNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void
+UseWaveform(uint8_t Enable)
+{
+  Handler.EmitWaveform = Enable ? CountEmitWaveform : NULL;
+}
+
+/**
+ * @brief  Print the bus time, callback calls and host time of one API call.
+ */
+static void
+Report(const char *Name, uint32_t Count, uint64_t BusNs, uint32_t CallsBefore,
+       double HostStart)
+{
+  printf("  %-22s %9.1f us bus  %6.1f calls  %7.0f ns host\r\n", Name,
+         BusNs / 1e3 / Count, (double)(Calls - CallsBefore) / Count,
+         (HostNs() - HostStart) / Count);
+}
+
+/**
+ * @brief  Run every API in one mode and keep its results for the comparison.
+ */
+static uint32_t
+RunApis(uint8_t Waveform, SHT1x_Sample_t *Samples, SHT1x_Resolution_t *Status)
+{
+  uint64_t Start;
+  uint32_t CallsBefore;
+  uint32_t Failures = 0;
+  double   HostStart;
+
+  UseWaveform(Waveform);
+  printf("%s\r\n", Waveform ? "EmitWaveform" : "Pins one by one");
+
+  // the conversion wait (DelayMs and DataRead polls) is the same in both modes
+  Start = SHT1x_Sim_Now(&Sim);
+  CallsBefore = Calls;
+  HostStart = HostNs();
+  for (int i = 0; i < SAMPLE_COUNT; i++)
+    Failures += SHT1x_ReadSample(&Handler, &Samples[i]) != SHT1x_OK;
+  Report("SHT1x_ReadSample", SAMPLE_COUNT, SHT1x_Sim_Now(&Sim) - Start,
+         CallsBefore, HostStart);
+
+  Start = SHT1x_Sim_Now(&Sim);
+  CallsBefore = Calls;
+  HostStart = HostNs();
+  for (int i = 0; i < CALL_COUNT; i++)
+    Failures += SHT1x_GetResolution(&Handler, Status) != SHT1x_OK;
+  Report("SHT1x_GetResolution", CALL_COUNT, SHT1x_Sim_Now(&Sim) - Start,
+         CallsBefore, HostStart);
+
+  Start = SHT1x_Sim_Now(&Sim);
+  CallsBefore = Calls;
+  HostStart = HostNs();
+  for (int i = 0; i < CALL_COUNT; i++)
+    Failures += SHT1x_SetResolution(&Handler, (i & 1) ? SHT1x_HighResolution :
+                                                        SHT1x_LowResolution) != SHT1x_OK;
+  Report("SHT1x_SetResolution", CALL_COUNT, SHT1x_Sim_Now(&Sim) - Start,
+         CallsBefore, HostStart);
+
+  Start = SHT1x_Sim_Now(&Sim);
+  CallsBefore = Calls;
+  HostStart = HostNs();
+  Failures += SHT1x_SoftReset(&Handler) != SHT1x_OK;
+  Report("SHT1x_SoftReset", 1, SHT1x_Sim_Now(&Sim) - Start, CallsBefore,
+         HostStart);
+  SHT1x_Sim_Advance(&Sim, 20000000);
+
+  return Failures;
+}
+
+
+int main(void)
+{
+  SHT1x_Sample_t     Edges[SAMPLE_COUNT], Wave[SAMPLE_COUNT];
+  SHT1x_Resolution_t EdgesStatus, WaveStatus;
+  SHT1x_Sample_t     Sample;
+  uint32_t           Failures;
+  uint32_t           Mismatches = 0;
+  uint8_t            Ok = 1;
+
+  printf("SHT1x Waveform Example\r\n\r\n");
+
+  SHT1x_Sim_Init(&Sim, NULL);
+  Sim.ActiveRiseC = 0;        // no self-heating, so both modes read the same values
+  SHT1x_Sim_Attach(&Sim, &Handler);
+  Handler.WaitDataLow = NULL; // poll DATA, as most MCU ports do
+  Inner = Handler;
+  Handler.DataConfigDir = CountDataConfigDir;
+  Handler.DataWrite = CountDataWrite;
+  Handler.DataRead = CountDataRead;
+  Handler.SckWrite = CountSckWrite;
+  Handler.DelayUs = CountDelayUs;
+  Handler.DelayMs = CountDelayMs;
+  if (Inner.WaitDataLow)
+    Handler.WaitDataLow = CountWaitDataLow;
+  SHT1x_Init(&Handler);
+
+  Failures = RunApis(0, Edges, &EdgesStatus);
+  Failures += RunApis(1, Wave, &WaveStatus);
+
+  for (int i = 0; i < SAMPLE_COUNT; i++)
+  {
+    if (Edges[i].TempRaw != Wave[i].TempRaw || Edges[i].HumRaw != Wave[i].HumRaw)
+      Mismatches++;
+  }
+  printf("\r\nFailures: %u, mismatches: %u, status %d/%d\r\n",
+         (unsigned)Failures, (unsigned)Mismatches, EdgesStatus, WaveStatus);
+  if (Failures || Mismatches || EdgesStatus != WaveStatus)
+    Ok = 0;
+
+  // faults are seen through the sampled bits as well
+  Sim.Faults.DropAck = 1;
+  printf("Missing ACK: result %d\r\n", SHT1x_ReadSample(&Handler, &Sample));
+  Ok &= SHT1x_ReadSample(&Handler, &Sample) == SHT1x_OK;
+  Sim.Faults.FlipMask = 0x01;
+  printf("Flipped bit: result %d\r\n", SHT1x_ReadSample(&Handler, &Sample));
+  Ok &= SHT1x_ReadSample(&Handler, &Sample) == SHT1x_OK;
+
+  printf("Protocol violations: %u\r\n", (unsigned)SHT1x_Sim_Violations(&Sim));
+  if (SHT1x_Sim_Violations(&Sim))
+    Ok = 0;
+
+  SHT1x_DeInit(&Handler);
+  printf("%s\r\n", Ok ? "OK" : "FAILED");
+  return Ok ? 0 : 1;
+}
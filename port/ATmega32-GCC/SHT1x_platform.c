@@ -30,80 +30,93 @@
   
 /* Includes ---------------------------------------------------------------------*/
 #include "SHT1x_platform.h"
-#include <avr/io.h>
-#include <util/delay.h>
+#if (SHT1X_CONFIG_WAVEFORM)
+#include "SHT1x_wave.h"
+#endif
+#if (SHT1x_DATA_USE_INT0 || SHT1x_ENGINE_TIMER1)
+#include <avr/interrupt.h>
+#endif
+#if (SHT1x_DATA_USE_INT0)
+#include <avr/sleep.h>
+#endif
+
+
+#if (SHT1x_DATA_USE_INT0)
+/* Private Variables ------------------------------------------------------------*/
+static volatile uint8_t  SHT1x_Port_DataFell;
+static volatile uint16_t SHT1x_Port_Ticks;
 
 
 
 /**
  ==================================================================================
-                           ##### Private Functions #####                           
+                           ##### Private Functions #####
  ==================================================================================
  */
 
-static void
-SHT1x_Platform_PlatformInit(void)
+ISR(INT0_vect)
 {
-  SHT1x_SCK_DDR |= (1<<SHT1x_SCK_NUM);
-  SHT1x_DATA_DDR |= (1<<SHT1x_DATA_NUM);
+  GICR &= ~(1<<INT0);
+  SHT1x_Port_DataFell = 1;
 }
 
-static void
-SHT1x_Platform_PlatformDeInit(void)
+ISR(TIMER2_COMP_vect)
 {
-  SHT1x_SCK_PORT &= ~(1<<SHT1x_SCK_NUM);
-  SHT1x_SCK_DDR &= ~(1<<SHT1x_SCK_NUM);
-
-  SHT1x_DATA_PORT &= ~(1<<SHT1x_DATA_NUM);
-  SHT1x_DATA_DDR &= ~(1<<SHT1x_DATA_NUM);
+  SHT1x_Port_Ticks++;
 }
+#endif
 
-static void
-SHT1x_Platform_DataConfigDir(uint8_t Dir)
-{
-  if (Dir)
-    SHT1x_DATA_DDR |= (1<<SHT1x_DATA_NUM);
-  else
-    SHT1x_DATA_DDR &= ~(1<<SHT1x_DATA_NUM);
-}
 
-static void
-SHT1x_Platform_DataWrite(uint8_t Level)
-{
-  if (Level)
-    SHT1x_DATA_PORT |= (1<<SHT1x_DATA_NUM);
-  else
-    SHT1x_DATA_PORT &= ~(1<<SHT1x_DATA_NUM);
-}
+#if (SHT1x_ENGINE_TIMER1)
+/* Private Variables ------------------------------------------------------------*/
+static SHT1x_Engine_t *SHT1x_Platform_Engine = NULL;
+static uint32_t SHT1x_Platform_EngineRemain = 0;    // Timer1 counts
 
-static uint8_t
-SHT1x_Platform_DataRead(void)
-{
-  return (SHT1x_DATA_PIN >> SHT1x_DATA_NUM) & 0x01;
-}
 
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+// Timer1 in CTC mode, clk/8; longer delays run in 16-bit pieces
 static void
-SHT1x_Platform_SckWrite(uint8_t Level)
+SHT1x_Platform_EngineArm(uint32_t Counts)
 {
-  if (Level)
-    SHT1x_SCK_PORT |= (1<<SHT1x_SCK_NUM);
-  else
-    SHT1x_SCK_PORT &= ~(1<<SHT1x_SCK_NUM);
+  const uint16_t Now = (Counts > 0x10000) ? 0 : (uint16_t)Counts;
+
+  SHT1x_Platform_EngineRemain = Counts - (Now ? Now : 0x10000);
+  OCR1A = Now - 1;
+  TCNT1 = 0;
+  TIFR = (1<<OCF1A);
+  TIMSK |= (1<<OCIE1A);
+  TCCR1B = (1<<WGM12) | (1<<CS11);
 }
 
 static void
-SHT1x_Platform_DelayMs(uint8_t Delay)
+SHT1x_Platform_EngineSchedule(uint32_t DelayUs)
 {
-  for (; Delay; --Delay)
-    _delay_ms(1);
+  TCCR1B = 0;
+  TIMSK &= ~(1<<OCIE1A);
+  if (DelayUs)
+    SHT1x_Platform_EngineArm(DelayUs * (F_CPU / 1000000UL) / 8 + 1);
 }
 
-static void
-SHT1x_Platform_DelayUs(uint8_t Delay)
+ISR(TIMER1_COMPA_vect)
 {
-  for (; Delay; --Delay)
-    _delay_us(1);
+  if (SHT1x_Platform_EngineRemain)
+  {
+    SHT1x_Platform_EngineArm(SHT1x_Platform_EngineRemain);
+    return;
+  }
+
+  TCCR1B = 0;
+  TIMSK &= ~(1<<OCIE1A);
+  if (SHT1x_Platform_Engine)
+    SHT1x_Engine_Tick(SHT1x_Platform_Engine);
 }
+#endif
 
 
 
@@ -121,14 +134,105 @@ SHT1x_Platform_DelayUs(uint8_t Delay)
 SHT1x_Result_t
 SHT1x_Platform_Init(SHT1x_Handler_t *Handler)
 {
-  Handler->PlatformInit = SHT1x_Platform_PlatformInit;
-  Handler->PlatformDeInit = SHT1x_Platform_PlatformDeInit;
-  Handler->DataConfigDir = SHT1x_Platform_DataConfigDir;
-  Handler->DataWrite = SHT1x_Platform_DataWrite;
-  Handler->DataRead = SHT1x_Platform_DataRead;
-  Handler->SckWrite = SHT1x_Platform_SckWrite;
-  Handler->DelayMs = SHT1x_Platform_DelayMs;
-  Handler->DelayUs = SHT1x_Platform_DelayUs;
+#if (SHT1X_CONFIG_STATIC_PORT)
+  (void)Handler;
+#else
+  Handler->PlatformInit = SHT1x_Port_PlatformInit;
+  Handler->PlatformDeInit = SHT1x_Port_PlatformDeInit;
+  Handler->DataConfigDir = SHT1x_Port_DataConfigDir;
+  Handler->DataWrite = SHT1x_Port_DataWrite;
+  Handler->DataRead = SHT1x_Port_DataRead;
+  Handler->SckWrite = SHT1x_Port_SckWrite;
+  Handler->DelayMs = SHT1x_Port_DelayMs;
+  Handler->DelayUs = SHT1x_Port_DelayUs;
+#if (SHT1x_DATA_USE_INT0)
+  Handler->WaitDataLow = SHT1x_Port_WaitDataLow;
+#endif
+#if (SHT1X_CONFIG_WAVEFORM)
+  Handler->EmitWaveform = SHT1x_Port_EmitWaveform;
+#endif
+#endif
 
   return SHT1x_OK;
 }
+
+
+#if (SHT1x_DATA_USE_INT0)
+/**
+ * @brief  Sleep until DATA is low or the timeout passes.
+ * @param  TimeoutMs: Timeout (ms)
+ * @retval 1: DATA is low, 0: Timeout
+ */
+uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs)
+{
+  SHT1x_Port_DataFell = 0;
+  SHT1x_Port_Ticks = 0;
+
+  // INT0 on falling edge
+  MCUCR = (MCUCR & ~((1<<ISC01) | (1<<ISC00))) | (1<<ISC01);
+  GIFR = (1<<INTF0);
+  GICR |= (1<<INT0);
+
+  // Timer2 CTC, 1 ms
+  OCR2 = (uint8_t)(F_CPU / 64 / 1000 - 1);
+  TCNT2 = 0;
+  TIFR = (1<<OCF2);
+  TIMSK |= (1<<OCIE2);
+  TCCR2 = (1<<WGM21) | (1<<CS22);
+
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  for (;;)
+  {
+    // check and sleep with interrupts off, sei takes effect after sleep
+    cli();
+    if (SHT1x_Port_DataFell || !SHT1x_Port_DataRead() ||
+        SHT1x_Port_Ticks > TimeoutMs)
+      break;
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+  }
+  sei();
+
+  TCCR2 = 0;
+  TIMSK &= ~(1<<OCIE2);
+  GICR &= ~(1<<INT0);
+
+  return SHT1x_Port_DataRead() ? 0 : 1;
+}
+#endif
+
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Play a waveform with the shared player of SHT1x_wave.h.
+ * @param  Steps: Waveform
+ * @param  Count: Number of steps
+ * @param  Samples: DATA samples, MSB first (zeroed by the caller)
+ * @retval None
+ */
+void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples)
+{
+  SHT1x_Wave_Play(Steps, Count, Samples);
+}
+#endif
+
+
+#if (SHT1x_ENGINE_TIMER1)
+/**
+ * @brief  Initialize Engine on Timer1. Global interrupts must be enabled.
+ * @param  Engine: Pointer to engine
+ * @param  Handler: Pointer to initialized handler
+ * @retval None
+ */
+void
+SHT1x_Platform_EngineInit(SHT1x_Engine_t *Engine, SHT1x_Handler_t *Handler)
+{
+  SHT1x_Platform_Engine = Engine;
+  SHT1x_Engine_Init(Engine, Handler, SHT1x_Platform_EngineSchedule);
+}
+#endif
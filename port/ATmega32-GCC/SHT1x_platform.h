@@ -40,6 +40,8 @@ extern "C" {
 /* Includes ---------------------------------------------------------------------*/
 #include <stdint.h>
 #include "SHT1x.h"
+#include <avr/io.h>
+#include <util/delay.h>
 
 
 /* Functionality Options --------------------------------------------------------*/
@@ -54,6 +56,117 @@ extern "C" {
 #define SHT1x_SCK_PORT  PORTA
 #define SHT1x_SCK_NUM   1
 
+/**
+ * @brief  Set to 1 when DATA is connected to INT0 (PD2, set the DATA pins
+ *         above accordingly). The CPU then sleeps in idle mode during
+ *         conversions; Timer2 counts the timeout and global interrupts are
+ *         enabled.
+ */
+#define SHT1x_DATA_USE_INT0  0
+
+/**
+ * @brief  Set to 1 to run SHT1x_engine on Timer1 (compare A interrupt). A
+ *         tick takes a few hundred cycles, so use a HalfPeriodUs above 4 us
+ *         on slow clocks.
+ */
+#define SHT1x_ENGINE_TIMER1  0
+
+
+
+/**
+ ==================================================================================
+                             ##### Port Functions #####                            
+ ==================================================================================
+ */
+
+/**
+ * @brief  Pin and delay functions. SHT1x.c calls them directly when
+ *         SHT1X_CONFIG_STATIC_PORT is enabled; otherwise SHT1x_Platform_Init
+ *         puts them into the handler.
+ */
+
+static inline void
+SHT1x_Port_PlatformInit(void)
+{
+  SHT1x_SCK_DDR |= (1<<SHT1x_SCK_NUM);
+  SHT1x_DATA_DDR |= (1<<SHT1x_DATA_NUM);
+}
+
+static inline void
+SHT1x_Port_PlatformDeInit(void)
+{
+  SHT1x_SCK_PORT &= ~(1<<SHT1x_SCK_NUM);
+  SHT1x_SCK_DDR &= ~(1<<SHT1x_SCK_NUM);
+
+  SHT1x_DATA_PORT &= ~(1<<SHT1x_DATA_NUM);
+  SHT1x_DATA_DDR &= ~(1<<SHT1x_DATA_NUM);
+}
+
+static inline void
+SHT1x_Port_DataConfigDir(uint8_t Dir)
+{
+  if (Dir)
+    SHT1x_DATA_DDR |= (1<<SHT1x_DATA_NUM);
+  else
+    SHT1x_DATA_DDR &= ~(1<<SHT1x_DATA_NUM);
+}
+
+static inline void
+SHT1x_Port_DataWrite(uint8_t Level)
+{
+  if (Level)
+    SHT1x_DATA_PORT |= (1<<SHT1x_DATA_NUM);
+  else
+    SHT1x_DATA_PORT &= ~(1<<SHT1x_DATA_NUM);
+}
+
+static inline uint8_t
+SHT1x_Port_DataRead(void)
+{
+  return (SHT1x_DATA_PIN >> SHT1x_DATA_NUM) & 0x01;
+}
+
+static inline void
+SHT1x_Port_SckWrite(uint8_t Level)
+{
+  if (Level)
+    SHT1x_SCK_PORT |= (1<<SHT1x_SCK_NUM);
+  else
+    SHT1x_SCK_PORT &= ~(1<<SHT1x_SCK_NUM);
+}
+
+static inline void
+SHT1x_Port_DelayMs(uint8_t Delay)
+{
+  for (; Delay; --Delay)
+    _delay_ms(1);
+}
+
+static inline void
+SHT1x_Port_DelayUs(uint8_t Delay)
+{
+  for (; Delay; --Delay)
+    _delay_us(1);
+}
+
+#if (SHT1x_DATA_USE_INT0)
+#define SHT1X_PORT_HAS_WAIT_DATA_LOW  1
+
+uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs);
+#endif
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Play a waveform in a tight loop on the port registers.
+ */
+#define SHT1X_PORT_HAS_EMIT_WAVEFORM  1
+
+void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples);
+#endif
+
 
 
 /**
@@ -71,6 +184,20 @@ SHT1x_Result_t
 SHT1x_Platform_Init(SHT1x_Handler_t *Handler);
 
 
+#if (SHT1x_ENGINE_TIMER1)
+#include "SHT1x_engine.h"
+
+/**
+ * @brief  Initialize Engine on Timer1. Global interrupts must be enabled.
+ * @param  Engine: Pointer to engine
+ * @param  Handler: Pointer to initialized handler
+ * @retval None
+ */
+void
+SHT1x_Platform_EngineInit(SHT1x_Engine_t *Engine, SHT1x_Handler_t *Handler);
+#endif
+
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,153 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_platform.hpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Pin policy of SHT1x C++ driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_PLATFORM_HPP_
+#define _SHT1X_PLATFORM_HPP_
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include <avr/io.h>
+#include <util/delay.h>
+#include "SHT1x.hpp"
+
+
+namespace sht1x
+{
+namespace avr
+{
+
+/**
+ * @brief  Data-space addresses of PORTx on ATmega32. DDRx and PINx are located
+ *         at PORTx - 1 and PORTx - 2. Plain numbers are used because the avr-libc
+ *         register macros are not constant expressions in C++.
+ */
+constexpr uint8_t PortA = 0x3B;
+constexpr uint8_t PortB = 0x38;
+constexpr uint8_t PortC = 0x35;
+constexpr uint8_t PortD = 0x32;
+
+
+/**
+ * @brief  Pin policy for sht1x::Sensor
+ * @param  DataPort: Port of DATA pin (PortA ... PortD)
+ * @param  DataNum: Bit number of DATA pin
+ * @param  SckPort: Port of SCK pin (PortA ... PortD)
+ * @param  SckNum: Bit number of SCK pin
+ * @note   All registers are in the I/O space, so every access compiles to a
+ *         single sbi/cbi/sbic instruction.
+ */
+template <uint8_t DataPort, uint8_t DataNum, uint8_t SckPort, uint8_t SckNum>
+struct Pins
+{
+  template <uint8_t Address>
+  static inline volatile uint8_t &
+  Reg()
+  {
+    return *reinterpret_cast<volatile uint8_t *>(Address);
+  }
+
+  static inline void
+  Init()
+  {
+    Reg<SckPort - 1>() |= (1<<SckNum);
+    Reg<DataPort - 1>() |= (1<<DataNum);
+  }
+
+  static inline void
+  DeInit()
+  {
+    Reg<SckPort>() &= ~(1<<SckNum);
+    Reg<SckPort - 1>() &= ~(1<<SckNum);
+
+    Reg<DataPort>() &= ~(1<<DataNum);
+    Reg<DataPort - 1>() &= ~(1<<DataNum);
+  }
+
+  static inline void
+  DataConfigDir(uint8_t Dir)
+  {
+    if (Dir)
+      Reg<DataPort - 1>() |= (1<<DataNum);
+    else
+      Reg<DataPort - 1>() &= ~(1<<DataNum);
+  }
+
+  static inline void
+  DataWrite(uint8_t Level)
+  {
+    if (Level)
+      Reg<DataPort>() |= (1<<DataNum);
+    else
+      Reg<DataPort>() &= ~(1<<DataNum);
+  }
+
+  static inline uint8_t
+  DataRead()
+  {
+    return (Reg<DataPort - 2>() >> DataNum) & 0x01;
+  }
+
+  static inline void
+  SckWrite(uint8_t Level)
+  {
+    if (Level)
+      Reg<SckPort>() |= (1<<SckNum);
+    else
+      Reg<SckPort>() &= ~(1<<SckNum);
+  }
+
+  template <uint8_t Us>
+  static inline void
+  DelayUs()
+  {
+    _delay_us(Us);
+  }
+
+  template <uint8_t Ms>
+  static inline void
+  DelayMs()
+  {
+    _delay_ms(Ms);
+  }
+};
+
+
+/**
+ * @brief  Same pins as the C port (SHT1x_platform.h): DATA on PA0, SCK on PA1
+ */
+using DefaultPins = Pins<PortA, 0, PortA, 1>;
+
+} // namespace avr
+} // namespace sht1x
+
+
+#endif //! _SHT1X_PLATFORM_HPP_
@@ -30,112 +30,171 @@
   
 /* Includes ---------------------------------------------------------------------*/
 #include "SHT1x_platform.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "driver/gpio.h"
-#include "rom/ets_sys.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#if (SHT1X_CONFIG_WAVEFORM)
+#include "SHT1x_wave.h"
+#endif
+#if (SHT1x_ENGINE_TIMER)
+#include "esp_timer.h"
+#endif
+
+
+/* Private Variables ------------------------------------------------------------*/
+static SemaphoreHandle_t SHT1x_Port_DataSem = NULL;
+#if (SHT1x_ENGINE_TIMER)
+static esp_timer_handle_t SHT1x_Platform_EngineTimer = NULL;
+#endif
 
 
 
 /**
  ==================================================================================
-                           ##### Private Functions #####                           
+                           ##### Private Functions #####
  ==================================================================================
  */
 
-static void
-SHT1x_SetGPIO_OUT(gpio_num_t GPIO_Pad)
+static void IRAM_ATTR
+SHT1x_Port_DataIsr(void *Arg)
 {
-  gpio_reset_pin(GPIO_Pad);
-  gpio_set_direction(GPIO_Pad, GPIO_MODE_OUTPUT);
-}
+  BaseType_t Woken = pdFALSE;
 
-static void
-SHT1x_SetGPIO_IN_PU(gpio_num_t GPIO_Pad)
-{
-  gpio_reset_pin(GPIO_Pad);
-  gpio_set_direction(GPIO_Pad, GPIO_MODE_INPUT);
-  gpio_set_pull_mode(GPIO_Pad, GPIO_PULLUP_ONLY);
+  (void)Arg;
+  gpio_intr_disable(SHT1x_DATA_GPIO);
+  xSemaphoreGiveFromISR(SHT1x_Port_DataSem, &Woken);
+  if (Woken)
+    portYIELD_FROM_ISR();
 }
 
-
-static void
-SHT1x_Platform_PlatformInit(void)
+#if (SHT1x_ENGINE_TIMER)
+static void IRAM_ATTR
+SHT1x_Platform_EngineTimerCb(void *Arg)
 {
-  SHT1x_SetGPIO_OUT(SHT1x_SCK_GPIO);
-  SHT1x_SetGPIO_OUT(SHT1x_DATA_GPIO);
+  SHT1x_Engine_Tick((SHT1x_Engine_t *)Arg);
 }
 
-static void
-SHT1x_Platform_PlatformDeInit(void)
+static void IRAM_ATTR
+SHT1x_Platform_EngineSchedule(uint32_t DelayUs)
 {
-  gpio_reset_pin(SHT1x_SCK_GPIO);
-  gpio_reset_pin(SHT1x_DATA_GPIO);
+  esp_timer_stop(SHT1x_Platform_EngineTimer);
+  if (DelayUs)
+    esp_timer_start_once(SHT1x_Platform_EngineTimer, DelayUs);
 }
+#endif
 
-static void
-SHT1x_Platform_DataConfigDir(uint8_t Dir)
-{
-  if (Dir)
-    SHT1x_SetGPIO_OUT(SHT1x_DATA_GPIO);
-  else
-    SHT1x_SetGPIO_IN_PU(SHT1x_DATA_GPIO);
-}
 
-static void
-SHT1x_Platform_DataWrite(uint8_t Level)
-{
-  gpio_set_level(SHT1x_DATA_GPIO, Level);
-}
 
-static uint8_t
-SHT1x_Platform_DataRead(void)
-{
-  return gpio_get_level(SHT1x_DATA_GPIO);
-}
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
 
-static void
-SHT1x_Platform_SckWrite(uint8_t Level)
+/**
+ * @brief  Initialize platform device to communicate SHT1x.
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_Platform_Init(SHT1x_Handler_t *Handler)
 {
-  gpio_set_level(SHT1x_SCK_GPIO, Level);
-}
+#if (SHT1X_CONFIG_STATIC_PORT)
+  (void)Handler;
+#else
+  Handler->PlatformInit = SHT1x_Port_PlatformInit;
+  Handler->PlatformDeInit = SHT1x_Port_PlatformDeInit;
+  Handler->DataConfigDir = SHT1x_Port_DataConfigDir;
+  Handler->DataWrite = SHT1x_Port_DataWrite;
+  Handler->DataRead = SHT1x_Port_DataRead;
+  Handler->SckWrite = SHT1x_Port_SckWrite;
+  Handler->DelayMs = SHT1x_Port_DelayMs;
+  Handler->DelayUs = SHT1x_Port_DelayUs;
+  Handler->WaitDataLow = SHT1x_Port_WaitDataLow;
+#if (SHT1X_CONFIG_WAVEFORM)
+  Handler->EmitWaveform = SHT1x_Port_EmitWaveform;
+#endif
+#endif
 
-static void
-SHT1x_Platform_DelayMs(uint8_t Delay)
-{
-  vTaskDelay(Delay / portTICK_PERIOD_MS);
+  return SHT1x_OK;
 }
 
-static void
-SHT1x_Platform_DelayUs(uint8_t Delay)
+
+/**
+ * @brief  Sleep until DATA is low or the timeout passes.
+ * @param  TimeoutMs: Timeout (ms)
+ * @retval 1: DATA is low, 0: Timeout
+ */
+uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs)
 {
-  ets_delay_us(Delay);
-}
+  if (!SHT1x_Port_DataSem)
+  {
+    SHT1x_Port_DataSem = xSemaphoreCreateBinary();
+    // ESP_ERR_INVALID_STATE if the application has installed it already
+    gpio_install_isr_service(0);
+    gpio_isr_handler_add(SHT1x_DATA_GPIO, SHT1x_Port_DataIsr, NULL);
+  }
 
+  xSemaphoreTake(SHT1x_Port_DataSem, 0);
+  gpio_set_intr_type(SHT1x_DATA_GPIO, GPIO_INTR_NEGEDGE);
+  gpio_intr_enable(SHT1x_DATA_GPIO);
 
+  // the edge may have passed before the interrupt was enabled
+  if (SHT1x_Port_DataRead())
+    xSemaphoreTake(SHT1x_Port_DataSem, pdMS_TO_TICKS(TimeoutMs) + 1);
 
+  gpio_intr_disable(SHT1x_DATA_GPIO);
+
+  return SHT1x_Port_DataRead() ? 0 : 1;
+}
+
+
+#if (SHT1X_CONFIG_WAVEFORM)
 /**
- ==================================================================================
-                            ##### Public Functions #####                           
- ==================================================================================
+ * @brief  Play a waveform with the shared player of SHT1x_wave.h.
+ * @param  Steps: Waveform
+ * @param  Count: Number of steps
+ * @param  Samples: DATA samples, MSB first (zeroed by the caller)
+ * @retval None
  */
+void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples)
+{
+  SHT1x_Wave_Play(Steps, Count, Samples);
+}
+#endif
+
 
+#if (SHT1x_ENGINE_TIMER)
 /**
- * @brief  Initialize platform device to communicate SHT1x.
+ * @brief  Initialize Engine on an esp_timer.
+ * @param  Engine: Pointer to engine
+ * @param  Handler: Pointer to initialized handler
  * @retval SHT1x_Result_t
  *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The timer could not be created.
  */
 SHT1x_Result_t
-SHT1x_Platform_Init(SHT1x_Handler_t *Handler)
+SHT1x_Platform_EngineInit(SHT1x_Engine_t *Engine, SHT1x_Handler_t *Handler)
 {
-  Handler->PlatformInit = SHT1x_Platform_PlatformInit;
-  Handler->PlatformDeInit = SHT1x_Platform_PlatformDeInit;
-  Handler->DataConfigDir = SHT1x_Platform_DataConfigDir;
-  Handler->DataWrite = SHT1x_Platform_DataWrite;
-  Handler->DataRead = SHT1x_Platform_DataRead;
-  Handler->SckWrite = SHT1x_Platform_SckWrite;
-  Handler->DelayMs = SHT1x_Platform_DelayMs;
-  Handler->DelayUs = SHT1x_Platform_DelayUs;
+  esp_timer_create_args_t Args = {
+    .callback = SHT1x_Platform_EngineTimerCb,
+    .arg = Engine,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    .dispatch_method = ESP_TIMER_ISR,
+#else
+    .dispatch_method = ESP_TIMER_TASK,
+#endif
+    .name = "sht1x",
+  };
+
+  if (!SHT1x_Platform_EngineTimer &&
+      esp_timer_create(&Args, &SHT1x_Platform_EngineTimer) != ESP_OK)
+    return SHT1x_FAIL;
+
+  SHT1x_Engine_Init(Engine, Handler, SHT1x_Platform_EngineSchedule);
 
   return SHT1x_OK;
 }
+#endif
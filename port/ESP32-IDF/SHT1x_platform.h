@@ -40,6 +40,11 @@ extern "C" {
 /* Includes ---------------------------------------------------------------------*/
 #include <stdint.h>
 #include "SHT1x.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "rom/ets_sys.h"
+#include "hal/gpio_ll.h"
 
 
 /* Functionality Options --------------------------------------------------------*/
@@ -49,6 +54,116 @@ extern "C" {
 #define SHT1x_SCK_GPIO    GPIO_NUM_17
 #define SHT1x_DATA_GPIO   GPIO_NUM_18
 
+/**
+ * @brief  Set to 1 to run SHT1x_engine on an esp_timer. One-shot esp_timers
+ *         need tens of us, so set HalfPeriodUs of the engine accordingly.
+ */
+#define SHT1x_ENGINE_TIMER  0
+
+
+
+/**
+ ==================================================================================
+                             ##### Port Functions #####                            
+ ==================================================================================
+ */
+
+/**
+ * @brief  Pin and delay functions. SHT1x.c calls them directly when
+ *         SHT1X_CONFIG_STATIC_PORT is enabled; otherwise SHT1x_Platform_Init
+ *         puts them into the handler.
+ */
+
+static inline void
+SHT1x_Port_SetGPIO_OUT(gpio_num_t GPIO_Pad)
+{
+  gpio_reset_pin(GPIO_Pad);
+  gpio_set_direction(GPIO_Pad, GPIO_MODE_OUTPUT);
+}
+
+static inline void
+SHT1x_Port_SetGPIO_IN_PU(gpio_num_t GPIO_Pad)
+{
+  gpio_reset_pin(GPIO_Pad);
+  gpio_set_direction(GPIO_Pad, GPIO_MODE_INPUT);
+  gpio_set_pull_mode(GPIO_Pad, GPIO_PULLUP_ONLY);
+}
+
+
+static inline void
+SHT1x_Port_PlatformInit(void)
+{
+  SHT1x_Port_SetGPIO_OUT(SHT1x_SCK_GPIO);
+  SHT1x_Port_SetGPIO_OUT(SHT1x_DATA_GPIO);
+}
+
+static inline void
+SHT1x_Port_PlatformDeInit(void)
+{
+  gpio_reset_pin(SHT1x_SCK_GPIO);
+  gpio_reset_pin(SHT1x_DATA_GPIO);
+}
+
+static inline void
+SHT1x_Port_DataConfigDir(uint8_t Dir)
+{
+  if (Dir)
+    SHT1x_Port_SetGPIO_OUT(SHT1x_DATA_GPIO);
+  else
+    SHT1x_Port_SetGPIO_IN_PU(SHT1x_DATA_GPIO);
+}
+
+static inline void
+SHT1x_Port_DataWrite(uint8_t Level)
+{
+  gpio_ll_set_level(&GPIO, SHT1x_DATA_GPIO, Level);
+}
+
+static inline uint8_t
+SHT1x_Port_DataRead(void)
+{
+  return gpio_ll_get_level(&GPIO, SHT1x_DATA_GPIO);
+}
+
+static inline void
+SHT1x_Port_SckWrite(uint8_t Level)
+{
+  gpio_ll_set_level(&GPIO, SHT1x_SCK_GPIO, Level);
+}
+
+static inline void
+SHT1x_Port_DelayMs(uint8_t Delay)
+{
+  vTaskDelay(Delay / portTICK_PERIOD_MS);
+}
+
+static inline void
+SHT1x_Port_DelayUs(uint8_t Delay)
+{
+  ets_delay_us(Delay);
+}
+
+/**
+ * @brief  Block the calling task on the falling-edge interrupt of DATA. The
+ *         GPIO ISR service is installed on the first call if the application
+ *         has not done it.
+ */
+#define SHT1X_PORT_HAS_WAIT_DATA_LOW  1
+
+uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs);
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Play a waveform in a tight loop on the GPIO registers.
+ */
+#define SHT1X_PORT_HAS_EMIT_WAVEFORM  1
+
+void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples);
+#endif
+
 
 
 /**
@@ -66,6 +181,24 @@ SHT1x_Result_t
 SHT1x_Platform_Init(SHT1x_Handler_t *Handler);
 
 
+#if (SHT1x_ENGINE_TIMER)
+#include "SHT1x_engine.h"
+
+/**
+ * @brief  Initialize Engine on an esp_timer. Ticks run in the ISR if
+ *         CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD is set, otherwise in
+ *         the esp_timer task.
+ * @param  Engine: Pointer to engine
+ * @param  Handler: Pointer to initialized handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The timer could not be created.
+ */
+SHT1x_Result_t
+SHT1x_Platform_EngineInit(SHT1x_Engine_t *Engine, SHT1x_Handler_t *Handler);
+#endif
+
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,85 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_platform.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Platform dependent part of SHT1x Library (host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+  
+/* Includes ---------------------------------------------------------------------*/
+#include "SHT1x_platform.h"
+#include <stddef.h>
+
+
+/* Private Variables ------------------------------------------------------------*/
+static uint8_t SHT1x_Platform_SimReady = 0;
+
+
+/* Public Variables -------------------------------------------------------------*/
+SHT1x_Sim_t SHT1x_Platform_Sim;
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate SHT1x.
+ * @note   The handler is bound to the default simulated sensor.
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No free simulator slot.
+ */
+SHT1x_Result_t
+SHT1x_Platform_Init(SHT1x_Handler_t *Handler)
+{
+#if (SHT1X_CONFIG_STATIC_PORT)
+  (void)Handler;
+  SHT1x_Platform_GetSim();
+  return SHT1x_OK;
+#else
+  return SHT1x_Sim_Attach(SHT1x_Platform_GetSim(), Handler);
+#endif
+}
+
+
+/**
+ * @brief  Get the default simulated sensor used by SHT1x_Platform_Init.
+ * @retval Pointer to simulated sensor
+ */
+SHT1x_Sim_t *
+SHT1x_Platform_GetSim(void)
+{
+  if (!SHT1x_Platform_SimReady)
+  {
+    SHT1x_Sim_Init(&SHT1x_Platform_Sim, NULL);
+    SHT1x_Platform_SimReady = 1;
+  }
+
+  return &SHT1x_Platform_Sim;
+}
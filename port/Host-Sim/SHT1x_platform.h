@@ -0,0 +1,160 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_platform.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Platform dependent part of SHT1x Library (host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+  
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_PLATFORM_H
+#define _SHT1X_PLATFORM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+#include "SHT1x_sim.h"
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate SHT1x.
+ * @note   The handler is bound to the default simulated sensor.
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No free simulator slot.
+ */
+SHT1x_Result_t
+SHT1x_Platform_Init(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Get the default simulated sensor used by SHT1x_Platform_Init.
+ * @retval Pointer to simulated sensor
+ */
+SHT1x_Sim_t *
+SHT1x_Platform_GetSim(void);
+
+
+
+/**
+ ==================================================================================
+                             ##### Port Functions #####                            
+ ==================================================================================
+ */
+
+/**
+ * @brief  Bus functions of the default simulated sensor. SHT1x.c calls them
+ *         directly when SHT1X_CONFIG_STATIC_PORT is enabled. The sensor is
+ *         initialized by SHT1x_Platform_Init or SHT1x_Platform_GetSim.
+ */
+extern SHT1x_Sim_t SHT1x_Platform_Sim;
+
+static inline void
+SHT1x_Port_PlatformInit(void)
+{
+  SHT1x_Sim_PlatformInit(&SHT1x_Platform_Sim);
+}
+
+static inline void
+SHT1x_Port_PlatformDeInit(void)
+{
+  SHT1x_Sim_PlatformDeInit(&SHT1x_Platform_Sim);
+}
+
+static inline void
+SHT1x_Port_DataConfigDir(uint8_t Dir)
+{
+  SHT1x_Sim_DataConfigDir(&SHT1x_Platform_Sim, Dir);
+}
+
+static inline void
+SHT1x_Port_DataWrite(uint8_t Level)
+{
+  SHT1x_Sim_DataWrite(&SHT1x_Platform_Sim, Level);
+}
+
+static inline uint8_t
+SHT1x_Port_DataRead(void)
+{
+  return SHT1x_Sim_DataRead(&SHT1x_Platform_Sim);
+}
+
+static inline void
+SHT1x_Port_SckWrite(uint8_t Level)
+{
+  SHT1x_Sim_SckWrite(&SHT1x_Platform_Sim, Level);
+}
+
+static inline void
+SHT1x_Port_DelayMs(uint8_t Delay)
+{
+  SHT1x_Sim_DelayMs(&SHT1x_Platform_Sim, Delay);
+}
+
+static inline void
+SHT1x_Port_DelayUs(uint8_t Delay)
+{
+  SHT1x_Sim_DelayUs(&SHT1x_Platform_Sim, Delay);
+}
+
+#define SHT1X_PORT_HAS_WAIT_DATA_LOW  1
+
+static inline uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs)
+{
+  return SHT1x_Sim_WaitDataLow(&SHT1x_Platform_Sim, TimeoutMs);
+}
+
+#if (SHT1X_CONFIG_WAVEFORM)
+#define SHT1X_PORT_HAS_EMIT_WAVEFORM  1
+
+static inline void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples)
+{
+  SHT1x_Sim_EmitWaveform(&SHT1x_Platform_Sim, Steps, Count, Samples);
+}
+#endif
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_platform.hpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Pin policy of SHT1x C++ driver (host simulator)
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_PLATFORM_HPP_
+#define _SHT1X_PLATFORM_HPP_
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.hpp"
+#include "SHT1x_sim.h"
+
+
+namespace sht1x
+{
+namespace sim
+{
+
+/**
+ * @brief  Pin policy for sht1x::Sensor bound to a simulated sensor
+ * @param  Id: Distinguishes policies of several simulated sensors
+ * @note   The calls are forwarded to the callbacks that SHT1x_Sim_Attach installs
+ *         in a private handler, so the simulator sees exactly the same bus
+ *         activity as with the C driver.
+ */
+template <int Id = 0>
+struct Pins
+{
+  static SHT1x_Handler_t &
+  Handler()
+  {
+    static SHT1x_Handler_t Instance;
+    return Instance;
+  }
+
+  /**
+   * @brief  Bind the policy to a simulated sensor. Call before Sensor::Init().
+   * @retval SHT1x_Result_t
+   *         - SHT1x_OK: Operation was successful.
+   *         - SHT1x_FAIL: No free simulator slot.
+   */
+  static SHT1x_Result_t
+  Attach(SHT1x_Sim_t *Sim)
+  {
+    return SHT1x_Sim_Attach(Sim, &Handler());
+  }
+
+  static void Init()                      { Handler().PlatformInit(); }
+  static void DeInit()                    { Handler().PlatformDeInit(); }
+  static void DataConfigDir(uint8_t Dir)  { Handler().DataConfigDir(Dir); }
+  static void DataWrite(uint8_t Level)    { Handler().DataWrite(Level); }
+  static uint8_t DataRead()               { return Handler().DataRead(); }
+  static void SckWrite(uint8_t Level)     { Handler().SckWrite(Level); }
+
+  template <uint8_t Us>
+  static void DelayUs()                   { Handler().DelayUs(Us); }
+
+  template <uint8_t Ms>
+  static void DelayMs()                   { Handler().DelayMs(Ms); }
+};
+
+} // namespace sim
+} // namespace sht1x
+
+
+#endif //! _SHT1X_PLATFORM_HPP_
@@ -0,0 +1,1152 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_sim.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Host-side simulated SHT1x sensor
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "SHT1x_sim.h"
+#include <math.h>
+#include <stddef.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define SHT1x_SIM_CMD_MeasureTemperature  0x03
+#define SHT1x_SIM_CMD_MeasureHumidity     0x05
+#define SHT1x_SIM_CMD_ReadStatusRegister  0x07
+#define SHT1x_SIM_CMD_WriteStatusRegister 0x06
+#define SHT1x_SIM_CMD_SoftReset           0x1E
+
+#define SHT1x_SIM_STATUS_LOW_RES          0x01
+#define SHT1x_SIM_STATUS_HEATER           0x04
+#define SHT1x_SIM_STATUS_WRITABLE         0x07
+
+#if (SHT1X_SIM_MAX_SLOTS > 1000)
+  #error "SHT1X_SIM_MAX_SLOTS must not exceed 1000"
+#endif
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef enum SHT1x_Sim_State_e
+{
+  SHT1x_Sim_Idle = 0,
+  SHT1x_Sim_RxCmd,        // Receiving address and command bits
+  SHT1x_Sim_CmdAck,       // ACK of the command
+  SHT1x_Sim_Converting,   // Measurement in progress
+  SHT1x_Sim_Tx,           // Transmitting a byte
+  SHT1x_Sim_TxAck,        // Waiting for ACK of the master
+  SHT1x_Sim_RxData,       // Receiving status register value
+  SHT1x_Sim_RxAck,        // ACK of the status register value
+  SHT1x_Sim_Resetting     // Soft reset in progress
+} SHT1x_Sim_State_t;
+
+#if (SHT1X_CONFIG_STATIC_PORT == 0)
+typedef struct SHT1x_Sim_SlotFns_s
+{
+  void (*DataConfigDir)(uint8_t);
+  void (*DataWrite)(uint8_t);
+  uint8_t (*DataRead)(void);
+  void (*SckWrite)(uint8_t);
+  void (*DelayMs)(uint8_t);
+  void (*DelayUs)(uint8_t);
+  void (*PlatformInit)(void);
+  void (*PlatformDeInit)(void);
+  uint8_t (*WaitDataLow)(uint16_t);
+#if (SHT1X_CONFIG_WAVEFORM)
+  void (*EmitWaveform)(const SHT1x_WaveStep_t *, uint8_t, uint8_t *);
+#endif
+} SHT1x_Sim_SlotFns_t;
+#endif
+
+
+/* Private Variables ------------------------------------------------------------*/
+static SHT1x_Sim_Clock_t SHT1x_Sim_SharedClock = {0};
+static SHT1x_Sim_t *SHT1x_Sim_Slots[1000] = {0};
+
+static const char *const SHT1x_Sim_ViolationNames[SHT1x_Sim_ViolationCount] =
+{
+  "SckHighShort",
+  "SckLowShort",
+  "DataSetup",
+  "DataHold",
+  "DataChangeSckHigh",
+  "ReadBeforeValid",
+  "Contention",
+  "SckWhileBusy",
+  "UnknownCommand"
+};
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static uint8_t
+SHT1x_Sim_Reverse8(uint8_t Value)
+{
+  uint8_t Result = 0;
+
+  for (uint8_t i = 0; i < 8; i++, Value >>= 1)
+    Result = (Result << 1) | (Value & 0x01);
+
+  return Result;
+}
+
+static uint32_t
+SHT1x_Sim_Random(SHT1x_Sim_t *Sim)
+{
+  // xorshift32, deterministic for a given seed
+  uint32_t x = Sim->Rand;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  Sim->Rand = x;
+  return x;
+}
+
+static void
+SHT1x_Sim_Violation(SHT1x_Sim_t *Sim, SHT1x_Sim_Violation_t Violation)
+{
+  Sim->Stats.Violations[Violation]++;
+  if (Sim->OnViolation)
+    Sim->OnViolation(Sim, Violation);
+}
+
+static uint8_t
+SHT1x_Sim_LowRes(SHT1x_Sim_t *Sim)
+{
+  return (Sim->Status & SHT1x_SIM_STATUS_LOW_RES) ? 1 : 0;
+}
+
+static uint64_t
+SHT1x_Sim_ConversionNs(SHT1x_Sim_t *Sim, uint8_t Cmd)
+{
+  uint32_t MaxMs;
+
+  if (Cmd == SHT1x_SIM_CMD_MeasureTemperature)
+    MaxMs = SHT1x_Sim_LowRes(Sim) ? 80 : 320;   // 12 / 14 bit
+  else
+    MaxMs = SHT1x_Sim_LowRes(Sim) ? 20 : 80;    // 8 / 12 bit
+
+  return (uint64_t)(MaxMs * 1000000.0 * Sim->OscillatorScale);
+}
+
+static void
+SHT1x_Sim_UpdateHeat(SHT1x_Sim_t *Sim, uint64_t Now)
+{
+  float Target = 0;
+  double Dt;
+
+  if (Now <= Sim->HeatUpdatedAt)
+    return;
+
+  if (Sim->Status & SHT1x_SIM_STATUS_HEATER)
+    Target += Sim->HeaterRiseC;
+  if (Sim->SelfHeatActive)
+    Target += Sim->ActiveRiseC;
+
+  Dt = (Now - Sim->HeatUpdatedAt) / 1e9;
+  Sim->HeatC += (Target - Sim->HeatC) * (float)(1.0 - exp(-Dt / Sim->ThermalTauS));
+  Sim->HeatUpdatedAt = Now;
+}
+
+static uint16_t
+SHT1x_Sim_RawTemperature(SHT1x_Sim_t *Sim)
+{
+  const float V = Sim->SupplyV;
+  const float D1 = (-0.0462f * V * V) + (0.1672f * V) - 39.682f;
+  const float D2 = SHT1x_Sim_LowRes(Sim) ? 0.04f : 0.01f;
+  const uint16_t Max = SHT1x_Sim_LowRes(Sim) ? 0x0FFF : 0x3FFF;
+  float Raw = ((Sim->AmbientC + Sim->HeatC) - D1) / D2;
+
+  if (Raw < 0)
+    return 0;
+  if (Raw > Max)
+    return Max;
+  return (uint16_t)(Raw + 0.5f);
+}
+
+static uint16_t
+SHT1x_Sim_RawHumidity(SHT1x_Sim_t *Sim)
+{
+  // Inverse of the conversion used by the driver
+  const float T = Sim->AmbientC + Sim->HeatC;
+  const float c1 = -4, t1 = 0.01f;
+  const float c2 = SHT1x_Sim_LowRes(Sim) ? 0.648f : 0.0405f;
+  const float c3 = SHT1x_Sim_LowRes(Sim) ? -0.00072f : -0.0000028f;
+  const float t2 = SHT1x_Sim_LowRes(Sim) ? 0.00128f : 0.00008f;
+  const uint16_t Max = SHT1x_Sim_LowRes(Sim) ? 0x00FF : 0x0FFF;
+  const double a = c3;
+  const double b = c2 + (T - 25) * t2;
+  const double c = c1 + (T - 25) * t1 - Sim->HumidityP;
+  double Disc = b * b - 4 * a * c;
+  double Raw;
+
+  if (Disc < 0)
+    Raw = -b / (2 * a);
+  else
+    Raw = (-b + sqrt(Disc)) / (2 * a);
+
+  if (Raw < 0)
+    return 0;
+  if (Raw > Max)
+    return Max;
+  return (uint16_t)(Raw + 0.5);
+}
+
+static void
+SHT1x_Sim_Schedule(SHT1x_Sim_t *Sim, uint8_t Pull, uint64_t At)
+{
+  Sim->PendingPull = Pull;
+  Sim->PendingAt = At;
+}
+
+static void
+SHT1x_Sim_PresentBit(SHT1x_Sim_t *Sim, uint64_t At)
+{
+  uint8_t Bit = (Sim->TxBuf[Sim->TxIndex] >> (7 - Sim->BitCount)) & 0x01;
+
+  if (Sim->Faults.BitErrorPpm &&
+      (SHT1x_Sim_Random(Sim) % 1000000) < Sim->Faults.BitErrorPpm)
+  {
+    Bit ^= 1;
+    Sim->Stats.FaultsInjected++;
+  }
+
+  SHT1x_Sim_Schedule(Sim, !Bit, At);
+}
+
+static void
+SHT1x_Sim_LoadByte(SHT1x_Sim_t *Sim, uint8_t Index)
+{
+  Sim->TxIndex = Index;
+  Sim->BitCount = 0;
+
+  if (Sim->Faults.FlipMask)
+  {
+    Sim->TxBuf[Index] ^= Sim->Faults.FlipMask;
+    Sim->Faults.FlipMask = 0;
+    Sim->Stats.FaultsInjected++;
+  }
+}
+
+static void
+SHT1x_Sim_PrepareTx(SHT1x_Sim_t *Sim, const uint8_t *Data, uint8_t Len)
+{
+  uint8_t CrcData[3];
+
+  CrcData[0] = Sim->Cmd;
+  for (uint8_t i = 0; i < Len; i++)
+  {
+    Sim->TxBuf[i] = Data[i];
+    CrcData[i + 1] = Data[i];
+  }
+  Sim->TxBuf[Len] = SHT1x_Sim_Crc(Sim->Status, CrcData, Len + 1);
+  Sim->TxLen = Len + 1;
+
+  SHT1x_Sim_LoadByte(Sim, 0);
+  Sim->State = SHT1x_Sim_Tx;
+}
+
+static void
+SHT1x_Sim_Finish(SHT1x_Sim_t *Sim, uint64_t At)
+{
+  uint8_t Data[2];
+  uint16_t Raw;
+
+  if (Sim->State == SHT1x_Sim_Resetting)
+  {
+    Sim->State = SHT1x_Sim_Idle;
+    return;
+  }
+
+  // Conversion complete: sensor pulls DATA low to signal data ready
+  SHT1x_Sim_UpdateHeat(Sim, At);
+  Sim->SelfHeatActive = 0;
+
+  if (Sim->Cmd == SHT1x_SIM_CMD_MeasureTemperature)
+    Raw = SHT1x_Sim_RawTemperature(Sim);
+  else
+    Raw = SHT1x_Sim_RawHumidity(Sim);
+
+  Data[0] = Raw >> 8;
+  Data[1] = Raw & 0xFF;
+  SHT1x_Sim_PrepareTx(Sim, Data, 2);
+
+  Sim->SensorPull = 1;
+  Sim->PendingAt = 0;
+}
+
+static void
+SHT1x_Sim_Sync(SHT1x_Sim_Clock_t *Clock)
+{
+  uint64_t Real;
+
+  if (!Clock->RealTimeNs)
+    return;
+
+  Real = Clock->RealTimeNs();
+  if (Real > Clock->NowNs)
+    Clock->NowNs = Real;
+}
+
+static void SHT1x_Sim_Resolve(SHT1x_Sim_t *Sim, uint64_t At);
+
+static void
+SHT1x_Sim_Update(SHT1x_Sim_t *Sim)
+{
+  uint64_t Now;
+  uint64_t Next;
+
+  SHT1x_Sim_Sync(Sim->Clock);
+  Now = Sim->Clock->NowNs;
+
+  for (;;)
+  {
+    Next = UINT64_MAX;
+    if (Sim->PendingAt && Sim->PendingAt < Next)
+      Next = Sim->PendingAt;
+    if (Sim->DoneAt && Sim->DoneAt < Next)
+      Next = Sim->DoneAt;
+    if (Next > Now)
+      break;
+
+    SHT1x_Sim_UpdateHeat(Sim, Next);
+
+    if (Next == Sim->PendingAt)
+    {
+      Sim->SensorPull = Sim->PendingPull;
+      Sim->PendingAt = 0;
+    }
+    else
+    {
+      Sim->DoneAt = 0;
+      SHT1x_Sim_Finish(Sim, Next);
+    }
+
+    SHT1x_Sim_Resolve(Sim, Next);
+  }
+
+  SHT1x_Sim_UpdateHeat(Sim, Now);
+}
+
+static void
+SHT1x_Sim_OnDataEdge(SHT1x_Sim_t *Sim, uint8_t Level, uint64_t At)
+{
+  Sim->Stats.DataEdges++;
+
+  if (!Sim->Sck)
+  {
+    if (Sim->SckFallAt && At - Sim->SckFallAt < Sim->Timing.DataHoldMinNs &&
+        Sim->MasterDir)
+      SHT1x_Sim_Violation(Sim, SHT1x_Sim_DataHold);
+    return;
+  }
+
+  // DATA changed while SCK is high: only allowed as part of a start sequence
+  if (!Level && Sim->StartPhase == 0 &&
+      (Sim->State == SHT1x_Sim_Idle || Sim->State == SHT1x_Sim_RxCmd))
+  {
+    Sim->StartPhase = 1;
+    return;
+  }
+
+  if (Level && Sim->StartPhase == 3)
+  {
+    Sim->StartPhase = 0;
+    Sim->State = SHT1x_Sim_RxCmd;
+    Sim->BitCount = 0;
+    Sim->ShiftReg = 0;
+    Sim->HighClocks = 0;
+    return;
+  }
+
+  Sim->StartPhase = 0;
+  if (Sim->State != SHT1x_Sim_Idle)
+    SHT1x_Sim_Violation(Sim, SHT1x_Sim_DataChangeSckHigh);
+}
+
+static void
+SHT1x_Sim_Resolve(SHT1x_Sim_t *Sim, uint64_t At)
+{
+  uint8_t Level;
+
+  switch (Sim->Faults.StuckData)
+  {
+  case SHT1x_Sim_StuckLow:
+    Level = 0;
+    break;
+
+  case SHT1x_Sim_StuckHigh:
+    Level = 1;
+    break;
+
+  default:
+    Level = Sim->MasterDir ? Sim->MasterLevel : 1;
+    if (Sim->SensorPull)
+    {
+      if (Sim->MasterDir && Sim->MasterLevel)
+        SHT1x_Sim_Violation(Sim, SHT1x_Sim_Contention);
+      Level = 0;
+    }
+    break;
+  }
+
+  if (Level != Sim->Line)
+  {
+    Sim->Line = Level;
+    Sim->DataChangeAt = At;
+    SHT1x_Sim_OnDataEdge(Sim, Level, At);
+  }
+}
+
+static void
+SHT1x_Sim_ExecuteCmd(SHT1x_Sim_t *Sim, uint64_t Now)
+{
+  const uint64_t At = Now + Sim->Timing.DataValidNs;
+
+  switch (Sim->Cmd)
+  {
+  case SHT1x_SIM_CMD_MeasureTemperature:
+  case SHT1x_SIM_CMD_MeasureHumidity:
+    SHT1x_Sim_Schedule(Sim, 0, At);
+    Sim->State = SHT1x_Sim_Converting;
+    Sim->Stats.Conversions++;
+    SHT1x_Sim_UpdateHeat(Sim, Now);
+    Sim->SelfHeatActive = 1;
+    if (Sim->Faults.HangConversion)
+    {
+      Sim->Faults.HangConversion--;
+      Sim->Stats.FaultsInjected++;
+      Sim->DoneAt = 0;
+    }
+    else
+    {
+      Sim->DoneAt = Now + SHT1x_Sim_ConversionNs(Sim, Sim->Cmd);
+    }
+    break;
+
+  case SHT1x_SIM_CMD_ReadStatusRegister:
+    SHT1x_Sim_PrepareTx(Sim, &Sim->Status, 1);
+    SHT1x_Sim_PresentBit(Sim, At);
+    break;
+
+  case SHT1x_SIM_CMD_WriteStatusRegister:
+    SHT1x_Sim_Schedule(Sim, 0, At);
+    Sim->State = SHT1x_Sim_RxData;
+    Sim->BitCount = 0;
+    Sim->ShiftReg = 0;
+    break;
+
+  case SHT1x_SIM_CMD_SoftReset:
+    SHT1x_Sim_Schedule(Sim, 0, At);
+    Sim->Status = 0;
+    Sim->State = SHT1x_Sim_Resetting;
+    Sim->DoneAt = Now + Sim->Timing.ResetTimeNs;
+    break;
+  }
+}
+
+static uint8_t
+SHT1x_Sim_GiveAck(SHT1x_Sim_t *Sim, uint64_t Now)
+{
+  if (Sim->Faults.DropAck)
+  {
+    Sim->Faults.DropAck--;
+    Sim->Stats.FaultsInjected++;
+    Sim->State = SHT1x_Sim_Idle;
+    return 0;
+  }
+
+  SHT1x_Sim_Schedule(Sim, 1, Now + Sim->Timing.DataValidNs);
+  return 1;
+}
+
+static void
+SHT1x_Sim_OnSckRise(SHT1x_Sim_t *Sim)
+{
+  const uint64_t Now = Sim->Clock->NowNs;
+
+  if (Sim->SckChangeAt && Now - Sim->SckChangeAt < Sim->Timing.SckLowMinNs)
+    SHT1x_Sim_Violation(Sim, SHT1x_Sim_SckLowShort);
+  if (Sim->DataChangeAt > Sim->SckChangeAt &&
+      Now - Sim->DataChangeAt < Sim->Timing.DataSetupMinNs)
+    SHT1x_Sim_Violation(Sim, SHT1x_Sim_DataSetup);
+
+  if (Sim->State == SHT1x_Sim_Converting || Sim->State == SHT1x_Sim_Resetting)
+    SHT1x_Sim_Violation(Sim, SHT1x_Sim_SckWhileBusy);
+  if (Sim->State == SHT1x_Sim_Resetting)
+    return;
+
+  if (Sim->StartPhase == 2)
+    Sim->StartPhase = (Sim->Line == 0) ? 3 : 0;
+
+  // Connection reset: nine or more clocks while DATA is high
+  if (Sim->Line)
+  {
+    if (++Sim->HighClocks >= 9 && Sim->State != SHT1x_Sim_Idle)
+    {
+      // Also aborts a conversion in progress
+      Sim->State = SHT1x_Sim_Idle;
+      Sim->SensorPull = 0;
+      Sim->PendingAt = 0;
+      Sim->DoneAt = 0;
+      Sim->SelfHeatActive = 0;
+      Sim->Stats.InterfaceResets++;
+    }
+  }
+  else
+  {
+    Sim->HighClocks = 0;
+  }
+
+  switch (Sim->State)
+  {
+  case SHT1x_Sim_RxCmd:
+  case SHT1x_Sim_RxData:
+    Sim->ShiftReg = (Sim->ShiftReg << 1) | Sim->Line;
+    Sim->BitCount++;
+    break;
+
+  case SHT1x_Sim_TxAck:
+    // Master ACK is sampled here, evaluated on the falling edge
+    Sim->ShiftReg = Sim->Line;
+    break;
+
+  default:
+    break;
+  }
+}
+
+static void
+SHT1x_Sim_OnSckFall(SHT1x_Sim_t *Sim)
+{
+  const uint64_t Now = Sim->Clock->NowNs;
+  const uint64_t At = Now + Sim->Timing.DataValidNs;
+
+  if (Sim->SckChangeAt && Now - Sim->SckChangeAt < Sim->Timing.SckHighMinNs)
+    SHT1x_Sim_Violation(Sim, SHT1x_Sim_SckHighShort);
+
+  Sim->SckFallAt = Now;
+
+  if (Sim->State == SHT1x_Sim_Converting || Sim->State == SHT1x_Sim_Resetting)
+    return;
+
+  if (Sim->StartPhase == 1)
+    Sim->StartPhase = (Sim->Line == 0) ? 2 : 0;
+  else if (Sim->StartPhase == 3)
+    Sim->StartPhase = 0;
+
+  switch (Sim->State)
+  {
+  case SHT1x_Sim_RxCmd:
+    if (Sim->BitCount < 8)
+      break;
+    Sim->Cmd = Sim->ShiftReg;
+    if ((Sim->Cmd != SHT1x_SIM_CMD_MeasureTemperature &&
+         Sim->Cmd != SHT1x_SIM_CMD_MeasureHumidity &&
+         Sim->Cmd != SHT1x_SIM_CMD_ReadStatusRegister &&
+         Sim->Cmd != SHT1x_SIM_CMD_WriteStatusRegister &&
+         Sim->Cmd != SHT1x_SIM_CMD_SoftReset))
+    {
+      SHT1x_Sim_Violation(Sim, SHT1x_Sim_UnknownCommand);
+      Sim->State = SHT1x_Sim_Idle;
+      break;
+    }
+    Sim->Stats.Commands++;
+    if (SHT1x_Sim_GiveAck(Sim, Now))
+      Sim->State = SHT1x_Sim_CmdAck;
+    break;
+
+  case SHT1x_Sim_CmdAck:
+    SHT1x_Sim_ExecuteCmd(Sim, Now);
+    break;
+
+  case SHT1x_Sim_Tx:
+    Sim->BitCount++;
+    if (Sim->BitCount < 8)
+    {
+      SHT1x_Sim_PresentBit(Sim, At);
+    }
+    else
+    {
+      SHT1x_Sim_Schedule(Sim, 0, At);
+      Sim->State = SHT1x_Sim_TxAck;
+    }
+    break;
+
+  case SHT1x_Sim_TxAck:
+    if (Sim->ShiftReg == 0 && Sim->TxIndex + 1 < Sim->TxLen)
+    {
+      SHT1x_Sim_LoadByte(Sim, Sim->TxIndex + 1);
+      SHT1x_Sim_PresentBit(Sim, At);
+      Sim->State = SHT1x_Sim_Tx;
+    }
+    else
+    {
+      Sim->State = SHT1x_Sim_Idle;
+    }
+    break;
+
+  case SHT1x_Sim_RxData:
+    if (Sim->BitCount < 8)
+      break;
+    if (SHT1x_Sim_GiveAck(Sim, Now))
+      Sim->State = SHT1x_Sim_RxAck;
+    break;
+
+  case SHT1x_Sim_RxAck:
+    SHT1x_Sim_Schedule(Sim, 0, At);
+    Sim->Status = (Sim->Status & ~SHT1x_SIM_STATUS_WRITABLE) |
+                  (Sim->ShiftReg & SHT1x_SIM_STATUS_WRITABLE);
+    Sim->State = SHT1x_Sim_Idle;
+    break;
+
+  default:
+    break;
+  }
+}
+
+
+/* Bus callbacks ----------------------------------------------------------------*/
+static void
+SHT1x_Sim_Tick(SHT1x_Sim_t *Sim, uint64_t Ns)
+{
+  Sim->Clock->NowNs += Ns;
+}
+
+#if (SHT1X_CONFIG_STATIC_PORT == 0)
+/* Slot trampolines -------------------------------------------------------------*/
+#define SHT1x_SIM_SLOT_FNS(a, b, c)                                               \
+  static void SHT1x_Sim_DataConfigDir_##a##b##c(uint8_t v)                        \
+  { SHT1x_Sim_DataConfigDir(SHT1x_Sim_Slots[a * 100 + b * 10 + c], v); }          \
+  static void SHT1x_Sim_DataWrite_##a##b##c(uint8_t v)                            \
+  { SHT1x_Sim_DataWrite(SHT1x_Sim_Slots[a * 100 + b * 10 + c], v); }              \
+  static uint8_t SHT1x_Sim_DataRead_##a##b##c(void)                               \
+  { return SHT1x_Sim_DataRead(SHT1x_Sim_Slots[a * 100 + b * 10 + c]); }           \
+  static void SHT1x_Sim_SckWrite_##a##b##c(uint8_t v)                             \
+  { SHT1x_Sim_SckWrite(SHT1x_Sim_Slots[a * 100 + b * 10 + c], v); }               \
+  static void SHT1x_Sim_DelayMs_##a##b##c(uint8_t v)                              \
+  { SHT1x_Sim_DelayMs(SHT1x_Sim_Slots[a * 100 + b * 10 + c], v); }                \
+  static void SHT1x_Sim_DelayUs_##a##b##c(uint8_t v)                              \
+  { SHT1x_Sim_DelayUs(SHT1x_Sim_Slots[a * 100 + b * 10 + c], v); }                \
+  static void SHT1x_Sim_PlatformInit_##a##b##c(void)                              \
+  { SHT1x_Sim_PlatformInit(SHT1x_Sim_Slots[a * 100 + b * 10 + c]); }              \
+  static void SHT1x_Sim_PlatformDeInit_##a##b##c(void)                            \
+  { SHT1x_Sim_PlatformDeInit(SHT1x_Sim_Slots[a * 100 + b * 10 + c]); }           \
+  static uint8_t SHT1x_Sim_WaitDataLow_##a##b##c(uint16_t v)                      \
+  { return SHT1x_Sim_WaitDataLow(SHT1x_Sim_Slots[a * 100 + b * 10 + c], v); }      \
+  SHT1x_SIM_SLOT_EMIT(a, b, c)
+
+#if (SHT1X_CONFIG_WAVEFORM)
+#define SHT1x_SIM_SLOT_EMIT(a, b, c)                                              \
+  static void SHT1x_Sim_EmitWaveform_##a##b##c(const SHT1x_WaveStep_t *s,         \
+                                               uint8_t n, uint8_t *v)             \
+  { SHT1x_Sim_EmitWaveform(SHT1x_Sim_Slots[a * 100 + b * 10 + c], s, n, v); }
+#define SHT1x_SIM_SLOT_EMIT_ENTRY(a, b, c)  , SHT1x_Sim_EmitWaveform_##a##b##c
+#else
+#define SHT1x_SIM_SLOT_EMIT(a, b, c)
+#define SHT1x_SIM_SLOT_EMIT_ENTRY(a, b, c)
+#endif
+
+#define SHT1x_SIM_SLOT_ENTRY(a, b, c)                                             \
+  { SHT1x_Sim_DataConfigDir_##a##b##c, SHT1x_Sim_DataWrite_##a##b##c,             \
+    SHT1x_Sim_DataRead_##a##b##c, SHT1x_Sim_SckWrite_##a##b##c,                   \
+    SHT1x_Sim_DelayMs_##a##b##c, SHT1x_Sim_DelayUs_##a##b##c,                     \
+    SHT1x_Sim_PlatformInit_##a##b##c, SHT1x_Sim_PlatformDeInit_##a##b##c,         \
+    SHT1x_Sim_WaitDataLow_##a##b##c SHT1x_SIM_SLOT_EMIT_ENTRY(a, b, c) },
+
+#define SHT1x_SIM_SLOTS_10(X, a, b) \
+  X(a, b, 0) X(a, b, 1) X(a, b, 2) X(a, b, 3) X(a, b, 4) \
+  X(a, b, 5) X(a, b, 6) X(a, b, 7) X(a, b, 8) X(a, b, 9)
+#define SHT1x_SIM_SLOTS_100(X, a) \
+  SHT1x_SIM_SLOTS_10(X, a, 0) SHT1x_SIM_SLOTS_10(X, a, 1) \
+  SHT1x_SIM_SLOTS_10(X, a, 2) SHT1x_SIM_SLOTS_10(X, a, 3) \
+  SHT1x_SIM_SLOTS_10(X, a, 4) SHT1x_SIM_SLOTS_10(X, a, 5) \
+  SHT1x_SIM_SLOTS_10(X, a, 6) SHT1x_SIM_SLOTS_10(X, a, 7) \
+  SHT1x_SIM_SLOTS_10(X, a, 8) SHT1x_SIM_SLOTS_10(X, a, 9)
+#define SHT1x_SIM_SLOTS_1000(X) \
+  SHT1x_SIM_SLOTS_100(X, 0) SHT1x_SIM_SLOTS_100(X, 1) \
+  SHT1x_SIM_SLOTS_100(X, 2) SHT1x_SIM_SLOTS_100(X, 3) \
+  SHT1x_SIM_SLOTS_100(X, 4) SHT1x_SIM_SLOTS_100(X, 5) \
+  SHT1x_SIM_SLOTS_100(X, 6) SHT1x_SIM_SLOTS_100(X, 7) \
+  SHT1x_SIM_SLOTS_100(X, 8) SHT1x_SIM_SLOTS_100(X, 9)
+
+// All 1000 slots are generated, only the first SHT1X_SIM_MAX_SLOTS are handed out
+SHT1x_SIM_SLOTS_1000(SHT1x_SIM_SLOT_FNS)
+
+static const SHT1x_Sim_SlotFns_t SHT1x_Sim_SlotFns[1000] =
+{
+  SHT1x_SIM_SLOTS_1000(SHT1x_SIM_SLOT_ENTRY)
+};
+#endif
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize simulated sensor with default parameters.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Clock: Virtual clock. NULL selects the internal shared clock.
+ * @retval None
+ */
+void
+SHT1x_Sim_Init(SHT1x_Sim_t *Sim, SHT1x_Sim_Clock_t *Clock)
+{
+  static const SHT1x_Sim_t Default = {0};
+
+  *Sim = Default;
+  Sim->Clock = Clock ? Clock : &SHT1x_Sim_SharedClock;
+
+  Sim->Timing.SckHighMinNs = 100;
+  Sim->Timing.SckLowMinNs = 100;
+  Sim->Timing.DataSetupMinNs = 100;
+  Sim->Timing.DataHoldMinNs = 10;
+  Sim->Timing.DataValidNs = 250;
+  Sim->Timing.CallCostNs = 200;
+  Sim->Timing.PinWriteNs = 20;
+  Sim->Timing.ResetTimeNs = 11000000;
+
+  Sim->Faults.Seed = 1;
+
+  Sim->AmbientC = 25.0f;
+  Sim->HumidityP = 50.0f;
+  Sim->SupplyV = 5.0f;
+  Sim->OscillatorScale = 0.85f;
+  Sim->HeaterRiseC = 5.5f;
+  Sim->ActiveRiseC = 0.3f;
+  Sim->ThermalTauS = 8.0f;
+
+  Sim->Line = 1;
+  Sim->HeatUpdatedAt = Sim->Clock->NowNs;
+  Sim->Rand = Sim->Faults.Seed;
+  Sim->Slot = -1;
+}
+
+
+/**
+ * @brief  Bind the simulated sensor to the platform-dependent part of Handler.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No free slot, or SHT1X_CONFIG_STATIC_PORT is enabled.
+ */
+SHT1x_Result_t
+SHT1x_Sim_Attach(SHT1x_Sim_t *Sim, SHT1x_Handler_t *Handler)
+{
+#if (SHT1X_CONFIG_STATIC_PORT)
+  (void)Sim;
+  (void)Handler;
+  return SHT1x_FAIL;
+#else
+  const SHT1x_Sim_SlotFns_t *Fns;
+
+  if (Sim->Slot < 0)
+  {
+    for (int16_t i = 0; i < SHT1X_SIM_MAX_SLOTS; i++)
+    {
+      if (!SHT1x_Sim_Slots[i])
+      {
+        SHT1x_Sim_Slots[i] = Sim;
+        Sim->Slot = i;
+        break;
+      }
+    }
+
+    if (Sim->Slot < 0)
+      return SHT1x_FAIL;
+  }
+
+  if (Sim->Faults.Seed)
+    Sim->Rand = Sim->Faults.Seed;
+
+  Fns = &SHT1x_Sim_SlotFns[Sim->Slot];
+  Handler->PlatformInit = Fns->PlatformInit;
+  Handler->PlatformDeInit = Fns->PlatformDeInit;
+  Handler->DataConfigDir = Fns->DataConfigDir;
+  Handler->DataWrite = Fns->DataWrite;
+  Handler->DataRead = Fns->DataRead;
+  Handler->SckWrite = Fns->SckWrite;
+  Handler->DelayMs = Fns->DelayMs;
+  Handler->DelayUs = Fns->DelayUs;
+  Handler->WaitDataLow = Fns->WaitDataLow;
+#if (SHT1X_CONFIG_WAVEFORM)
+  Handler->EmitWaveform = Fns->EmitWaveform;
+#endif
+
+  return SHT1x_OK;
+#endif
+}
+
+
+/**
+ * @brief  Release the slot of the simulated sensor.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval None
+ */
+void
+SHT1x_Sim_Detach(SHT1x_Sim_t *Sim)
+{
+  if (Sim->Slot >= 0)
+    SHT1x_Sim_Slots[Sim->Slot] = NULL;
+  Sim->Slot = -1;
+}
+
+
+/**
+ * @brief  Remove and restore sensor power. The interface and the status register
+ *         are cleared and the sensor stays busy for Timing.ResetTimeNs.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval None
+ */
+void
+SHT1x_Sim_PowerCycle(SHT1x_Sim_t *Sim)
+{
+  const uint64_t Now = Sim->Clock->NowNs;
+
+  SHT1x_Sim_Update(Sim);
+  Sim->Status = 0;
+  Sim->SensorPull = 0;
+  Sim->PendingAt = 0;
+  Sim->StartPhase = 0;
+  Sim->HighClocks = 0;
+  Sim->SelfHeatActive = 0;
+  Sim->State = SHT1x_Sim_Resetting;
+  Sim->DoneAt = Now + Sim->Timing.ResetTimeNs;
+  SHT1x_Sim_Resolve(Sim, Now);
+}
+
+
+/**
+ * @brief  Advance the virtual clock of the sensor.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Ns: Time to advance (ns)
+ * @retval None
+ */
+void
+SHT1x_Sim_Advance(SHT1x_Sim_t *Sim, uint64_t Ns)
+{
+  SHT1x_Sim_Tick(Sim, Ns);
+  SHT1x_Sim_Update(Sim);
+}
+
+
+/**
+ * @brief  Current time on the virtual clock of the sensor.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval Time (ns)
+ */
+uint64_t
+SHT1x_Sim_Now(SHT1x_Sim_t *Sim)
+{
+  SHT1x_Sim_Sync(Sim->Clock);
+  return Sim->Clock->NowNs;
+}
+
+
+/**
+ * @brief  Total number of protocol violations.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval Number of violations
+ */
+uint32_t
+SHT1x_Sim_Violations(SHT1x_Sim_t *Sim)
+{
+  uint32_t Sum = 0;
+
+  for (uint8_t i = 0; i < SHT1x_Sim_ViolationCount; i++)
+    Sum += Sim->Stats.Violations[i];
+
+  return Sum;
+}
+
+
+/**
+ * @brief  Name of a violation, useful for reports.
+ * @param  Violation: Violation
+ * @retval Constant string
+ */
+const char *
+SHT1x_Sim_ViolationName(SHT1x_Sim_Violation_t Violation)
+{
+  if (Violation >= SHT1x_Sim_ViolationCount)
+    return "Unknown";
+
+  return SHT1x_Sim_ViolationNames[Violation];
+}
+
+
+/**
+ * @brief  SHT1x CRC-8 as transmitted by the sensor.
+ * @param  Status: Status register (lower nibble seeds the CRC)
+ * @param  Data: Command byte followed by the data bytes
+ * @param  Len: Number of bytes
+ * @retval CRC byte in transmitted bit order
+ */
+uint8_t
+SHT1x_Sim_Crc(uint8_t Status, const uint8_t *Data, uint8_t Len)
+{
+  // x^8 + x^5 + x^4 + 1, seeded with the reversed status nibble
+  uint8_t Crc = SHT1x_Sim_Reverse8(Status & 0x0F);
+
+  for (uint8_t i = 0; i < Len; i++)
+  {
+    Crc ^= Data[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+      Crc = (Crc & 0x80) ? (uint8_t)((Crc << 1) ^ 0x31) : (uint8_t)(Crc << 1);
+  }
+
+  return SHT1x_Sim_Reverse8(Crc);
+}
+
+
+/**
+ * @brief  Bus function: initialize the master side (SCK and DATA output low).
+ * @param  Sim: Pointer to simulated sensor
+ * @retval None
+ */
+void
+SHT1x_Sim_PlatformInit(SHT1x_Sim_t *Sim)
+{
+  SHT1x_Sim_Update(Sim);
+  Sim->MasterDir = 1;
+  Sim->MasterLevel = 0;
+  Sim->Sck = 0;
+  SHT1x_Sim_Resolve(Sim, Sim->Clock->NowNs);
+  SHT1x_Sim_Tick(Sim, Sim->Timing.CallCostNs);
+}
+
+/**
+ * @brief  Bus function: release DATA.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval None
+ */
+void
+SHT1x_Sim_PlatformDeInit(SHT1x_Sim_t *Sim)
+{
+  SHT1x_Sim_Update(Sim);
+  Sim->MasterDir = 0;
+  SHT1x_Sim_Resolve(Sim, Sim->Clock->NowNs);
+  SHT1x_Sim_Tick(Sim, Sim->Timing.CallCostNs);
+}
+
+/**
+ * @brief  Bus function: set direction of DATA.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Dir: 0: Input, 1: Output
+ * @retval None
+ */
+void
+SHT1x_Sim_DataConfigDir(SHT1x_Sim_t *Sim, uint8_t Dir)
+{
+  SHT1x_Sim_Update(Sim);
+  Sim->MasterDir = Dir ? 1 : 0;
+  SHT1x_Sim_Resolve(Sim, Sim->Clock->NowNs);
+  SHT1x_Sim_Tick(Sim, Sim->Timing.CallCostNs);
+}
+
+/**
+ * @brief  Bus function: set output latch of DATA.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Level: Output level
+ * @retval None
+ */
+void
+SHT1x_Sim_DataWrite(SHT1x_Sim_t *Sim, uint8_t Level)
+{
+  SHT1x_Sim_Update(Sim);
+  Sim->MasterLevel = Level ? 1 : 0;
+  SHT1x_Sim_Resolve(Sim, Sim->Clock->NowNs);
+  SHT1x_Sim_Tick(Sim, Sim->Timing.CallCostNs);
+}
+
+/**
+ * @brief  Bus function: read DATA.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval DATA level
+ */
+uint8_t
+SHT1x_Sim_DataRead(SHT1x_Sim_t *Sim)
+{
+  uint8_t Level;
+
+  SHT1x_Sim_Update(Sim);
+  if (Sim->PendingAt)
+    SHT1x_Sim_Violation(Sim, SHT1x_Sim_ReadBeforeValid);
+  Level = Sim->Line;
+  SHT1x_Sim_Tick(Sim, Sim->Timing.CallCostNs);
+
+  return Level;
+}
+
+/**
+ * @brief  Bus function: sleep until DATA is low, like a falling-edge
+ *         interrupt. The clock advances to the edge, or to the timeout.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  TimeoutMs: Timeout (ms)
+ * @retval 1: DATA is low, 0: Timeout
+ */
+uint8_t
+SHT1x_Sim_WaitDataLow(SHT1x_Sim_t *Sim, uint16_t TimeoutMs)
+{
+  const uint64_t Deadline = Sim->Clock->NowNs + TimeoutMs * 1000000ULL;
+  uint64_t Next;
+
+  SHT1x_Sim_Update(Sim);
+  while (Sim->Line && Sim->Clock->NowNs < Deadline)
+  {
+    // jump to the next sensor event, nothing else can pull DATA low
+    Next = Deadline;
+    if (Sim->PendingAt && Sim->PendingAt < Next)
+      Next = Sim->PendingAt;
+    if (Sim->DoneAt && Sim->DoneAt < Next)
+      Next = Sim->DoneAt;
+    SHT1x_Sim_Tick(Sim, Next - Sim->Clock->NowNs);
+    SHT1x_Sim_Update(Sim);
+  }
+
+  // wake-up latency
+  SHT1x_Sim_Tick(Sim, Sim->Timing.CallCostNs);
+
+  return Sim->Line ? 0 : 1;
+}
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Bus function: play a waveform like a bulk emitter. The call costs
+ *         CallCostNs once, every pin access inside it PinWriteNs.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Steps: Waveform
+ * @param  Count: Number of steps
+ * @param  Samples: DATA samples, MSB first
+ * @retval None
+ */
+void
+SHT1x_Sim_EmitWaveform(SHT1x_Sim_t *Sim, const SHT1x_WaveStep_t *Steps,
+                       uint8_t Count, uint8_t *Samples)
+{
+  const uint32_t CallCostNs = Sim->Timing.CallCostNs;
+  uint8_t Bit = 0;
+
+  SHT1x_Sim_Tick(Sim, CallCostNs);
+
+  // the bus functions below then cost one pin access each
+  Sim->Timing.CallCostNs = Sim->Timing.PinWriteNs;
+  for (; Count; Count--, Steps++)
+  {
+    const uint8_t Pins = Steps->Pins;
+
+    if ((Pins & SHT1X_WAVE_SCK ? 1 : 0) != Sim->Sck)
+      SHT1x_Sim_SckWrite(Sim, Pins & SHT1X_WAVE_SCK);
+
+    if (Pins & SHT1X_WAVE_RELEASE)
+    {
+      if (Sim->MasterDir)
+        SHT1x_Sim_DataConfigDir(Sim, 0);
+    }
+    else
+    {
+      if (!Sim->MasterDir)
+        SHT1x_Sim_DataConfigDir(Sim, 1);
+      if ((Pins & SHT1X_WAVE_DATA ? 1 : 0) != Sim->MasterLevel)
+        SHT1x_Sim_DataWrite(Sim, Pins & SHT1X_WAVE_DATA);
+    }
+
+    SHT1x_Sim_Tick(Sim, Steps->DelayUs * 1000ULL);
+    SHT1x_Sim_Update(Sim);
+
+    if (Pins & SHT1X_WAVE_SAMPLE)
+    {
+      if (SHT1x_Sim_DataRead(Sim))
+        Samples[Bit >> 3] |= (uint8_t)(0x80 >> (Bit & 7));
+      Bit++;
+    }
+  }
+  Sim->Timing.CallCostNs = CallCostNs;
+}
+#endif
+
+/**
+ * @brief  Bus function: set SCK.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Level: Output level
+ * @retval None
+ */
+void
+SHT1x_Sim_SckWrite(SHT1x_Sim_t *Sim, uint8_t Level)
+{
+  Level = Level ? 1 : 0;
+
+  SHT1x_Sim_Update(Sim);
+  if (Level != Sim->Sck)
+  {
+    Sim->Sck = Level;
+    Sim->Stats.SckEdges++;
+    if (Level)
+      SHT1x_Sim_OnSckRise(Sim);
+    else
+      SHT1x_Sim_OnSckFall(Sim);
+    Sim->SckChangeAt = Sim->Clock->NowNs;
+    SHT1x_Sim_Resolve(Sim, Sim->Clock->NowNs);
+  }
+  SHT1x_Sim_Tick(Sim, Sim->Timing.CallCostNs);
+}
+
+/**
+ * @brief  Bus function: delay (ms).
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Delay: Delay (ms)
+ * @retval None
+ */
+void
+SHT1x_Sim_DelayMs(SHT1x_Sim_t *Sim, uint8_t Delay)
+{
+  SHT1x_Sim_Tick(Sim, Delay * 1000000ULL + Sim->Timing.CallCostNs);
+  SHT1x_Sim_Update(Sim);
+}
+
+/**
+ * @brief  Bus function: delay (us).
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Delay: Delay (us)
+ * @retval None
+ */
+void
+SHT1x_Sim_DelayUs(SHT1x_Sim_t *Sim, uint8_t Delay)
+{
+  SHT1x_Sim_Tick(Sim, Delay * 1000ULL + Sim->Timing.CallCostNs);
+  SHT1x_Sim_Update(Sim);
+}
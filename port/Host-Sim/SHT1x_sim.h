@@ -0,0 +1,411 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_sim.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Host-side simulated SHT1x sensor
+ *         Functionalities of the this file:
+ *          + Bus-level model of the SHT1x 2-wire interface on a virtual clock
+ *          + Status register, conversion time, CRC-8 and self-heating model
+ *          + Protocol timing checker
+ *          + Deterministic fault injection
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_SIM_H_
+#define _SHT1X_SIM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  Number of simulated sensors that can be attached to handlers at the
+ *         same time. Every slot owns its own set of callback functions because
+ *         the callbacks of SHT1x_Handler_t do not carry a context pointer.
+ * @note   The maximum value is 1000.
+ */
+#ifndef SHT1X_SIM_MAX_SLOTS
+  #define SHT1X_SIM_MAX_SLOTS   1000
+#endif
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Virtual clock. Several simulated sensors may share one clock to model
+ *         sensors that are driven by the same CPU.
+ */
+typedef struct SHT1x_Sim_Clock_s
+{
+  uint64_t NowNs;
+
+  // Real-time source (optional). The virtual time never falls behind it, so
+  // conversions end in real time; bus calls still add their cost on top.
+  uint64_t (*RealTimeNs)(void);
+} SHT1x_Sim_Clock_t;
+
+/**
+ * @brief  Protocol violations detected by the timing checker
+ */
+typedef enum SHT1x_Sim_Violation_e
+{
+  SHT1x_Sim_SckHighShort = 0,   // SCK high time shorter than tSCKH
+  SHT1x_Sim_SckLowShort,        // SCK low time shorter than tSCKL
+  SHT1x_Sim_DataSetup,          // DATA changed less than tSU before SCK rising edge
+  SHT1x_Sim_DataHold,           // DATA changed less than tHO after SCK falling edge
+  SHT1x_Sim_DataChangeSckHigh,  // DATA changed while SCK high outside a start sequence
+  SHT1x_Sim_ReadBeforeValid,    // DATA read less than tV after SCK falling edge
+  SHT1x_Sim_Contention,         // Master drives DATA high while sensor pulls it low
+  SHT1x_Sim_SckWhileBusy,       // SCK toggled during a conversion or reset
+  SHT1x_Sim_UnknownCommand,     // Invalid address bits or command
+  SHT1x_Sim_ViolationCount
+} SHT1x_Sim_Violation_t;
+
+/**
+ * @brief  Stuck DATA line fault
+ */
+typedef enum SHT1x_Sim_Stuck_e
+{
+  SHT1x_Sim_StuckNone = 0,
+  SHT1x_Sim_StuckLow  = 1,
+  SHT1x_Sim_StuckHigh = 2
+} SHT1x_Sim_Stuck_t;
+
+/**
+ * @brief  Timing parameters (ns). Defaults follow the SHT1x datasheet.
+ */
+typedef struct SHT1x_Sim_Timing_s
+{
+  uint32_t SckHighMinNs;    // tSCKH
+  uint32_t SckLowMinNs;     // tSCKL
+  uint32_t DataSetupMinNs;  // tSU
+  uint32_t DataHoldMinNs;   // tHO
+  uint32_t DataValidNs;     // tV, sensor output delay after SCK falling edge
+  uint32_t CallCostNs;      // Time consumed by every callback (models the MCU)
+  uint32_t PinWriteNs;      // Time of one pin access inside EmitWaveform
+  uint32_t ResetTimeNs;     // Soft reset and power-up time
+} SHT1x_Sim_Timing_t;
+
+/**
+ * @brief  Fault injection. All counters are decremented as faults are consumed.
+ */
+typedef struct SHT1x_Sim_Faults_s
+{
+  uint16_t DropAck;         // Number of upcoming sensor ACKs to withhold
+  uint16_t HangConversion;  // Number of upcoming conversions that never complete
+  SHT1x_Sim_Stuck_t StuckData;
+  uint8_t  FlipMask;        // XOR mask applied to the next transmitted byte
+  uint32_t BitErrorPpm;     // Random bit errors on transmitted bits (ppm)
+  uint32_t Seed;            // Seed of the bit error generator
+} SHT1x_Sim_Faults_t;
+
+/**
+ * @brief  Bus and protocol counters
+ */
+typedef struct SHT1x_Sim_Stats_s
+{
+  uint32_t SckEdges;
+  uint32_t DataEdges;
+  uint32_t Commands;
+  uint32_t Conversions;
+  uint32_t InterfaceResets;
+  uint32_t Violations[SHT1x_Sim_ViolationCount];
+  uint32_t FaultsInjected;
+} SHT1x_Sim_Stats_t;
+
+/**
+ * @brief  Simulated sensor
+ * @note   Initialize with SHT1x_Sim_Init, then change the public parameters
+ *         (environment, timing, faults) at any time.
+ */
+typedef struct SHT1x_Sim_s SHT1x_Sim_t;
+
+struct SHT1x_Sim_s
+{
+  // Public parameters
+  SHT1x_Sim_Clock_t *Clock;
+  SHT1x_Sim_Timing_t Timing;
+  SHT1x_Sim_Faults_t Faults;
+  SHT1x_Sim_Stats_t  Stats;
+
+  float AmbientC;           // Ambient temperature
+  float HumidityP;          // Ambient relative humidity
+  float SupplyV;            // Supply voltage, used for the d1 coefficient
+  float OscillatorScale;    // Conversion time scale (0.7 ... 1.0 of maximum)
+  float HeaterRiseC;        // Steady-state rise with internal heater on
+  float ActiveRiseC;        // Steady-state rise at 100% measurement duty cycle
+  float ThermalTauS;        // Thermal time constant of the die
+
+  // Called on every protocol violation (optional)
+  void (*OnViolation)(SHT1x_Sim_t *Sim, SHT1x_Sim_Violation_t Violation);
+
+  // Private state
+  uint8_t  MasterDir;       // 1: master drives DATA
+  uint8_t  MasterLevel;     // Output latch of the master
+  uint8_t  Sck;
+  uint8_t  Line;            // Resolved DATA level
+  uint8_t  SensorPull;      // 1: sensor pulls DATA low
+  uint8_t  PendingPull;
+  uint64_t PendingAt;       // Time at which PendingPull takes effect (0: none)
+
+  uint8_t  State;
+  uint8_t  StartPhase;
+  uint8_t  BitCount;
+  uint8_t  ShiftReg;
+  uint8_t  Cmd;
+  uint8_t  Status;
+  uint8_t  HighClocks;      // Consecutive SCK pulses with DATA high
+  uint8_t  TxBuf[3];
+  uint8_t  TxLen;
+  uint8_t  TxIndex;
+  uint8_t  SelfHeatActive;
+
+  uint64_t SckChangeAt;
+  uint64_t SckFallAt;
+  uint64_t DataChangeAt;
+  uint64_t DoneAt;          // Conversion or reset completion time (0: none)
+  uint64_t HeatUpdatedAt;
+  float    HeatC;           // Current self-heating offset
+  uint32_t Rand;
+
+  int16_t  Slot;
+};
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize simulated sensor with default parameters.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Clock: Virtual clock. NULL selects the internal shared clock.
+ * @retval None
+ */
+void
+SHT1x_Sim_Init(SHT1x_Sim_t *Sim, SHT1x_Sim_Clock_t *Clock);
+
+
+/**
+ * @brief  Bind the simulated sensor to the platform-dependent part of Handler.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Handler: Pointer to handler
+ * @note   Not available when SHT1X_CONFIG_STATIC_PORT is enabled; the driver is
+ *         then connected to the default simulated sensor of SHT1x_platform.h.
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No free slot, or SHT1X_CONFIG_STATIC_PORT is enabled.
+ */
+SHT1x_Result_t
+SHT1x_Sim_Attach(SHT1x_Sim_t *Sim, SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Release the slot of the simulated sensor.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval None
+ */
+void
+SHT1x_Sim_Detach(SHT1x_Sim_t *Sim);
+
+
+/**
+ * @brief  Remove and restore sensor power. The interface and the status register
+ *         are cleared and the sensor stays busy for Timing.ResetTimeNs.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval None
+ */
+void
+SHT1x_Sim_PowerCycle(SHT1x_Sim_t *Sim);
+
+
+/**
+ * @brief  Advance the virtual clock of the sensor.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Ns: Time to advance (ns)
+ * @retval None
+ */
+void
+SHT1x_Sim_Advance(SHT1x_Sim_t *Sim, uint64_t Ns);
+
+
+/**
+ * @brief  Current time on the virtual clock of the sensor.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval Time (ns)
+ */
+uint64_t
+SHT1x_Sim_Now(SHT1x_Sim_t *Sim);
+
+
+/**
+ * @brief  Total number of protocol violations.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval Number of violations
+ */
+uint32_t
+SHT1x_Sim_Violations(SHT1x_Sim_t *Sim);
+
+
+/**
+ * @brief  Name of a violation, useful for reports.
+ * @param  Violation: Violation
+ * @retval Constant string
+ */
+const char *
+SHT1x_Sim_ViolationName(SHT1x_Sim_Violation_t Violation);
+
+
+/**
+ * @brief  SHT1x CRC-8 as transmitted by the sensor.
+ * @param  Status: Status register (lower nibble seeds the CRC)
+ * @param  Data: Command byte followed by the data bytes
+ * @param  Len: Number of bytes
+ * @retval CRC byte in transmitted bit order
+ */
+uint8_t
+SHT1x_Sim_Crc(uint8_t Status, const uint8_t *Data, uint8_t Len);
+
+
+/**
+ * @brief  Bus function: initialize the master side (SCK and DATA output low).
+ * @param  Sim: Pointer to simulated sensor
+ * @retval None
+ */
+void
+SHT1x_Sim_PlatformInit(SHT1x_Sim_t *Sim);
+
+
+/**
+ * @brief  Bus function: release DATA.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval None
+ */
+void
+SHT1x_Sim_PlatformDeInit(SHT1x_Sim_t *Sim);
+
+
+/**
+ * @brief  Bus function: set direction of DATA.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Dir: 0: Input, 1: Output
+ * @retval None
+ */
+void
+SHT1x_Sim_DataConfigDir(SHT1x_Sim_t *Sim, uint8_t Dir);
+
+
+/**
+ * @brief  Bus function: set output latch of DATA.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Level: Output level
+ * @retval None
+ */
+void
+SHT1x_Sim_DataWrite(SHT1x_Sim_t *Sim, uint8_t Level);
+
+
+/**
+ * @brief  Bus function: read DATA.
+ * @param  Sim: Pointer to simulated sensor
+ * @retval DATA level
+ */
+uint8_t
+SHT1x_Sim_DataRead(SHT1x_Sim_t *Sim);
+
+
+/**
+ * @brief  Bus function: sleep until DATA is low, like a falling-edge
+ *         interrupt. The clock advances to the edge, or to the timeout.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  TimeoutMs: Timeout (ms)
+ * @retval 1: DATA is low, 0: Timeout
+ */
+uint8_t
+SHT1x_Sim_WaitDataLow(SHT1x_Sim_t *Sim, uint16_t TimeoutMs);
+
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Bus function: play a waveform like a bulk emitter. The call costs
+ *         CallCostNs once, every pin access inside it PinWriteNs.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Steps: Waveform
+ * @param  Count: Number of steps
+ * @param  Samples: DATA samples, MSB first
+ * @retval None
+ */
+void
+SHT1x_Sim_EmitWaveform(SHT1x_Sim_t *Sim, const SHT1x_WaveStep_t *Steps,
+                       uint8_t Count, uint8_t *Samples);
+#endif
+
+
+/**
+ * @brief  Bus function: set SCK.
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Level: Output level
+ * @retval None
+ */
+void
+SHT1x_Sim_SckWrite(SHT1x_Sim_t *Sim, uint8_t Level);
+
+
+/**
+ * @brief  Bus function: delay (ms).
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Delay: Delay (ms)
+ * @retval None
+ */
+void
+SHT1x_Sim_DelayMs(SHT1x_Sim_t *Sim, uint8_t Delay);
+
+
+/**
+ * @brief  Bus function: delay (us).
+ * @param  Sim: Pointer to simulated sensor
+ * @param  Delay: Delay (us)
+ * @retval None
+ */
+void
+SHT1x_Sim_DelayUs(SHT1x_Sim_t *Sim, uint8_t Delay);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_SIM_H_
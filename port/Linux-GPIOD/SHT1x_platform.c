@@ -0,0 +1,513 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_platform.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Platform dependent part of SHT1x Library
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 199309L
+#include "SHT1x_platform.h"
+#include <stddef.h>
+#include <time.h>
+#include <gpiod.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+#if (SHT1X_GPIOD_MAX_SLOTS > 64)
+  #error "SHT1X_GPIOD_MAX_SLOTS must not exceed 64"
+#endif
+
+
+/* Private Data Types -----------------------------------------------------------*/
+#if !(SHT1X_CONFIG_STATIC_PORT)
+typedef struct SHT1x_GPIOD_SlotFns_s
+{
+  void (*PlatformInit)(void);
+  void (*PlatformDeInit)(void);
+  void (*DataConfigDir)(uint8_t);
+  void (*DataWrite)(uint8_t);
+  uint8_t (*DataRead)(void);
+  void (*SckWrite)(uint8_t);
+  uint8_t (*WaitDataLow)(uint16_t);
+#if (SHT1X_CONFIG_WAVEFORM)
+  void (*EmitWaveform)(const SHT1x_WaveStep_t *, uint8_t, uint8_t *);
+#endif
+} SHT1x_GPIOD_SlotFns_t;
+#endif
+
+
+/* Private Variables ------------------------------------------------------------*/
+// The port of SHT1x_Platform_Init and of the static port functions
+static SHT1x_GPIOD_t SHT1x_GPIOD_Default =
+{
+  SHT1x_GPIO_CHIP, SHT1x_SCK_LINE, SHT1x_DATA_LINE, NULL, NULL, NULL, -1
+};
+
+#if !(SHT1X_CONFIG_STATIC_PORT)
+static SHT1x_GPIOD_t *SHT1x_GPIOD_Slots[64] = {0};
+#endif
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static uint64_t
+SHT1x_Port_NowNs(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+SHT1x_GPIOD_PlatformInit(SHT1x_GPIOD_t *Port)
+{
+  Port->ChipHandle = gpiod_chip_open_lookup(Port->Chip);
+  if (!Port->ChipHandle)
+    return;
+
+  Port->Sck = gpiod_chip_get_line(Port->ChipHandle, Port->SckLine);
+  Port->Data = gpiod_chip_get_line(Port->ChipHandle, Port->DataLine);
+  gpiod_line_request_output(Port->Sck, SHT1x_CONSUMER, 0);
+  gpiod_line_request_output(Port->Data, SHT1x_CONSUMER, 1);
+}
+
+static void
+SHT1x_GPIOD_PlatformDeInit(SHT1x_GPIOD_t *Port)
+{
+  if (!Port->ChipHandle)
+    return;
+
+  gpiod_line_release(Port->Sck);
+  gpiod_line_release(Port->Data);
+  gpiod_chip_close(Port->ChipHandle);
+  Port->ChipHandle = NULL;
+}
+
+static void
+SHT1x_GPIOD_DataConfigDir(SHT1x_GPIOD_t *Port, uint8_t Dir)
+{
+  if (Dir)
+    gpiod_line_set_config(Port->Data, GPIOD_LINE_REQUEST_DIRECTION_OUTPUT,
+                          0, gpiod_line_get_value(Port->Data));
+  else
+    gpiod_line_set_config(Port->Data, GPIOD_LINE_REQUEST_DIRECTION_INPUT,
+                          GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP, 0);
+}
+
+static void
+SHT1x_GPIOD_DataWrite(SHT1x_GPIOD_t *Port, uint8_t Level)
+{
+  gpiod_line_set_value(Port->Data, Level);
+}
+
+static uint8_t
+SHT1x_GPIOD_DataRead(SHT1x_GPIOD_t *Port)
+{
+  return gpiod_line_get_value(Port->Data) ? 1 : 0;
+}
+
+static void
+SHT1x_GPIOD_SckWrite(SHT1x_GPIOD_t *Port, uint8_t Level)
+{
+  gpiod_line_set_value(Port->Sck, Level);
+}
+
+/**
+ * @brief  Block until DATA is low or the timeout passes. DATA is requested
+ *         for falling-edge events only for the wait.
+ * @param  Port: Pointer to port
+ * @param  TimeoutMs: Timeout (ms)
+ * @retval 1: DATA is low, 0: Timeout
+ */
+static uint8_t
+SHT1x_GPIOD_WaitDataLow(SHT1x_GPIOD_t *Port, uint16_t TimeoutMs)
+{
+  struct timespec ts = {TimeoutMs / 1000, (TimeoutMs % 1000) * 1000000L};
+  struct gpiod_line_event Event;
+  uint8_t Low;
+
+  if (SHT1x_Platform_EdgeArm(Port) < 0)
+    return SHT1x_GPIOD_DataRead(Port) ? 0 : 1;
+
+  // the edge may have passed before the request
+  if (gpiod_line_get_value(Port->Data) &&
+      gpiod_line_event_wait(Port->Data, &ts) == 1)
+    gpiod_line_event_read(Port->Data, &Event);
+
+  Low = gpiod_line_get_value(Port->Data) ? 0 : 1;
+  SHT1x_Platform_EdgeDisarm(Port);
+
+  return Low;
+}
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Play a waveform. Only the lines that change are written, and each
+ *         delay runs from the start of its step, so the time of the line
+ *         calls is part of it.
+ * @param  Port: Pointer to port
+ * @param  Steps: Waveform
+ * @param  Count: Number of steps
+ * @param  Samples: DATA samples, MSB first (zeroed by the caller)
+ * @retval None
+ */
+static void
+SHT1x_GPIOD_EmitWaveform(SHT1x_GPIOD_t *Port, const SHT1x_WaveStep_t *Steps,
+                         uint8_t Count, uint8_t *Samples)
+{
+  uint8_t Pins = (uint8_t)~Steps->Pins;   // the first step sets every line
+  uint8_t Changed;
+  uint8_t Bit = 0;
+  uint64_t End;
+
+  for (; Count; Count--, Steps++)
+  {
+    End = SHT1x_Port_NowNs() + Steps->DelayUs * 1000ULL;
+    Changed = Pins ^ Steps->Pins;
+    Pins = Steps->Pins;
+
+    if (Changed & SHT1X_WAVE_SCK)
+      gpiod_line_set_value(Port->Sck, (Pins & SHT1X_WAVE_SCK) ? 1 : 0);
+
+    if (Pins & SHT1X_WAVE_RELEASE)
+    {
+      if (Changed & SHT1X_WAVE_RELEASE)
+        gpiod_line_set_config(Port->Data, GPIOD_LINE_REQUEST_DIRECTION_INPUT,
+                              GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP, 0);
+    }
+    else if (Changed & SHT1X_WAVE_RELEASE)
+      gpiod_line_set_config(Port->Data, GPIOD_LINE_REQUEST_DIRECTION_OUTPUT,
+                            0, (Pins & SHT1X_WAVE_DATA) ? 1 : 0);
+    else if (Changed & SHT1X_WAVE_DATA)
+      gpiod_line_set_value(Port->Data, (Pins & SHT1X_WAVE_DATA) ? 1 : 0);
+
+    while (SHT1x_Port_NowNs() < End);
+
+    if (Pins & SHT1X_WAVE_SAMPLE)
+    {
+      if (gpiod_line_get_value(Port->Data))
+        Samples[Bit >> 3] |= (uint8_t)(0x80 >> (Bit & 7));
+      Bit++;
+    }
+  }
+}
+#endif
+
+
+
+/**
+ ==================================================================================
+                             ##### Port Functions #####
+ ==================================================================================
+ */
+
+void
+SHT1x_Port_PlatformInit(void)
+{
+  SHT1x_GPIOD_PlatformInit(&SHT1x_GPIOD_Default);
+}
+
+void
+SHT1x_Port_PlatformDeInit(void)
+{
+  SHT1x_GPIOD_PlatformDeInit(&SHT1x_GPIOD_Default);
+}
+
+void
+SHT1x_Port_DataConfigDir(uint8_t Dir)
+{
+  SHT1x_GPIOD_DataConfigDir(&SHT1x_GPIOD_Default, Dir);
+}
+
+void
+SHT1x_Port_DataWrite(uint8_t Level)
+{
+  SHT1x_GPIOD_DataWrite(&SHT1x_GPIOD_Default, Level);
+}
+
+uint8_t
+SHT1x_Port_DataRead(void)
+{
+  return SHT1x_GPIOD_DataRead(&SHT1x_GPIOD_Default);
+}
+
+void
+SHT1x_Port_SckWrite(uint8_t Level)
+{
+  SHT1x_GPIOD_SckWrite(&SHT1x_GPIOD_Default, Level);
+}
+
+void
+SHT1x_Port_DelayMs(uint8_t Delay)
+{
+  struct timespec ts = {0, Delay * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+void
+SHT1x_Port_DelayUs(uint8_t Delay)
+{
+  // too short for the scheduler
+  const uint64_t End = SHT1x_Port_NowNs() + Delay * 1000ULL;
+  while (SHT1x_Port_NowNs() < End);
+}
+
+uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs)
+{
+  return SHT1x_GPIOD_WaitDataLow(&SHT1x_GPIOD_Default, TimeoutMs);
+}
+
+#if (SHT1X_CONFIG_WAVEFORM)
+void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples)
+{
+  SHT1x_GPIOD_EmitWaveform(&SHT1x_GPIOD_Default, Steps, Count, Samples);
+}
+#endif
+
+
+
+#if !(SHT1X_CONFIG_STATIC_PORT)
+/* Slot trampolines -------------------------------------------------------------*/
+#define SHT1x_GPIOD_SLOT_FNS(a, b)                                                \
+  static void SHT1x_GPIOD_PlatformInit_##a##b(void)                               \
+  { SHT1x_GPIOD_PlatformInit(SHT1x_GPIOD_Slots[a * 8 + b]); }                     \
+  static void SHT1x_GPIOD_PlatformDeInit_##a##b(void)                             \
+  { SHT1x_GPIOD_PlatformDeInit(SHT1x_GPIOD_Slots[a * 8 + b]); }                   \
+  static void SHT1x_GPIOD_DataConfigDir_##a##b(uint8_t v)                         \
+  { SHT1x_GPIOD_DataConfigDir(SHT1x_GPIOD_Slots[a * 8 + b], v); }                 \
+  static void SHT1x_GPIOD_DataWrite_##a##b(uint8_t v)                             \
+  { SHT1x_GPIOD_DataWrite(SHT1x_GPIOD_Slots[a * 8 + b], v); }                     \
+  static uint8_t SHT1x_GPIOD_DataRead_##a##b(void)                                \
+  { return SHT1x_GPIOD_DataRead(SHT1x_GPIOD_Slots[a * 8 + b]); }                  \
+  static void SHT1x_GPIOD_SckWrite_##a##b(uint8_t v)                              \
+  { SHT1x_GPIOD_SckWrite(SHT1x_GPIOD_Slots[a * 8 + b], v); }                      \
+  static uint8_t SHT1x_GPIOD_WaitDataLow_##a##b(uint16_t v)                       \
+  { return SHT1x_GPIOD_WaitDataLow(SHT1x_GPIOD_Slots[a * 8 + b], v); }            \
+  SHT1x_GPIOD_SLOT_EMIT(a, b)
+
+#if (SHT1X_CONFIG_WAVEFORM)
+#define SHT1x_GPIOD_SLOT_EMIT(a, b)                                               \
+  static void SHT1x_GPIOD_EmitWaveform_##a##b(const SHT1x_WaveStep_t *s,          \
+                                              uint8_t n, uint8_t *v)              \
+  { SHT1x_GPIOD_EmitWaveform(SHT1x_GPIOD_Slots[a * 8 + b], s, n, v); }
+#define SHT1x_GPIOD_SLOT_EMIT_ENTRY(a, b)   , SHT1x_GPIOD_EmitWaveform_##a##b
+#else
+#define SHT1x_GPIOD_SLOT_EMIT(a, b)
+#define SHT1x_GPIOD_SLOT_EMIT_ENTRY(a, b)
+#endif
+
+#define SHT1x_GPIOD_SLOT_ENTRY(a, b)                                              \
+  { SHT1x_GPIOD_PlatformInit_##a##b, SHT1x_GPIOD_PlatformDeInit_##a##b,           \
+    SHT1x_GPIOD_DataConfigDir_##a##b, SHT1x_GPIOD_DataWrite_##a##b,               \
+    SHT1x_GPIOD_DataRead_##a##b, SHT1x_GPIOD_SckWrite_##a##b,                     \
+    SHT1x_GPIOD_WaitDataLow_##a##b SHT1x_GPIOD_SLOT_EMIT_ENTRY(a, b) },
+
+#define SHT1x_GPIOD_SLOTS_8(X, a) \
+  X(a, 0) X(a, 1) X(a, 2) X(a, 3) X(a, 4) X(a, 5) X(a, 6) X(a, 7)
+#define SHT1x_GPIOD_SLOTS_64(X) \
+  SHT1x_GPIOD_SLOTS_8(X, 0) SHT1x_GPIOD_SLOTS_8(X, 1) \
+  SHT1x_GPIOD_SLOTS_8(X, 2) SHT1x_GPIOD_SLOTS_8(X, 3) \
+  SHT1x_GPIOD_SLOTS_8(X, 4) SHT1x_GPIOD_SLOTS_8(X, 5) \
+  SHT1x_GPIOD_SLOTS_8(X, 6) SHT1x_GPIOD_SLOTS_8(X, 7)
+
+// All 64 slots are generated, only the first SHT1X_GPIOD_MAX_SLOTS are handed out
+SHT1x_GPIOD_SLOTS_64(SHT1x_GPIOD_SLOT_FNS)
+
+static const SHT1x_GPIOD_SlotFns_t SHT1x_GPIOD_SlotFns[64] =
+{
+  SHT1x_GPIOD_SLOTS_64(SHT1x_GPIOD_SLOT_ENTRY)
+};
+#endif
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate SHT1x. The handler drives
+ *         the sensor of SHT1x_GPIO_CHIP, SHT1x_SCK_LINE and SHT1x_DATA_LINE.
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The default port is attached to another handler.
+ */
+SHT1x_Result_t
+SHT1x_Platform_Init(SHT1x_Handler_t *Handler)
+{
+#if (SHT1X_CONFIG_STATIC_PORT)
+  (void)Handler;
+  return SHT1x_OK;
+#else
+  return SHT1x_GPIOD_Attach(&SHT1x_GPIOD_Default, Handler);
+#endif
+}
+
+
+/**
+ * @brief  Set the chip and the lines of a port.
+ * @param  Port: Pointer to port
+ * @param  Chip: Chip name, number or path, e.g. "gpiochip1" (kept, not copied)
+ * @param  SckLine: Line offset of SCK
+ * @param  DataLine: Line offset of DATA
+ * @retval None
+ */
+void
+SHT1x_GPIOD_Init(SHT1x_GPIOD_t *Port, const char *Chip,
+                 unsigned int SckLine, unsigned int DataLine)
+{
+  Port->Chip = Chip;
+  Port->SckLine = SckLine;
+  Port->DataLine = DataLine;
+  Port->ChipHandle = NULL;
+  Port->Sck = NULL;
+  Port->Data = NULL;
+  Port->Slot = -1;
+}
+
+
+/**
+ * @brief  Bind a port to the platform-dependent part of Handler. The chip is
+ *         opened and the lines are requested by SHT1x_Init.
+ * @param  Port: Pointer to port
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No free slot, or SHT1X_CONFIG_STATIC_PORT is enabled.
+ */
+SHT1x_Result_t
+SHT1x_GPIOD_Attach(SHT1x_GPIOD_t *Port, SHT1x_Handler_t *Handler)
+{
+#if (SHT1X_CONFIG_STATIC_PORT)
+  (void)Port;
+  (void)Handler;
+  return SHT1x_FAIL;
+#else
+  const SHT1x_GPIOD_SlotFns_t *Fns;
+
+  if (Port->Slot < 0)
+  {
+    for (int8_t i = 0; i < SHT1X_GPIOD_MAX_SLOTS; i++)
+    {
+      if (!SHT1x_GPIOD_Slots[i])
+      {
+        SHT1x_GPIOD_Slots[i] = Port;
+        Port->Slot = i;
+        break;
+      }
+    }
+
+    if (Port->Slot < 0)
+      return SHT1x_FAIL;
+  }
+
+  Fns = &SHT1x_GPIOD_SlotFns[Port->Slot];
+  Handler->PlatformInit = Fns->PlatformInit;
+  Handler->PlatformDeInit = Fns->PlatformDeInit;
+  Handler->DataConfigDir = Fns->DataConfigDir;
+  Handler->DataWrite = Fns->DataWrite;
+  Handler->DataRead = Fns->DataRead;
+  Handler->SckWrite = Fns->SckWrite;
+  Handler->DelayMs = SHT1x_Port_DelayMs;
+  Handler->DelayUs = SHT1x_Port_DelayUs;
+  Handler->WaitDataLow = Fns->WaitDataLow;
+#if (SHT1X_CONFIG_WAVEFORM)
+  Handler->EmitWaveform = Fns->EmitWaveform;
+#endif
+
+  return SHT1x_OK;
+#endif
+}
+
+
+/**
+ * @brief  Release the slot of a port, after SHT1x_DeInit of its handler.
+ * @param  Port: Pointer to port
+ * @retval None
+ */
+void
+SHT1x_GPIOD_Detach(SHT1x_GPIOD_t *Port)
+{
+#if !(SHT1X_CONFIG_STATIC_PORT)
+  if (Port->Slot >= 0)
+    SHT1x_GPIOD_Slots[Port->Slot] = NULL;
+#endif
+  Port->Slot = -1;
+}
+
+
+/**
+ * @brief  Request DATA for falling-edge events until SHT1x_Platform_EdgeDisarm.
+ *         The value of DATA can still be read meanwhile.
+ * @param  Context: Pointer to the port of the sensor (SHT1x_GPIOD_t), NULL for
+ *                  the port of SHT1x_Platform_Init
+ * @retval File descriptor that becomes readable on a falling edge, -1 if the
+ *         line does not support events (DATA stays an input)
+ */
+int
+SHT1x_Platform_EdgeArm(void *Context)
+{
+  SHT1x_GPIOD_t *Port = Context ? (SHT1x_GPIOD_t *)Context : &SHT1x_GPIOD_Default;
+
+  gpiod_line_release(Port->Data);
+  if (gpiod_line_request_falling_edge_events_flags(Port->Data, SHT1x_CONSUMER,
+                                                   GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP) < 0)
+  {
+    gpiod_line_request_input_flags(Port->Data, SHT1x_CONSUMER,
+                                   GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP);
+    return -1;
+  }
+
+  return gpiod_line_event_get_fd(Port->Data);
+}
+
+/**
+ * @brief  Return DATA to a plain input after SHT1x_Platform_EdgeArm. The file
+ *         descriptor of the events is closed.
+ * @param  Context: Pointer to the port of the sensor (SHT1x_GPIOD_t), NULL for
+ *                  the port of SHT1x_Platform_Init
+ * @retval None
+ */
+void
+SHT1x_Platform_EdgeDisarm(void *Context)
+{
+  SHT1x_GPIOD_t *Port = Context ? (SHT1x_GPIOD_t *)Context : &SHT1x_GPIOD_Default;
+
+  gpiod_line_release(Port->Data);
+  gpiod_line_request_input_flags(Port->Data, SHT1x_CONSUMER,
+                                 GPIOD_LINE_REQUEST_FLAG_BIAS_PULL_UP);
+}
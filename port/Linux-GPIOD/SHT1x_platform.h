@@ -0,0 +1,231 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_platform.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Platform dependent part of SHT1x Library
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+  
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_PLATFORM_H
+#define _SHT1X_PLATFORM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+
+/* Functionality Options --------------------------------------------------------*/
+/**
+ * @brief  Specify GPIO chip and line offsets of the sensor of
+ *         SHT1x_Platform_Init and of the SHT1x_Port_* functions
+ */
+#define SHT1x_GPIO_CHIP   "gpiochip0"
+#define SHT1x_SCK_LINE    17
+#define SHT1x_DATA_LINE   18
+#define SHT1x_CONSUMER    "sht1x"
+
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  Number of ports that can be attached at the same time (1 to 64).
+ *         Every slot owns its own set of callback functions because the
+ *         callbacks of SHT1x_Handler_t do not carry a context pointer.
+ */
+#ifndef SHT1X_GPIOD_MAX_SLOTS
+#define SHT1X_GPIOD_MAX_SLOTS   16
+#endif
+
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+struct gpiod_chip;
+struct gpiod_line;
+
+/**
+ * @brief  One sensor on a GPIO chip. Sensors may share a chip, each one opens
+ *         it on its own.
+ */
+typedef struct SHT1x_GPIOD_s
+{
+  const char *Chip;         // Chip name, number or path
+  unsigned int SckLine;     // Line offset of SCK
+  unsigned int DataLine;    // Line offset of DATA
+
+  // Private
+  struct gpiod_chip *ChipHandle;
+  struct gpiod_line *Sck;
+  struct gpiod_line *Data;
+  int8_t Slot;
+} SHT1x_GPIOD_t;
+
+
+
+/**
+ ==================================================================================
+                             ##### Port Functions #####                            
+ ==================================================================================
+ */
+
+/**
+ * @brief  Pin and delay functions on libgpiod (v1.5 or later) for the sensor
+ *         of SHT1x_GPIO_CHIP. SHT1x.c calls them directly when
+ *         SHT1X_CONFIG_STATIC_PORT is enabled; otherwise the handlers are
+ *         bound to an SHT1x_GPIOD_t each by SHT1x_GPIOD_Attach.
+ * @note   SHT1x_Port_WaitDataLow blocks in the kernel on a falling-edge event
+ *         of DATA instead of polling it.
+ */
+void
+SHT1x_Port_PlatformInit(void);
+
+void
+SHT1x_Port_PlatformDeInit(void);
+
+void
+SHT1x_Port_DataConfigDir(uint8_t Dir);
+
+void
+SHT1x_Port_DataWrite(uint8_t Level);
+
+uint8_t
+SHT1x_Port_DataRead(void);
+
+void
+SHT1x_Port_SckWrite(uint8_t Level);
+
+void
+SHT1x_Port_DelayMs(uint8_t Delay);
+
+void
+SHT1x_Port_DelayUs(uint8_t Delay);
+
+#define SHT1X_PORT_HAS_WAIT_DATA_LOW  1
+
+uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs);
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Play a waveform with one line request call per changed pin and
+ *         busy-waits between them. SCK and DATA are set one after the
+ *         other, a bulk set would change them at the same time (tHO).
+ */
+#define SHT1X_PORT_HAS_EMIT_WAVEFORM  1
+
+void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples);
+#endif
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####                               
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize platform device to communicate SHT1x. The handler drives
+ *         the sensor of SHT1x_GPIO_CHIP, SHT1x_SCK_LINE and SHT1x_DATA_LINE.
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The default port is attached to another handler.
+ */
+SHT1x_Result_t
+SHT1x_Platform_Init(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Set the chip and the lines of a port.
+ * @param  Port: Pointer to port
+ * @param  Chip: Chip name, number or path, e.g. "gpiochip1" (kept, not copied)
+ * @param  SckLine: Line offset of SCK
+ * @param  DataLine: Line offset of DATA
+ * @retval None
+ */
+void
+SHT1x_GPIOD_Init(SHT1x_GPIOD_t *Port, const char *Chip,
+                 unsigned int SckLine, unsigned int DataLine);
+
+
+/**
+ * @brief  Bind a port to the platform-dependent part of Handler, in place of
+ *         SHT1x_Platform_Init. The chip is opened and the lines are requested
+ *         by SHT1x_Init.
+ * @param  Port: Pointer to port
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No free slot, or SHT1X_CONFIG_STATIC_PORT is enabled.
+ */
+SHT1x_Result_t
+SHT1x_GPIOD_Attach(SHT1x_GPIOD_t *Port, SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Release the slot of a port, after SHT1x_DeInit of its handler.
+ * @param  Port: Pointer to port
+ * @retval None
+ */
+void
+SHT1x_GPIOD_Detach(SHT1x_GPIOD_t *Port);
+
+
+/**
+ * @brief  Request DATA for falling-edge events, e.g. for the EdgeArm hook of
+ *         SHT1x_evloop.h. The value of DATA can still be read meanwhile.
+ * @param  Context: Pointer to the port of the sensor (SHT1x_GPIOD_t), NULL for
+ *                  the port of SHT1x_Platform_Init
+ * @retval File descriptor that becomes readable on a falling edge, -1 if the
+ *         line does not support events
+ */
+int
+SHT1x_Platform_EdgeArm(void *Context);
+
+
+/**
+ * @brief  Return DATA to a plain input after SHT1x_Platform_EdgeArm.
+ * @param  Context: Pointer to the port of the sensor (SHT1x_GPIOD_t), NULL for
+ *                  the port of SHT1x_Platform_Init
+ * @retval None
+ */
+void
+SHT1x_Platform_EdgeDisarm(void *Context);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -30,119 +30,156 @@
   
 /* Includes ---------------------------------------------------------------------*/
 #include "SHT1x_platform.h"
-#include "main.h"
+#if (SHT1X_CONFIG_WAVEFORM)
+#include "SHT1x_wave.h"
+#endif
+
+
+#if defined(SHT1x_ENGINE_TIM)
+/* Private Variables ------------------------------------------------------------*/
+extern TIM_HandleTypeDef SHT1x_ENGINE_TIM;
+
+static SHT1x_Engine_t *SHT1x_Platform_Engine = NULL;
+static uint32_t SHT1x_Platform_EngineRemainUs = 0;
 
 
 
 /**
  ==================================================================================
-                           ##### Private Functions #####                           
+                           ##### Private Functions #####
  ==================================================================================
  */
 
+// one-shot timer, longer delays run in 16-bit pieces
 static void
-SHT1x_SetGPIO_OUT(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+SHT1x_Platform_EngineSchedule(uint32_t DelayUs)
 {
-  GPIO_InitTypeDef GPIO_InitStruct = {0};
-  GPIO_InitStruct.Pin = GPIO_Pin;
-  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
-  GPIO_InitStruct.Pull = GPIO_NOPULL;
-  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-  HAL_GPIO_Init(GPIOx, &GPIO_InitStruct);
-}
+  const uint32_t Us = (DelayUs > 0x10000) ? 0x10000 : DelayUs;
 
-static void
-SHT1x_SetGPIO_IN_PU(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
-{
-  GPIO_InitTypeDef GPIO_InitStruct = {0};
-  GPIO_InitStruct.Pin = GPIO_Pin;
-  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-  GPIO_InitStruct.Pull = GPIO_PULLUP;
-  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
-  HAL_GPIO_Init(GPIOx, &GPIO_InitStruct);
+  HAL_TIM_Base_Stop_IT(&SHT1x_ENGINE_TIM);
+  SHT1x_Platform_EngineRemainUs = DelayUs - Us;
+  if (!Us)
+    return;
+
+  __HAL_TIM_SET_AUTORELOAD(&SHT1x_ENGINE_TIM, Us - 1);
+  __HAL_TIM_SET_COUNTER(&SHT1x_ENGINE_TIM, 0);
+  __HAL_TIM_CLEAR_FLAG(&SHT1x_ENGINE_TIM, TIM_FLAG_UPDATE);
+  HAL_TIM_Base_Start_IT(&SHT1x_ENGINE_TIM);
 }
+#endif
 
 
-static void
-SHT1x_Platform_PlatformInit(void)
-{
-  SHT1x_SetGPIO_OUT(SHT1x_SCK_GPIO, SHT1x_SCK_PIN);
-  SHT1x_SetGPIO_OUT(SHT1x_DATA_GPIO, SHT1x_DATA_PIN);
-}
 
-static void
-SHT1x_Platform_PlatformDeInit(void)
-{
-}
+/**
+ ==================================================================================
+                            ##### Public Functions #####                           
+ ==================================================================================
+ */
 
-static void
-SHT1x_Platform_DataConfigDir(uint8_t Dir)
+/**
+ * @brief  Initialize platform device to communicate SHT1x.
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_Platform_Init(SHT1x_Handler_t *Handler)
 {
-  if (Dir)
-    SHT1x_SetGPIO_OUT(SHT1x_DATA_GPIO, SHT1x_DATA_PIN);
-  else
-    SHT1x_SetGPIO_IN_PU(SHT1x_DATA_GPIO, SHT1x_DATA_PIN);
-}
+#if (SHT1X_CONFIG_STATIC_PORT)
+  (void)Handler;
+#else
+  Handler->PlatformInit = SHT1x_Port_PlatformInit;
+  Handler->PlatformDeInit = SHT1x_Port_PlatformDeInit;
+  Handler->DataConfigDir = SHT1x_Port_DataConfigDir;
+  Handler->DataWrite = SHT1x_Port_DataWrite;
+  Handler->DataRead = SHT1x_Port_DataRead;
+  Handler->SckWrite = SHT1x_Port_SckWrite;
+  Handler->DelayMs = SHT1x_Port_DelayMs;
+  Handler->DelayUs = SHT1x_Port_DelayUs;
+  Handler->WaitDataLow = SHT1x_Port_WaitDataLow;
+#if (SHT1X_CONFIG_WAVEFORM)
+  Handler->EmitWaveform = SHT1x_Port_EmitWaveform;
+#endif
+#endif
 
-static void
-SHT1x_Platform_DataWrite(uint8_t Level)
-{
-  HAL_GPIO_WritePin(SHT1x_DATA_GPIO, SHT1x_DATA_PIN, Level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+  return SHT1x_OK;
 }
 
-static uint8_t
-SHT1x_Platform_DataRead(void)
-{
-  return HAL_GPIO_ReadPin(SHT1x_DATA_GPIO, SHT1x_DATA_PIN);
-}
 
-static void
-SHT1x_Platform_SckWrite(uint8_t Level)
+/**
+ * @brief  Sleep until DATA is low or the timeout passes.
+ * @param  TimeoutMs: Timeout (ms)
+ * @retval 1: DATA is low, 0: Timeout
+ */
+uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs)
 {
-  HAL_GPIO_WritePin(SHT1x_SCK_GPIO, SHT1x_SCK_PIN, Level ? GPIO_PIN_SET : GPIO_PIN_RESET);
-}
+  const uint32_t Start = HAL_GetTick();
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
 
-static void
-SHT1x_Platform_DelayMs(uint8_t Delay)
-{
-  HAL_Delay(Delay);
+  GPIO_InitStruct.Pin = SHT1x_DATA_PIN;
+  GPIO_InitStruct.Mode = GPIO_MODE_EVT_FALLING;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  HAL_GPIO_Init(SHT1x_DATA_GPIO, &GPIO_InitStruct);
+
+  // an edge between the check and WFE sets the event flag, WFE returns at once
+  while (SHT1x_Port_DataRead() && (HAL_GetTick() - Start) <= TimeoutMs)
+    __WFE();
+
+  EXTI->EMR &= ~SHT1x_DATA_PIN;
+  EXTI->FTSR &= ~SHT1x_DATA_PIN;
+  SHT1x_Port_SetGPIO_IN_PU(SHT1x_DATA_GPIO, SHT1x_DATA_PIN);
+
+  return SHT1x_Port_DataRead() ? 0 : 1;
 }
 
-static void
-SHT1x_Platform_DelayUs(uint8_t Delay)
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Play a waveform with the shared player of SHT1x_wave.h.
+ * @param  Steps: Waveform
+ * @param  Count: Number of steps
+ * @param  Samples: DATA samples, MSB first (zeroed by the caller)
+ * @retval None
+ */
+void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples)
 {
-  uint32_t clk_freq = HAL_RCC_GetSysClockFreq();
-  uint32_t ticks = (Delay * clk_freq) / 1000000;
-  for (uint32_t i = 0; i < ticks; i++)
-  {
-    __NOP();
-  }
+  SHT1x_Wave_Play(Steps, Count, Samples);
 }
+#endif
 
 
-
+#if defined(SHT1x_ENGINE_TIM)
 /**
- ==================================================================================
-                            ##### Public Functions #####                           
- ==================================================================================
+ * @brief  Initialize Engine on the timer SHT1x_ENGINE_TIM.
+ * @param  Engine: Pointer to engine
+ * @param  Handler: Pointer to initialized handler
+ * @retval None
  */
+void
+SHT1x_Platform_EngineInit(SHT1x_Engine_t *Engine, SHT1x_Handler_t *Handler)
+{
+  SHT1x_Platform_Engine = Engine;
+  SHT1x_Engine_Init(Engine, Handler, SHT1x_Platform_EngineSchedule);
+}
+
 
 /**
- * @brief  Initialize platform device to communicate SHT1x.
- * @retval SHT1x_Result_t
- *         - SHT1x_OK: Operation was successful.
+ * @brief  Update interrupt of SHT1x_ENGINE_TIM.
+ * @retval None
  */
-SHT1x_Result_t
-SHT1x_Platform_Init(SHT1x_Handler_t *Handler)
+void
+SHT1x_Platform_EngineIRQ(void)
 {
-  Handler->PlatformInit = SHT1x_Platform_PlatformInit;
-  Handler->PlatformDeInit = SHT1x_Platform_PlatformDeInit;
-  Handler->DataConfigDir = SHT1x_Platform_DataConfigDir;
-  Handler->DataWrite = SHT1x_Platform_DataWrite;
-  Handler->DataRead = SHT1x_Platform_DataRead;
-  Handler->SckWrite = SHT1x_Platform_SckWrite;
-  Handler->DelayMs = SHT1x_Platform_DelayMs;
-  Handler->DelayUs = SHT1x_Platform_DelayUs;
+  if (SHT1x_Platform_EngineRemainUs)
+  {
+    SHT1x_Platform_EngineSchedule(SHT1x_Platform_EngineRemainUs);
+    return;
+  }
 
-  return SHT1x_OK;
+  HAL_TIM_Base_Stop_IT(&SHT1x_ENGINE_TIM);
+  if (SHT1x_Platform_Engine)
+    SHT1x_Engine_Tick(SHT1x_Platform_Engine);
 }
+#endif
@@ -40,6 +40,7 @@ extern "C" {
 /* Includes ---------------------------------------------------------------------*/
 #include <stdint.h>
 #include "SHT1x.h"
+#include "main.h"
 
 
 /* Functionality Options --------------------------------------------------------*/
@@ -51,6 +52,136 @@ extern "C" {
 #define SHT1x_DATA_GPIO   GPIOA
 #define SHT1x_DATA_PIN    GPIO_PIN_1
 
+/**
+ * @brief  Timer handle of SHT1x_engine, counting at 1 MHz with its update
+ *         interrupt enabled (e.g. htim6). Call SHT1x_Platform_EngineIRQ from
+ *         HAL_TIM_PeriodElapsedCallback for this timer.
+ */
+// #define SHT1x_ENGINE_TIM  htim6
+
+
+
+/**
+ ==================================================================================
+                             ##### Port Functions #####                            
+ ==================================================================================
+ */
+
+/**
+ * @brief  Pin and delay functions. SHT1x.c calls them directly when
+ *         SHT1X_CONFIG_STATIC_PORT is enabled; otherwise SHT1x_Platform_Init
+ *         puts them into the handler.
+ */
+
+static inline void
+SHT1x_Port_SetGPIO_OUT(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  GPIO_InitStruct.Pin = GPIO_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOx, &GPIO_InitStruct);
+}
+
+static inline void
+SHT1x_Port_SetGPIO_IN_PU(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
+{
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+  GPIO_InitStruct.Pin = GPIO_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(GPIOx, &GPIO_InitStruct);
+}
+
+
+static inline void
+SHT1x_Port_PlatformInit(void)
+{
+#if defined(DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  SHT1x_Port_SetGPIO_OUT(SHT1x_SCK_GPIO, SHT1x_SCK_PIN);
+  SHT1x_Port_SetGPIO_OUT(SHT1x_DATA_GPIO, SHT1x_DATA_PIN);
+}
+
+static inline void
+SHT1x_Port_PlatformDeInit(void)
+{
+}
+
+static inline void
+SHT1x_Port_DataConfigDir(uint8_t Dir)
+{
+  if (Dir)
+    SHT1x_Port_SetGPIO_OUT(SHT1x_DATA_GPIO, SHT1x_DATA_PIN);
+  else
+    SHT1x_Port_SetGPIO_IN_PU(SHT1x_DATA_GPIO, SHT1x_DATA_PIN);
+}
+
+static inline void
+SHT1x_Port_DataWrite(uint8_t Level)
+{
+  SHT1x_DATA_GPIO->BSRR = Level ? SHT1x_DATA_PIN : ((uint32_t)SHT1x_DATA_PIN << 16);
+}
+
+static inline uint8_t
+SHT1x_Port_DataRead(void)
+{
+  return (SHT1x_DATA_GPIO->IDR & SHT1x_DATA_PIN) ? 1 : 0;
+}
+
+static inline void
+SHT1x_Port_SckWrite(uint8_t Level)
+{
+  SHT1x_SCK_GPIO->BSRR = Level ? SHT1x_SCK_PIN : ((uint32_t)SHT1x_SCK_PIN << 16);
+}
+
+static inline void
+SHT1x_Port_DelayMs(uint8_t Delay)
+{
+  HAL_Delay(Delay);
+}
+
+static inline void
+SHT1x_Port_DelayUs(uint8_t Delay)
+{
+#if defined(DWT)
+  // cycle counter, enabled by SHT1x_Port_PlatformInit
+  const uint32_t Start = DWT->CYCCNT;
+  const uint32_t Cycles = Delay * (SystemCoreClock / 1000000);
+
+  while ((DWT->CYCCNT - Start) < Cycles);
+#else
+  // Cortex-M0/M0+ have no cycle counter, about 4 cycles per iteration
+  for (volatile uint32_t i = Delay * (SystemCoreClock / 4000000); i; i--);
+#endif
+}
+
+/**
+ * @brief  Sleep in WFE until the falling edge of DATA. The EXTI line of DATA
+ *         is set to event mode only for the wait, so no EXTI interrupt handler
+ *         is needed; SysTick wakes the core to count the timeout.
+ */
+#define SHT1X_PORT_HAS_WAIT_DATA_LOW  1
+
+uint8_t
+SHT1x_Port_WaitDataLow(uint16_t TimeoutMs);
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Play a waveform in a tight loop on the BSRR registers, timed by
+ *         the cycle counter.
+ */
+#define SHT1X_PORT_HAS_EMIT_WAVEFORM  1
+
+void
+SHT1x_Port_EmitWaveform(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                        uint8_t *Samples);
+#endif
+
 
 
 /**
@@ -68,6 +199,28 @@ SHT1x_Result_t
 SHT1x_Platform_Init(SHT1x_Handler_t *Handler);
 
 
+#if defined(SHT1x_ENGINE_TIM)
+#include "SHT1x_engine.h"
+
+/**
+ * @brief  Initialize Engine on the timer SHT1x_ENGINE_TIM.
+ * @param  Engine: Pointer to engine
+ * @param  Handler: Pointer to initialized handler
+ * @retval None
+ */
+void
+SHT1x_Platform_EngineInit(SHT1x_Engine_t *Engine, SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Update interrupt of SHT1x_ENGINE_TIM.
+ * @retval None
+ */
+void
+SHT1x_Platform_EngineIRQ(void);
+#endif
+
+
 
 #ifdef __cplusplus
 }
@@ -35,6 +35,9 @@
 
 /* Includes ---------------------------------------------------------------------*/
 #include "SHT1x.h"
+#if (SHT1X_CONFIG_STATIC_PORT)
+#include "SHT1x_platform.h"
+#endif
 
 
 /* Private Constants ------------------------------------------------------------*/
@@ -44,6 +47,120 @@
 #define SHT1x_CMD_WriteStatusRegister 0x06
 #define SHT1x_CMD_SoftReset           0x1E
 
+/**
+ * @brief  Conversion time (datasheet): at most 20/80/320 ms for 8/12/14 bit, up
+ *         to 30% shorter depending on the internal oscillator. The timeout
+ *         allows 25% over the maximum.
+ */
+#define SHT1X_CONV_MIN_PERCENT        70
+#define SHT1X_CONV_TIMEOUT_PERCENT    125
+#define SHT1X_CONV_POLL_STEPS         64
+
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Waveform sizes (steps): start sequence, byte written with its ACK
+ *         clock and the release check, byte read with its ACK/NACK clock
+ */
+#define SHT1X_WAVE_START_STEPS        6
+#define SHT1X_WAVE_WRITE_STEPS        19
+#define SHT1X_WAVE_READ_STEPS         19
+#define SHT1X_WAVE_CMD_STEPS          (SHT1X_WAVE_START_STEPS + SHT1X_WAVE_WRITE_STEPS)
+#define SHT1X_WAVE_CRC_BYTES          (SHT1X_CONFIG_CRC_CHECK ? 1 : 0)
+#define SHT1X_WAVE_SAMPLE_BYTES       4
+#endif
+
+
+/**
+ * @brief  Streaming states
+ */
+#define SHT1X_STREAM_STOPPED          0
+#define SHT1X_STREAM_CONVERTING       1
+#define SHT1X_STREAM_DELIVERING       2
+#define SHT1X_STREAM_STOPPING         3
+
+
+/* Private Macros ---------------------------------------------------------------*/
+#if (SHT1X_CONFIG_STATIC_PORT)
+  #define SHT1X_PORT_DATA_CONFIG_DIR(Dir)     ((void)Handler, SHT1x_Port_DataConfigDir(Dir))
+  #define SHT1X_PORT_DATA_WRITE(Level)        ((void)Handler, SHT1x_Port_DataWrite(Level))
+  #define SHT1X_PORT_DATA_READ()              ((void)Handler, SHT1x_Port_DataRead())
+  #define SHT1X_PORT_SCK_WRITE(Level)         ((void)Handler, SHT1x_Port_SckWrite(Level))
+  #define SHT1X_PORT_DELAY_MS(Delay)          ((void)Handler, SHT1x_Port_DelayMs(Delay))
+  #define SHT1X_PORT_DELAY_US(Delay)          ((void)Handler, SHT1x_Port_DelayUs(Delay))
+  #define SHT1X_PORT_PLATFORM_INIT()          ((void)Handler, SHT1x_Port_PlatformInit())
+  #define SHT1X_PORT_PLATFORM_DEINIT()        ((void)Handler, SHT1x_Port_PlatformDeInit())
+  #if defined(SHT1X_PORT_HAS_WAIT_DATA_LOW)
+  #define SHT1X_PORT_HAS_WAIT()               ((void)Handler, 1)
+  #define SHT1X_PORT_WAIT_DATA_LOW(Timeout)   SHT1x_Port_WaitDataLow(Timeout)
+  #else
+  #define SHT1X_PORT_HAS_WAIT()               ((void)Handler, 0)
+  #define SHT1X_PORT_WAIT_DATA_LOW(Timeout)   ((void)(Timeout), 0)
+  #endif
+  #if defined(SHT1X_PORT_HAS_EMIT_WAVEFORM)
+  #define SHT1X_PORT_HAS_EMIT()               ((void)Handler, 1)
+  #define SHT1X_PORT_EMIT_WAVEFORM(St, N, Sa) ((void)Handler, SHT1x_Port_EmitWaveform(St, N, Sa))
+  #else
+  #define SHT1X_PORT_HAS_EMIT()               ((void)Handler, 0)
+  #define SHT1X_PORT_EMIT_WAVEFORM(St, N, Sa) ((void)Handler, (void)(St), (void)(N), (void)(Sa))
+  #endif
+#else
+  #define SHT1X_PORT_DATA_CONFIG_DIR(Dir)     Handler->DataConfigDir(Dir)
+  #define SHT1X_PORT_DATA_WRITE(Level)        Handler->DataWrite(Level)
+  #define SHT1X_PORT_DATA_READ()              Handler->DataRead()
+  #define SHT1X_PORT_SCK_WRITE(Level)         Handler->SckWrite(Level)
+  #define SHT1X_PORT_DELAY_MS(Delay)          Handler->DelayMs(Delay)
+  #define SHT1X_PORT_DELAY_US(Delay)          Handler->DelayUs(Delay)
+  #define SHT1X_PORT_PLATFORM_INIT()          \
+    do { if (Handler->PlatformInit) Handler->PlatformInit(); } while (0)
+  #define SHT1X_PORT_PLATFORM_DEINIT()        \
+    do { if (Handler->PlatformDeInit) Handler->PlatformDeInit(); } while (0)
+  #define SHT1X_PORT_HAS_WAIT()               (Handler->WaitDataLow != 0)
+  #define SHT1X_PORT_WAIT_DATA_LOW(Timeout)   Handler->WaitDataLow(Timeout)
+  #define SHT1X_PORT_HAS_EMIT()               (Handler->EmitWaveform != 0)
+  #define SHT1X_PORT_EMIT_WAVEFORM(St, N, Sa) Handler->EmitWaveform(St, N, Sa)
+#endif
+
+// DATA direction writes of the driver, the last one is kept in the handler
+#define SHT1X_DATA_CONFIG_DIR(Dir)            \
+  do { Handler->DataOutput = (Dir); SHT1X_PORT_DATA_CONFIG_DIR(Dir); } while (0)
+
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+  #define SHT1X_INSTR_TIME(Var)               const uint32_t Var = Handler->GetTime()
+  #define SHT1X_INSTR_PHASE(Ph, From, To)     \
+    SHT1x_RecordLatency(&Handler->Stats.Phase[Ph], (uint32_t)((To) - (From)))
+  #define SHT1X_INSTR_COUNT(Counter)          (Handler->Stats.Counter++)
+#else
+  #define SHT1X_INSTR_TIME(Var)
+  #define SHT1X_INSTR_PHASE(Ph, From, To)
+  #define SHT1X_INSTR_COUNT(Counter)
+#endif
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+  #define SHT1X_STAMP(Field)                  ((Field) = Handler->GetTime())
+#else
+  #define SHT1X_STAMP(Field)
+#endif
+
+#if (SHT1X_CONFIG_BUS_TUNING)
+  // bus delays are given for the fixed 4 us half period and scaled
+  #define SHT1X_BUS_DELAY_US(Delay)           SHT1x_BusDelay(Handler, Delay)
+  #define SHT1X_BUS_SETTLE()                  SHT1x_BusSettle(Handler)
+  #define SHT1X_BUS_WAIT_TV()                 SHT1x_BusSettle(Handler)
+  #define SHT1X_BUS_RESYNC()                  SHT1x_BusResync(Handler)
+  #define SHT1X_BUS_RESULT(Clean)             SHT1x_BusResult(Handler, Clean)
+  #define SHT1X_BUS_CHECK_RESULT(Raw)         SHT1x_BusCheckResult(Handler, Raw)
+  #define SHT1X_BUS_LEVEL()                   (Handler->BusLevel)
+#else
+  #define SHT1X_BUS_DELAY_US(Delay)           SHT1X_PORT_DELAY_US(Delay)
+  #define SHT1X_BUS_SETTLE()
+  #define SHT1X_BUS_WAIT_TV()                 SHT1X_PORT_DELAY_US(1)
+  #define SHT1X_BUS_RESYNC()
+  #define SHT1X_BUS_RESULT(Clean)
+  #define SHT1X_BUS_CHECK_RESULT(Raw)         SHT1x_OK
+  #define SHT1X_BUS_LEVEL()                   0
+#endif
+
 
 
 /**
@@ -52,6 +169,287 @@
  ==================================================================================
  */
 
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+static void
+SHT1x_RecordLatency(SHT1x_Latency_t *Latency, uint32_t Time)
+{
+  if (Time < Latency->Min)
+    Latency->Min = Time;
+  if (Time > Latency->Max)
+    Latency->Max = Time;
+  Latency->Count++;
+  Latency->Sum += Time;
+}
+
+static void
+SHT1x_ClearStats(SHT1x_Stats_t *Stats)
+{
+  static const SHT1x_Stats_t Empty = {0};
+
+  *Stats = Empty;
+  for (uint8_t i = 0; i < SHT1x_PhaseCount; i++)
+    Stats->Phase[i].Min = UINT32_MAX;
+}
+#endif
+
+#if (SHT1X_CONFIG_BUS_TUNING)
+static const uint8_t SHT1x_BusHalfUs[SHT1X_BUS_LEVELS] =
+{
+  1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64
+};
+
+static inline void
+SHT1x_BusDelay(SHT1x_Handler_t *Handler, uint8_t Delay)
+{
+  SHT1X_PORT_DELAY_US((uint8_t)(((uint16_t)Delay * Handler->BusHalfUs + 3) >> 2));
+}
+
+// the sensor output (tV) grows with the line capacitance like the shortest
+// safe half period, so it is waited for one half period
+static inline void
+SHT1x_BusSettle(SHT1x_Handler_t *Handler)
+{
+  SHT1X_PORT_DELAY_US(Handler->BusHalfUs);
+}
+
+static void
+SHT1x_BusSetLevel(SHT1x_Handler_t *Handler, uint8_t Level)
+{
+  Handler->BusLevel = Level;
+  Handler->BusHalfUs = SHT1x_BusHalfUs[Level];
+  Handler->BusClean = 0;
+  Handler->BusTrial = 0;
+}
+
+static uint8_t
+SHT1x_BusCheckByte(const SHT1x_BusTuning_t *Tuning)
+{
+  return (uint8_t)~(Tuning->Level + (Tuning->Hold & 0xFF) + (Tuning->Hold >> 8));
+}
+
+// after a misread the sensor may still hold a result or wait for clocks of a
+// command. Its first byte is clocked out without ACK, then DATA stays high for
+// nine clocks, which resets the connection.
+static void
+SHT1x_BusResync(SHT1x_Handler_t *Handler)
+{
+  if (!Handler->BusResync)
+    return;
+  Handler->BusResync = 0;
+
+  SHT1X_DATA_CONFIG_DIR(0);
+  for (uint8_t counter = 0; counter < 18; counter++)
+  {
+    SHT1X_PORT_SCK_WRITE(1);
+    SHT1X_BUS_DELAY_US(4);
+    SHT1X_PORT_SCK_WRITE(0);
+    SHT1X_BUS_DELAY_US(4);
+  }
+  SHT1X_DATA_CONFIG_DIR(1);
+}
+
+// one step slower on an error, one step faster after a hold of clean
+// transfers. A level that fails right after a speed-up is tried again only
+// after twice the hold, one that passes halves it.
+static void
+SHT1x_BusResult(SHT1x_Handler_t *Handler, uint8_t Clean)
+{
+  if (!Clean)
+  {
+    Handler->BusErrors++;
+    Handler->BusResync = 1;
+    if (Handler->BusTrial && Handler->BusHold <= SHT1X_BUS_HOLD_MAX / 2)
+      Handler->BusHold *= 2;
+    SHT1x_BusSetLevel(Handler, (Handler->BusLevel < SHT1X_BUS_LEVELS - 1) ?
+                               Handler->BusLevel + 1 : Handler->BusLevel);
+    return;
+  }
+
+  if (++Handler->BusClean < Handler->BusHold)
+    return;
+
+  Handler->BusClean = 0;
+  if (Handler->BusTrial)
+  {
+    Handler->BusTrial = 0;
+    if (Handler->BusHold >= 2 * SHT1X_BUS_HOLD)
+      Handler->BusHold /= 2;
+  }
+  if (Handler->BusLevel > SHT1X_BUS_FASTEST)
+  {
+    SHT1x_BusSetLevel(Handler, Handler->BusLevel - 1);
+    Handler->BusTrial = 1;
+  }
+}
+
+// a result wider than the resolution of the last measurement is a misread
+static SHT1x_Result_t
+SHT1x_BusCheckResult(SHT1x_Handler_t *Handler, uint16_t Raw)
+{
+  const uint8_t High = (Handler->ResolutionStatus == SHT1x_HighResolution) ? 1 : 0;
+  uint8_t Bits;
+
+  if (Handler->Command == SHT1x_CMD_MeasureTemperature)
+    Bits = High ? 14 : 12;
+  else if (Handler->Command == SHT1x_CMD_MeasureHumidity)
+    Bits = High ? 12 : 8;
+  else
+    Bits = 16;
+
+  SHT1x_BusResult(Handler, (Raw >> Bits) ? 0 : 1);
+  return (Raw >> Bits) ? SHT1x_FAIL : SHT1x_OK;
+}
+#endif
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Waveforms of the fixed transactions, the same for every handler.
+ *         The readouts end with a NACK, after the CRC if it is checked.
+ */
+static struct
+{
+  SHT1x_WaveStep_t MeasureTemperature[SHT1X_WAVE_CMD_STEPS];
+  SHT1x_WaveStep_t MeasureHumidity[SHT1X_WAVE_CMD_STEPS];
+  SHT1x_WaveStep_t Readout[(2 + SHT1X_WAVE_CRC_BYTES) * SHT1X_WAVE_READ_STEPS];
+  SHT1x_WaveStep_t ReadStatus[SHT1X_WAVE_CMD_STEPS +
+                              (1 + SHT1X_WAVE_CRC_BYTES) * SHT1X_WAVE_READ_STEPS];
+  uint8_t Compiled;
+} SHT1x_Wave;
+
+static inline SHT1x_WaveStep_t *
+SHT1x_WaveStep(SHT1x_WaveStep_t *Step, uint8_t Pins, uint8_t DelayUs)
+{
+  Step->Pins = Pins;
+  Step->DelayUs = DelayUs;
+  return Step + 1;
+}
+
+// same levels and delays as SHT1x_Start
+static SHT1x_WaveStep_t *
+SHT1x_WaveStart(SHT1x_WaveStep_t *Step)
+{
+  Step = SHT1x_WaveStep(Step, SHT1X_WAVE_DATA, 2);
+  Step = SHT1x_WaveStep(Step, SHT1X_WAVE_DATA | SHT1X_WAVE_SCK, 2);
+  Step = SHT1x_WaveStep(Step, SHT1X_WAVE_SCK, 2);
+  Step = SHT1x_WaveStep(Step, 0, 8);
+  Step = SHT1x_WaveStep(Step, SHT1X_WAVE_SCK, 2);
+  return SHT1x_WaveStep(Step, SHT1X_WAVE_DATA | SHT1X_WAVE_SCK, 2);
+}
+
+// 8 bits, ACK of the sensor (sample 0) and DATA released after it (sample 1)
+static SHT1x_WaveStep_t *
+SHT1x_WaveWrite(SHT1x_WaveStep_t *Step, uint8_t Byte)
+{
+  for (uint8_t counter = 0; counter < 8; counter++, Byte <<= 1)
+  {
+    const uint8_t Data = (Byte & 0x80) ? SHT1X_WAVE_DATA : 0;
+
+    Step = SHT1x_WaveStep(Step, Data, 4);
+    Step = SHT1x_WaveStep(Step, Data | SHT1X_WAVE_SCK, 4);
+  }
+
+  Step = SHT1x_WaveStep(Step, SHT1X_WAVE_RELEASE | SHT1X_WAVE_SAMPLE, 4);
+  Step = SHT1x_WaveStep(Step, SHT1X_WAVE_RELEASE | SHT1X_WAVE_SCK, 4);
+  return SHT1x_WaveStep(Step, SHT1X_WAVE_RELEASE | SHT1X_WAVE_SAMPLE, 1);
+}
+
+// 8 sampled bits, then an ACK (DATA released again) or a NACK (bus idle)
+static SHT1x_WaveStep_t *
+SHT1x_WaveRead(SHT1x_WaveStep_t *Step, uint8_t Ack)
+{
+  const uint8_t Data = Ack ? 0 : SHT1X_WAVE_DATA;
+
+  for (uint8_t counter = 0; counter < 8; counter++)
+  {
+    Step = SHT1x_WaveStep(Step, SHT1X_WAVE_RELEASE | SHT1X_WAVE_SCK |
+                                SHT1X_WAVE_SAMPLE, 4);
+    Step = SHT1x_WaveStep(Step, SHT1X_WAVE_RELEASE, 4);
+  }
+
+  Step = SHT1x_WaveStep(Step, Data, 4);
+  Step = SHT1x_WaveStep(Step, Data | SHT1X_WAVE_SCK, 4);
+  return SHT1x_WaveStep(Step, Ack ? SHT1X_WAVE_RELEASE : SHT1X_WAVE_DATA,
+                        Ack ? 4 : 0);
+}
+
+static void
+SHT1x_WaveCompileAll(void)
+{
+  SHT1x_WaveStep_t *Step;
+
+  SHT1x_WaveWrite(SHT1x_WaveStart(SHT1x_Wave.MeasureTemperature),
+                  SHT1x_CMD_MeasureTemperature);
+  SHT1x_WaveWrite(SHT1x_WaveStart(SHT1x_Wave.MeasureHumidity),
+                  SHT1x_CMD_MeasureHumidity);
+
+  Step = SHT1x_WaveRead(SHT1x_Wave.Readout, 1);
+  Step = SHT1x_WaveRead(Step, SHT1X_WAVE_CRC_BYTES);
+#if (SHT1X_CONFIG_CRC_CHECK)
+  SHT1x_WaveRead(Step, 0);
+#endif
+
+  Step = SHT1x_WaveWrite(SHT1x_WaveStart(SHT1x_Wave.ReadStatus),
+                         SHT1x_CMD_ReadStatusRegister);
+  Step = SHT1x_WaveRead(Step, SHT1X_WAVE_CRC_BYTES);
+#if (SHT1X_CONFIG_CRC_CHECK)
+  SHT1x_WaveRead(Step, 0);
+#endif
+
+  SHT1x_Wave.Compiled = 1;
+}
+
+static inline void
+SHT1x_WaveCompile(void)
+{
+  if (!SHT1x_Wave.Compiled)
+    SHT1x_WaveCompileAll();
+}
+
+// 8 samples from bit Index on
+static inline uint8_t
+SHT1x_WaveByte(const uint8_t *Samples, uint8_t Index)
+{
+  const uint16_t Bits = ((uint16_t)Samples[Index >> 3] << 8) | Samples[(Index >> 3) + 1];
+
+  return (uint8_t)(Bits >> (8 - (Index & 7)));
+}
+
+// play a waveform in one call of the port, the fixed ones are compiled on
+// first use
+static inline void
+SHT1x_WaveEmit(SHT1x_Handler_t *Handler, const SHT1x_WaveStep_t *Steps,
+               uint8_t Count, uint8_t *Samples)
+{
+  SHT1x_WaveCompile();
+
+  for (uint8_t i = 0; i < SHT1X_WAVE_SAMPLE_BYTES; i++)
+    Samples[i] = 0;
+
+  Handler->DataOutput = 0;
+  SHT1X_PORT_EMIT_WAVEFORM(Steps, Count, Samples);
+}
+
+// check the ACK of the command (sample 0) and, for measurements, that the
+// conversion started (sample 1)
+static SHT1x_Result_t
+SHT1x_WaveCheckCmd(SHT1x_Handler_t *Handler, const uint8_t *Samples,
+                   uint8_t Measure)
+{
+  (void)Handler;
+
+  if (Samples[0] & 0x80)
+  {
+    SHT1X_INSTR_COUNT(Nacks);
+    return SHT1x_FAIL;
+  }
+
+  if (Measure && !(Samples[0] & 0x40))
+    return SHT1x_FAIL;
+
+  return SHT1x_OK;
+}
+#endif
+
 static inline void
 SHT1x_Start(SHT1x_Handler_t *Handler)
 {
@@ -64,38 +462,38 @@ SHT1x_Start(SHT1x_Handler_t *Handler)
    * DATA   |_____|
    */
 
-  Handler->DataWrite(1);
-  Handler->DelayUs(2);
+  SHT1X_PORT_DATA_WRITE(1);
+  SHT1X_BUS_DELAY_US(2);
 
-  Handler->SckWrite(1);
-  Handler->DelayUs(2);
+  SHT1X_PORT_SCK_WRITE(1);
+  SHT1X_BUS_DELAY_US(2);
 
-  Handler->DataWrite(0);
-  Handler->DelayUs(2);
+  SHT1X_PORT_DATA_WRITE(0);
+  SHT1X_BUS_DELAY_US(2);
 
-  Handler->SckWrite(0);
-  Handler->DelayUs(8);
+  SHT1X_PORT_SCK_WRITE(0);
+  SHT1X_BUS_DELAY_US(8);
 
-  Handler->SckWrite(1);
-  Handler->DelayUs(2);
+  SHT1X_PORT_SCK_WRITE(1);
+  SHT1X_BUS_DELAY_US(2);
 
-  Handler->DataWrite(1);
-  Handler->DelayUs(2);
+  SHT1X_PORT_DATA_WRITE(1);
+  SHT1X_BUS_DELAY_US(2);
 
-  Handler->SckWrite(0);
+  SHT1X_PORT_SCK_WRITE(0);
 }
 
 static inline void
 SHT1x_SendACK(SHT1x_Handler_t *Handler)
 {
-  Handler->DataConfigDir(1);
-
-  Handler->DataWrite(0);
-  Handler->DelayUs(4);
-  Handler->SckWrite(1);
-  Handler->DelayUs(4);
-  Handler->SckWrite(0);
-  Handler->DelayUs(4);
+  SHT1X_DATA_CONFIG_DIR(1);
+
+  SHT1X_PORT_DATA_WRITE(0);
+  SHT1X_BUS_DELAY_US(4);
+  SHT1X_PORT_SCK_WRITE(1);
+  SHT1X_BUS_DELAY_US(4);
+  SHT1X_PORT_SCK_WRITE(0);
+  SHT1X_BUS_DELAY_US(4);
 }
 
 static inline void
@@ -105,11 +503,11 @@ SHT1x_SiftIn(SHT1x_Handler_t *Handler, uint8_t *Data)
 
   for (int8_t counter = 7; counter >= 0; --counter)
   {
-    Handler->SckWrite(1);
-    Handler->DelayUs(4);
-    DataBuff |= (Handler->DataRead() << counter);
-    Handler->SckWrite(0);
-    Handler->DelayUs(4);
+    SHT1X_PORT_SCK_WRITE(1);
+    SHT1X_BUS_DELAY_US(4);
+    DataBuff |= (SHT1X_PORT_DATA_READ() << counter);
+    SHT1X_PORT_SCK_WRITE(0);
+    SHT1X_BUS_DELAY_US(4);
   }
 
   *Data = DataBuff;
@@ -122,8 +520,7 @@ SHT1x_shiftDataIn(SHT1x_Handler_t *Handler, uint16_t *Data)
   uint16_t val1 = 0;
   uint8_t read1 = 0;
 
-  Handler->DataConfigDir(0);
-
+  // DATA is an input since the ACK of the command
   SHT1x_SiftIn(Handler, &read1); // read MSB byte
 
   val1 = (read1 << 8); //read1*256;
@@ -131,7 +528,7 @@ SHT1x_shiftDataIn(SHT1x_Handler_t *Handler, uint16_t *Data)
   //Send acknowledgment to sensor that MSB byte is read
   SHT1x_SendACK(Handler);
 
-  Handler->DataConfigDir(0);
+  SHT1X_DATA_CONFIG_DIR(0);
 
   //read LSB byte of from the sensor
   SHT1x_SiftIn(Handler, &read1);
@@ -141,11 +538,27 @@ SHT1x_shiftDataIn(SHT1x_Handler_t *Handler, uint16_t *Data)
   *Data = val1;
 }
 
-//Send the command to read temp or humidity to micro controller
+//Send a command with DATA already configured as output
 static SHT1x_Result_t
-SHT1x_SendCmd(SHT1x_Handler_t *Handler, uint8_t CMD)
+SHT1x_WriteCmd(SHT1x_Handler_t *Handler, uint8_t CMD)
 {
-  Handler->DataConfigDir(1);
+#if (SHT1X_CONFIG_CRC_CHECK)
+  Handler->Command = CMD;
+#endif
+
+#if (SHT1X_CONFIG_WAVEFORM)
+  if (SHT1X_PORT_HAS_EMIT())
+  {
+    SHT1x_WaveStep_t Steps[SHT1X_WAVE_CMD_STEPS];
+    uint8_t Samples[SHT1X_WAVE_SAMPLE_BYTES];
+
+    SHT1x_WaveWrite(SHT1x_WaveStart(Steps), CMD);
+    SHT1x_WaveEmit(Handler, Steps, SHT1X_WAVE_CMD_STEPS, Samples);
+    return SHT1x_WaveCheckCmd(Handler, Samples, 0);
+  }
+#endif
+
+  SHT1X_BUS_RESYNC();
 
   //Initiate the start signal to sensor
   SHT1x_Start(Handler);
@@ -154,311 +567,1086 @@ SHT1x_SendCmd(SHT1x_Handler_t *Handler, uint8_t CMD)
   for (uint8_t counter = 0; counter < 8; counter++, CMD <<= 1)
   {
     if (CMD & 0x80)
-      Handler->DataWrite(1);
+      SHT1X_PORT_DATA_WRITE(1);
     else
-      Handler->DataWrite(0);
+      SHT1X_PORT_DATA_WRITE(0);
 
-    Handler->DelayUs(4);
-    Handler->SckWrite(1);
+    SHT1X_BUS_DELAY_US(4);
+    SHT1X_PORT_SCK_WRITE(1);
 
-    Handler->DelayUs(4);
-    Handler->SckWrite(0);
+    SHT1X_BUS_DELAY_US(4);
+    SHT1X_PORT_SCK_WRITE(0);
   }
 
-  Handler->DataConfigDir(0);
+  SHT1X_DATA_CONFIG_DIR(0);
+  SHT1X_BUS_SETTLE();
 
   //Check acknowledgments if the sensor has ack the cmd
-  if (Handler->DataRead())
+  if (SHT1X_PORT_DATA_READ())
+  {
+    SHT1X_INSTR_COUNT(Nacks);
+    SHT1X_BUS_RESULT(0);
     return SHT1x_FAIL;
+  }
 
-  Handler->DelayUs(4);
-  Handler->SckWrite(1);
-  Handler->DelayUs(4);
-  Handler->SckWrite(0);
+  SHT1X_BUS_DELAY_US(4);
+  SHT1X_PORT_SCK_WRITE(1);
+  SHT1X_BUS_DELAY_US(4);
+  SHT1X_PORT_SCK_WRITE(0);
 
+  SHT1X_BUS_RESULT(1);
   return SHT1x_OK;
 }
 
-// pooling for the sensor to complete measuring data
+//Configure DATA as output before a command, waveforms drive it themselves.
+//After a NACK DATA is an output already.
+static inline void
+SHT1x_ClaimData(SHT1x_Handler_t *Handler)
+{
+#if (SHT1X_CONFIG_WAVEFORM)
+  if (SHT1X_PORT_HAS_EMIT())
+    return;
+#endif
+
+  if (!Handler->DataOutput)
+    SHT1X_DATA_CONFIG_DIR(1);
+}
+
+//Send the command to read temp or humidity to micro controller
 static SHT1x_Result_t
-SHT1x_WaitForResult(SHT1x_Handler_t *Handler)
+SHT1x_SendCmd(SHT1x_Handler_t *Handler, uint8_t CMD)
 {
+  SHT1x_ClaimData(Handler);
+
+  return SHT1x_WriteCmd(Handler, CMD);
+}
+
+//Send a measurement command with DATA already configured as output and check
+//that the conversion started
+static SHT1x_Result_t
+SHT1x_WriteMeasureCmd(SHT1x_Handler_t *Handler, SHT1x_Measurement_t Measurement)
+{
+  const uint8_t CMD = (Measurement == SHT1x_MeasureHumidity) ?
+                      SHT1x_CMD_MeasureHumidity : SHT1x_CMD_MeasureTemperature;
+
+#if (SHT1X_CONFIG_WAVEFORM)
+  if (SHT1X_PORT_HAS_EMIT())
+  {
+    uint8_t Samples[SHT1X_WAVE_SAMPLE_BYTES];
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+    Handler->Command = CMD;
+#endif
+    SHT1x_WaveEmit(Handler, (Measurement == SHT1x_MeasureHumidity) ?
+                   SHT1x_Wave.MeasureHumidity : SHT1x_Wave.MeasureTemperature,
+                   SHT1X_WAVE_CMD_STEPS, Samples);
+    return SHT1x_WaveCheckCmd(Handler, Samples, 1);
+  }
+#endif
+
+  if (SHT1x_WriteCmd(Handler, CMD) != SHT1x_OK)
+    return SHT1x_FAIL;
+
+  //check if sensor has started measuring data after ack (DATA is released
+  //within tV of the falling edge)
+  SHT1X_BUS_WAIT_TV();
+  if (!SHT1X_PORT_DATA_READ())
+  {
+    SHT1X_BUS_RESULT(0);
+    return SHT1x_FAIL;
+  }
+
+  return SHT1x_OK;
+}
+
+// wait for the sensor to complete measuring data: sleep on the DATA edge if
+// the port can, otherwise sleep until the earliest possible end of conversion
+// and then poll in 1/64 of the maximum time
+static SHT1x_Result_t
+SHT1x_WaitForResult(SHT1x_Handler_t *Handler, SHT1x_Measurement_t Measurement)
+{
+  uint16_t MinMs, MaxMs, Step, Timeout;
+  uint16_t Elapsed;
   uint8_t ack = 0;
 
-  Handler->DataConfigDir(0);
+  SHT1x_GetConversionTime(Handler, Measurement, &MinMs, &MaxMs);
+  Step = (MaxMs >= SHT1X_CONV_POLL_STEPS) ? (MaxMs / SHT1X_CONV_POLL_STEPS) : 1;
+  Timeout = (uint16_t)((uint32_t)MaxMs * SHT1X_CONV_TIMEOUT_PERCENT / 100);
 
-  for (uint16_t counter = 0; counter < 50; counter++)
+  if (SHT1X_PORT_HAS_WAIT())
   {
-    ack = Handler->DataRead();
+    SHT1X_INSTR_COUNT(EdgeWaits);
+    if (SHT1X_PORT_WAIT_DATA_LOW(Timeout))
+      return SHT1x_OK;
+
+    SHT1X_INSTR_COUNT(Timeouts);
+    return SHT1x_TIME_OUT;
+  }
+
+  SHT1x_Sleep(Handler, MinMs);
+
+  for (Elapsed = MinMs; ; Elapsed += Step)
+  {
+    SHT1X_INSTR_COUNT(PollIterations);
+    ack = SHT1X_PORT_DATA_READ();
     if (!ack)
       return SHT1x_OK;
 
-    Handler->DelayMs(10);
+    if (Elapsed >= Timeout)
+      break;
+
+    SHT1X_PORT_DELAY_MS((uint8_t)Step);
   }
 
+  SHT1X_INSTR_COUNT(Timeouts);
   return SHT1x_TIME_OUT;
 }
 
-//Skip the CRC
+//End the transmission: DATA is left high as output and SCK low (bus idle)
+static inline void
+SHT1x_SendNACK(SHT1x_Handler_t *Handler)
+{
+  SHT1X_DATA_CONFIG_DIR(1);
+
+  SHT1X_PORT_DATA_WRITE(1);
+  SHT1X_BUS_DELAY_US(4);
+  SHT1X_PORT_SCK_WRITE(1);
+  SHT1X_BUS_DELAY_US(4);
+  SHT1X_PORT_SCK_WRITE(0);
+}
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+//Read the CRC after the last data byte, end the transmission and check it
 static SHT1x_Result_t
-SHT1x_CheckCRC(SHT1x_Handler_t *Handler)
+SHT1x_CheckCRC(SHT1x_Handler_t *Handler, const uint8_t *Data, uint8_t Len)
 {
-  Handler->DataConfigDir(1);
-  Handler->DataWrite(1);
+  uint8_t Crc;
+
+  SHT1x_SendACK(Handler);
+  SHT1X_DATA_CONFIG_DIR(0);
+  SHT1x_SiftIn(Handler, &Crc);
+  SHT1x_SendNACK(Handler);
 
-  for (uint8_t counter = 0; counter < 9; counter++)
+  if (Crc != SHT1x_CRC8(Handler->StatusReg, Data, Len))
   {
-    Handler->DelayUs(4);
-    Handler->SckWrite(1);
-    Handler->DelayUs(4);
-    Handler->SckWrite(0);
+    SHT1X_INSTR_COUNT(CrcErrors);
+    SHT1X_BUS_RESULT(0);
+    return SHT1x_FAIL;
   }
 
-  SHT1x_Start(Handler);
+  return SHT1x_OK;
+}
+#endif
+
+//Read a measurement result and end the transmission
+static SHT1x_Result_t
+SHT1x_ReadData(SHT1x_Handler_t *Handler, uint16_t *Data)
+{
+#if (SHT1X_CONFIG_WAVEFORM)
+  if (SHT1X_PORT_HAS_EMIT())
+  {
+    uint8_t Samples[SHT1X_WAVE_SAMPLE_BYTES];
+
+    SHT1x_WaveEmit(Handler, SHT1x_Wave.Readout,
+                   sizeof(SHT1x_Wave.Readout) / sizeof(SHT1x_WaveStep_t), Samples);
+    *Data = ((uint16_t)Samples[0] << 8) | Samples[1];
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+    {
+      const uint8_t Bytes[3] = {Handler->Command, Samples[0], Samples[1]};
+
+      if (Samples[2] != SHT1x_CRC8(Handler->StatusReg, Bytes, 3))
+      {
+        SHT1X_INSTR_COUNT(CrcErrors);
+        return SHT1x_FAIL;
+      }
+    }
+#endif
+
+    return SHT1x_OK;
+  }
+#endif
+
+  SHT1x_shiftDataIn(Handler, Data);
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+  {
+    const uint8_t Bytes[3] = {Handler->Command, (uint8_t)(*Data >> 8), (uint8_t)*Data};
+
+    if (SHT1x_CheckCRC(Handler, Bytes, 3) != SHT1x_OK)
+      return SHT1x_FAIL;
+  }
+#else
+  // without CRC the transmission ends right after the LSB
+  SHT1x_SendNACK(Handler);
+#endif
+
+  return SHT1X_BUS_CHECK_RESULT(*Data);
+}
+
+#if (SHT1X_CONFIG_STREAM)
+//Read the result, start the next measurement and deliver the result
+static SHT1x_Result_t
+SHT1x_StreamService(SHT1x_Handler_t *Handler)
+{
+  SHT1x_StreamBuffer_t *Buffer = (SHT1x_StreamBuffer_t *)Handler->StreamContext;
+  SHT1x_Measurement_t Measurement = (SHT1x_Measurement_t)Handler->StreamMeasurement;
+  uint16_t Raw;
+  uint16_t *Target = &Raw;
+
+  if (!Handler->StreamSink)
+    Target = &Buffer->Raw[Buffer->Count];
+
+  if (SHT1x_ReadData(Handler, Target) != SHT1x_OK)
+  {
+    Handler->StreamState = SHT1X_STREAM_STOPPED;
+    return SHT1x_FAIL;
+  }
+
+  // result of the conversion that was running when the sink stopped streaming
+  if (Handler->StreamState == SHT1X_STREAM_STOPPING)
+  {
+    Handler->StreamState = SHT1X_STREAM_STOPPED;
+    return SHT1x_OK;
+  }
+
+  if (!Handler->StreamSink && ++Buffer->Count >= Buffer->Size)
+  {
+    Handler->StreamState = SHT1X_STREAM_STOPPED;
+    return SHT1x_OK;
+  }
+
+  // the next conversion runs while the sink processes this result
+  if (Handler->StreamMode == SHT1x_StreamAlternate)
+    Handler->StreamMeasurement = (Measurement == SHT1x_MeasureHumidity) ?
+                                 SHT1x_MeasureTemperature : SHT1x_MeasureHumidity;
+
+  if (SHT1x_WriteMeasureCmd(Handler, (SHT1x_Measurement_t)Handler->StreamMeasurement)
+      != SHT1x_OK)
+  {
+    Handler->StreamState = SHT1X_STREAM_STOPPED;
+    return SHT1x_FAIL;
+  }
+
+  if (Handler->StreamSink)
+  {
+    Handler->StreamState = SHT1X_STREAM_DELIVERING;
+    Handler->StreamSink(Handler->StreamContext, Measurement, Raw);
+    // on SHT1x_StreamStop the conversion started above is read out and dropped
+    if (Handler->StreamState == SHT1X_STREAM_DELIVERING)
+      Handler->StreamState = SHT1X_STREAM_CONVERTING;
+  }
 
   return SHT1x_OK;
 }
+#endif
 
+#if (SHT1X_CONFIG_RESOLUTION_CONTROL || SHT1X_CONFIG_INTERNAL_HEATER_CONTROL)
 static SHT1x_Result_t
 SHT1x_ReadStatusRegister(SHT1x_Handler_t *Handler, uint8_t *Reg)
 {
+#if (SHT1X_CONFIG_WAVEFORM)
+  if (SHT1X_PORT_HAS_EMIT())
+  {
+    uint8_t Samples[SHT1X_WAVE_SAMPLE_BYTES];
+
+    SHT1x_WaveEmit(Handler, SHT1x_Wave.ReadStatus,
+                   sizeof(SHT1x_Wave.ReadStatus) / sizeof(SHT1x_WaveStep_t), Samples);
+    if (SHT1x_WaveCheckCmd(Handler, Samples, 0) != SHT1x_OK)
+      return SHT1x_FAIL;
+
+    // samples 0 and 1 belong to the command
+    *Reg = SHT1x_WaveByte(Samples, 2);
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+    {
+      const uint8_t Bytes[2] = {SHT1x_CMD_ReadStatusRegister, *Reg};
+
+      // the register itself seeds the CRC of its readout
+      Handler->StatusReg = *Reg;
+      if (SHT1x_WaveByte(Samples, 10) != SHT1x_CRC8(*Reg, Bytes, 2))
+      {
+        SHT1X_INSTR_COUNT(CrcErrors);
+        return SHT1x_FAIL;
+      }
+    }
+#endif
+
+    return SHT1x_OK;
+  }
+#endif
+
   //Send command to read Status Register
   if (SHT1x_SendCmd(Handler, SHT1x_CMD_ReadStatusRegister) != SHT1x_OK)
     return SHT1x_FAIL;
 
   SHT1x_SiftIn(Handler, Reg);
 
-  SHT1x_CheckCRC(Handler);
+#if (SHT1X_CONFIG_CRC_CHECK)
+  {
+    const uint8_t Bytes[2] = {SHT1x_CMD_ReadStatusRegister, *Reg};
+
+    // the register itself seeds the CRC of its readout
+    Handler->StatusReg = *Reg;
+    return SHT1x_CheckCRC(Handler, Bytes, 2);
+  }
+#else
+  SHT1x_SendNACK(Handler);
 
   return SHT1x_OK;
+#endif
 }
 
 static SHT1x_Result_t
 SHT1x_WriteStatusRegister(SHT1x_Handler_t *Handler, uint8_t Reg)
 {
+#if (SHT1X_CONFIG_CRC_CHECK)
+  const uint8_t Status = Reg;
+#endif
+
+#if (SHT1X_CONFIG_WAVEFORM)
+  if (SHT1X_PORT_HAS_EMIT())
+  {
+    SHT1x_WaveStep_t Steps[SHT1X_WAVE_CMD_STEPS + SHT1X_WAVE_WRITE_STEPS];
+    uint8_t Samples[SHT1X_WAVE_SAMPLE_BYTES];
+
+    SHT1x_WaveWrite(SHT1x_WaveWrite(SHT1x_WaveStart(Steps),
+                                    SHT1x_CMD_WriteStatusRegister), Reg);
+    SHT1x_WaveEmit(Handler, Steps, sizeof(Steps) / sizeof(Steps[0]), Samples);
+    if (SHT1x_WaveCheckCmd(Handler, Samples, 0) != SHT1x_OK)
+      return SHT1x_FAIL;
+
+    // ACK of the register value
+    if (Samples[0] & 0x20)
+    {
+      SHT1X_INSTR_COUNT(Nacks);
+      return SHT1x_FAIL;
+    }
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+    Handler->StatusReg = Status;
+#endif
+
+    return SHT1x_OK;
+  }
+#endif
+
   //Send command to Write Status Register
   if (SHT1x_SendCmd(Handler, SHT1x_CMD_WriteStatusRegister) != SHT1x_OK)
     return SHT1x_FAIL;
 
-  Handler->DataConfigDir(1);
+  SHT1X_DATA_CONFIG_DIR(1);
 
   for (uint8_t counter = 0; counter < 8; counter++, Reg <<= 1)
   {
     if (Reg & 0x80)
-      Handler->DataWrite(1);
+      SHT1X_PORT_DATA_WRITE(1);
     else
-      Handler->DataWrite(0);
+      SHT1X_PORT_DATA_WRITE(0);
 
-    Handler->DelayUs(4);
-    Handler->SckWrite(1);
+    SHT1X_BUS_DELAY_US(4);
+    SHT1X_PORT_SCK_WRITE(1);
 
-    Handler->DelayUs(4);
-    Handler->SckWrite(0);
+    SHT1X_BUS_DELAY_US(4);
+    SHT1X_PORT_SCK_WRITE(0);
   }
 
-  Handler->DataConfigDir(0);
+  SHT1X_DATA_CONFIG_DIR(0);
+  SHT1X_BUS_SETTLE();
 
   //Check acknowledgments if the sensor has ack the cmd
-  if (Handler->DataRead())
+  if (SHT1X_PORT_DATA_READ())
+  {
+    SHT1X_INSTR_COUNT(Nacks);
+    SHT1X_BUS_RESULT(0);
     return SHT1x_FAIL;
+  }
+
+  SHT1X_BUS_DELAY_US(4);
+  SHT1X_PORT_SCK_WRITE(1);
+  SHT1X_BUS_DELAY_US(4);
+  SHT1X_PORT_SCK_WRITE(0);
 
-  Handler->DelayUs(4);
-  Handler->SckWrite(1);
-  Handler->DelayUs(4);
-  Handler->SckWrite(0);
+  //the sensor releases DATA within tV, before the next transfer may drive it
+  SHT1X_BUS_WAIT_TV();
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+  Handler->StatusReg = Status;
+#endif
 
   return SHT1x_OK;
 }
+#endif
 
+// a failed check slows the bus down, the measurement is done once more at the
+// slower level so a failed speed-up does not fail the sample. A command that
+// failed its check may still have started a conversion, which ends first.
 static SHT1x_Result_t
-SHT1x_ReadTemp(SHT1x_Handler_t *Handler, uint16_t *TempRaw)
+SHT1x_Measure(SHT1x_Handler_t *Handler, SHT1x_Measurement_t Measurement,
+              SHT1x_Sample_t *Sample)
 {
-  if (SHT1x_SendCmd(Handler, SHT1x_CMD_MeasureTemperature) != SHT1x_OK)
-    return SHT1x_FAIL;
+  uint16_t *Raw = (Measurement == SHT1x_MeasureHumidity) ?
+                  &Sample->HumRaw : &Sample->TempRaw;
+  uint8_t Level;
 
-  Handler->DataConfigDir(0);
+  for (uint8_t Retry = 0; ; Retry++)
+  {
+    SHT1X_INSTR_TIME(TimeStart);
+
+    Level = SHT1X_BUS_LEVEL();
+    if (SHT1x_StartMeasurement(Handler, Measurement) != SHT1x_OK)
+    {
+      if (Retry || SHT1X_BUS_LEVEL() == Level)
+        return SHT1x_FAIL;
+
+      SHT1x_WaitForResult(Handler, Measurement);
+      continue;
+    }
+
+    SHT1X_INSTR_TIME(TimeCmd);
+    SHT1X_INSTR_PHASE(SHT1x_PhaseCommand, TimeStart, TimeCmd);
+
+    //poll until sensor has finished measuring data
+    if (SHT1x_WaitForResult(Handler, Measurement) != SHT1x_OK)
+      return SHT1x_TIME_OUT;
+
+    SHT1X_INSTR_TIME(TimeReady);
+    SHT1X_INSTR_PHASE(SHT1x_PhaseWait, TimeCmd, TimeReady);
+    SHT1X_STAMP(Sample->ConversionTime);
+
+    //read the data from the Sensor
+    Level = SHT1X_BUS_LEVEL();
+    if (SHT1x_ReadResult(Handler, Raw) == SHT1x_OK)
+    {
+      SHT1X_INSTR_TIME(TimeDone);
+      SHT1X_INSTR_PHASE(SHT1x_PhaseReadout, TimeReady, TimeDone);
+      return SHT1x_OK;
+    }
 
-  //check if sensor has started measuring data after ack
-  if (!Handler->DataRead())
-    return SHT1x_FAIL;
+    if (Retry || SHT1X_BUS_LEVEL() == Level)
+      return SHT1x_FAIL;
+  }
+}
 
-  //wait till sensor finishes reading data
-  if (SHT1x_WaitForResult(Handler) != SHT1x_OK)
-    return SHT1x_TIME_OUT;
+//Temperature coefficient d2 (Celsius) of the resolution
+static float
+SHT1x_TempD2(SHT1x_Resolution_t Resolution)
+{
+  //Temperature constant for sht11 at 12bit or 14bit
+  return (Resolution == SHT1x_LowResolution) ? 0.04 : 0.01;
+}
+
+//Linear humidity coefficient c2 of the resolution
+static float
+SHT1x_HumC2(SHT1x_Resolution_t Resolution)
+{
+  //Humidity constant for 8 bit or 12 bit
+  return (Resolution == SHT1x_LowResolution) ? 0.648 : 0.0405;
+}
+
+static float
+SHT1x_TempConvertRawC(SHT1x_Handler_t *Handler, uint16_t RawTemp)
+{
+  const float D1 = Handler->D1Celsius;
+  const float D2 = SHT1x_TempD2(Handler->ResolutionStatus);
+
+  //calculation for temperature given in data sheet
+  return D1 + (D2 * RawTemp);
+}
+
+#if (SHT1X_CONFIG_FAHRENHEIT_MEASUREMENT)
+/**
+ * @brief  Convert raw temperature to Fahrenheit. 
+ * @param  Handler: Pointer to handler
+ * @param  RawTemp: Raw temperature
+ * @retval Temperature in Fahrenheit
+ */
+static float
+SHT1x_TempConvertRawF(SHT1x_Handler_t *Handler, uint16_t RawTemp)
+{
+  const float D1 = Handler->D1Fahrenheit;
+  float D2 = 0.018;
+
+  switch (Handler->ResolutionStatus)
+  {
+  case SHT1x_LowResolution:
+    //Temperature constant for sht11 at 12bit
+    D2 = 0.072; //for 12 bits
+    break;
+
+  case SHT1x_HighResolution:
+    //Temperature constants for sht11 at 14bit
+    D2 = 0.018; //for 14 bits
+    break;
+  }
+
+  //calculation for temperature given in data sheet
+  return D1 + (D2 * RawTemp);
+}
+#endif
 
-  //read the data from the Sensor
-  SHT1x_shiftDataIn(Handler, TempRaw);
-  SHT1x_CheckCRC(Handler);
+static float
+SHT1x_HumConvertRawP(SHT1x_Handler_t *Handler, uint16_t RawHum, float TempC)
+{
+  float realHumidity;
+
+  const float c1 = -4;
+  const float c2 = SHT1x_HumC2(Handler->ResolutionStatus);
+  float c3 = -0.0000028;
+  const float t1 = 0.01;
+  float t2 = 0.00008;
+
+  switch (Handler->ResolutionStatus)
+  {
+  case SHT1x_LowResolution:
+    //Humidity constants for 8 bit
+    c3 = -0.00072;
+
+    //Temperature constants for 8 bit
+    t2 = 0.00128;
+    break;
+
+  case SHT1x_HighResolution:
+    //Humidity constants for 12 bit
+    c3 = -0.0000028;
+
+    //Temperature constants for 12 bit
+    t2 = 0.00008;
+    break;
+  }
+
+  //convert it into relative humidity for linear compensation
+  realHumidity = c1 + (c2 * RawHum) + (c3 * RawHum * RawHum);
+  // calculate relative humidity with temperature compensation
+  return (TempC - 25.0) * (t1 + (t2 * RawHum)) + realHumidity;
+}
+
+
+
+/**
+ ==================================================================================
+                      ##### Public Measurement Functions #####                     
+ ==================================================================================
+ */
+
+/**
+ * @brief  Readout of Measurement Results
+ * @param  Handler: Pointer to handler
+ * @param  Sample: Pointer to sample structure
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Operation failed.
+ *         - SHT1x_TIME_OUT: Timeout occurred.
+ */
+SHT1x_Result_t
+SHT1x_ReadSample(SHT1x_Handler_t *Handler, SHT1x_Sample_t *Sample)
+{
+  SHT1x_Result_t Result;
+
+  SHT1X_STAMP(Sample->CommandTime);
+
+  //get the sensor reading raw data for humidity
+  Result = SHT1x_Measure(Handler, SHT1x_MeasureHumidity, Sample);
+  if (Result != SHT1x_OK)
+    return Result;
+
+  //get the sensor reading raw data for temperature
+  Result = SHT1x_Measure(Handler, SHT1x_MeasureTemperature, Sample);
+  if (Result != SHT1x_OK)
+    return Result;
+
+  SHT1X_STAMP(Sample->ReadoutTime);
+#if (SHT1X_CONFIG_TIMESTAMPS)
+  SHT1x_RecordHistogram(Handler, Sample);
+#endif
+
+  return SHT1x_ConvertSample(Handler, Sample);
+}
+
+
+/**
+ * @brief  Send a measurement command and return without waiting for the
+ *         conversion. Use SHT1x_IsResultReady and SHT1x_ReadResult to get the
+ *         result, so other work (or other sensors) can be serviced meanwhile.
+ * @param  Handler: Pointer to handler
+ * @param  Measurement: Quantity to measure
+ *         - SHT1x_MeasureTemperature
+ *         - SHT1x_MeasureHumidity
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Conversion started.
+ *         - SHT1x_FAIL: Operation failed.
+ */
+SHT1x_Result_t
+SHT1x_StartMeasurement(SHT1x_Handler_t *Handler, SHT1x_Measurement_t Measurement)
+{
+  SHT1x_ClaimData(Handler);
+
+  return SHT1x_WriteMeasureCmd(Handler, Measurement);
+}
+
+
+/**
+ * @brief  Check the end of the conversion started by SHT1x_StartMeasurement.
+ * @param  Handler: Pointer to handler
+ * @retval 1: Result is ready, 0: Conversion is in progress
+ */
+uint8_t
+SHT1x_IsResultReady(SHT1x_Handler_t *Handler)
+{
+  return SHT1X_PORT_DATA_READ() ? 0 : 1;
+}
+
+
+/**
+ * @brief  Read the result of a finished conversion.
+ * @param  Handler: Pointer to handler
+ * @param  Raw: Pointer to raw temperature or humidity
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: CRC mismatch (SHT1X_CONFIG_CRC_CHECK only). With
+ *                       SHT1X_CONFIG_BUS_TUNING, a misread that made
+ *                       SHT1x_BusHalfPeriod grow is worth one more
+ *                       measurement, SHT1x_ReadSample does so.
+ */
+SHT1x_Result_t
+SHT1x_ReadResult(SHT1x_Handler_t *Handler, uint16_t *Raw)
+{
+  return SHT1x_ReadData(Handler, Raw);
+}
+
+
+/**
+ * @brief  Conversion time of a measurement at the current resolution, from the
+ *         datasheet.
+ * @param  Handler: Pointer to handler
+ * @param  Measurement: Quantity to measure
+ * @param  MinMs: Pointer to earliest end of conversion (ms)
+ * @param  MaxMs: Pointer to latest end of conversion (ms)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_GetConversionTime(SHT1x_Handler_t *Handler, SHT1x_Measurement_t Measurement,
+                        uint16_t *MinMs, uint16_t *MaxMs)
+{
+  uint16_t Max;
+
+  if (Measurement == SHT1x_MeasureTemperature)
+    Max = (Handler->ResolutionStatus == SHT1x_LowResolution) ? 80 : 320;
+  else
+    Max = (Handler->ResolutionStatus == SHT1x_LowResolution) ? 20 : 80;
+
+  *MinMs = (uint16_t)((uint32_t)Max * SHT1X_CONV_MIN_PERCENT / 100);
+  *MaxMs = Max;
 
   return SHT1x_OK;
 }
 
-static SHT1x_Result_t
-SHT1x_ReadHumidity(SHT1x_Handler_t *Handler, uint16_t *HumidityRaw)
+
+/**
+ * @brief  Sleep using the delay function of the handler. Long delays are split
+ *         into several calls of DelayMs.
+ * @param  Handler: Pointer to handler
+ * @param  Ms: Delay (ms)
+ * @retval None
+ */
+void
+SHT1x_Sleep(SHT1x_Handler_t *Handler, uint32_t Ms)
+{
+  for (; Ms > 250; Ms -= 250)
+    SHT1X_PORT_DELAY_MS(250);
+  if (Ms)
+    SHT1X_PORT_DELAY_MS((uint8_t)Ms);
+}
+
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+/**
+ * @brief  CRC-8 (x^8 + x^5 + x^4 + 1) of a transfer as the sensor computes it
+ * @param  Seed: Status register, its lower nibble seeds the CRC
+ * @param  Data: Command and data bytes, in received order
+ * @param  Len: Number of bytes
+ * @retval CRC byte as received from the sensor
+ */
+uint8_t
+SHT1x_CRC8(uint8_t Seed, const uint8_t *Data, uint8_t Len)
 {
-  Handler->DataConfigDir(0);
+  uint8_t Crc = 0;
 
-  // send cmd to read humidity to sensor
-  if (SHT1x_SendCmd(Handler, SHT1x_CMD_MeasureHumidity) != SHT1x_OK)
+  // the lower nibble of the status register seeds the CRC, bit-reversed
+  for (uint8_t i = 0; i < 4; i++)
+    Crc |= ((Seed >> i) & 0x01) << (7 - i);
+
+  for (uint8_t i = 0; i < Len; i++)
+  {
+    Crc ^= Data[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+      Crc = (Crc & 0x80) ? (uint8_t)((Crc << 1) ^ 0x31) : (uint8_t)(Crc << 1);
+  }
+
+  Seed = 0;
+  for (uint8_t i = 0; i < 8; i++)
+    Seed |= ((Crc >> i) & 0x01) << (7 - i);
+
+  return Seed;
+}
+#endif
+
+
+/**
+ * @brief  Convert TempRaw and HumRaw of Sample to physical values, using the
+ *         resolution and supply voltage settings of Handler.
+ * @param  Handler: Pointer to handler
+ * @param  Sample: Pointer to sample structure
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_ConvertSample(SHT1x_Handler_t *Handler, SHT1x_Sample_t *Sample)
+{
+  Sample->TempCelsius = SHT1x_TempConvertRawC(Handler, Sample->TempRaw);
+#if (SHT1X_CONFIG_FAHRENHEIT_MEASUREMENT)
+  Sample->TempFahrenheit = SHT1x_TempConvertRawF(Handler, Sample->TempRaw);
+#endif
+  Sample->HumidityPercent = SHT1x_HumConvertRawP(Handler, Sample->HumRaw,
+                                                 Sample->TempCelsius);
+
+  return SHT1x_OK;
+}
+
+
+
+#if (SHT1X_CONFIG_STREAM)
+/**
+ ==================================================================================
+                       ##### Public Streaming Functions #####                      
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start streaming: issue the first measurement command and return.
+ *         SHT1x_StreamPoll or SHT1x_StreamRun reads each result, issues the
+ *         next command right away and hands the result to Sink.
+ * @param  Handler: Pointer to handler
+ * @param  Sink: Result callback, or NULL to store results in a buffer
+ * @param  Context: Argument of Sink, or pointer to SHT1x_StreamBuffer_t when
+ *         Sink is NULL
+ * @param  Mode: Alternate temperature and humidity or repeat one of them
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Operation failed.
+ */
+SHT1x_Result_t
+SHT1x_StreamStart(SHT1x_Handler_t *Handler, SHT1x_StreamSink_t Sink,
+                  void *Context, SHT1x_StreamMode_t Mode)
+{
+  SHT1x_Measurement_t Measurement = (Mode == SHT1x_StreamTemperature) ?
+                                    SHT1x_MeasureTemperature : SHT1x_MeasureHumidity;
+
+  if (Handler->StreamState != SHT1X_STREAM_STOPPED)
+    return SHT1x_FAIL;
+  if (!Sink && (!Context || ((SHT1x_StreamBuffer_t *)Context)->Count >=
+                            ((SHT1x_StreamBuffer_t *)Context)->Size))
     return SHT1x_FAIL;
 
-  Handler->DataConfigDir(0);
+  Handler->StreamSink = Sink;
+  Handler->StreamContext = Context;
+  Handler->StreamMode = (uint8_t)Mode;
+  Handler->StreamMeasurement = (uint8_t)Measurement;
 
-  //check if sensor has started measuring data after ack
-  if (!Handler->DataRead())
+  if (SHT1x_StartMeasurement(Handler, Measurement) != SHT1x_OK)
     return SHT1x_FAIL;
 
-  //poll until sensor has finished measuring data
-  if (SHT1x_WaitForResult(Handler) != SHT1x_OK)
-    return SHT1x_TIME_OUT;
+  Handler->StreamState = SHT1X_STREAM_CONVERTING;
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Service the stream without blocking. When a result is ready it is
+ *         read, the next command is issued and the result is delivered.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The next command or a CRC check failed. Streaming is
+ *           stopped.
+ */
+SHT1x_Result_t
+SHT1x_StreamPoll(SHT1x_Handler_t *Handler)
+{
+  if (Handler->StreamState != SHT1X_STREAM_CONVERTING &&
+      Handler->StreamState != SHT1X_STREAM_STOPPING)
+    return SHT1x_OK;
+
+  SHT1X_INSTR_COUNT(PollIterations);
+  if (SHT1X_PORT_DATA_READ())
+    return SHT1x_OK;
+
+  return SHT1x_StreamService(Handler);
+}
+
+
+/**
+ * @brief  Service the stream until SHT1x_StreamStop is called from the sink
+ *         or the buffer is full. Waits for conversions like SHT1x_ReadSample.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Streaming stopped.
+ *         - SHT1x_FAIL: A command or a CRC check failed.
+ *         - SHT1x_TIME_OUT: A conversion did not complete.
+ */
+SHT1x_Result_t
+SHT1x_StreamRun(SHT1x_Handler_t *Handler)
+{
+  SHT1x_Result_t Result;
 
-  //read the data from the Sensor
-  SHT1x_shiftDataIn(Handler, HumidityRaw);
-  SHT1x_CheckCRC(Handler);
+  while (Handler->StreamState == SHT1X_STREAM_CONVERTING ||
+         Handler->StreamState == SHT1X_STREAM_STOPPING)
+  {
+    if (SHT1x_WaitForResult(Handler,
+                            (SHT1x_Measurement_t)Handler->StreamMeasurement) != SHT1x_OK)
+    {
+      Handler->StreamState = SHT1X_STREAM_STOPPED;
+      return SHT1x_TIME_OUT;
+    }
+
+    Result = SHT1x_StreamService(Handler);
+    if (Result != SHT1x_OK)
+      return Result;
+  }
 
   return SHT1x_OK;
 }
 
-static float
-SHT1x_TempConvertRawC(SHT1x_Handler_t *Handler, uint16_t RawTemp)
+
+/**
+ * @brief  Stop streaming. From the sink, the conversion in progress is
+ *         discarded by the next SHT1x_StreamPoll or by SHT1x_StreamRun and
+ *         SHT1x_IsStreaming reports 1 until then. From outside, it is waited
+ *         for and discarded before returning.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_TIME_OUT: The conversion in progress did not complete.
+ */
+SHT1x_Result_t
+SHT1x_StreamStop(SHT1x_Handler_t *Handler)
 {
-  const float D1 = Handler->D1Celsius;
-  float D2 = 0.01;
+  uint16_t Raw;
 
-  switch (Handler->ResolutionStatus)
+  switch (Handler->StreamState)
   {
-  case SHT1x_LowResolution:
-    //Temperature constant for sht11 at 12bit
-    D2 = 0.04;
+  case SHT1X_STREAM_DELIVERING:
+    Handler->StreamState = SHT1X_STREAM_STOPPING;
     break;
 
-  case SHT1x_HighResolution:
-    //Temperature constants for sht11 at 14bit
-    D2 = 0.01;
+  case SHT1X_STREAM_CONVERTING:
+  case SHT1X_STREAM_STOPPING:
+    Handler->StreamState = SHT1X_STREAM_STOPPED;
+    if (SHT1x_WaitForResult(Handler,
+                            (SHT1x_Measurement_t)Handler->StreamMeasurement) != SHT1x_OK)
+      return SHT1x_TIME_OUT;
+    SHT1x_ReadData(Handler, &Raw);
+    break;
+
+  default:
     break;
   }
 
-  //calculation for temperature given in data sheet
-  return D1 + (D2 * RawTemp);
+  return SHT1x_OK;
 }
 
-#if (SHT1X_CONFIG_FAHRENHEIT_MEASUREMENT)
+
 /**
- * @brief  Convert raw temperature to Fahrenheit. 
+ * @brief  Check if streaming is active
  * @param  Handler: Pointer to handler
- * @param  RawTemp: Raw temperature
- * @retval Temperature in Fahrenheit
+ * @retval 1: Streaming, 0: Stopped
  */
-static float
-SHT1x_TempConvertRawF(SHT1x_Handler_t *Handler, uint16_t RawTemp)
+uint8_t
+SHT1x_IsStreaming(SHT1x_Handler_t *Handler)
 {
-  uint16_t obtVal;
-  SHT1x_Result_t Result;
-  const float D1 = Handler->D1Fahrenheit;
-  float D2 = 0.018;
+  return (Handler->StreamState != SHT1X_STREAM_STOPPED) ? 1 : 0;
+}
+#endif
 
-  switch (ResolutionStatus)
-  {
-  case SHT1x_LowResolution:
-    //Temperature constant for sht11 at 12bit
-    D2 = 0.072; //for 12 bits
-    break;
 
-  case SHT1x_HighResolution:
-    //Temperature constants for sht11 at 14bit
-    D2 = 0.018; //for 14 bits
-    break;
+
+#if (SHT1X_CONFIG_REPORT)
+/**
+ ==================================================================================
+                  ##### Public Report-by-Exception Functions #####                 
+ ==================================================================================
+ */
+
+/**
+ * @brief  Set the deadbands and the heartbeat interval of report-by-exception.
+ *         The deadbands are converted to raw counts for both resolutions with
+ *         the d2 (temperature) and c2 (humidity) coefficients. The next sample
+ *         is always reported.
+ * @note   c2 is the slope of the humidity curve at its low end. Higher up one
+ *         count is worth less, so there the humidity deadband is narrower
+ *         than HumDeadbandP (about half of it at 100%RH).
+ * @param  Handler: Pointer to handler
+ * @param  TempDeadbandC: Temperature change to report (Celsius, 0: any change)
+ * @param  HumDeadbandP: Humidity change to report (%RH, 0: any change)
+ * @param  HeartbeatMs: Report a sample at least this often (0: never)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: A deadband is negative or too large.
+ */
+SHT1x_Result_t
+SHT1x_ReportConfig(SHT1x_Handler_t *Handler, float TempDeadbandC,
+                   float HumDeadbandP, uint32_t HeartbeatMs)
+{
+  float TempBand, HumBand;
+
+  for (uint8_t Resolution = 0; Resolution < 2; Resolution++)
+  {
+    // a change of exactly the deadband is not reported
+    TempBand = TempDeadbandC / SHT1x_TempD2((SHT1x_Resolution_t)Resolution);
+    HumBand = HumDeadbandP / SHT1x_HumC2((SHT1x_Resolution_t)Resolution);
+    if (!(TempBand >= 0 && TempBand <= 0xFFFF && HumBand >= 0 && HumBand <= 0xFFFF))
+      return SHT1x_FAIL;
+
+    Handler->ReportTempBand[Resolution] = (uint16_t)(TempBand + 0.5f);
+    Handler->ReportHumBand[Resolution] = (uint16_t)(HumBand + 0.5f);
   }
 
-  //calculation for temperature given in data sheet
-  return D1 + (D2 * RawTemp);
+  Handler->ReportHeartbeatMs = HeartbeatMs;
+  Handler->ReportState = 0;
+
+  return SHT1x_OK;
 }
-#endif
 
-static float
-SHT1x_HumConvertRawP(SHT1x_Handler_t *Handler, uint16_t RawHum, float TempC)
-{
-  float realHumidity;
 
-  const float c1 = -4;
-  float c2 = 0.0405;
-  float c3 = -0.0000028;
-  const float t1 = 0.01;
-  float t2 = t2 = 0.00008;
+/**
+ * @brief  Check whether a successful sample must be reported: its raw
+ *         temperature or humidity differs from the last reported sample by
+ *         more than the deadband, the heartbeat interval has expired, or the
+ *         resolution has changed since. A reported sample becomes the new
+ *         reference.
+ * @param  Handler: Pointer to handler
+ * @param  Sample: Pointer to sample of SHT1x_ReadSample
+ * @param  NowMs: Current time (ms, wraps around)
+ * @retval 1: Report the sample, 0: Skip it
+ */
+uint8_t
+SHT1x_ReportCheck(SHT1x_Handler_t *Handler, const SHT1x_Sample_t *Sample,
+                  uint32_t NowMs)
+{
+  const uint8_t Resolution = (uint8_t)Handler->ResolutionStatus;
+  uint16_t TempDiff, HumDiff;
 
-  switch (Handler->ResolutionStatus)
+  if (Handler->ReportState == 1 + Resolution)
   {
-  case SHT1x_LowResolution:
-    //Humidity constants for 8 bit
-    c2 = 0.648;
-    c3 = -0.00072;
+    TempDiff = (Sample->TempRaw > Handler->ReportTempRaw) ?
+               Sample->TempRaw - Handler->ReportTempRaw :
+               Handler->ReportTempRaw - Sample->TempRaw;
+    HumDiff = (Sample->HumRaw > Handler->ReportHumRaw) ?
+              Sample->HumRaw - Handler->ReportHumRaw :
+              Handler->ReportHumRaw - Sample->HumRaw;
+
+    if (TempDiff <= Handler->ReportTempBand[Resolution] &&
+        HumDiff <= Handler->ReportHumBand[Resolution] &&
+        (!Handler->ReportHeartbeatMs ||
+         (uint32_t)(NowMs - Handler->ReportTimeMs) < Handler->ReportHeartbeatMs))
+      return 0;
+  }
 
-    //Temperature constants for 8 bit
-    t2 = 0.00128;
-    break;
+  Handler->ReportTempRaw = Sample->TempRaw;
+  Handler->ReportHumRaw = Sample->HumRaw;
+  Handler->ReportTimeMs = NowMs;
+  Handler->ReportState = 1 + Resolution;
 
-  case SHT1x_HighResolution:
-    //Humidity constants for 12 bit
-    c2 = 0.0405;
-    c3 = -0.0000028;
+  return 1;
+}
 
-    //Temperature constants for 12 bit
-    t2 = 0.00008;
-    break;
-  }
 
-  //convert it into relative humidity for linear compensation
-  realHumidity = c1 + (c2 * RawHum) + (c3 * RawHum * RawHum);
-  // calculate relative humidity with temperature compensation
-  return (TempC - 25.0) * (t1 + (t2 * RawHum)) + realHumidity;
+/**
+ * @brief  Forget the last reported sample, so the next one is reported,
+ *         e.g. after the uplink lost a message.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_ReportReset(SHT1x_Handler_t *Handler)
+{
+  Handler->ReportState = 0;
+
+  return SHT1x_OK;
 }
+#endif
 
 
 
+
+#if (SHT1X_CONFIG_BUS_TUNING)
 /**
  ==================================================================================
-                      ##### Public Measurement Functions #####                     
+                      ##### Public Bus Tuning Functions #####                      
  ==================================================================================
  */
 
 /**
- * @brief  Readout of Measurement Results
+ * @brief  Get the bus speed settings of the handler, to restore them with
+ *         SHT1x_BusTuningSet after a restart. Store them when they differ
+ *         from the stored copy.
  * @param  Handler: Pointer to handler
- * @param  Sample: Pointer to sample structure
+ * @param  Tuning: Pointer to settings
  * @retval SHT1x_Result_t
  *         - SHT1x_OK: Operation was successful.
- *         - SHT1x_FAIL: Operation failed.
- *         - SHT1x_TIME_OUT: Timeout occurred.
  */
 SHT1x_Result_t
-SHT1x_ReadSample(SHT1x_Handler_t *Handler, SHT1x_Sample_t *Sample)
+SHT1x_BusTuningGet(SHT1x_Handler_t *Handler, SHT1x_BusTuning_t *Tuning)
 {
-  uint16_t Buffer;
-  SHT1x_Result_t Result;
+  // a level on trial is not proven yet
+  Tuning->Level = Handler->BusTrial ? Handler->BusLevel + 1 : Handler->BusLevel;
+  Tuning->Hold = Handler->BusHold;
+  Tuning->Check = SHT1x_BusCheckByte(Tuning);
 
-  //get the sensor reading raw data for humidity
-  Result = SHT1x_ReadHumidity(Handler, &Buffer);
-  if (Result != SHT1x_OK)
-    return Result;
-  Sample->HumRaw = Buffer;
+  return SHT1x_OK;
+}
 
-  //get the sensor reading raw data for temperature
-  Result = SHT1x_ReadTemp(Handler, &Buffer);
-  if (Result != SHT1x_OK)
-    return Result;
-  Sample->TempRaw = Buffer;
 
-  Sample->TempCelsius = SHT1x_TempConvertRawC(Handler, Sample->TempRaw);
-#if (SHT1X_CONFIG_FAHRENHEIT_MEASUREMENT)
-  Sample->TempFahrenheit = SHT1x_TempConvertRawF(Handler, Sample->TempRaw);
-#endif
-  Sample->HumidityPercent = SHT1x_HumConvertRawP(Handler, Sample->HumRaw,
-                                                 Sample->TempCelsius);
+/**
+ * @brief  Restore bus speed settings of SHT1x_BusTuningGet, after SHT1x_Init.
+ *         The restored level has to pass its hold again before a faster one
+ *         is tried.
+ * @param  Handler: Pointer to handler
+ * @param  Tuning: Pointer to settings
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The settings are invalid (e.g. erased memory). The
+ *                       handler keeps its settings.
+ */
+SHT1x_Result_t
+SHT1x_BusTuningSet(SHT1x_Handler_t *Handler, const SHT1x_BusTuning_t *Tuning)
+{
+  if (Tuning->Check != SHT1x_BusCheckByte(Tuning) ||
+      Tuning->Level + 1 <= SHT1X_BUS_FASTEST || Tuning->Level >= SHT1X_BUS_LEVELS ||
+      Tuning->Hold < SHT1X_BUS_HOLD || Tuning->Hold > SHT1X_BUS_HOLD_MAX)
+    return SHT1x_FAIL;
+
+  SHT1x_BusSetLevel(Handler, Tuning->Level);
+  Handler->BusHold = Tuning->Hold;
 
   return SHT1x_OK;
 }
 
 
+/**
+ * @brief  Get the SCK half period of the current speed level.
+ * @param  Handler: Pointer to handler
+ * @retval Half period (us)
+ */
+uint8_t
+SHT1x_BusHalfPeriod(SHT1x_Handler_t *Handler)
+{
+  return Handler->BusHalfUs;
+}
+#endif
 
 /**
  ==================================================================================
@@ -475,18 +1663,46 @@ SHT1x_ReadSample(SHT1x_Handler_t *Handler, SHT1x_Sample_t *Sample)
 SHT1x_Result_t
 SHT1x_Init(SHT1x_Handler_t *Handler)
 {
-#if (SHT1x_PowerVoltageValue == 0 || SHT1x_PowerVoltageValue == 2)
+#if (SHT1X_CONFIG_POWER_VOLTAGE_CONTROL == 0 || SHT1X_CONFIG_POWER_VOLTAGE_CONTROL == 2)
   Handler->D1Celsius = -40;
   Handler->D1Fahrenheit = -40;
-#elif (SHT1x_PowerVoltageValue == 1)
+#elif (SHT1X_CONFIG_POWER_VOLTAGE_CONTROL == 1)
   Handler->D1Celsius = -39.63;
   Handler->D1Fahrenheit = -39.31;
 #endif
 
   Handler->ResolutionStatus = SHT1x_HighResolution;
+  Handler->DataOutput = 0;
+
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+  SHT1x_ClearStats(&Handler->Stats);
+#endif
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+  SHT1x_ResetHistogram(Handler);
+#endif
+
+#if (SHT1X_CONFIG_STREAM)
+  Handler->StreamState = SHT1X_STREAM_STOPPED;
+#endif
+
+#if (SHT1X_CONFIG_REPORT)
+  SHT1x_ReportConfig(Handler, 0, 0, 0);
+#endif
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+  Handler->StatusReg = 0;
+#endif
+
+#if (SHT1X_CONFIG_BUS_TUNING)
+  SHT1x_BusSetLevel(Handler, (SHT1X_BUS_FASTEST > SHT1X_BUS_LEVEL_DEFAULT) ?
+                             SHT1X_BUS_FASTEST : SHT1X_BUS_LEVEL_DEFAULT);
+  Handler->BusHold = SHT1X_BUS_HOLD;
+  Handler->BusErrors = 0;
+  Handler->BusResync = 0;
+#endif
 
-  if (Handler->PlatformInit)
-    Handler->PlatformInit();
+  SHT1X_PORT_PLATFORM_INIT();
 
   return SHT1x_OK;
 }
@@ -501,8 +1717,7 @@ SHT1x_Init(SHT1x_Handler_t *Handler)
 SHT1x_Result_t
 SHT1x_DeInit(SHT1x_Handler_t *Handler)
 {
-  if (Handler->PlatformDeInit)
-    Handler->PlatformDeInit();
+  SHT1X_PORT_PLATFORM_DEINIT();
 
   return SHT1x_OK;
 }
@@ -526,7 +1741,11 @@ SHT1x_SoftReset(SHT1x_Handler_t *Handler)
   Handler->ResolutionStatus = SHT1x_HighResolution;
 #endif
 
-  Handler->DelayMs(20);
+#if (SHT1X_CONFIG_CRC_CHECK)
+  Handler->StatusReg = 0;
+#endif
+
+  SHT1X_PORT_DELAY_MS(20);
 
   return SHT1x_OK;
 }
@@ -677,7 +1896,7 @@ SHT1x_GetInternalHeater(SHT1x_Handler_t *Handler, SHT1x_Heater_t *Heater)
 #endif
 
 
-#if (SHT1X_CONFIG_POWER_VOLTAGE_CONTROL)
+#if (SHT1X_CONFIG_POWER_VOLTAGE_CONTROL == 0)
 /**
  * @brief  Set The SHT1x power supply voltage.
  * @param  Handler: Pointer to handler
@@ -700,3 +1919,176 @@ SHT1x_SetPowVoltage(SHT1x_Handler_t *Handler, float Voltage)
   return SHT1x_OK;
 }
 #endif
+
+
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+/**
+ * @brief  Get instrumentation data of the handler.
+ * @param  Handler: Pointer to handler
+ * @param  Stats: Pointer to copy the statistics to
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_GetStats(SHT1x_Handler_t *Handler, SHT1x_Stats_t *Stats)
+{
+  *Stats = Handler->Stats;
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Clear instrumentation data of the handler.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_ResetStats(SHT1x_Handler_t *Handler)
+{
+  SHT1x_ClearStats(&Handler->Stats);
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Get min/max/mean latency of a measurement phase.
+ * @param  Handler: Pointer to handler
+ * @param  Phase: Measurement phase
+ *         - SHT1x_PhaseCommand: Start sequence, command and ACK.
+ *         - SHT1x_PhaseWait: Waiting for the end of conversion.
+ *         - SHT1x_PhaseReadout: Shift-in of the result.
+ * @param  Min: Pointer to minimum latency (units of GetTime)
+ * @param  Max: Pointer to maximum latency (units of GetTime)
+ * @param  Mean: Pointer to mean latency (units of GetTime)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No phase has been recorded yet.
+ */
+SHT1x_Result_t
+SHT1x_GetLatency(SHT1x_Handler_t *Handler, SHT1x_Phase_t Phase,
+                 uint32_t *Min, uint32_t *Max, uint32_t *Mean)
+{
+  const SHT1x_Latency_t *Latency;
+
+  if (Phase >= SHT1x_PhaseCount)
+    return SHT1x_FAIL;
+
+  Latency = &Handler->Stats.Phase[Phase];
+  if (!Latency->Count)
+    return SHT1x_FAIL;
+
+  *Min = Latency->Min;
+  *Max = Latency->Max;
+  *Mean = (uint32_t)(Latency->Sum / Latency->Count);
+
+  return SHT1x_OK;
+}
+#endif
+
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+/**
+ * @brief  Count the command-to-data latency of a sample in the histogram of
+ *         the handler. SHT1x_ReadSample does it; the non-blocking paths call it
+ *         once CommandTime and ReadoutTime of the sample are set.
+ * @param  Handler: Pointer to handler
+ * @param  Sample: Pointer to sample
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_RecordHistogram(SHT1x_Handler_t *Handler, const SHT1x_Sample_t *Sample)
+{
+  unsigned long Time = (unsigned long)(Sample->ReadoutTime - Sample->CommandTime);
+  uint8_t Bucket;
+
+  // unsigned long has at least 32 bits, also where int has 16 (AVR)
+#if defined(__GNUC__)
+  Bucket = Time ? (uint8_t)(8 * sizeof(unsigned long) - __builtin_clzl(Time)) : 0;
+#else
+  for (Bucket = 0; Time; Bucket++)
+    Time >>= 1;
+#endif
+
+  if (Handler->Histogram[Bucket] != UINT32_MAX)
+    Handler->Histogram[Bucket]++;
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Get the command-to-data latency histogram of the handler.
+ * @param  Handler: Pointer to handler
+ * @param  Histogram: Array of SHT1X_HISTOGRAM_BUCKETS counters
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_GetHistogram(SHT1x_Handler_t *Handler, uint32_t *Histogram)
+{
+  for (uint8_t i = 0; i < SHT1X_HISTOGRAM_BUCKETS; i++)
+    Histogram[i] = Handler->Histogram[i];
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Clear the latency histogram of the handler.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_ResetHistogram(SHT1x_Handler_t *Handler)
+{
+  for (uint8_t i = 0; i < SHT1X_HISTOGRAM_BUCKETS; i++)
+    Handler->Histogram[i] = 0;
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Upper bound of the command-to-data latency of a percentage of the
+ *         samples, with the resolution of the histogram.
+ * @param  Handler: Pointer to handler
+ * @param  Percent: 1 ... 100
+ * @param  Latency: Pointer to latency (units of GetTime)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No sample has been recorded yet or invalid Percent.
+ */
+SHT1x_Result_t
+SHT1x_GetLatencyPercentile(SHT1x_Handler_t *Handler, uint8_t Percent,
+                           uint32_t *Latency)
+{
+  uint64_t Total = 0, Count = 0, Target;
+  uint8_t i;
+
+  if (!Percent || Percent > 100)
+    return SHT1x_FAIL;
+
+  for (i = 0; i < SHT1X_HISTOGRAM_BUCKETS; i++)
+    Total += Handler->Histogram[i];
+  if (!Total)
+    return SHT1x_FAIL;
+
+  Target = (Total * Percent + 99) / 100;
+  for (i = 0; i < SHT1X_HISTOGRAM_BUCKETS; i++)
+  {
+    Count += Handler->Histogram[i];
+    if (Count >= Target)
+      break;
+  }
+
+  // bucket i holds latencies below 2^i
+  *Latency = i ? (uint32_t)(((uint64_t)1 << i) - 1) : 0;
+
+  return SHT1x_OK;
+}
+#endif
@@ -0,0 +1,411 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_adapt.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Adaptive sample period of one SHT1x sensor
+ *         Functionalities of the this file:
+ *          + Fixed-point 1-D Kalman filter on the raw temperature and humidity
+ *          + Next sample time from the predicted uncertainty: short periods
+ *            during transients, exponential back-off while steady
+ *          + Filtered estimates between samples without bus access
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "SHT1x_adapt.h"
+#include <stddef.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+/**
+ * @brief  Measurement noise variance of the raw values (counts^2 in Q8): the
+ *         repeatability of the sensor (0.1 C, 0.1 %RH) plus quantization
+ */
+#define SHT1X_ADAPT_R_TEMP_HIGH   (25 * 256)
+#define SHT1X_ADAPT_R_HUM_HIGH    (9 * 256)
+#define SHT1X_ADAPT_R_TEMP_LOW    (2 * 256)
+#define SHT1X_ADAPT_R_HUM_LOW     (1 * 256)
+
+/**
+ * @brief  Default tolerated standard deviation of the estimates
+ */
+#define SHT1X_ADAPT_LIMIT_C       0.1f
+#define SHT1X_ADAPT_LIMIT_P       1.0f
+
+#define SHT1X_ADAPT_MAX           0xFFFFFFFFUL
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static uint32_t
+SHT1x_Adapt_Saturate(uint64_t Value)
+{
+  return (Value > SHT1X_ADAPT_MAX) ? SHT1X_ADAPT_MAX : (uint32_t)Value;
+}
+
+static uint32_t
+SHT1x_Adapt_Sqrt(uint64_t Value)
+{
+  uint64_t Root = 0;
+  uint64_t Bit = 1ULL << 62;
+
+  while (Bit > Value)
+    Bit >>= 2;
+  while (Bit)
+  {
+    if (Value >= Root + Bit)
+    {
+      Value -= Root + Bit;
+      Root = (Root >> 1) + Bit;
+    }
+    else
+    {
+      Root >>= 1;
+    }
+    Bit >>= 2;
+  }
+
+  return (uint32_t)Root;
+}
+
+/**
+ * @brief  Growth of a variance in DtMs at a drift rate variance of Q
+ */
+static uint32_t
+SHT1x_Adapt_Growth(uint32_t Q, uint32_t DtMs)
+{
+  uint64_t Growth;
+
+  if (!DtMs)
+    return 0;
+  if (DtMs > 0x7FFFFFFF)
+    DtMs = 0x7FFFFFFF;
+
+  Growth = (uint64_t)Q * DtMs / 1000;
+  if (Growth > 0xFFFFFFFFFFFFFFFFULL / DtMs)
+    return SHT1X_ADAPT_MAX;
+  return SHT1x_Adapt_Saturate((Growth * DtMs / 1000) >> 16);
+}
+
+/**
+ * @brief  Drift rate variance that grows a variance by Variance in DtMs
+ */
+static uint32_t
+SHT1x_Adapt_Rate(uint32_t Variance, uint32_t DtMs)
+{
+  uint64_t Rate = ((uint64_t)Variance << 16) * 1000 / DtMs;
+
+  if (Rate > 0xFFFFFFFFFFFFFFFFULL / 1000)
+    return SHT1X_ADAPT_MAX;
+  return SHT1x_Adapt_Saturate(Rate * 1000 / DtMs);
+}
+
+/**
+ * @brief  Variance of a filter DtMs after its last update
+ */
+static uint32_t
+SHT1x_Adapt_Predict(const SHT1x_AdaptFilter_t *Filter, uint32_t DtMs)
+{
+  return SHT1x_Adapt_Saturate((uint64_t)Filter->P +
+                              SHT1x_Adapt_Growth(Filter->Q, DtMs));
+}
+
+static void
+SHT1x_Adapt_Start(SHT1x_AdaptFilter_t *Filter, uint16_t Raw, uint32_t MinPeriodMs)
+{
+  Filter->X = (int32_t)Raw << 8;
+  Filter->P = Filter->R;
+
+  // as uncertain as a transient, so the period starts at its minimum
+  Filter->Q = SHT1x_Adapt_Rate(Filter->Limit, MinPeriodMs);
+}
+
+/**
+ * @brief  Correct a filter with a raw value DtMs after its last update.
+ * @retval 1: The value is a transient
+ *         0: The value is within the prediction
+ */
+static uint8_t
+SHT1x_Adapt_Correct(SHT1x_AdaptFilter_t *Filter, uint16_t Raw, uint32_t DtMs)
+{
+  const int32_t Nu = ((int32_t)Raw << 8) - Filter->X;
+  const uint32_t Nu2 = SHT1x_Adapt_Saturate(((uint64_t)((int64_t)Nu * Nu)) >> 8);
+  const uint32_t Prior = Filter->P;
+  uint32_t Excess, Observed, Gain;
+  uint8_t Transient = 0;
+
+  Filter->P = SHT1x_Adapt_Predict(Filter, DtMs);
+
+  // drift rate that explains the innovation, beyond the noise
+  Excess = (Nu2 > Prior + Filter->R) ? Nu2 - Prior - Filter->R : 0;
+  Observed = SHT1x_Adapt_Rate(Excess, DtMs);
+
+  if ((uint64_t)Nu2 >
+      (uint64_t)SHT1X_ADAPT_GATE * SHT1X_ADAPT_GATE * (Filter->P + Filter->R))
+  {
+    // follow a step at once instead of converging to it
+    Filter->P = Nu2 - Filter->R;
+    if (Observed > Filter->Q)
+      Filter->Q = Observed;
+    Transient = 1;
+  }
+  else if (Observed >= Filter->Q)
+  {
+    Filter->Q += (Observed - Filter->Q) >> SHT1X_ADAPT_Q_SHIFT;
+  }
+  else
+  {
+    Filter->Q -= (Filter->Q - Observed) >> SHT1X_ADAPT_Q_SHIFT;
+  }
+
+  // K = P / (P + R) in Q16
+  Gain = (uint32_t)(((uint64_t)Filter->P << 16) / ((uint64_t)Filter->P + Filter->R));
+  Filter->X += (int32_t)((int64_t)Gain * Nu / 65536);
+  Filter->P = (uint32_t)((uint64_t)Filter->P * Filter->R /
+                         ((uint64_t)Filter->P + Filter->R));
+
+  return Transient;
+}
+
+/**
+ * @brief  Time until the variance of a filter reaches its limit (ms)
+ */
+static uint32_t
+SHT1x_Adapt_Horizon(const SHT1x_AdaptFilter_t *Filter)
+{
+  uint64_t Seconds2;
+
+  if (Filter->P >= Filter->Limit)
+    return 0;
+  if (!Filter->Q)
+    return SHT1X_ADAPT_MAX;
+
+  // (Limit - P) = Q * t^2
+  Seconds2 = ((uint64_t)(Filter->Limit - Filter->P) << 16) / Filter->Q;
+  if (Seconds2 >= 18000000000000ULL)
+    return SHT1X_ADAPT_MAX;
+  return SHT1x_Adapt_Sqrt(Seconds2 * 1000000);
+}
+
+/**
+ * @brief  Convert a standard deviation to a variance in counts^2 Q8
+ */
+static uint32_t
+SHT1x_Adapt_Variance(float Sigma, float CountsPerUnit)
+{
+  float Counts = Sigma * CountsPerUnit;
+  float Variance = Counts * Counts * 256.0f;
+
+  return (Variance >= 4294967040.0f) ? SHT1X_ADAPT_MAX : (uint32_t)Variance;
+}
+
+static void
+SHT1x_Adapt_SetResolution(SHT1x_Adapt_t *Adapt, float TempC, float HumP)
+{
+  Adapt->Resolution = (uint8_t)Adapt->Handler->ResolutionStatus;
+
+  // d2 of temperature and c2 of humidity per count
+  if (Adapt->Resolution == SHT1x_HighResolution)
+  {
+    Adapt->Temp.R = SHT1X_ADAPT_R_TEMP_HIGH;
+    Adapt->Hum.R = SHT1X_ADAPT_R_HUM_HIGH;
+    Adapt->Temp.Limit = SHT1x_Adapt_Variance(TempC, 1.0f / 0.01f);
+    Adapt->Hum.Limit = SHT1x_Adapt_Variance(HumP, 1.0f / 0.0405f);
+  }
+  else
+  {
+    Adapt->Temp.R = SHT1X_ADAPT_R_TEMP_LOW;
+    Adapt->Hum.R = SHT1X_ADAPT_R_HUM_LOW;
+    Adapt->Temp.Limit = SHT1x_Adapt_Variance(TempC, 1.0f / 0.04f);
+    Adapt->Hum.Limit = SHT1x_Adapt_Variance(HumP, 1.0f / 0.648f);
+  }
+
+  Adapt->TempLimitC = TempC;
+  Adapt->HumLimitP = HumP;
+  Adapt->Valid = 0;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the adaptive sampler of a handler. The noise and the
+ *         tolerated uncertainty of the estimates are set for the resolution of
+ *         the handler (about 0.1 C and 1 %RH of standard deviation). They can
+ *         be changed with SHT1x_Adapt_SetLimits.
+ * @param  Adapt: Pointer to adaptive sampler
+ * @param  Handler: Pointer to initialized handler
+ * @param  MinPeriodMs: Shortest sample period (ms)
+ * @param  MaxPeriodMs: Longest sample period (ms)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters.
+ */
+SHT1x_Result_t
+SHT1x_Adapt_Init(SHT1x_Adapt_t *Adapt, SHT1x_Handler_t *Handler,
+                 uint32_t MinPeriodMs, uint32_t MaxPeriodMs)
+{
+  if (!Adapt || !Handler || !MinPeriodMs || MinPeriodMs > MaxPeriodMs)
+    return SHT1x_FAIL;
+
+  Adapt->Handler = Handler;
+  Adapt->MinPeriodMs = MinPeriodMs;
+  Adapt->MaxPeriodMs = MaxPeriodMs;
+  Adapt->PeriodMs = MinPeriodMs;
+  Adapt->LastMs = 0;
+  Adapt->Transients = 0;
+  SHT1x_Adapt_SetResolution(Adapt, SHT1X_ADAPT_LIMIT_C, SHT1X_ADAPT_LIMIT_P);
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Set the tolerated standard deviation of the estimates. The sample
+ *         period is stretched until the predicted uncertainty of one of them
+ *         reaches its limit. The filters restart with the next sample.
+ * @param  Adapt: Pointer to adaptive sampler
+ * @param  TempC: Temperature (°C)
+ * @param  HumP: Humidity (%RH), converted with the slope of the humidity curve
+ *         at its low end
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Limits are not positive.
+ */
+SHT1x_Result_t
+SHT1x_Adapt_SetLimits(SHT1x_Adapt_t *Adapt, float TempC, float HumP)
+{
+  if (!(TempC > 0) || !(HumP > 0))
+    return SHT1x_FAIL;
+
+  SHT1x_Adapt_SetResolution(Adapt, TempC, HumP);
+  Adapt->PeriodMs = Adapt->MinPeriodMs;
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Add a sample to the filters and compute the next sample period.
+ *         A change of resolution restarts the filters.
+ * @param  Adapt: Pointer to adaptive sampler
+ * @param  Sample: Pointer to a successful sample, or NULL for a failed one
+ * @param  NowMs: Time of the sample (ms)
+ * @retval Next sample period (ms). MinPeriodMs after a failed sample.
+ */
+uint32_t
+SHT1x_Adapt_Update(SHT1x_Adapt_t *Adapt, const SHT1x_Sample_t *Sample,
+                   uint32_t NowMs)
+{
+  uint32_t DtMs, Period, Horizon;
+
+  if (!Sample)
+  {
+    Adapt->PeriodMs = Adapt->MinPeriodMs;
+    return Adapt->PeriodMs;
+  }
+
+  if (Adapt->Resolution != (uint8_t)Adapt->Handler->ResolutionStatus)
+    SHT1x_Adapt_SetResolution(Adapt, Adapt->TempLimitC, Adapt->HumLimitP);
+
+  if (!Adapt->Valid)
+  {
+    SHT1x_Adapt_Start(&Adapt->Temp, Sample->TempRaw, Adapt->MinPeriodMs);
+    SHT1x_Adapt_Start(&Adapt->Hum, Sample->HumRaw, Adapt->MinPeriodMs);
+    Adapt->Valid = 1;
+    Adapt->LastMs = NowMs;
+    Adapt->PeriodMs = Adapt->MinPeriodMs;
+    return Adapt->PeriodMs;
+  }
+
+  DtMs = NowMs - Adapt->LastMs;
+  if (!DtMs)
+    DtMs = 1;
+  Adapt->LastMs = NowMs;
+
+  if (SHT1x_Adapt_Correct(&Adapt->Temp, Sample->TempRaw, DtMs) |
+      SHT1x_Adapt_Correct(&Adapt->Hum, Sample->HumRaw, DtMs))
+    Adapt->Transients++;
+
+  // sample again when the first of the estimates becomes too uncertain
+  Period = SHT1x_Adapt_Horizon(&Adapt->Temp);
+  Horizon = SHT1x_Adapt_Horizon(&Adapt->Hum);
+  if (Horizon < Period)
+    Period = Horizon;
+
+  // back off at most by doubling, so a slow drift is not overlooked
+  if (Period / 2 > Adapt->PeriodMs)
+    Period = Adapt->PeriodMs * 2;
+  if (Period < Adapt->MinPeriodMs)
+    Period = Adapt->MinPeriodMs;
+  if (Period > Adapt->MaxPeriodMs)
+    Period = Adapt->MaxPeriodMs;
+
+  Adapt->PeriodMs = Period;
+  return Period;
+}
+
+
+/**
+ * @brief  Get the filtered sample at any time, without bus access. The raw
+ *         values are rounded estimates, converted with SHT1x_ConvertSample.
+ * @param  Adapt: Pointer to adaptive sampler
+ * @param  NowMs: Current time (ms)
+ * @param  Sample: Pointer to sample
+ * @param  TempVar: Pointer to get the predicted variance of TempRaw (counts^2
+ *         in Q8), or NULL
+ * @param  HumVar: Pointer to get the predicted variance of HumRaw, or NULL
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No sample has been added yet.
+ */
+SHT1x_Result_t
+SHT1x_Adapt_Estimate(SHT1x_Adapt_t *Adapt, uint32_t NowMs, SHT1x_Sample_t *Sample,
+                     uint32_t *TempVar, uint32_t *HumVar)
+{
+  if (!Adapt->Valid)
+    return SHT1x_FAIL;
+
+  Sample->TempRaw = (Adapt->Temp.X > 0) ? (uint16_t)((Adapt->Temp.X + 128) >> 8) : 0;
+  Sample->HumRaw = (Adapt->Hum.X > 0) ? (uint16_t)((Adapt->Hum.X + 128) >> 8) : 0;
+  SHT1x_ConvertSample(Adapt->Handler, Sample);
+
+  if (TempVar)
+    *TempVar = SHT1x_Adapt_Predict(&Adapt->Temp, NowMs - Adapt->LastMs);
+  if (HumVar)
+    *HumVar = SHT1x_Adapt_Predict(&Adapt->Hum, NowMs - Adapt->LastMs);
+
+  return SHT1x_OK;
+}
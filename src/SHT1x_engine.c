@@ -0,0 +1,384 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_engine.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Timer-driven SHT1x transfer engine
+ *         Functionalities of the this file:
+ *          + Measurement and status register transfers advanced by one
+ *            half-clock per timer tick, with no busy-wait
+ *          + Conversion wait on the same timer (sleep, then poll DATA)
+ *          + Completion callback from the timer context
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "SHT1x_engine.h"
+#if (SHT1X_CONFIG_STATIC_PORT)
+#include "SHT1x_platform.h"
+#endif
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define SHT1x_CMD_MeasureTemperature  0x03
+#define SHT1x_CMD_MeasureHumidity     0x05
+#define SHT1x_CMD_ReadStatusRegister  0x07
+
+/**
+ * @brief  Phases of a transfer, each one takes a few ticks (Step)
+ */
+#define SHT1X_ENGINE_START            0   // Transmission start
+#define SHT1X_ENGINE_TX               1   // Command bits
+#define SHT1X_ENGINE_TX_ACK           2   // ACK of the sensor
+#define SHT1X_ENGINE_CONVERT          3   // Conversion wait
+#define SHT1X_ENGINE_RX               4   // Data bits
+#define SHT1X_ENGINE_RX_ACK           5   // ACK of the master
+#define SHT1X_ENGINE_RX_NACK          6   // NACK of the master, end of transfer
+
+/**
+ * @brief  Conversion wait, like SHT1x_WaitForResult
+ */
+#define SHT1X_ENGINE_MIN_PERCENT      70
+#define SHT1X_ENGINE_TIMEOUT_PERCENT  125
+#define SHT1X_ENGINE_POLL_STEPS       64
+
+
+/* Private Macros ---------------------------------------------------------------*/
+#if (SHT1X_CONFIG_STATIC_PORT)
+  #define SHT1X_ENGINE_DATA_CONFIG_DIR(Dir)   SHT1x_Port_DataConfigDir(Dir)
+  #define SHT1X_ENGINE_DATA_WRITE(Level)      SHT1x_Port_DataWrite(Level)
+  #define SHT1X_ENGINE_DATA_READ()            SHT1x_Port_DataRead()
+  #define SHT1X_ENGINE_SCK_WRITE(Level)       SHT1x_Port_SckWrite(Level)
+#else
+  #define SHT1X_ENGINE_DATA_CONFIG_DIR(Dir)   Engine->Handler->DataConfigDir(Dir)
+  #define SHT1X_ENGINE_DATA_WRITE(Level)      Engine->Handler->DataWrite(Level)
+  #define SHT1X_ENGINE_DATA_READ()            Engine->Handler->DataRead()
+  #define SHT1X_ENGINE_SCK_WRITE(Level)       Engine->Handler->SckWrite(Level)
+#endif
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static void
+SHT1x_Engine_Goto(SHT1x_Engine_t *Engine, uint8_t Phase)
+{
+  Engine->Phase = Phase;
+  Engine->Step = 0;
+}
+
+static void
+SHT1x_Engine_Finish(SHT1x_Engine_t *Engine, SHT1x_Result_t Result)
+{
+#if (SHT1X_CONFIG_CRC_CHECK)
+  uint8_t Data[3];
+
+  if (Result == SHT1x_OK)
+  {
+    Data[0] = Engine->Cmd;
+    for (uint8_t i = 0; i + 1 < Engine->Bytes; i++)
+      Data[i + 1] = Engine->Rx[i];
+
+    if (Engine->Rx[Engine->Bytes - 1] !=
+        SHT1x_CRC8(Engine->Handler->StatusReg, Data, Engine->Bytes))
+      Result = SHT1x_FAIL;
+    else if (Engine->Cmd == SHT1x_CMD_ReadStatusRegister)
+      Engine->Handler->StatusReg = Engine->Rx[0];
+  }
+#endif
+
+  if (Result == SHT1x_OK)
+  {
+    if (Engine->Cmd == SHT1x_CMD_ReadStatusRegister)
+      Engine->Status = Engine->Rx[0];
+    else
+      Engine->Raw = ((uint16_t)Engine->Rx[0] << 8) | Engine->Rx[1];
+  }
+
+  Engine->Result = Result;
+  Engine->Busy = 0;
+  Engine->Schedule(0);
+
+  if (Engine->Done)
+    Engine->Done(Engine->Context, Result);
+}
+
+static SHT1x_Result_t
+SHT1x_Engine_Begin(SHT1x_Engine_t *Engine, uint8_t Cmd, uint8_t Bytes)
+{
+  if (Engine->Busy)
+    return SHT1x_FAIL;
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+  Bytes++;
+#endif
+
+  Engine->Cmd = Cmd;
+  Engine->Bytes = Bytes;
+  Engine->Byte = 0;
+  Engine->Bit = 8;
+  Engine->Result = SHT1x_OK;
+  Engine->Busy = 1;
+  // the engine drives DATA itself, the next command of the driver claims it
+  Engine->Handler->DataOutput = 0;
+  SHT1x_Engine_Goto(Engine, SHT1X_ENGINE_START);
+
+  Engine->Schedule(Engine->HalfPeriodUs);
+
+  return SHT1x_OK;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the engine
+ * @param  Engine: Pointer to engine
+ * @param  Handler: Pointer to initialized handler
+ * @param  Schedule: Timer glue of the port
+ * @retval None
+ */
+void
+SHT1x_Engine_Init(SHT1x_Engine_t *Engine, SHT1x_Handler_t *Handler,
+                  SHT1x_EngineSchedule_t Schedule)
+{
+  Engine->Handler = Handler;
+  Engine->Schedule = Schedule;
+  Engine->Done = 0;
+  Engine->Context = 0;
+  Engine->HalfPeriodUs = SHT1X_ENGINE_HALF_PERIOD_US;
+  Engine->Result = SHT1x_OK;
+  Engine->Busy = 0;
+}
+
+
+/**
+ * @brief  Start a measurement. The result is in Engine->Raw when Done is
+ *         called or SHT1x_Engine_IsBusy returns 0.
+ * @param  Engine: Pointer to engine
+ * @param  Measurement: Temperature or humidity
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: A transfer is in progress.
+ */
+SHT1x_Result_t
+SHT1x_Engine_Measure(SHT1x_Engine_t *Engine, SHT1x_Measurement_t Measurement)
+{
+  uint16_t MinMs, MaxMs;
+
+  SHT1x_GetConversionTime(Engine->Handler, Measurement, &MinMs, &MaxMs);
+  Engine->WaitedMs = MinMs;
+  Engine->StepMs = (MaxMs >= SHT1X_ENGINE_POLL_STEPS) ?
+                   (MaxMs / SHT1X_ENGINE_POLL_STEPS) : 1;
+  Engine->TimeoutMs = (uint16_t)((uint32_t)MaxMs * SHT1X_ENGINE_TIMEOUT_PERCENT / 100);
+
+  return SHT1x_Engine_Begin(Engine, (Measurement == SHT1x_MeasureHumidity) ?
+                            SHT1x_CMD_MeasureHumidity : SHT1x_CMD_MeasureTemperature, 2);
+}
+
+
+/**
+ * @brief  Start a status register read. The result is in Engine->Status.
+ * @param  Engine: Pointer to engine
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: A transfer is in progress.
+ */
+SHT1x_Result_t
+SHT1x_Engine_ReadStatus(SHT1x_Engine_t *Engine)
+{
+  return SHT1x_Engine_Begin(Engine, SHT1x_CMD_ReadStatusRegister, 1);
+}
+
+
+/**
+ * @brief  Advance the transfer by one step. Call it from the timer interrupt
+ *         armed by Schedule.
+ * @param  Engine: Pointer to engine
+ * @retval None
+ */
+void
+SHT1x_Engine_Tick(SHT1x_Engine_t *Engine)
+{
+  uint32_t Next = Engine->HalfPeriodUs;
+  uint8_t Step = Engine->Step++;
+
+  if (!Engine->Busy)
+    return;
+
+  switch (Engine->Phase)
+  {
+  case SHT1X_ENGINE_START:
+    // DATA falls while SCK is high, then rises during the next SCK pulse
+    switch (Step)
+    {
+    case 0: SHT1X_ENGINE_DATA_CONFIG_DIR(1); SHT1X_ENGINE_DATA_WRITE(1); break;
+    case 1: SHT1X_ENGINE_SCK_WRITE(1); break;
+    case 2: SHT1X_ENGINE_DATA_WRITE(0); break;
+    case 3: SHT1X_ENGINE_SCK_WRITE(0); break;
+    case 4: SHT1X_ENGINE_SCK_WRITE(1); break;
+    default:
+      SHT1X_ENGINE_DATA_WRITE(1);
+      SHT1x_Engine_Goto(Engine, SHT1X_ENGINE_TX);
+      break;
+    }
+    break;
+
+  case SHT1X_ENGINE_TX:
+    if (!Step)
+    {
+      // data changes while SCK is low
+      SHT1X_ENGINE_SCK_WRITE(0);
+      SHT1X_ENGINE_DATA_WRITE((Engine->Cmd >> --Engine->Bit) & 0x01);
+    }
+    else
+    {
+      SHT1X_ENGINE_SCK_WRITE(1);
+      SHT1x_Engine_Goto(Engine, Engine->Bit ? SHT1X_ENGINE_TX : SHT1X_ENGINE_TX_ACK);
+    }
+    break;
+
+  case SHT1X_ENGINE_TX_ACK:
+    switch (Step)
+    {
+    case 0:
+      SHT1X_ENGINE_SCK_WRITE(0);
+      SHT1X_ENGINE_DATA_CONFIG_DIR(0);
+      break;
+    case 1:
+      if (SHT1X_ENGINE_DATA_READ())
+      {
+        SHT1x_Engine_Finish(Engine, SHT1x_FAIL);
+        return;
+      }
+      SHT1X_ENGINE_SCK_WRITE(1);
+      break;
+    default:
+      SHT1X_ENGINE_SCK_WRITE(0);
+      Engine->Bit = 8;
+      SHT1x_Engine_Goto(Engine, (Engine->Cmd == SHT1x_CMD_ReadStatusRegister) ?
+                                SHT1X_ENGINE_RX : SHT1X_ENGINE_CONVERT);
+      break;
+    }
+    break;
+
+  case SHT1X_ENGINE_CONVERT:
+    if (!Step)
+    {
+      // the sensor has released DATA (tV) and converts
+      if (!SHT1X_ENGINE_DATA_READ())
+      {
+        SHT1x_Engine_Finish(Engine, SHT1x_FAIL);
+        return;
+      }
+      Next = Engine->WaitedMs * 1000UL;
+    }
+    else if (!SHT1X_ENGINE_DATA_READ())
+    {
+      SHT1x_Engine_Goto(Engine, SHT1X_ENGINE_RX);
+    }
+    else if (Engine->WaitedMs >= Engine->TimeoutMs)
+    {
+      SHT1x_Engine_Finish(Engine, SHT1x_TIME_OUT);
+      return;
+    }
+    else
+    {
+      Engine->WaitedMs += Engine->StepMs;
+      Next = Engine->StepMs * 1000UL;
+    }
+    break;
+
+  case SHT1X_ENGINE_RX:
+    if (!Step)
+    {
+      SHT1X_ENGINE_SCK_WRITE(1);
+    }
+    else
+    {
+      Engine->Rx[Engine->Byte] = (uint8_t)((Engine->Rx[Engine->Byte] << 1) |
+                                           SHT1X_ENGINE_DATA_READ());
+      SHT1X_ENGINE_SCK_WRITE(0);
+      if (--Engine->Bit)
+        SHT1x_Engine_Goto(Engine, SHT1X_ENGINE_RX);
+      else
+        SHT1x_Engine_Goto(Engine, (Engine->Byte + 1 < Engine->Bytes) ?
+                                  SHT1X_ENGINE_RX_ACK : SHT1X_ENGINE_RX_NACK);
+    }
+    break;
+
+  case SHT1X_ENGINE_RX_ACK:
+  case SHT1X_ENGINE_RX_NACK:
+    switch (Step)
+    {
+    case 0:
+      SHT1X_ENGINE_DATA_CONFIG_DIR(1);
+      SHT1X_ENGINE_DATA_WRITE(Engine->Phase == SHT1X_ENGINE_RX_NACK);
+      break;
+    case 1:
+      SHT1X_ENGINE_SCK_WRITE(1);
+      break;
+    default:
+      SHT1X_ENGINE_SCK_WRITE(0);
+      if (Engine->Phase == SHT1X_ENGINE_RX_NACK)
+      {
+        // DATA is left high as output and SCK low (bus idle)
+        SHT1x_Engine_Finish(Engine, SHT1x_OK);
+        return;
+      }
+      SHT1X_ENGINE_DATA_CONFIG_DIR(0);
+      Engine->Byte++;
+      Engine->Bit = 8;
+      SHT1x_Engine_Goto(Engine, SHT1X_ENGINE_RX);
+      break;
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  Engine->Schedule(Next);
+}
+
+
+/**
+ * @brief  Check if a transfer is in progress
+ * @param  Engine: Pointer to engine
+ * @retval 1: Busy, 0: Idle (Engine->Result holds the result)
+ */
+uint8_t
+SHT1x_Engine_IsBusy(SHT1x_Engine_t *Engine)
+{
+  return Engine->Busy;
+}
@@ -0,0 +1,458 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_rollup.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Fixed-memory rollup store of SHT1x samples
+ *         Functionalities of the this file:
+ *          + Minute, hour and day buckets with min, max, sum and count of the
+ *            raw values, updated in O(1) per sample without allocation
+ *          + Summary of the newest buckets of a level (e.g. last hour min/max)
+ *          + Compact serialization of a level for uplink, and its decoder
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "SHT1x_rollup.h"
+#include <stddef.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+static const uint32_t SHT1x_Rollup_Width[SHT1x_RollupLevels] = {60, 3600, 86400};
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static SHT1x_RollupBucket_t *
+SHT1x_Rollup_Ring(SHT1x_Rollup_t *Rollup, SHT1x_RollupLevel_t Level, uint8_t *Size)
+{
+  switch (Level)
+  {
+  case SHT1x_RollupMinute:
+    *Size = SHT1X_ROLLUP_MINUTES;
+    return Rollup->Minute;
+
+  case SHT1x_RollupHour:
+    *Size = SHT1X_ROLLUP_HOURS;
+    return Rollup->Hour;
+
+  case SHT1x_RollupDay:
+    *Size = SHT1X_ROLLUP_DAYS;
+    return Rollup->Day;
+
+  default:
+    *Size = 0;
+    return NULL;
+  }
+}
+
+static void
+SHT1x_Rollup_Clear(SHT1x_RollupBucket_t *Bucket)
+{
+  static const SHT1x_RollupBucket_t Empty = {0};
+
+  *Bucket = Empty;
+}
+
+static uint16_t
+SHT1x_Rollup_Average(uint64_t Sum, uint32_t Count)
+{
+  return (uint16_t)((Sum + Count / 2) / Count);
+}
+
+static uint8_t *
+SHT1x_Rollup_PutVarint(uint8_t *Out, uint32_t Value)
+{
+  while (Value >= 0x80)
+  {
+    *Out++ = (uint8_t)(Value | 0x80);
+    Value >>= 7;
+  }
+  *Out++ = (uint8_t)Value;
+
+  return Out;
+}
+
+static const uint8_t *
+SHT1x_Rollup_GetVarint(const uint8_t *In, const uint8_t *End, uint32_t *Value)
+{
+  uint32_t Result = 0;
+
+  for (uint8_t Shift = 0; In < End && Shift < 35; Shift += 7)
+  {
+    Result |= (uint32_t)(*In & 0x7F) << Shift;
+    if (!(*In++ & 0x80))
+    {
+      *Value = Result;
+      return In;
+    }
+  }
+
+  return NULL;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize an empty store
+ * @param  Rollup: Pointer to store
+ * @retval None
+ */
+void
+SHT1x_Rollup_Init(SHT1x_Rollup_t *Rollup)
+{
+  SHT1x_RollupBucket_t *Ring;
+  uint8_t Size;
+
+  for (uint8_t Level = 0; Level < SHT1x_RollupLevels; Level++)
+  {
+    Ring = SHT1x_Rollup_Ring(Rollup, (SHT1x_RollupLevel_t)Level, &Size);
+    for (uint8_t i = 0; i < Size; i++)
+      SHT1x_Rollup_Clear(&Ring[i]);
+    Rollup->Newest[Level] = 0;
+  }
+
+  Rollup->Empty = 1;
+}
+
+
+/**
+ * @brief  Add raw values of one sample.
+ * @param  Rollup: Pointer to store
+ * @param  TimeS: Sample time (s). Older samples are accepted as long as their
+ *         buckets are still stored.
+ * @param  TempRaw: Raw temperature
+ * @param  HumRaw: Raw humidity
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The sample is older than every level.
+ */
+SHT1x_Result_t
+SHT1x_Rollup_AddRaw(SHT1x_Rollup_t *Rollup, uint32_t TimeS,
+                    uint16_t TempRaw, uint16_t HumRaw)
+{
+  SHT1x_RollupBucket_t *Ring;
+  SHT1x_RollupBucket_t *Bucket;
+  SHT1x_Result_t Result = SHT1x_FAIL;
+  uint32_t Period, Gap;
+  uint8_t Size;
+
+  for (uint8_t Level = 0; Level < SHT1x_RollupLevels; Level++)
+  {
+    Ring = SHT1x_Rollup_Ring(Rollup, (SHT1x_RollupLevel_t)Level, &Size);
+    Period = TimeS / SHT1x_Rollup_Width[Level];
+
+    if (Rollup->Empty)
+    {
+      Rollup->Newest[Level] = Period;
+    }
+    else if (Period > Rollup->Newest[Level])
+    {
+      // buckets of the skipped periods are empty, at most one turn of the ring
+      Gap = Period - Rollup->Newest[Level];
+      if (Gap > Size)
+        Gap = Size;
+      for (uint32_t i = Period - Gap + 1; Gap; Gap--, i++)
+        SHT1x_Rollup_Clear(&Ring[i % Size]);
+      Rollup->Newest[Level] = Period;
+    }
+    else if (Rollup->Newest[Level] - Period >= Size)
+    {
+      continue;
+    }
+
+    Bucket = &Ring[Period % Size];
+    if (!Bucket->Count)
+    {
+      Bucket->TempMin = Bucket->TempMax = TempRaw;
+      Bucket->HumMin = Bucket->HumMax = HumRaw;
+    }
+    else
+    {
+      if (TempRaw < Bucket->TempMin)
+        Bucket->TempMin = TempRaw;
+      if (TempRaw > Bucket->TempMax)
+        Bucket->TempMax = TempRaw;
+      if (HumRaw < Bucket->HumMin)
+        Bucket->HumMin = HumRaw;
+      if (HumRaw > Bucket->HumMax)
+        Bucket->HumMax = HumRaw;
+    }
+    Bucket->TempSum += TempRaw;
+    Bucket->HumSum += HumRaw;
+    Bucket->Count++;
+
+    Result = SHT1x_OK;
+  }
+
+  Rollup->Empty = 0;
+
+  return Result;
+}
+
+
+/**
+ * @brief  Add a sample of SHT1x_ReadSample.
+ * @param  Rollup: Pointer to store
+ * @param  TimeS: Sample time (s)
+ * @param  Sample: Pointer to sample
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The sample is older than every level.
+ */
+SHT1x_Result_t
+SHT1x_Rollup_Add(SHT1x_Rollup_t *Rollup, uint32_t TimeS,
+                 const SHT1x_Sample_t *Sample)
+{
+  return SHT1x_Rollup_AddRaw(Rollup, TimeS, Sample->TempRaw, Sample->HumRaw);
+}
+
+
+/**
+ * @brief  Get one bucket.
+ * @param  Rollup: Pointer to store
+ * @param  Level: Level of the bucket
+ * @param  Age: 0 for the newest bucket (being filled), 1 for the one before, ...
+ * @param  Bucket: Pointer to copy the bucket to
+ * @param  StartS: Pointer to start time of the bucket (s), may be NULL
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Age is out of range or the store is empty.
+ */
+SHT1x_Result_t
+SHT1x_Rollup_Get(SHT1x_Rollup_t *Rollup, SHT1x_RollupLevel_t Level, uint8_t Age,
+                 SHT1x_RollupBucket_t *Bucket, uint32_t *StartS)
+{
+  SHT1x_RollupBucket_t *Ring;
+  uint32_t Period;
+  uint8_t Size;
+
+  Ring = SHT1x_Rollup_Ring(Rollup, Level, &Size);
+  if (!Ring || Rollup->Empty || Age >= Size || Age > Rollup->Newest[Level])
+    return SHT1x_FAIL;
+
+  Period = Rollup->Newest[Level] - Age;
+  *Bucket = Ring[Period % Size];
+  if (StartS)
+    *StartS = Period * SHT1x_Rollup_Width[Level];
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Merge the newest buckets of a level, e.g. 60 minute buckets for the
+ *         last hour.
+ * @param  Rollup: Pointer to store
+ * @param  Level: Level of the buckets
+ * @param  Buckets: Number of buckets to merge, including the newest one
+ * @param  Summary: Pointer to the merged buckets (Count is 0 if no sample)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Buckets is out of range.
+ */
+SHT1x_Result_t
+SHT1x_Rollup_Summary(SHT1x_Rollup_t *Rollup, SHT1x_RollupLevel_t Level,
+                     uint8_t Buckets, SHT1x_RollupSummary_t *Summary)
+{
+  static const SHT1x_RollupSummary_t Empty = {0};
+  SHT1x_RollupBucket_t Bucket;
+  uint8_t Size;
+
+  *Summary = Empty;
+
+  if (!SHT1x_Rollup_Ring(Rollup, Level, &Size) || Buckets > Size)
+    return SHT1x_FAIL;
+
+  for (uint8_t Age = 0; Age < Buckets; Age++)
+  {
+    if (SHT1x_Rollup_Get(Rollup, Level, Age, &Bucket, NULL) != SHT1x_OK)
+      break;
+    if (!Bucket.Count)
+      continue;
+
+    if (!Summary->Count || Bucket.TempMin < Summary->TempMin)
+      Summary->TempMin = Bucket.TempMin;
+    if (!Summary->Count || Bucket.TempMax > Summary->TempMax)
+      Summary->TempMax = Bucket.TempMax;
+    if (!Summary->Count || Bucket.HumMin < Summary->HumMin)
+      Summary->HumMin = Bucket.HumMin;
+    if (!Summary->Count || Bucket.HumMax > Summary->HumMax)
+      Summary->HumMax = Bucket.HumMax;
+    Summary->TempSum += Bucket.TempSum;
+    Summary->HumSum += Bucket.HumSum;
+    Summary->Count += Bucket.Count;
+  }
+
+  if (Summary->Count)
+  {
+    Summary->TempAvg = SHT1x_Rollup_Average(Summary->TempSum, Summary->Count);
+    Summary->HumAvg = SHT1x_Rollup_Average(Summary->HumSum, Summary->Count);
+  }
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Serialize the newest buckets of a level, newest first. An empty
+ *         bucket takes 1 byte. Others hold the count, the minimums, and the
+ *         maximums and averages as offsets from the minimums in base-128
+ *         varints, typically 9 to 11 bytes.
+ * @param  Rollup: Pointer to store
+ * @param  Level: Level of the buckets
+ * @param  Buckets: Number of buckets
+ * @param  Buffer: Output buffer
+ * @param  Size: Size of Buffer, SHT1X_ROLLUP_SERIAL_SIZE(Buckets) is enough
+ * @retval Number of bytes written, 0 if Buffer is too small or Buckets is out
+ *         of range
+ */
+uint16_t
+SHT1x_Rollup_Serialize(SHT1x_Rollup_t *Rollup, SHT1x_RollupLevel_t Level,
+                       uint8_t Buckets, uint8_t *Buffer, uint16_t Size)
+{
+  SHT1x_RollupBucket_t Bucket;
+  uint8_t Item[21];
+  uint8_t *Out = Buffer;
+  uint8_t *End;
+  uint32_t StartS = 0;
+  uint8_t RingSize;
+
+  if (!SHT1x_Rollup_Ring(Rollup, Level, &RingSize) || Buckets > RingSize || Size < 6)
+    return 0;
+
+  SHT1x_Rollup_Get(Rollup, Level, 0, &Bucket, &StartS);
+
+  // header: level, bucket count, start of the newest bucket (little-endian)
+  *Out++ = (uint8_t)Level;
+  *Out++ = Buckets;
+  for (uint8_t i = 0; i < 4; i++)
+    *Out++ = (uint8_t)(StartS >> (8 * i));
+
+  for (uint8_t Age = 0; Age < Buckets; Age++)
+  {
+    if (SHT1x_Rollup_Get(Rollup, Level, Age, &Bucket, NULL) != SHT1x_OK)
+      SHT1x_Rollup_Clear(&Bucket);
+
+    End = SHT1x_Rollup_PutVarint(Item, Bucket.Count);
+    if (Bucket.Count)
+    {
+      *End++ = (uint8_t)Bucket.TempMin;
+      *End++ = (uint8_t)(Bucket.TempMin >> 8);
+      End = SHT1x_Rollup_PutVarint(End, Bucket.TempMax - Bucket.TempMin);
+      End = SHT1x_Rollup_PutVarint(End, SHT1x_Rollup_Average(Bucket.TempSum, Bucket.Count) -
+                                        Bucket.TempMin);
+      *End++ = (uint8_t)Bucket.HumMin;
+      *End++ = (uint8_t)(Bucket.HumMin >> 8);
+      End = SHT1x_Rollup_PutVarint(End, Bucket.HumMax - Bucket.HumMin);
+      End = SHT1x_Rollup_PutVarint(End, SHT1x_Rollup_Average(Bucket.HumSum, Bucket.Count) -
+                                        Bucket.HumMin);
+    }
+
+    if ((uint16_t)(Out - Buffer) + (End - Item) > Size)
+      return 0;
+    for (uint8_t *In = Item; In < End; In++)
+      *Out++ = *In;
+  }
+
+  return (uint16_t)(Out - Buffer);
+}
+
+
+/**
+ * @brief  Decode the output of SHT1x_Rollup_Serialize. Sums are rebuilt from
+ *         the averages.
+ * @param  Buffer: Serialized level
+ * @param  Length: Length of Buffer
+ * @param  Level: Pointer to level of the buckets
+ * @param  StartS: Pointer to start time of the newest bucket (s)
+ * @param  Buckets: Array of decoded buckets, newest first
+ * @param  MaxBuckets: Size of Buckets
+ * @retval Number of decoded buckets, 0 on a malformed buffer
+ */
+uint8_t
+SHT1x_Rollup_Deserialize(const uint8_t *Buffer, uint16_t Length,
+                         SHT1x_RollupLevel_t *Level, uint32_t *StartS,
+                         SHT1x_RollupBucket_t *Buckets, uint8_t MaxBuckets)
+{
+  const uint8_t *In = Buffer + 6;
+  const uint8_t *End = Buffer + Length;
+  SHT1x_RollupBucket_t *Bucket;
+  uint32_t Max, Avg;
+  uint8_t Count;
+
+  if (Length < 6 || Buffer[0] >= SHT1x_RollupLevels || Buffer[1] > MaxBuckets)
+    return 0;
+
+  *Level = (SHT1x_RollupLevel_t)Buffer[0];
+  Count = Buffer[1];
+  *StartS = 0;
+  for (uint8_t i = 0; i < 4; i++)
+    *StartS |= (uint32_t)Buffer[2 + i] << (8 * i);
+
+  for (uint8_t i = 0; i < Count; i++)
+  {
+    Bucket = &Buckets[i];
+    SHT1x_Rollup_Clear(Bucket);
+
+    In = SHT1x_Rollup_GetVarint(In, End, &Bucket->Count);
+    if (!In)
+      return 0;
+    if (!Bucket->Count)
+      continue;
+
+    if (End - In < 2)
+      return 0;
+    Bucket->TempMin = (uint16_t)(In[0] | (In[1] << 8));
+    In += 2;
+    if (!(In = SHT1x_Rollup_GetVarint(In, End, &Max)) ||
+        !(In = SHT1x_Rollup_GetVarint(In, End, &Avg)))
+      return 0;
+    Bucket->TempMax = (uint16_t)(Bucket->TempMin + Max);
+    Bucket->TempSum = (Bucket->TempMin + Avg) * Bucket->Count;
+
+    if (End - In < 2)
+      return 0;
+    Bucket->HumMin = (uint16_t)(In[0] | (In[1] << 8));
+    In += 2;
+    if (!(In = SHT1x_Rollup_GetVarint(In, End, &Max)) ||
+        !(In = SHT1x_Rollup_GetVarint(In, End, &Avg)))
+      return 0;
+    Bucket->HumMax = (uint16_t)(Bucket->HumMin + Max);
+    Bucket->HumSum = (Bucket->HumMin + Avg) * Bucket->Count;
+  }
+
+  return Count;
+}
@@ -0,0 +1,455 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_sched.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Conversion scheduler for several SHT1x sensors
+ *         Functionalities of the this file:
+ *          + Keep conversions of all sensors running at the same time
+ *          + Read results out in completion order
+ *          + Per-sensor sample period and missed deadline report
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)                          
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    
+ * of this software and associated documentation files (the "Software"), to deal   
+ * in the Software without restriction, including without limitation the rights    
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       
+ * copies of the Software, and to permit persons to whom the Software is           
+ * furnished to do so, subject to the following conditions:                        
+ *                                                                                 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "SHT1x_sched.h"
+#include <stddef.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+// Retry flags of a sensor
+#define SHT1X_SCHED_RETRIED       0x01  // A failed transfer was done again
+#define SHT1X_SCHED_RESEND        0x02  // Send the command after the timeout
+
+
+/* Private Macros ---------------------------------------------------------------*/
+#if (SHT1X_CONFIG_BUS_TUNING)
+  #define SHT1X_SCHED_HALF_US(Sensor)         SHT1x_BusHalfPeriod((Sensor)->Handler)
+#else
+  #define SHT1X_SCHED_HALF_US(Sensor)         0
+#endif
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static uint8_t
+SHT1x_Sched_Reached(uint32_t Now, uint32_t At)
+{
+  return ((int32_t)(Now - At) >= 0) ? 1 : 0;
+}
+
+static uint8_t
+SHT1x_Sched_Finish(SHT1x_Sched_t *Sched, uint8_t Index, SHT1x_Result_t Result,
+                   uint32_t Now)
+{
+  SHT1x_SchedSensor_t *Sensor = &Sched->Sensors[Index];
+  uint32_t Deadline;
+
+  Sensor->State = SHT1x_SchedIdle;
+  Sensor->Sweep = 0;
+  Sensor->Retry = 0;
+  Sensor->Result = Result;
+  Sensor->Samples++;
+  if (Result != SHT1x_OK)
+    Sensor->Errors++;
+
+  if (Sensor->PeriodMs)
+  {
+    // a sample must be completed before the next one is due
+    Deadline = Sensor->DueAt + Sensor->PeriodMs;
+    if ((int32_t)(Now - Deadline) > 0)
+    {
+      Sensor->Missed++;
+      Sensor->LateMs = Now - Deadline;
+    }
+
+    Sensor->DueAt = Deadline;
+    if (SHT1x_Sched_Reached(Now, Deadline))
+      Sensor->DueAt = Now; // do not try to catch up
+    Sensor->Due = 1;
+  }
+
+  if (Sched->OnSample)
+    Sched->OnSample(Index, Sensor);
+
+  return 1;
+}
+
+// a transfer that failed a check and slowed the bus down is done once more per
+// sample at the slower level. The sensor may have taken a failed command
+// anyway, so the command is sent again after the conversion timeout.
+static SHT1x_Result_t
+SHT1x_Sched_Start(SHT1x_SchedSensor_t *Sensor, SHT1x_Measurement_t Measurement,
+                  uint32_t Now)
+{
+  const uint8_t HalfUs = SHT1X_SCHED_HALF_US(Sensor);
+  uint16_t MaxMs;
+
+  Sensor->Retry &= ~SHT1X_SCHED_RESEND;
+  if (SHT1x_StartMeasurement(Sensor->Handler, Measurement) != SHT1x_OK)
+  {
+    if (Sensor->Retry || SHT1X_SCHED_HALF_US(Sensor) == HalfUs)
+      return SHT1x_FAIL;
+    Sensor->Retry = SHT1X_SCHED_RETRIED | SHT1X_SCHED_RESEND;
+  }
+
+  SHT1x_GetConversionTime(Sensor->Handler, Measurement, &Sensor->MinMs, &MaxMs);
+  Sensor->TimeoutMs = (uint16_t)((uint32_t)MaxMs * SHT1X_SCHED_TIMEOUT_PERCENT / 100);
+  if (Sensor->Retry & SHT1X_SCHED_RESEND)
+    Sensor->MinMs = Sensor->TimeoutMs;
+  Sensor->StartedAt = Now;
+  Sensor->State = (Measurement == SHT1x_MeasureHumidity) ?
+                  SHT1x_SchedHumidity : SHT1x_SchedTemperature;
+
+  return SHT1x_OK;
+}
+
+static uint8_t
+SHT1x_Sched_Service(SHT1x_Sched_t *Sched, uint8_t Index)
+{
+  SHT1x_SchedSensor_t *Sensor = &Sched->Sensors[Index];
+  uint32_t Now = Sched->GetTimeMs();
+  uint16_t Raw;
+  uint8_t HalfUs;
+
+  switch (Sensor->State)
+  {
+  case SHT1x_SchedIdle:
+    if (!Sensor->Due || !SHT1x_Sched_Reached(Now, Sensor->DueAt))
+      break;
+
+    Sensor->Due = 0;
+#if (SHT1X_CONFIG_TIMESTAMPS)
+    Sensor->Sample.CommandTime = Sensor->Handler->GetTime();
+#endif
+    if (SHT1x_Sched_Start(Sensor, SHT1x_MeasureHumidity, Now) != SHT1x_OK)
+      return SHT1x_Sched_Finish(Sched, Index, SHT1x_FAIL, Now);
+    break;
+
+  case SHT1x_SchedHumidity:
+  case SHT1x_SchedTemperature:
+    // DATA is not looked at before the earliest end of conversion
+    if ((Now - Sensor->StartedAt) < Sensor->MinMs)
+      break;
+
+    if (Sensor->Retry & SHT1X_SCHED_RESEND)
+    {
+      if (SHT1x_Sched_Start(Sensor, (Sensor->State == SHT1x_SchedHumidity) ?
+                            SHT1x_MeasureHumidity : SHT1x_MeasureTemperature,
+                            Now) != SHT1x_OK)
+        return SHT1x_Sched_Finish(Sched, Index, SHT1x_FAIL, Now);
+      break;
+    }
+
+    if (!SHT1x_IsResultReady(Sensor->Handler))
+    {
+      if ((Now - Sensor->StartedAt) > Sensor->TimeoutMs)
+        return SHT1x_Sched_Finish(Sched, Index, SHT1x_TIME_OUT, Now);
+      break;
+    }
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+    Sensor->Sample.ConversionTime = Sensor->Handler->GetTime();
+#endif
+    HalfUs = SHT1X_SCHED_HALF_US(Sensor);
+    if (SHT1x_ReadResult(Sensor->Handler, &Raw) != SHT1x_OK)
+    {
+      if (Sensor->Retry || SHT1X_SCHED_HALF_US(Sensor) == HalfUs)
+        return SHT1x_Sched_Finish(Sched, Index, SHT1x_FAIL, Now);
+
+      Sensor->Retry = SHT1X_SCHED_RETRIED;
+      if (SHT1x_Sched_Start(Sensor, (Sensor->State == SHT1x_SchedHumidity) ?
+                            SHT1x_MeasureHumidity : SHT1x_MeasureTemperature,
+                            Now) != SHT1x_OK)
+        return SHT1x_Sched_Finish(Sched, Index, SHT1x_FAIL, Now);
+      break;
+    }
+
+    if (Sensor->State == SHT1x_SchedHumidity)
+    {
+      Sensor->Sample.HumRaw = Raw;
+      if (SHT1x_Sched_Start(Sensor, SHT1x_MeasureTemperature, Now) != SHT1x_OK)
+        return SHT1x_Sched_Finish(Sched, Index, SHT1x_FAIL, Now);
+      break;
+    }
+
+    Sensor->Sample.TempRaw = Raw;
+#if (SHT1X_CONFIG_TIMESTAMPS)
+    Sensor->Sample.ReadoutTime = Sensor->Handler->GetTime();
+    SHT1x_RecordHistogram(Sensor->Handler, &Sensor->Sample);
+#endif
+    SHT1x_ConvertSample(Sensor->Handler, &Sensor->Sample);
+    return SHT1x_Sched_Finish(Sched, Index, SHT1x_OK, Now);
+
+  default:
+    Sensor->State = SHT1x_SchedIdle;
+    break;
+  }
+
+  return 0;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the scheduler. Handlers must be initialized with SHT1x_Init
+ *         and PeriodMs of every sensor set before calling this function.
+ *         Periodic sensors are due immediately.
+ * @param  Sched: Pointer to scheduler
+ * @param  Sensors: Array of sensors
+ * @param  Count: Number of sensors
+ * @param  GetTimeMs: Millisecond time base
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters.
+ */
+SHT1x_Result_t
+SHT1x_Sched_Init(SHT1x_Sched_t *Sched, SHT1x_SchedSensor_t *Sensors,
+                 uint8_t Count, uint32_t (*GetTimeMs)(void))
+{
+  uint32_t Now;
+
+  if (!Sched || !Sensors || !Count || !GetTimeMs)
+    return SHT1x_FAIL;
+
+  Sched->Sensors = Sensors;
+  Sched->Count = Count;
+  Sched->GetTimeMs = GetTimeMs;
+  Sched->OnSample = NULL;
+  Sched->Next = 0;
+
+  Now = GetTimeMs();
+  for (uint8_t i = 0; i < Count; i++)
+  {
+    if (!Sensors[i].Handler)
+      return SHT1x_FAIL;
+
+    Sensors[i].Result = SHT1x_OK;
+    Sensors[i].Samples = 0;
+    Sensors[i].Errors = 0;
+    Sensors[i].Missed = 0;
+    Sensors[i].LateMs = 0;
+    Sensors[i].State = SHT1x_SchedIdle;
+    Sensors[i].Sweep = 0;
+    Sensors[i].Retry = 0;
+    Sensors[i].Due = Sensors[i].PeriodMs ? 1 : 0;
+    Sensors[i].DueAt = Now;
+    Sensors[i].StartedAt = Now;
+    Sensors[i].MinMs = 0;
+    Sensors[i].TimeoutMs = 0;
+  }
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Request a sample from one sensor, regardless of its period.
+ * @param  Sched: Pointer to scheduler
+ * @param  Index: Index of the sensor
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index.
+ */
+SHT1x_Result_t
+SHT1x_Sched_Trigger(SHT1x_Sched_t *Sched, uint8_t Index)
+{
+  if (Index >= Sched->Count)
+    return SHT1x_FAIL;
+
+  Sched->Sensors[Index].Due = 1;
+  Sched->Sensors[Index].DueAt = Sched->GetTimeMs();
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Change the sample period of one sensor. The next sample of a waiting
+ *         sensor moves to one new period after the start of the last one, so
+ *         it may be called from OnSample to adapt the period to every sample.
+ *         A sensor that was not periodic is due immediately; with 0, a sample
+ *         that is already due is still taken.
+ * @param  Sched: Pointer to scheduler
+ * @param  Index: Index of the sensor
+ * @param  PeriodMs: Sample period (0: only on SHT1x_Sched_Trigger)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index.
+ */
+SHT1x_Result_t
+SHT1x_Sched_SetPeriod(SHT1x_Sched_t *Sched, uint8_t Index, uint32_t PeriodMs)
+{
+  SHT1x_SchedSensor_t *Sensor;
+
+  if (Index >= Sched->Count)
+    return SHT1x_FAIL;
+
+  Sensor = &Sched->Sensors[Index];
+  if (Sensor->State == SHT1x_SchedIdle && PeriodMs)
+  {
+    if (!Sensor->PeriodMs && !Sensor->Due)
+    {
+      Sensor->Due = 1;
+      Sensor->DueAt = Sched->GetTimeMs();
+    }
+    else if (Sensor->PeriodMs && Sensor->Due)
+    {
+      Sensor->DueAt += PeriodMs - Sensor->PeriodMs;
+    }
+  }
+  Sensor->PeriodMs = PeriodMs;
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Service all sensors once without blocking: start conversions that are
+ *         due and read out the sensors whose result is ready.
+ * @param  Sched: Pointer to scheduler
+ * @retval Number of samples completed in this call
+ */
+uint8_t
+SHT1x_Sched_Poll(SHT1x_Sched_t *Sched)
+{
+  uint8_t Completed = 0;
+  uint8_t Index = Sched->Next;
+
+  // rotate the first sensor so that no sensor waits behind the others forever
+  for (uint8_t i = 0; i < Sched->Count; i++)
+  {
+    Completed += SHT1x_Sched_Service(Sched, Index);
+    if (++Index >= Sched->Count)
+      Index = 0;
+  }
+
+  if (++Sched->Next >= Sched->Count)
+    Sched->Next = 0;
+
+  return Completed;
+}
+
+
+/**
+ * @brief  Time the caller may sleep before the next SHT1x_Sched_Poll.
+ * @param  Sched: Pointer to scheduler
+ * @retval 0: A conversion may be complete or a sample is due
+ *         0xFFFFFFFF: Nothing is scheduled
+ *         Otherwise: Milliseconds until the earliest end of a conversion or
+ *         until the next sample is due
+ */
+uint32_t
+SHT1x_Sched_IdleTime(SHT1x_Sched_t *Sched)
+{
+  uint32_t Now = Sched->GetTimeMs();
+  uint32_t Idle = 0xFFFFFFFF;
+  SHT1x_SchedSensor_t *Sensor;
+
+  for (uint8_t i = 0; i < Sched->Count; i++)
+  {
+    Sensor = &Sched->Sensors[i];
+    if (Sensor->State != SHT1x_SchedIdle)
+    {
+      if ((Now - Sensor->StartedAt) >= Sensor->MinMs)
+        return 0;
+      if ((Sensor->StartedAt + Sensor->MinMs - Now) < Idle)
+        Idle = Sensor->StartedAt + Sensor->MinMs - Now;
+      continue;
+    }
+    if (!Sensor->Due)
+      continue;
+    if (SHT1x_Sched_Reached(Now, Sensor->DueAt))
+      return 0;
+    if ((Sensor->DueAt - Now) < Idle)
+      Idle = Sensor->DueAt - Now;
+  }
+
+  return Idle;
+}
+
+
+/**
+ * @brief  Sample all sensors once and wait for the results. Conversions of all
+ *         sensors run concurrently. The delay function of the first sensor
+ *         is used while no result can be ready, and between the polls of the
+ *         conversions that may end (SHT1X_SCHED_POLL_MS).
+ * @param  Sched: Pointer to scheduler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: All samples were successful.
+ *         - SHT1x_FAIL: At least one sample failed. Check Result of sensors.
+ */
+SHT1x_Result_t
+SHT1x_Sched_Sweep(SHT1x_Sched_t *Sched)
+{
+  uint8_t Pending;
+  uint8_t Completed;
+  uint32_t Idle;
+  SHT1x_Result_t Result = SHT1x_OK;
+  SHT1x_SchedSensor_t *Sensor;
+
+  for (uint8_t i = 0; i < Sched->Count; i++)
+  {
+    Sched->Sensors[i].Sweep = 1;
+    if (Sched->Sensors[i].State == SHT1x_SchedIdle)
+      SHT1x_Sched_Trigger(Sched, i);
+  }
+
+  do
+  {
+    Completed = SHT1x_Sched_Poll(Sched);
+
+    // sleep through the part of the conversions where no result can be ready,
+    // then poll the conversions that may end any moment at SHT1X_SCHED_POLL_MS
+    Idle = SHT1x_Sched_IdleTime(Sched);
+    if (!Idle && !Completed)
+      Idle = SHT1X_SCHED_POLL_MS;
+    if (Idle && Idle != 0xFFFFFFFF)
+      SHT1x_Sleep(Sched->Sensors[0].Handler, Idle);
+
+    Pending = 0;
+    for (uint8_t i = 0; i < Sched->Count; i++)
+      Pending |= Sched->Sensors[i].Sweep;
+  } while (Pending);
+
+  for (uint8_t i = 0; i < Sched->Count; i++)
+  {
+    Sensor = &Sched->Sensors[i];
+    if (Sensor->Result != SHT1x_OK)
+      Result = SHT1x_FAIL;
+  }
+
+  return Result;
+}
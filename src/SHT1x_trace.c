@@ -0,0 +1,517 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_trace.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Bus waveform capture for SHT1x driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)                          
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    
+ * of this software and associated documentation files (the "Software"), to deal   
+ * in the Software without restriction, including without limitation the rights    
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       
+ * copies of the Software, and to permit persons to whom the Software is           
+ * furnished to do so, subject to the following conditions:                        
+ *                                                                                 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "SHT1x_trace.h"
+#include <stddef.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+#define SHT1X_TRACE_STATE_MASK  0x0F
+#define SHT1X_TRACE_VERSION     1
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct SHT1x_Trace_s
+{
+  SHT1x_Handler_t Inner;
+  uint32_t (*GetTime)(void);
+  uint32_t *Buffer;
+  uint16_t Size;
+  uint16_t Head;
+  uint16_t Count;
+  uint32_t Lost;
+  uint8_t  State;
+  uint8_t  Mode;
+} SHT1x_Trace_t;
+
+typedef struct SHT1x_TraceReader_s
+{
+  const uint32_t *Ring;
+  uint16_t RingSize;
+  uint16_t RingFirst;
+  const uint8_t *Bin;
+  uint32_t Count;
+} SHT1x_TraceReader_t;
+
+
+/* Private Variables ------------------------------------------------------------*/
+static SHT1x_Trace_t SHT1x_Trace = {0};
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static void
+SHT1x_Trace_Record(uint8_t Flags)
+{
+  uint32_t Word = (SHT1x_Trace.GetTime() << SHT1X_TRACE_TIME_SHIFT) |
+                  SHT1x_Trace.State | Flags;
+
+  if (SHT1x_Trace.Count == SHT1x_Trace.Size)
+  {
+    SHT1x_Trace.Lost++;
+    if (SHT1x_Trace.Mode == SHT1x_TraceStop)
+      return;
+  }
+  else
+  {
+    SHT1x_Trace.Count++;
+  }
+
+  SHT1x_Trace.Buffer[SHT1x_Trace.Head] = Word;
+  if (++SHT1x_Trace.Head == SHT1x_Trace.Size)
+    SHT1x_Trace.Head = 0;
+}
+
+static void
+SHT1x_Trace_Update(uint8_t Bit, uint8_t Level)
+{
+  uint8_t State = Level ? (SHT1x_Trace.State | Bit) : (SHT1x_Trace.State & ~Bit);
+
+  if (State != SHT1x_Trace.State)
+  {
+    SHT1x_Trace.State = State;
+    SHT1x_Trace_Record(0);
+  }
+}
+
+
+/* Shim callbacks ---------------------------------------------------------------*/
+static void
+SHT1x_Trace_DataConfigDir(uint8_t Dir)
+{
+  SHT1x_Trace.Inner.DataConfigDir(Dir);
+  SHT1x_Trace_Update(SHT1X_TRACE_DATA_DIR, Dir);
+}
+
+static void
+SHT1x_Trace_DataWrite(uint8_t Level)
+{
+  SHT1x_Trace.Inner.DataWrite(Level);
+  SHT1x_Trace_Update(SHT1X_TRACE_DATA_OUT, Level);
+}
+
+static uint8_t
+SHT1x_Trace_DataRead(void)
+{
+  uint8_t Level = SHT1x_Trace.Inner.DataRead();
+
+  SHT1x_Trace.State = Level ? (SHT1x_Trace.State | SHT1X_TRACE_DATA_IN) :
+                              (SHT1x_Trace.State & ~SHT1X_TRACE_DATA_IN);
+  SHT1x_Trace_Record(SHT1X_TRACE_SAMPLE);
+
+  return Level;
+}
+
+static uint8_t
+SHT1x_Trace_WaitDataLow(uint16_t TimeoutMs)
+{
+  uint8_t Low = SHT1x_Trace.Inner.WaitDataLow(TimeoutMs);
+
+  SHT1x_Trace.State = Low ? (SHT1x_Trace.State & ~SHT1X_TRACE_DATA_IN) :
+                            (SHT1x_Trace.State | SHT1X_TRACE_DATA_IN);
+  SHT1x_Trace_Record(SHT1X_TRACE_SAMPLE);
+
+  return Low;
+}
+
+static void
+SHT1x_Trace_SckWrite(uint8_t Level)
+{
+  SHT1x_Trace.Inner.SckWrite(Level);
+  SHT1x_Trace_Update(SHT1X_TRACE_SCK, Level);
+}
+
+static void
+SHT1x_Trace_PlatformInit(void)
+{
+  if (SHT1x_Trace.Inner.PlatformInit)
+    SHT1x_Trace.Inner.PlatformInit();
+
+  // Platform layers configure both pins as low outputs
+  SHT1x_Trace.State = SHT1X_TRACE_DATA_DIR;
+  SHT1x_Trace_Record(0);
+}
+
+
+/* Output -----------------------------------------------------------------------*/
+static uint8_t
+SHT1x_Trace_Utoa(uint64_t Value, char *Str)
+{
+  char Tmp[20];
+  uint8_t Len = 0;
+  uint8_t i = 0;
+
+  do
+  {
+    Tmp[Len++] = '0' + (char)(Value % 10);
+    Value /= 10;
+  } while (Value);
+
+  while (Len)
+    Str[i++] = Tmp[--Len];
+
+  return i;
+}
+
+static void
+SHT1x_Trace_WriteStr(SHT1x_TraceWrite_t Write, const char *Str)
+{
+  uint16_t Len = 0;
+
+  while (Str[Len])
+    Len++;
+
+  Write((const uint8_t *)Str, Len);
+}
+
+static void
+SHT1x_Trace_PutLE32(uint8_t *Data, uint32_t Value)
+{
+  Data[0] = Value & 0xFF;
+  Data[1] = (Value >> 8) & 0xFF;
+  Data[2] = (Value >> 16) & 0xFF;
+  Data[3] = (Value >> 24) & 0xFF;
+}
+
+static uint32_t
+SHT1x_Trace_GetLE32(const uint8_t *Data)
+{
+  return (uint32_t)Data[0] | ((uint32_t)Data[1] << 8) |
+         ((uint32_t)Data[2] << 16) | ((uint32_t)Data[3] << 24);
+}
+
+static uint32_t
+SHT1x_Trace_ReadWord(const SHT1x_TraceReader_t *Reader, uint32_t Index)
+{
+  uint32_t Pos;
+
+  if (Reader->Bin)
+    return SHT1x_Trace_GetLE32(&Reader->Bin[Index * 4]);
+
+  Pos = Reader->RingFirst + Index;
+  if (Pos >= Reader->RingSize)
+    Pos -= Reader->RingSize;
+
+  return Reader->Ring[Pos];
+}
+
+static void
+SHT1x_Trace_SetReaderRing(SHT1x_TraceReader_t *Reader)
+{
+  uint16_t First = SHT1x_Trace.Head;
+
+  if (SHT1x_Trace.Count < SHT1x_Trace.Size)
+    First = (SHT1x_Trace.Head >= SHT1x_Trace.Count) ?
+            SHT1x_Trace.Head - SHT1x_Trace.Count :
+            SHT1x_Trace.Head + SHT1x_Trace.Size - SHT1x_Trace.Count;
+
+  Reader->Ring = SHT1x_Trace.Buffer;
+  Reader->RingSize = SHT1x_Trace.Size;
+  Reader->RingFirst = First;
+  Reader->Bin = NULL;
+  Reader->Count = SHT1x_Trace.Count;
+}
+
+static void
+SHT1x_Trace_WriteVcd(const SHT1x_TraceReader_t *Reader, SHT1x_TraceWrite_t Write,
+                     uint32_t TickPs)
+{
+  const uint32_t TimeMask = 0xFFFFFFFFUL >> SHT1X_TRACE_TIME_SHIFT;
+  char Line[48];
+  uint8_t Len;
+  uint8_t Prev = 0;
+  uint32_t PrevTick = 0;
+  uint64_t Ticks = 0;
+
+  SHT1x_Trace_WriteStr(Write,
+    "$timescale 1 ns $end\n"
+    "$scope module sht1x $end\n"
+    "$var wire 1 ! sck $end\n"
+    "$var wire 1 \" data_master $end\n"
+    "$var wire 1 # data_dir $end\n"
+    "$var wire 1 $ data_in $end\n"
+    "$var event 1 % sample $end\n"
+    "$upscope $end\n"
+    "$enddefinitions $end\n");
+
+  for (uint32_t i = 0; i < Reader->Count; i++)
+  {
+    const uint32_t Word = SHT1x_Trace_ReadWord(Reader, i);
+    const uint32_t Tick = (Word >> SHT1X_TRACE_TIME_SHIFT) & TimeMask;
+    const uint8_t State = Word & SHT1X_TRACE_STATE_MASK;
+    const uint8_t Changed = (i == 0) ? SHT1X_TRACE_STATE_MASK : (State ^ Prev);
+
+    if (i)
+      Ticks += (Tick - PrevTick) & TimeMask;
+    PrevTick = Tick;
+
+    Line[0] = '#';
+    Len = 1 + SHT1x_Trace_Utoa(Ticks * TickPs / 1000, &Line[1]);
+    Line[Len++] = '\n';
+
+    if (Changed & SHT1X_TRACE_SCK)
+    {
+      Line[Len++] = (State & SHT1X_TRACE_SCK) ? '1' : '0';
+      Line[Len++] = '!';
+      Line[Len++] = '\n';
+    }
+    if (Changed & (SHT1X_TRACE_DATA_OUT | SHT1X_TRACE_DATA_DIR))
+    {
+      if (!(State & SHT1X_TRACE_DATA_DIR))
+        Line[Len++] = 'z';
+      else
+        Line[Len++] = (State & SHT1X_TRACE_DATA_OUT) ? '1' : '0';
+      Line[Len++] = '"';
+      Line[Len++] = '\n';
+    }
+    if (Changed & SHT1X_TRACE_DATA_DIR)
+    {
+      Line[Len++] = (State & SHT1X_TRACE_DATA_DIR) ? '1' : '0';
+      Line[Len++] = '#';
+      Line[Len++] = '\n';
+    }
+    if (Changed & SHT1X_TRACE_DATA_IN)
+    {
+      Line[Len++] = (State & SHT1X_TRACE_DATA_IN) ? '1' : '0';
+      Line[Len++] = '$';
+      Line[Len++] = '\n';
+    }
+    if (Word & SHT1X_TRACE_SAMPLE)
+    {
+      Line[Len++] = '1';
+      Line[Len++] = '%';
+      Line[Len++] = '\n';
+    }
+
+    Write((const uint8_t *)Line, Len);
+    Prev = State;
+  }
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Insert the tracing shim between the driver and the platform callbacks
+ *         of Handler. Call after the platform part of Handler is initialized.
+ * @note   There is a single trace instance because the handler callbacks do not
+ *         carry a context pointer.
+ * @param  Handler: Pointer to handler
+ * @param  Buffer: Preallocated event buffer
+ * @param  Size: Number of events in Buffer
+ * @param  GetTime: Free-running timestamp counter
+ * @param  Mode: Behavior when the buffer is full
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters or trace already attached.
+ */
+SHT1x_Result_t
+SHT1x_Trace_Attach(SHT1x_Handler_t *Handler, uint32_t *Buffer, uint16_t Size,
+                   uint32_t (*GetTime)(void), SHT1x_TraceMode_t Mode)
+{
+  if (!Buffer || !Size || !GetTime || SHT1x_Trace.Buffer)
+    return SHT1x_FAIL;
+
+  SHT1x_Trace.Inner = *Handler;
+  SHT1x_Trace.GetTime = GetTime;
+  SHT1x_Trace.Buffer = Buffer;
+  SHT1x_Trace.Size = Size;
+  SHT1x_Trace.Mode = Mode;
+  SHT1x_Trace.State = SHT1X_TRACE_DATA_DIR;
+  SHT1x_Trace_Clear();
+
+  Handler->PlatformInit = SHT1x_Trace_PlatformInit;
+  Handler->DataConfigDir = SHT1x_Trace_DataConfigDir;
+  Handler->DataWrite = SHT1x_Trace_DataWrite;
+  Handler->DataRead = SHT1x_Trace_DataRead;
+  Handler->SckWrite = SHT1x_Trace_SckWrite;
+  if (Handler->WaitDataLow)
+    Handler->WaitDataLow = SHT1x_Trace_WaitDataLow;
+#if (SHT1X_CONFIG_WAVEFORM)
+  // drive the pins one by one so that every edge is recorded
+  Handler->EmitWaveform = NULL;
+#endif
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Restore the original callbacks of Handler.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_Trace_Detach(SHT1x_Handler_t *Handler)
+{
+  if (!SHT1x_Trace.Buffer)
+    return SHT1x_OK;
+
+  Handler->PlatformInit = SHT1x_Trace.Inner.PlatformInit;
+  Handler->DataConfigDir = SHT1x_Trace.Inner.DataConfigDir;
+  Handler->DataWrite = SHT1x_Trace.Inner.DataWrite;
+  Handler->DataRead = SHT1x_Trace.Inner.DataRead;
+  Handler->SckWrite = SHT1x_Trace.Inner.SckWrite;
+  Handler->WaitDataLow = SHT1x_Trace.Inner.WaitDataLow;
+#if (SHT1X_CONFIG_WAVEFORM)
+  Handler->EmitWaveform = SHT1x_Trace.Inner.EmitWaveform;
+#endif
+  SHT1x_Trace.Buffer = NULL;
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Discard the recorded events.
+ * @retval None
+ */
+void
+SHT1x_Trace_Clear(void)
+{
+  SHT1x_Trace.Head = 0;
+  SHT1x_Trace.Count = 0;
+  SHT1x_Trace.Lost = 0;
+}
+
+
+/**
+ * @brief  Number of recorded events.
+ * @param  Lost: Pointer to get the number of lost events (can be NULL)
+ * @retval Number of events in the buffer
+ */
+uint16_t
+SHT1x_Trace_Count(uint32_t *Lost)
+{
+  if (Lost)
+    *Lost = SHT1x_Trace.Lost;
+
+  return SHT1x_Trace.Count;
+}
+
+
+/**
+ * @brief  Write the recorded events as VCD.
+ * @param  Write: Output function
+ * @param  TickPs: Duration of one GetTime unit in picoseconds
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Trace is not attached.
+ */
+SHT1x_Result_t
+SHT1x_Trace_DumpVcd(SHT1x_TraceWrite_t Write, uint32_t TickPs)
+{
+  SHT1x_TraceReader_t Reader;
+
+  if (!SHT1x_Trace.Buffer)
+    return SHT1x_FAIL;
+
+  SHT1x_Trace_SetReaderRing(&Reader);
+  SHT1x_Trace_WriteVcd(&Reader, Write, TickPs);
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Write the recorded events as compact binary. Convert it to VCD with
+ *         SHT1x_Trace_BinaryToVcd.
+ * @param  Write: Output function
+ * @param  TickPs: Duration of one GetTime unit in picoseconds
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Trace is not attached.
+ */
+SHT1x_Result_t
+SHT1x_Trace_DumpBinary(SHT1x_TraceWrite_t Write, uint32_t TickPs)
+{
+  SHT1x_TraceReader_t Reader;
+  uint8_t Data[SHT1X_TRACE_HEADER_SIZE] = {'S', 'H', 'T', 'T', SHT1X_TRACE_VERSION};
+
+  if (!SHT1x_Trace.Buffer)
+    return SHT1x_FAIL;
+
+  SHT1x_Trace_SetReaderRing(&Reader);
+
+  // Header: magic, version, 3 reserved bytes, TickPs, event count
+  SHT1x_Trace_PutLE32(&Data[8], TickPs);
+  SHT1x_Trace_PutLE32(&Data[12], Reader.Count);
+  Write(Data, SHT1X_TRACE_HEADER_SIZE);
+
+  for (uint32_t i = 0; i < Reader.Count; i++)
+  {
+    SHT1x_Trace_PutLE32(Data, SHT1x_Trace_ReadWord(&Reader, i));
+    Write(Data, 4);
+  }
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Convert a compact binary dump to VCD.
+ * @param  Data: Binary dump
+ * @param  Len: Length of Data
+ * @param  Write: Output function
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Data is not a valid dump.
+ */
+SHT1x_Result_t
+SHT1x_Trace_BinaryToVcd(const uint8_t *Data, uint32_t Len, SHT1x_TraceWrite_t Write)
+{
+  SHT1x_TraceReader_t Reader = {0};
+
+  if (Len < SHT1X_TRACE_HEADER_SIZE ||
+      Data[0] != 'S' || Data[1] != 'H' || Data[2] != 'T' || Data[3] != 'T' ||
+      Data[4] != SHT1X_TRACE_VERSION)
+    return SHT1x_FAIL;
+
+  Reader.Bin = &Data[SHT1X_TRACE_HEADER_SIZE];
+  Reader.Count = SHT1x_Trace_GetLE32(&Data[12]);
+  if ((Len - SHT1X_TRACE_HEADER_SIZE) / 4 < Reader.Count)
+    return SHT1x_FAIL;
+
+  SHT1x_Trace_WriteVcd(&Reader, Write, SHT1x_Trace_GetLE32(&Data[8]));
+
+  return SHT1x_OK;
+}
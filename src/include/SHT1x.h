@@ -65,6 +65,92 @@ extern "C"
   #define SHT1X_CONFIG_INTERNAL_HEATER_CONTROL 1
 #endif
 
+#ifndef SHT1X_CONFIG_INSTRUMENTATION
+  #define SHT1X_CONFIG_INSTRUMENTATION 0
+#endif
+
+#ifndef SHT1X_CONFIG_TIMESTAMPS
+  #define SHT1X_CONFIG_TIMESTAMPS 0
+#endif
+
+#ifndef SHT1X_CONFIG_STREAM
+  #define SHT1X_CONFIG_STREAM 0
+#endif
+
+#ifndef SHT1X_CONFIG_CRC_CHECK
+  #define SHT1X_CONFIG_CRC_CHECK 0
+#endif
+
+#ifndef SHT1X_CONFIG_REPORT
+  #define SHT1X_CONFIG_REPORT 0
+#endif
+
+#ifndef SHT1X_CONFIG_BUS_TUNING
+  #define SHT1X_CONFIG_BUS_TUNING 0
+#endif
+
+#ifndef SHT1X_CONFIG_WAVEFORM
+  #define SHT1X_CONFIG_WAVEFORM 0
+#endif
+
+#ifndef SHT1X_CONFIG_STATIC_PORT
+  #define SHT1X_CONFIG_STATIC_PORT 0
+#endif
+
+#if (SHT1X_CONFIG_BUS_TUNING) && !(SHT1X_CONFIG_CRC_CHECK)
+  #error "SHT1X_CONFIG_BUS_TUNING needs SHT1X_CONFIG_CRC_CHECK"
+#endif
+
+
+/* Exported Constants -----------------------------------------------------------*/
+#if (SHT1X_CONFIG_TIMESTAMPS)
+/**
+ * @brief  Number of buckets of the latency histogram. Bucket 0 counts a latency
+ *         of 0, bucket n counts latencies in [2^(n-1), 2^n) units of GetTime.
+ */
+#define SHT1X_HISTOGRAM_BUCKETS 33
+#endif
+
+#if (SHT1X_CONFIG_BUS_TUNING)
+/**
+ * @brief  Number of bus speed levels. Level n has an SCK half period of
+ *         1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48 or 64 us; level 3 is the
+ *         fixed timing of the driver and the starting point.
+ */
+#define SHT1X_BUS_LEVELS        12
+#define SHT1X_BUS_LEVEL_DEFAULT 3
+
+/**
+ * @brief  Fastest level the tuner may select, e.g. to keep a margin on a
+ *         bus without CRC, where not every misread is caught
+ */
+#ifndef SHT1X_BUS_FASTEST
+#define SHT1X_BUS_FASTEST       0
+#endif
+
+/**
+ * @brief  Clean transfers before a faster level is tried. Every failed try
+ *         doubles the wait, up to SHT1X_BUS_HOLD_MAX.
+ */
+#ifndef SHT1X_BUS_HOLD
+#define SHT1X_BUS_HOLD          32
+#endif
+
+#ifndef SHT1X_BUS_HOLD_MAX
+#define SHT1X_BUS_HOLD_MAX      32768
+#endif
+#endif
+
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  Pins of a waveform step
+ */
+#define SHT1X_WAVE_SCK      0x01  // SCK level
+#define SHT1X_WAVE_DATA     0x02  // DATA level while DATA is driven
+#define SHT1X_WAVE_RELEASE  0x04  // DATA is an input (pulled up)
+#define SHT1X_WAVE_SAMPLE   0x08  // Read DATA at the end of the step
+#endif
+
 
 /* Exported Data Types ----------------------------------------------------------*/
 /**
@@ -76,6 +162,108 @@ typedef enum SHT1x_Resolution_e
   SHT1x_HighResolution = 1
 } SHT1x_Resolution_t;
 
+#if (SHT1X_CONFIG_WAVEFORM)
+/**
+ * @brief  One step of a waveform: set SCK, then DATA, hold them for DelayUs
+ *         and read DATA if Pins has SHT1X_WAVE_SAMPLE.
+ * @note   SCK and DATA change together only on a falling SCK edge. Ports that
+ *         write both pins at once must keep 10 ns between the two (tHO).
+ */
+typedef struct SHT1x_WaveStep_s
+{
+  uint8_t Pins;
+  uint8_t DelayUs;
+} SHT1x_WaveStep_t;
+#endif
+
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+/**
+ * @brief  Phases of a measurement transaction
+ */
+typedef enum SHT1x_Phase_e
+{
+  SHT1x_PhaseCommand = 0,   // Start sequence, command and ACK
+  SHT1x_PhaseWait = 1,      // Waiting for the end of conversion
+  SHT1x_PhaseReadout = 2,   // Shift-in of the result
+  SHT1x_PhaseCount
+} SHT1x_Phase_t;
+
+/**
+ * @brief  Latency statistics of one phase (units of GetTime)
+ */
+typedef struct SHT1x_Latency_s
+{
+  uint32_t Min;
+  uint32_t Max;
+  uint32_t Count;
+  uint64_t Sum;
+} SHT1x_Latency_t;
+
+/**
+ * @brief  Instrumentation data
+ */
+typedef struct SHT1x_Stats_s
+{
+  SHT1x_Latency_t Phase[SHT1x_PhaseCount];
+  uint32_t Nacks;           // Commands or writes not acknowledged by sensor
+  uint32_t Timeouts;        // Conversions that did not complete in time
+  uint32_t PollIterations;  // DATA reads while waiting for conversion
+  uint32_t EdgeWaits;       // WaitDataLow calls while waiting for conversion
+  uint32_t CrcErrors;       // Transfers with a wrong CRC (SHT1X_CONFIG_CRC_CHECK)
+} SHT1x_Stats_t;
+#endif
+
+/**
+ * @brief  Measurement data type
+ */
+typedef enum SHT1x_Measurement_e
+{
+  SHT1x_MeasureTemperature = 0,
+  SHT1x_MeasureHumidity = 1
+} SHT1x_Measurement_t;
+
+#if (SHT1X_CONFIG_STREAM)
+/**
+ * @brief  Streaming mode data type
+ */
+typedef enum SHT1x_StreamMode_e
+{
+  SHT1x_StreamAlternate = 0,    // Humidity, temperature, humidity, ...
+  SHT1x_StreamTemperature = 1,  // Temperature only
+  SHT1x_StreamHumidity = 2      // Humidity only
+} SHT1x_StreamMode_t;
+
+/**
+ * @brief  Streaming sink. Called with every raw result as soon as it is read;
+ *         the next measurement is already running. May call SHT1x_StreamStop.
+ */
+typedef void (*SHT1x_StreamSink_t)(void *Context, SHT1x_Measurement_t Measurement,
+                                   uint16_t Raw);
+
+/**
+ * @brief  Caller-provided buffer for streaming without a sink. Results are
+ *         shifted in directly to Raw[Count]; streaming stops when it is full.
+ */
+typedef struct SHT1x_StreamBuffer_s
+{
+  uint16_t *Raw;
+  uint32_t Size;
+  uint32_t Count;
+} SHT1x_StreamBuffer_t;
+#endif
+
+#if (SHT1X_CONFIG_BUS_TUNING)
+/**
+ * @brief  Bus speed settings to keep across restarts (e.g. in EEPROM)
+ */
+typedef struct SHT1x_BusTuning_s
+{
+  uint8_t  Level;     // Speed level (0: fastest)
+  uint8_t  Check;     // Check byte of the other fields
+  uint16_t Hold;      // Clean transfers before a faster level is tried
+} SHT1x_BusTuning_t;
+#endif
+
 /**
  * @brief  Handler data type
  * @note   User must initialize this this functions before using library:
@@ -91,13 +279,21 @@ typedef enum SHT1x_Resolution_e
  *         - SckWriteLow
  *         - DelayMs
  *         - DelayUs
+ * @note   WaitDataLow is optional. With SHT1X_CONFIG_STATIC_PORT it is used
+ *         if SHT1x_platform.h defines SHT1X_PORT_HAS_WAIT_DATA_LOW.
+ * @note   EmitWaveform is optional too (SHT1X_CONFIG_WAVEFORM), static ports
+ *         define SHT1X_PORT_HAS_EMIT_WAVEFORM.
+ * @note   The functions are not part of the handler when SHT1X_CONFIG_STATIC_PORT
+ *         is enabled; SHT1x_platform.h provides them instead.
  */
 typedef struct SHT1x_Handler_s
 {
   float D1Celsius;
   float D1Fahrenheit;
   SHT1x_Resolution_t ResolutionStatus;
+  uint8_t DataOutput;           // DATA is configured as output (private)
 
+#if (SHT1X_CONFIG_STATIC_PORT == 0)
   // Initialize the platform-dependent layer
   void (*PlatformInit)(void);
   // Uninitialize the platform-dependent layer
@@ -117,6 +313,71 @@ typedef struct SHT1x_Handler_s
   void (*DelayMs)(uint8_t);
   // Delay (us)
   void (*DelayUs)(uint8_t);
+
+  // Sleep until DATA is low or TimeoutMs passes, e.g. on the falling-edge
+  // interrupt of DATA (optional, DATA is polled if NULL). Return 1 if DATA
+  // is low, 0 on timeout.
+  uint8_t (*WaitDataLow)(uint16_t TimeoutMs);
+
+#if (SHT1X_CONFIG_WAVEFORM)
+  // Play Count steps of a waveform and store the DATA samples MSB first in
+  // Samples, which the caller zeroes (optional, the pins are driven one by
+  // one if NULL)
+  void (*EmitWaveform)(const SHT1x_WaveStep_t *Steps, uint8_t Count,
+                       uint8_t *Samples);
+#endif
+#endif
+
+#if (SHT1X_CONFIG_INSTRUMENTATION || SHT1X_CONFIG_TIMESTAMPS)
+  // Free-running cycle or us counter used for phase timing (wraps around)
+  uint32_t (*GetTime)(void);
+#endif
+
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+  SHT1x_Stats_t Stats;
+#endif
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+  // Command-to-data time of the samples
+  uint32_t Histogram[SHT1X_HISTOGRAM_BUCKETS];
+#endif
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+  // Last command and status register, they are part of the CRC (private)
+  uint8_t Command;
+  uint8_t StatusReg;
+#endif
+
+#if (SHT1X_CONFIG_STREAM)
+  // Streaming state (private)
+  SHT1x_StreamSink_t StreamSink;
+  void *StreamContext;
+  uint8_t StreamMode;
+  uint8_t StreamMeasurement;
+  volatile uint8_t StreamState;
+#endif
+
+#if (SHT1X_CONFIG_BUS_TUNING)
+  // Bus speed tuning state (private, see SHT1x_BusTuningGet)
+  uint8_t  BusLevel;
+  uint8_t  BusHalfUs;           // SCK half period of BusLevel
+  uint8_t  BusTrial;            // BusLevel has not passed its hold yet
+  uint8_t  BusResync;           // Reset the connection before the next command
+  uint16_t BusHold;
+  uint16_t BusClean;            // Clean transfers since the last change
+  uint32_t BusErrors;           // Transfers that failed a check
+#endif
+
+#if (SHT1X_CONFIG_REPORT)
+  // Report-by-exception state (private, see SHT1x_ReportConfig)
+  uint16_t ReportTempBand[2];   // Temperature deadband of each resolution (raw)
+  uint16_t ReportHumBand[2];    // Humidity deadband of each resolution (raw)
+  uint32_t ReportHeartbeatMs;
+  uint32_t ReportTimeMs;        // Time of the last reported sample
+  uint16_t ReportTempRaw;       // Raw values of the last reported sample
+  uint16_t ReportHumRaw;
+  uint8_t  ReportState;         // 0: nothing reported, else 1 + its resolution
+#endif
 } SHT1x_Handler_t;
 
 /**
@@ -129,6 +390,11 @@ typedef struct SHT1x_Sample_s
   float TempCelsius;
   float TempFahrenheit;
   float HumidityPercent;
+#if (SHT1X_CONFIG_TIMESTAMPS)
+  uint32_t CommandTime;     // First command issued (units of GetTime)
+  uint32_t ConversionTime;  // Last conversion complete
+  uint32_t ReadoutTime;     // Last result read
+#endif
 } SHT1x_Sample_t;
 
 /**
@@ -171,6 +437,276 @@ SHT1x_Result_t
 SHT1x_ReadSample(SHT1x_Handler_t *Handler, SHT1x_Sample_t *Sample);
 
 
+/**
+ * @brief  Send a measurement command and return without waiting for the
+ *         conversion. Use SHT1x_IsResultReady and SHT1x_ReadResult to get the
+ *         result, so other work (or other sensors) can be serviced meanwhile.
+ * @param  Handler: Pointer to handler
+ * @param  Measurement: Quantity to measure
+ *         - SHT1x_MeasureTemperature
+ *         - SHT1x_MeasureHumidity
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Conversion started.
+ *         - SHT1x_FAIL: Operation failed.
+ */
+SHT1x_Result_t
+SHT1x_StartMeasurement(SHT1x_Handler_t *Handler, SHT1x_Measurement_t Measurement);
+
+
+/**
+ * @brief  Check the end of the conversion started by SHT1x_StartMeasurement.
+ * @param  Handler: Pointer to handler
+ * @retval 1: Result is ready, 0: Conversion is in progress
+ */
+uint8_t
+SHT1x_IsResultReady(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Read the result of a finished conversion.
+ * @param  Handler: Pointer to handler
+ * @param  Raw: Pointer to raw temperature or humidity
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: CRC mismatch (SHT1X_CONFIG_CRC_CHECK only). With
+ *                       SHT1X_CONFIG_BUS_TUNING, a misread that made
+ *                       SHT1x_BusHalfPeriod grow is worth one more
+ *                       measurement, SHT1x_ReadSample does so.
+ */
+SHT1x_Result_t
+SHT1x_ReadResult(SHT1x_Handler_t *Handler, uint16_t *Raw);
+
+
+/**
+ * @brief  Conversion time of a measurement at the current resolution, from the
+ *         datasheet.
+ * @param  Handler: Pointer to handler
+ * @param  Measurement: Quantity to measure
+ * @param  MinMs: Pointer to earliest end of conversion (ms)
+ * @param  MaxMs: Pointer to latest end of conversion (ms)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_GetConversionTime(SHT1x_Handler_t *Handler, SHT1x_Measurement_t Measurement,
+                        uint16_t *MinMs, uint16_t *MaxMs);
+
+
+/**
+ * @brief  Sleep using the delay function of the handler. Long delays are split
+ *         into several calls of DelayMs.
+ * @param  Handler: Pointer to handler
+ * @param  Ms: Delay (ms)
+ * @retval None
+ */
+void
+SHT1x_Sleep(SHT1x_Handler_t *Handler, uint32_t Ms);
+
+
+#if (SHT1X_CONFIG_CRC_CHECK)
+/**
+ * @brief  CRC-8 (x^8 + x^5 + x^4 + 1) of a transfer as the sensor computes it
+ * @param  Seed: Status register, its lower nibble seeds the CRC
+ * @param  Data: Command and data bytes, in received order
+ * @param  Len: Number of bytes
+ * @retval CRC byte as received from the sensor
+ */
+uint8_t
+SHT1x_CRC8(uint8_t Seed, const uint8_t *Data, uint8_t Len);
+#endif
+
+
+/**
+ * @brief  Convert TempRaw and HumRaw of Sample to physical values, using the
+ *         resolution and supply voltage settings of Handler.
+ * @param  Handler: Pointer to handler
+ * @param  Sample: Pointer to sample structure
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_ConvertSample(SHT1x_Handler_t *Handler, SHT1x_Sample_t *Sample);
+
+
+
+#if (SHT1X_CONFIG_STREAM)
+/**
+ ==================================================================================
+                         ##### Streaming Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start streaming: issue the first measurement command and return.
+ *         SHT1x_StreamPoll or SHT1x_StreamRun reads each result, issues the
+ *         next command right away and hands the result to Sink.
+ * @param  Handler: Pointer to handler
+ * @param  Sink: Result callback, or NULL to store results in a buffer
+ * @param  Context: Argument of Sink, or pointer to SHT1x_StreamBuffer_t when
+ *         Sink is NULL
+ * @param  Mode: Alternate temperature and humidity or repeat one of them
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Operation failed.
+ */
+SHT1x_Result_t
+SHT1x_StreamStart(SHT1x_Handler_t *Handler, SHT1x_StreamSink_t Sink,
+                  void *Context, SHT1x_StreamMode_t Mode);
+
+
+/**
+ * @brief  Service the stream without blocking. When a result is ready it is
+ *         read, the next command is issued and the result is delivered.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The next command or a CRC check failed. Streaming is
+ *           stopped.
+ */
+SHT1x_Result_t
+SHT1x_StreamPoll(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Service the stream until SHT1x_StreamStop is called from the sink
+ *         or the buffer is full. Waits for conversions like SHT1x_ReadSample.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Streaming stopped.
+ *         - SHT1x_FAIL: A command or a CRC check failed.
+ *         - SHT1x_TIME_OUT: A conversion did not complete.
+ */
+SHT1x_Result_t
+SHT1x_StreamRun(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Stop streaming. From the sink, the conversion in progress is
+ *         discarded by the next SHT1x_StreamPoll or by SHT1x_StreamRun and
+ *         SHT1x_IsStreaming reports 1 until then. From outside, it is waited
+ *         for and discarded before returning.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_TIME_OUT: The conversion in progress did not complete.
+ */
+SHT1x_Result_t
+SHT1x_StreamStop(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Check if streaming is active
+ * @param  Handler: Pointer to handler
+ * @retval 1: Streaming, 0: Stopped
+ */
+uint8_t
+SHT1x_IsStreaming(SHT1x_Handler_t *Handler);
+#endif
+
+
+
+#if (SHT1X_CONFIG_REPORT)
+/**
+ ==================================================================================
+                     ##### Report-by-Exception Functions #####                     
+ ==================================================================================
+ */
+
+/**
+ * @brief  Set the deadbands and the heartbeat interval of report-by-exception.
+ *         The deadbands are converted to raw counts for both resolutions with
+ *         the d2 (temperature) and c2 (humidity) coefficients. The next sample
+ *         is always reported.
+ * @note   c2 is the slope of the humidity curve at its low end. Higher up one
+ *         count is worth less, so there the humidity deadband is narrower
+ *         than HumDeadbandP (about half of it at 100%RH).
+ * @param  Handler: Pointer to handler
+ * @param  TempDeadbandC: Temperature change to report (Celsius, 0: any change)
+ * @param  HumDeadbandP: Humidity change to report (%RH, 0: any change)
+ * @param  HeartbeatMs: Report a sample at least this often (0: never)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: A deadband is negative or too large.
+ */
+SHT1x_Result_t
+SHT1x_ReportConfig(SHT1x_Handler_t *Handler, float TempDeadbandC,
+                   float HumDeadbandP, uint32_t HeartbeatMs);
+
+
+/**
+ * @brief  Check whether a successful sample must be reported: its raw
+ *         temperature or humidity differs from the last reported sample by
+ *         more than the deadband, the heartbeat interval has expired, or the
+ *         resolution has changed since. A reported sample becomes the new
+ *         reference.
+ * @param  Handler: Pointer to handler
+ * @param  Sample: Pointer to sample of SHT1x_ReadSample
+ * @param  NowMs: Current time (ms, wraps around)
+ * @retval 1: Report the sample, 0: Skip it
+ */
+uint8_t
+SHT1x_ReportCheck(SHT1x_Handler_t *Handler, const SHT1x_Sample_t *Sample,
+                  uint32_t NowMs);
+
+
+/**
+ * @brief  Forget the last reported sample, so the next one is reported,
+ *         e.g. after the uplink lost a message.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_ReportReset(SHT1x_Handler_t *Handler);
+#endif
+
+
+
+#if (SHT1X_CONFIG_BUS_TUNING)
+/**
+ ==================================================================================
+                          ##### Bus Tuning Functions #####                         
+ ==================================================================================
+ */
+
+/**
+ * @brief  Get the bus speed settings of the handler, to restore them with
+ *         SHT1x_BusTuningSet after a restart. Store them when they differ
+ *         from the stored copy.
+ * @param  Handler: Pointer to handler
+ * @param  Tuning: Pointer to settings
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_BusTuningGet(SHT1x_Handler_t *Handler, SHT1x_BusTuning_t *Tuning);
+
+
+/**
+ * @brief  Restore bus speed settings of SHT1x_BusTuningGet, after SHT1x_Init.
+ *         The restored level has to pass its hold again before a faster one
+ *         is tried.
+ * @param  Handler: Pointer to handler
+ * @param  Tuning: Pointer to settings
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The settings are invalid (e.g. erased memory). The
+ *                       handler keeps its settings.
+ */
+SHT1x_Result_t
+SHT1x_BusTuningSet(SHT1x_Handler_t *Handler, const SHT1x_BusTuning_t *Tuning);
+
+
+/**
+ * @brief  Get the SCK half period of the current speed level.
+ * @param  Handler: Pointer to handler
+ * @retval Half period (us)
+ */
+uint8_t
+SHT1x_BusHalfPeriod(SHT1x_Handler_t *Handler);
+#endif
+
+
 
 /**
  ==================================================================================
@@ -292,6 +828,99 @@ SHT1x_SetPowVoltage(SHT1x_Handler_t *Handler, float Voltage);
 #endif
 
 
+#if (SHT1X_CONFIG_INSTRUMENTATION)
+/**
+ * @brief  Get instrumentation data of the handler.
+ * @param  Handler: Pointer to handler
+ * @param  Stats: Pointer to copy the statistics to
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_GetStats(SHT1x_Handler_t *Handler, SHT1x_Stats_t *Stats);
+
+
+/**
+ * @brief  Clear instrumentation data of the handler.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_ResetStats(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Get min/max/mean latency of a measurement phase.
+ * @param  Handler: Pointer to handler
+ * @param  Phase: Measurement phase
+ *         - SHT1x_PhaseCommand: Start sequence, command and ACK.
+ *         - SHT1x_PhaseWait: Waiting for the end of conversion.
+ *         - SHT1x_PhaseReadout: Shift-in of the result.
+ * @param  Min: Pointer to minimum latency (units of GetTime)
+ * @param  Max: Pointer to maximum latency (units of GetTime)
+ * @param  Mean: Pointer to mean latency (units of GetTime)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No phase has been recorded yet.
+ */
+SHT1x_Result_t
+SHT1x_GetLatency(SHT1x_Handler_t *Handler, SHT1x_Phase_t Phase,
+                 uint32_t *Min, uint32_t *Max, uint32_t *Mean);
+#endif
+
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+/**
+ * @brief  Count the command-to-data latency of a sample in the histogram of
+ *         the handler. SHT1x_ReadSample does it; the non-blocking paths call it
+ *         once CommandTime and ReadoutTime of the sample are set.
+ * @param  Handler: Pointer to handler
+ * @param  Sample: Pointer to sample
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_RecordHistogram(SHT1x_Handler_t *Handler, const SHT1x_Sample_t *Sample);
+
+
+/**
+ * @brief  Get the command-to-data latency histogram of the handler.
+ * @param  Handler: Pointer to handler
+ * @param  Histogram: Array of SHT1X_HISTOGRAM_BUCKETS counters
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_GetHistogram(SHT1x_Handler_t *Handler, uint32_t *Histogram);
+
+
+/**
+ * @brief  Clear the latency histogram of the handler.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_ResetHistogram(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Upper bound of the command-to-data latency of a percentage of the
+ *         samples, with the resolution of the histogram.
+ * @param  Handler: Pointer to handler
+ * @param  Percent: 1 ... 100
+ * @param  Latency: Pointer to latency (units of GetTime)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No sample has been recorded yet or invalid Percent.
+ */
+SHT1x_Result_t
+SHT1x_GetLatencyPercentile(SHT1x_Handler_t *Handler, uint8_t Percent,
+                           uint32_t *Latency);
+#endif
+
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,480 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x.hpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  SHT1x series sensor driver, header-only C++17 template version
+ *         Functionalities of the this file:
+ *          + Read Temperature in Raw data, Celsius and Fahrenheit
+ *          + Read Humidity in Raw data and percentage
+ *          + Resolution and supply voltage fixed at compile time
+ *          + Control internal heater
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_HPP_
+#define _SHT1X_HPP_
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+
+
+/**
+ * @brief  This file is independent of SHT1x.c and SHT1x_config.h. The bus
+ *         protocol is the same as the C driver; the platform layer is a class
+ *         with static member functions (the pin policy) instead of a handler
+ *         with function pointers, so every bus access is resolved and inlined at
+ *         compile time.
+ *
+ *         A pin policy must provide:
+ *
+ *         struct Pins
+ *         {
+ *           static void Init();                    // Initialize the platform
+ *           static void DeInit();                  // Uninitialize the platform
+ *           static void DataConfigDir(uint8_t Dir);// 0: input, 1: output
+ *           static void DataWrite(uint8_t Level);
+ *           static uint8_t DataRead();
+ *           static void SckWrite(uint8_t Level);
+ *           template <uint8_t Us> static void DelayUs();
+ *           template <uint8_t Ms> static void DelayMs();
+ *         };
+ *
+ *         Delays are template arguments so ports can use delay primitives that
+ *         need compile-time constants (e.g. _delay_us of avr-libc).
+ */
+
+namespace sht1x
+{
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Measurement resolution
+ */
+enum class Resolution : uint8_t
+{
+  Low = 0,    // Temperature 12-bit & Humidity 8-bit
+  High = 1    // Temperature 14-bit & Humidity 12-bit
+};
+
+/**
+ * @brief  Internal heater state
+ */
+enum class Heater : uint8_t
+{
+  Off = 0,
+  On = 1
+};
+
+/**
+ * @brief  Functions result (same values as SHT1x_Result_t)
+ */
+enum class Result : uint8_t
+{
+  Ok = 0,
+  Fail = 1,
+  TimeOut = 2
+};
+
+/**
+ * @brief  Sample data type
+ */
+struct Sample
+{
+  uint16_t TempRaw;
+  uint16_t HumRaw;
+  float TempCelsius;
+  float HumidityPercent;
+};
+
+
+
+/**
+ ==================================================================================
+                                ##### Sensor #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  SHT1x sensor
+ * @param  PinPolicy: Platform-dependent layer (see above)
+ * @param  Res: Measurement resolution. Init() programs the sensor accordingly.
+ * @param  SupplyMv: Power supply voltage (mV), used for the d1 coefficient.
+ * @note   The class has no data members and no virtual functions; all conversion
+ *         coefficients are compile-time constants.
+ */
+template <class PinPolicy,
+          Resolution Res = Resolution::High,
+          uint16_t SupplyMv = 5000>
+class Sensor
+{
+public:
+  /* Constants ------------------------------------------------------------------*/
+  static constexpr uint8_t CMD_MeasureTemperature  = 0x03;
+  static constexpr uint8_t CMD_MeasureHumidity     = 0x05;
+  static constexpr uint8_t CMD_ReadStatusRegister  = 0x07;
+  static constexpr uint8_t CMD_WriteStatusRegister = 0x06;
+  static constexpr uint8_t CMD_SoftReset           = 0x1E;
+
+  /**
+   * @brief  Maximum conversion time (ms) from the datasheet. Conversions may end
+   *         up to 30% earlier.
+   */
+  static constexpr uint16_t TempMaxMs = (Res == Resolution::Low) ? 80 : 320;
+  static constexpr uint16_t HumMaxMs = (Res == Resolution::Low) ? 20 : 80;
+
+  static constexpr float Voltage = SupplyMv / 1000.0f;
+
+  // Temperature coefficients (same formula as SHT1x_SetPowVoltage)
+  static constexpr float D1Celsius =
+    (-0.0462f * Voltage * Voltage) + (0.1672f * Voltage) - 39.682f;
+  static constexpr float D1Fahrenheit =
+    (-0.1249f * Voltage * Voltage) + (0.633f * Voltage) - 40.039f;
+  static constexpr float D2Celsius = (Res == Resolution::Low) ? 0.04f : 0.01f;
+  static constexpr float D2Fahrenheit = (Res == Resolution::Low) ? 0.072f : 0.018f;
+
+  // Humidity coefficients
+  static constexpr float C1 = -4.0f;
+  static constexpr float C2 = (Res == Resolution::Low) ? 0.648f : 0.0405f;
+  static constexpr float C3 = (Res == Resolution::Low) ? -0.00072f : -0.0000028f;
+  static constexpr float T1 = 0.01f;
+  static constexpr float T2 = (Res == Resolution::Low) ? 0.00128f : 0.00008f;
+
+  static_assert(SupplyMv >= 2400 && SupplyMv <= 5500,
+                "SHT1x supply voltage must be between 2.4V and 5.5V");
+
+
+  /* Conversion -----------------------------------------------------------------*/
+  static constexpr float
+  TempConvertRawC(uint16_t RawTemp)
+  {
+    return D1Celsius + (D2Celsius * RawTemp);
+  }
+
+  static constexpr float
+  TempConvertRawF(uint16_t RawTemp)
+  {
+    return D1Fahrenheit + (D2Fahrenheit * RawTemp);
+  }
+
+  static constexpr float
+  HumConvertRawP(uint16_t RawHum, float TempC)
+  {
+    return (TempC - 25.0f) * (T1 + (T2 * RawHum)) +
+           C1 + (C2 * RawHum) + (C3 * RawHum * RawHum);
+  }
+
+
+  /* Control --------------------------------------------------------------------*/
+  /**
+   * @brief  Initialize the platform and program the resolution.
+   * @note   The sensor starts in high resolution after power-up, so the status
+   *         register is only written for Resolution::Low.
+   * @retval Result
+   *         - Result::Ok: Operation was successful.
+   *         - Result::Fail: Operation failed.
+   */
+  static Result
+  Init()
+  {
+    PinPolicy::Init();
+
+    if constexpr (Res == Resolution::Low)
+    {
+      uint8_t StatusReg = 0;
+
+      if (ReadStatusRegister(StatusReg) != Result::Ok)
+        return Result::Fail;
+      if (WriteStatusRegister(StatusReg | 0x01) != Result::Ok)
+        return Result::Fail;
+    }
+
+    return Result::Ok;
+  }
+
+  static Result
+  DeInit()
+  {
+    PinPolicy::DeInit();
+    return Result::Ok;
+  }
+
+  /**
+   * @brief  Resets SHT1x. This takes about 20ms
+   * @note   The sensor returns to high resolution; call Init() again for
+   *         Resolution::Low.
+   */
+  static Result
+  SoftReset()
+  {
+    if (SendCmd(CMD_SoftReset) != Result::Ok)
+      return Result::Fail;
+
+    PinPolicy::template DelayMs<20>();
+
+    return Result::Ok;
+  }
+
+  static Result
+  SetInternalHeater(Heater State)
+  {
+    uint8_t StatusReg = 0;
+
+    if (ReadStatusRegister(StatusReg) != Result::Ok)
+      return Result::Fail;
+
+    if (State == Heater::On)
+      StatusReg |= 0x04;
+    else
+      StatusReg &= 0xFB;
+
+    return WriteStatusRegister(StatusReg);
+  }
+
+  static Result
+  GetInternalHeater(Heater &State)
+  {
+    uint8_t StatusReg = 0;
+
+    if (ReadStatusRegister(StatusReg) != Result::Ok)
+      return Result::Fail;
+
+    State = (StatusReg & 0x04) ? Heater::On : Heater::Off;
+
+    return Result::Ok;
+  }
+
+
+  /* Measurement ----------------------------------------------------------------*/
+  /**
+   * @brief  Readout of Measurement Results
+   * @param  Out: Sample structure
+   * @retval Result
+   *         - Result::Ok: Operation was successful.
+   *         - Result::Fail: Operation failed.
+   *         - Result::TimeOut: Timeout occurred.
+   */
+  static Result
+  ReadSample(Sample &Out)
+  {
+    Result Status;
+
+    Status = Measure<CMD_MeasureHumidity>(Out.HumRaw);
+    if (Status != Result::Ok)
+      return Status;
+
+    Status = Measure<CMD_MeasureTemperature>(Out.TempRaw);
+    if (Status != Result::Ok)
+      return Status;
+
+    Out.TempCelsius = TempConvertRawC(Out.TempRaw);
+    Out.HumidityPercent = HumConvertRawP(Out.HumRaw, Out.TempCelsius);
+
+    return Result::Ok;
+  }
+
+  static Result
+  ReadStatusRegister(uint8_t &Reg)
+  {
+    if (SendCmd(CMD_ReadStatusRegister) != Result::Ok)
+      return Result::Fail;
+
+    Reg = ShiftIn();
+    SkipCRC();
+
+    return Result::Ok;
+  }
+
+  static Result
+  WriteStatusRegister(uint8_t Reg)
+  {
+    if (SendCmd(CMD_WriteStatusRegister) != Result::Ok)
+      return Result::Fail;
+
+    PinPolicy::DataConfigDir(1);
+    return ShiftOut(Reg);
+  }
+
+
+private:
+  static inline void
+  Start()
+  {
+    /*
+     * Start Sequence
+     *        __    __
+     * SCK  _|  |__|  |__
+     *      __       ____
+     * DATA   |_____|
+     */
+    PinPolicy::DataWrite(1);
+    PinPolicy::template DelayUs<2>();
+    PinPolicy::SckWrite(1);
+    PinPolicy::template DelayUs<2>();
+    PinPolicy::DataWrite(0);
+    PinPolicy::template DelayUs<2>();
+    PinPolicy::SckWrite(0);
+    PinPolicy::template DelayUs<8>();
+    PinPolicy::SckWrite(1);
+    PinPolicy::template DelayUs<2>();
+    PinPolicy::DataWrite(1);
+    PinPolicy::template DelayUs<2>();
+    PinPolicy::SckWrite(0);
+  }
+
+  static inline void
+  Clock()
+  {
+    PinPolicy::template DelayUs<4>();
+    PinPolicy::SckWrite(1);
+    PinPolicy::template DelayUs<4>();
+    PinPolicy::SckWrite(0);
+  }
+
+  // Shift out one byte and check the ACK of the sensor. DATA must be output.
+  static Result
+  ShiftOut(uint8_t Data)
+  {
+    for (uint8_t counter = 0; counter < 8; counter++, Data <<= 1)
+    {
+      PinPolicy::DataWrite((Data & 0x80) ? 1 : 0);
+      Clock();
+    }
+
+    PinPolicy::DataConfigDir(0);
+
+    if (PinPolicy::DataRead())
+      return Result::Fail;
+
+    Clock();
+    // The sensor releases DATA up to tV after the falling edge of the ACK clock.
+    PinPolicy::template DelayUs<1>();
+
+    return Result::Ok;
+  }
+
+  static uint8_t
+  ShiftIn()
+  {
+    uint8_t Data = 0;
+
+    for (uint8_t counter = 0; counter < 8; counter++)
+    {
+      PinPolicy::SckWrite(1);
+      PinPolicy::template DelayUs<4>();
+      Data = (Data << 1) | PinPolicy::DataRead();
+      PinPolicy::SckWrite(0);
+      PinPolicy::template DelayUs<4>();
+    }
+
+    return Data;
+  }
+
+  static inline void
+  SendACK()
+  {
+    PinPolicy::DataConfigDir(1);
+    PinPolicy::DataWrite(0);
+    PinPolicy::template DelayUs<4>();
+    PinPolicy::SckWrite(1);
+    PinPolicy::template DelayUs<4>();
+    PinPolicy::SckWrite(0);
+    PinPolicy::template DelayUs<4>();
+  }
+
+  // NACK the last data byte: the sensor skips the CRC and the bus is idle
+  static void
+  SkipCRC()
+  {
+    PinPolicy::DataConfigDir(1);
+    PinPolicy::DataWrite(1);
+    Clock();
+  }
+
+  static Result
+  SendCmd(uint8_t CMD)
+  {
+    PinPolicy::DataConfigDir(1);
+    Start();
+    return ShiftOut(CMD);
+  }
+
+  template <uint8_t CMD>
+  static Result
+  WaitForResult()
+  {
+    // sleep to 70% of the maximum conversion time, then poll DATA in 1/64
+    // steps of it until 125% of it
+    constexpr uint16_t MaxMs = (CMD == CMD_MeasureTemperature) ? TempMaxMs : HumMaxMs;
+    constexpr uint16_t MinMs = MaxMs * 70 / 100;
+    constexpr uint8_t StepMs = (MaxMs >= 64) ? (MaxMs / 64) : 1;
+    constexpr uint8_t Steps = (MaxMs * 125 / 100 - MinMs) / StepMs;
+
+    PinPolicy::template DelayMs<MinMs>();
+
+    for (uint8_t counter = 0; counter <= Steps; counter++)
+    {
+      if (!PinPolicy::DataRead())
+        return Result::Ok;
+
+      PinPolicy::template DelayMs<StepMs>();
+    }
+
+    return Result::TimeOut;
+  }
+
+  template <uint8_t CMD>
+  static Result
+  Measure(uint16_t &Raw)
+  {
+    uint16_t Value;
+
+    if (SendCmd(CMD) != Result::Ok)
+      return Result::Fail;
+
+    // check if sensor has started measuring data after ack
+    if (!PinPolicy::DataRead())
+      return Result::Fail;
+
+    if (WaitForResult<CMD>() != Result::Ok)
+      return Result::TimeOut;
+
+    Value = ShiftIn() << 8;
+    SendACK();
+    PinPolicy::DataConfigDir(0);
+    Value |= ShiftIn();
+    Raw = Value;
+
+    SkipCRC();
+
+    return Result::Ok;
+  }
+};
+
+} // namespace sht1x
+
+
+#endif //! _SHT1X_HPP_
@@ -0,0 +1,193 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_adapt.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Adaptive sample period of one SHT1x sensor
+ *         Functionalities of the this file:
+ *          + Fixed-point 1-D Kalman filter on the raw temperature and humidity
+ *          + Next sample time from the predicted uncertainty: short periods
+ *            during transients, exponential back-off while steady
+ *          + Filtered estimates between samples without bus access
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_ADAPT_H_
+#define _SHT1X_ADAPT_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  An innovation larger than this many standard deviations of its
+ *         prediction is taken as a transient: the filter follows it at once
+ *         and the drift rate jumps to the observed rate of change.
+ */
+#ifndef SHT1X_ADAPT_GATE
+#define SHT1X_ADAPT_GATE        3
+#endif
+
+/**
+ * @brief  Weight of a new observation in the drift rate estimate is
+ *         1 / 2^this value. Without transients, the drift rate decays by this
+ *         weight on every sample.
+ */
+#ifndef SHT1X_ADAPT_Q_SHIFT
+#define SHT1X_ADAPT_Q_SHIFT     2
+#endif
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Kalman filter of one raw quantity
+ * @note   The quantity drifts at an unknown rate, so the variance of the
+ *         estimate grows with Q * t^2. Values are raw counts in Q8 fixed point
+ *         (counts * 256), variances counts^2 in Q8 and Q counts^2/s^2 in Q24.
+ */
+typedef struct SHT1x_AdaptFilter_s
+{
+  // Parameters, set by SHT1x_Adapt_Init for the resolution of the handler
+  uint32_t R;                 // Measurement noise variance
+  uint32_t Limit;             // Tolerated variance of the estimate
+
+  // State
+  int32_t  X;                 // Estimate
+  uint32_t P;                 // Variance of the estimate
+  uint32_t Q;                 // Variance of the drift rate
+} SHT1x_AdaptFilter_t;
+
+/**
+ * @brief  Adaptive sampler of one sensor
+ */
+typedef struct SHT1x_Adapt_s
+{
+  // Parameters
+  SHT1x_Handler_t *Handler;
+  uint32_t MinPeriodMs;
+  uint32_t MaxPeriodMs;
+
+  SHT1x_AdaptFilter_t Temp;
+  SHT1x_AdaptFilter_t Hum;
+
+  // Last update
+  uint32_t PeriodMs;          // Period until the next sample
+  uint32_t LastMs;            // Time of the last sample
+  uint32_t Transients;        // Samples outside of the prediction
+
+  // Private state
+  float    TempLimitC;        // Tolerated standard deviations
+  float    HumLimitP;
+  uint8_t  Valid;             // The filters hold a sample
+  uint8_t  Resolution;        // Resolution of the filtered samples
+} SHT1x_Adapt_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the adaptive sampler of a handler. The noise and the
+ *         tolerated uncertainty of the estimates are set for the resolution of
+ *         the handler (about 0.1 C and 1 %RH of standard deviation). They can
+ *         be changed with SHT1x_Adapt_SetLimits.
+ * @param  Adapt: Pointer to adaptive sampler
+ * @param  Handler: Pointer to initialized handler
+ * @param  MinPeriodMs: Shortest sample period (ms)
+ * @param  MaxPeriodMs: Longest sample period (ms)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters.
+ */
+SHT1x_Result_t
+SHT1x_Adapt_Init(SHT1x_Adapt_t *Adapt, SHT1x_Handler_t *Handler,
+                 uint32_t MinPeriodMs, uint32_t MaxPeriodMs);
+
+
+/**
+ * @brief  Set the tolerated standard deviation of the estimates. The sample
+ *         period is stretched until the predicted uncertainty of one of them
+ *         reaches its limit. The filters restart with the next sample.
+ * @param  Adapt: Pointer to adaptive sampler
+ * @param  TempC: Temperature (°C)
+ * @param  HumP: Humidity (%RH), converted with the slope of the humidity curve
+ *         at its low end
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Limits are not positive.
+ */
+SHT1x_Result_t
+SHT1x_Adapt_SetLimits(SHT1x_Adapt_t *Adapt, float TempC, float HumP);
+
+
+/**
+ * @brief  Add a sample to the filters and compute the next sample period.
+ *         A change of resolution restarts the filters.
+ * @param  Adapt: Pointer to adaptive sampler
+ * @param  Sample: Pointer to a successful sample, or NULL for a failed one
+ * @param  NowMs: Time of the sample (ms)
+ * @retval Next sample period (ms). MinPeriodMs after a failed sample.
+ */
+uint32_t
+SHT1x_Adapt_Update(SHT1x_Adapt_t *Adapt, const SHT1x_Sample_t *Sample,
+                   uint32_t NowMs);
+
+
+/**
+ * @brief  Get the filtered sample at any time, without bus access. The raw
+ *         values are rounded estimates, converted with SHT1x_ConvertSample.
+ * @param  Adapt: Pointer to adaptive sampler
+ * @param  NowMs: Current time (ms)
+ * @param  Sample: Pointer to sample
+ * @param  TempVar: Pointer to get the predicted variance of TempRaw (counts^2
+ *         in Q8), or NULL
+ * @param  HumVar: Pointer to get the predicted variance of HumRaw, or NULL
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No sample has been added yet.
+ */
+SHT1x_Result_t
+SHT1x_Adapt_Estimate(SHT1x_Adapt_t *Adapt, uint32_t NowMs, SHT1x_Sample_t *Sample,
+                     uint32_t *TempVar, uint32_t *HumVar);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_ADAPT_H_
@@ -0,0 +1,679 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_co.hpp
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  C++20 coroutine interface of the SHT1x driver
+ *         Functionalities of the this file:
+ *          + co_await a sample or a resolution change of a sensor
+ *          + Conversion wait suspends the coroutine; it is resumed by a timer
+ *            or by a DATA falling-edge event
+ *          + Coroutine frames from a fixed pool, no heap allocation
+ *          + Minimal single-threaded executor
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_CO_HPP_
+#define _SHT1X_CO_HPP_
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+#include "SHT1x.h"
+
+
+/**
+ * @brief  This file is built on the non-blocking functions of the C driver
+ *         (SHT1x_StartMeasurement, SHT1x_IsResultReady and SHT1x_ReadResult), so
+ *         it works with every port and configuration of SHT1x.c. Bus transfers
+ *         run synchronously inside the coroutine; only the conversion wait
+ *         suspends it.
+ *
+ *         sht1x::co::Executor Exec(NowMs, IdleUntil);
+ *         sht1x::co::Sensor   Sensor(Handler, Exec);
+ *
+ *         sht1x::co::Task<> Logger()
+ *         {
+ *           for (;;)
+ *           {
+ *             sht1x::co::Reading R = co_await Sensor.ReadSample();
+ *             ...
+ *             co_await Exec.Sleep(1000);
+ *           }
+ *         }
+ *
+ *         Exec.Spawn(Logger());
+ *         Exec.Run();
+ *
+ *         Every coroutine frame (the spawned task and each pending ReadSample)
+ *         takes one block of a fixed pool. If the pool is exhausted, the task
+ *         completes at once with SHT1x_FAIL instead of allocating.
+ */
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  Number of coroutine frames that can exist at the same time
+ */
+#ifndef SHT1X_CO_FRAMES
+#define SHT1X_CO_FRAMES       8
+#endif
+
+/**
+ * @brief  Size of a frame block (bytes). Frames larger than this fail to
+ *         allocate; FramePool::Largest reports the largest request.
+ */
+#ifndef SHT1X_CO_FRAME_SIZE
+#define SHT1X_CO_FRAME_SIZE   256
+#endif
+
+
+namespace sht1x
+{
+namespace co
+{
+
+/**
+ ==================================================================================
+                              ##### Frame Pool #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Fixed pool of coroutine frames
+ * @param  BlockSize: Size of each block (bytes)
+ * @param  Blocks: Number of blocks (1 to 32)
+ */
+template <size_t BlockSize, uint8_t Blocks>
+class FramePool
+{
+public:
+  static_assert(Blocks >= 1 && Blocks <= 32, "Frame pool holds 1 to 32 blocks");
+  static_assert(BlockSize % alignof(max_align_t) == 0,
+                "Frame block size must be a multiple of the maximum alignment");
+
+  void *
+  Allocate(size_t Size) noexcept
+  {
+    if (Size > Largest)
+      Largest = (uint16_t)Size;
+
+    if (Size <= BlockSize)
+    {
+      for (uint8_t i = 0; i < Blocks; i++)
+      {
+        if (Used & (1UL << i))
+          continue;
+
+        Used |= (1UL << i);
+        if (++InUse > Peak)
+          Peak = InUse;
+        return Storage[i];
+      }
+    }
+
+    Failures++;
+    return nullptr;
+  }
+
+  void
+  Release(void *Frame) noexcept
+  {
+    const uint8_t i = (uint8_t)(((uint8_t *)Frame - Storage[0]) / BlockSize);
+
+    Used &= ~(1UL << i);
+    InUse--;
+  }
+
+  // Statistics
+  uint8_t  InUse = 0;       // Allocated blocks
+  uint8_t  Peak = 0;        // Maximum of InUse
+  uint16_t Largest = 0;     // Largest requested frame (bytes)
+  uint32_t Failures = 0;    // Requests that did not get a block
+
+private:
+  alignas(max_align_t) uint8_t Storage[Blocks][BlockSize];
+  uint32_t Used = 0;
+};
+
+/**
+ * @brief  Pool of every Task frame
+ */
+inline FramePool<SHT1X_CO_FRAME_SIZE, SHT1X_CO_FRAMES> Frames;
+
+
+
+/**
+ ==================================================================================
+                                 ##### Task #####
+ ==================================================================================
+ */
+
+class Executor;
+void Retire(Executor *Owner) noexcept;
+
+/**
+ * @brief  Part of the promise that does not depend on the result type
+ */
+struct PromiseBase
+{
+  std::coroutine_handle<> Continuation; // Awaiting coroutine
+  Executor *Owner = nullptr;            // Executor of a spawned task
+
+  /**
+   * @brief  Resume the awaiting coroutine, or free the frame of a spawned task.
+   */
+  struct FinalAwaiter
+  {
+    bool await_ready() noexcept { return false; }
+
+    template <class Promise>
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<Promise> Frame) noexcept
+    {
+      PromiseBase &P = Frame.promise();
+
+      if (P.Continuation)
+        return P.Continuation;
+      if (P.Owner)
+      {
+        Executor *Owner = P.Owner;
+        Frame.destroy();
+        Retire(Owner);
+      }
+      return std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  static void *
+  operator new(size_t Size) noexcept
+  {
+    return Frames.Allocate(Size);
+  }
+
+  static void
+  operator delete(void *Frame) noexcept
+  {
+    Frames.Release(Frame);
+  }
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  FinalAwaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception() noexcept { std::terminate(); }
+};
+
+template <class T>
+struct PromiseValue : PromiseBase
+{
+  T Value = T(SHT1x_FAIL);
+  void return_value(T V) noexcept { Value = V; }
+};
+
+template <>
+struct PromiseValue<void> : PromiseBase
+{
+  void return_void() noexcept {}
+};
+
+
+/**
+ * @brief  Lazily started coroutine. It runs when it is awaited or spawned.
+ * @param  T: Result type. It must be constructible from SHT1x_Result_t, which
+ *         is the result of a task whose frame could not be allocated.
+ */
+template <class T = void>
+class [[nodiscard]] Task
+{
+public:
+  struct promise_type : PromiseValue<T>
+  {
+    Task
+    get_return_object() noexcept
+    {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    static Task
+    get_return_object_on_allocation_failure() noexcept
+    {
+      return Task();
+    }
+  };
+
+  Task() noexcept = default;
+  Task(Task &&Other) noexcept : Frame(Other.Frame) { Other.Frame = nullptr; }
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+  ~Task() { if (Frame) Frame.destroy(); }
+
+  /**
+   * @brief  false if the frame pool was exhausted
+   */
+  bool Valid() const noexcept { return (bool)Frame; }
+
+  bool await_ready() const noexcept { return !Frame; }
+
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<> Caller) noexcept
+  {
+    Frame.promise().Continuation = Caller;
+    return Frame;
+  }
+
+  T
+  await_resume() noexcept
+  {
+    if constexpr (!std::is_void_v<T>)
+      return Frame ? Frame.promise().Value : T(SHT1x_FAIL);
+  }
+
+private:
+  friend class Executor;
+
+  explicit Task(std::coroutine_handle<promise_type> F) noexcept : Frame(F) {}
+
+  std::coroutine_handle<promise_type> Frame;
+};
+
+
+/**
+ * @brief  Result of an operation that completes without suspending
+ */
+template <class T>
+struct Done
+{
+  T Value;
+
+  bool await_ready() const noexcept { return true; }
+  void await_suspend(std::coroutine_handle<>) const noexcept {}
+  T await_resume() const noexcept { return Value; }
+};
+
+
+
+/**
+ ==================================================================================
+                               ##### Executor #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Single-threaded executor of the tasks. It resumes coroutines that
+ *         sleep until a time, or that wait for an edge of DATA until a timeout.
+ * @note   Time is in milliseconds and may wrap around.
+ */
+class Executor
+{
+public:
+  /**
+   * @brief  Coroutine waiting in the executor
+   */
+  struct Waiter
+  {
+    std::coroutine_handle<> Frame;
+    SHT1x_Handler_t *Handler;   // Sensor of an edge wait, nullptr for a sleep
+    uint32_t Deadline;
+    volatile uint8_t Fired;
+  };
+
+  /**
+   * @param  NowMs: Monotonic time (ms)
+   * @param  IdleUntil: Wait until the time (ms) or until Notify is called.
+   *         nullptr polls the time in a busy loop.
+   */
+  Executor(uint32_t (*NowMs)(void), void (*IdleUntil)(uint32_t Ms)) noexcept
+    : NowMs(NowMs), IdleUntil(IdleUntil), Waiters(), Live(0)
+  {
+  }
+
+  /**
+   * @brief  Start a task. It runs until its first suspension before Spawn
+   *         returns; its frame is freed when it finishes.
+   * @retval true: Task started, false: Its frame could not be allocated
+   */
+  bool
+  Spawn(Task<> &&T) noexcept
+  {
+    std::coroutine_handle<Task<>::promise_type> Frame = T.Frame;
+
+    if (!Frame)
+      return false;
+
+    T.Frame = nullptr;
+    Frame.promise().Owner = this;
+    Live++;
+    Frame.resume();
+    return true;
+  }
+
+  /**
+   * @brief  Resume waiting coroutines until every spawned task has finished.
+   */
+  void
+  Run() noexcept
+  {
+    while (Live)
+    {
+      if (!RunOnce())
+        return;
+    }
+  }
+
+  /**
+   * @brief  Resume the coroutines whose time has come, or wait for the next one.
+   * @retval 0: No coroutine is waiting in the executor, 1: otherwise
+   */
+  uint8_t
+  RunOnce() noexcept
+  {
+    const uint32_t Now = NowMs();
+    uint32_t Next = 0;
+    uint8_t  Waiting = 0;
+    uint8_t  Resumed = 0;
+
+    for (Waiter &W : Waiters)
+    {
+      if (!W.Frame)
+        continue;
+
+      if (W.Fired || (int32_t)(Now - W.Deadline) >= 0)
+      {
+        std::coroutine_handle<> Frame = W.Frame;
+        W.Frame = nullptr;
+        Frame.resume();
+        Resumed = 1;
+      }
+      else if (!Waiting++ || (int32_t)(W.Deadline - Next) < 0)
+      {
+        Next = W.Deadline;
+      }
+    }
+
+    // resumed coroutines may have added waiters, so look again before idling
+    if (Resumed)
+      return 1;
+    if (!Waiting)
+      return 0;
+    if (IdleUntil)
+      IdleUntil(Next);
+    return 1;
+  }
+
+  /**
+   * @brief  Report an edge of DATA of a sensor. It may be called from an
+   *         interrupt or an event callback of the port.
+   */
+  void
+  Notify(SHT1x_Handler_t *Handler) noexcept
+  {
+    for (Waiter &W : Waiters)
+    {
+      if (W.Frame && W.Handler == Handler)
+        W.Fired = 1;
+    }
+  }
+
+  uint32_t Now() const noexcept { return NowMs(); }
+  uint8_t Tasks() const noexcept { return Live; }
+
+
+  /* Awaiters -------------------------------------------------------------------*/
+  struct SleepAwaiter
+  {
+    Executor &Exec;
+    uint32_t Ms;
+
+    bool await_ready() const noexcept { return !Ms; }
+
+    bool
+    await_suspend(std::coroutine_handle<> Frame) noexcept
+    {
+      return Exec.Wait(Frame, nullptr, Ms) != nullptr;
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  struct EdgeAwaiter
+  {
+    Executor &Exec;
+    SHT1x_Handler_t *Handler;
+    uint32_t TimeoutMs;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool
+    await_suspend(std::coroutine_handle<> Frame) noexcept
+    {
+      Waiter *W = Exec.Wait(Frame, Handler, TimeoutMs);
+
+      if (!W)
+        return false;
+      // the edge may have come before the waiter was registered
+      if (SHT1x_IsResultReady(Handler))
+      {
+        W->Frame = nullptr;
+        return false;
+      }
+      return true;
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  /**
+   * @brief  co_await Sleep(Ms) suspends the coroutine for Ms milliseconds.
+   */
+  SleepAwaiter Sleep(uint32_t Ms) noexcept { return {*this, Ms}; }
+
+  /**
+   * @brief  co_await WaitEdge(Handler, TimeoutMs) suspends the coroutine until
+   *         Notify(Handler) or the timeout. The caller checks DATA afterwards.
+   */
+  EdgeAwaiter
+  WaitEdge(SHT1x_Handler_t *Handler, uint32_t TimeoutMs) noexcept
+  {
+    return {*this, Handler, TimeoutMs};
+  }
+
+private:
+  friend void Retire(Executor *Owner) noexcept;
+
+  Waiter *
+  Wait(std::coroutine_handle<> Frame, SHT1x_Handler_t *Handler,
+       uint32_t Ms) noexcept
+  {
+    for (Waiter &W : Waiters)
+    {
+      if (W.Frame)
+        continue;
+
+      W.Handler = Handler;
+      W.Deadline = NowMs() + Ms;
+      W.Fired = 0;
+      W.Frame = Frame;
+      return &W;
+    }
+
+    // every frame waits on one awaiter at most, so this is not expected
+    return nullptr;
+  }
+
+  uint32_t (*NowMs)(void);
+  void (*IdleUntil)(uint32_t Ms);
+  Waiter  Waiters[SHT1X_CO_FRAMES];
+  uint8_t Live;
+};
+
+inline void
+Retire(Executor *Owner) noexcept
+{
+  Owner->Live--;
+}
+
+
+
+/**
+ ==================================================================================
+                                ##### Sensor #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  How a waiting conversion is resumed
+ */
+enum class Wake : uint8_t
+{
+  Timer = 0,  // Sleep 70% of the maximum conversion time, then poll DATA in
+              // 1/64 steps (same policy as SHT1x_ReadSample)
+  Edge = 1    // Wait for Executor::Notify from a DATA falling-edge event
+};
+
+/**
+ * @brief  Result of ReadSample
+ */
+struct Reading
+{
+  Reading(SHT1x_Result_t Result = SHT1x_FAIL) noexcept : Result(Result), Sample() {}
+
+  SHT1x_Result_t Result;
+  SHT1x_Sample_t Sample;
+};
+
+
+/**
+ * @brief  Sensor bound to an initialized handler of the C driver
+ * @note   Operations of one sensor must not overlap; an operation started while
+ *         another one is pending fails with SHT1x_FAIL.
+ */
+class Sensor
+{
+public:
+  Sensor(SHT1x_Handler_t &Handler, Executor &Exec, Wake Mode = Wake::Timer) noexcept
+    : Handler(&Handler), Exec(Exec), Mode(Mode), Busy(0)
+  {
+  }
+
+  /**
+   * @brief  Measure humidity and temperature, and convert them.
+   * @retval Reading
+   *         - SHT1x_OK: Operation was successful.
+   *         - SHT1x_FAIL: Operation failed, or no frame was available.
+   *         - SHT1x_TIME_OUT: The sensor did not finish a conversion.
+   */
+  Task<Reading>
+  ReadSample() noexcept
+  {
+    static constexpr SHT1x_Measurement_t Order[2] =
+      {SHT1x_MeasureHumidity, SHT1x_MeasureTemperature};
+    Reading  Out(SHT1x_OK);
+    uint16_t MinMs, MaxMs;
+    uint32_t Start, TimeoutMs, StepMs;
+
+    if (Busy)
+      co_return Reading(SHT1x_FAIL);
+    Busy = 1;
+
+    for (SHT1x_Measurement_t Measurement : Order)
+    {
+      Out.Result = SHT1x_StartMeasurement(Handler, Measurement);
+      if (Out.Result != SHT1x_OK)
+        break;
+
+      SHT1x_GetConversionTime(Handler, Measurement, &MinMs, &MaxMs);
+      Start = Exec.Now();
+      TimeoutMs = (uint32_t)MaxMs * 125 / 100;
+      StepMs = (MaxMs >= 64) ? (MaxMs / 64) : 1;
+
+      if (Mode == Wake::Timer)
+        co_await Exec.Sleep(MinMs);
+      while (!SHT1x_IsResultReady(Handler))
+      {
+        const uint32_t Elapsed = Exec.Now() - Start;
+
+        if (Elapsed >= TimeoutMs)
+        {
+          Out.Result = SHT1x_TIME_OUT;
+          break;
+        }
+        if (Mode == Wake::Edge)
+          co_await Exec.WaitEdge(Handler, TimeoutMs - Elapsed);
+        else
+          co_await Exec.Sleep(StepMs);
+      }
+      if (Out.Result != SHT1x_OK)
+        break;
+
+      Out.Result = SHT1x_ReadResult(Handler,
+                                    (Measurement == SHT1x_MeasureHumidity) ?
+                                    &Out.Sample.HumRaw : &Out.Sample.TempRaw);
+      if (Out.Result != SHT1x_OK)
+        break;
+    }
+
+    if (Out.Result == SHT1x_OK)
+      Out.Result = SHT1x_ConvertSample(Handler, &Out.Sample);
+
+    Busy = 0;
+    co_return Out;
+  }
+
+#if (SHT1X_CONFIG_RESOLUTION_CONTROL)
+  /**
+   * @brief  Set the measurement resolution. There is no conversion to wait
+   *         for, so the awaiter completes without suspending or allocating.
+   * @retval SHT1x_Result_t
+   *         - SHT1x_OK: Operation was successful.
+   *         - SHT1x_FAIL: Operation failed, or a sample is being read.
+   */
+  Done<SHT1x_Result_t>
+  SetResolution(SHT1x_Resolution_t Resolution) noexcept
+  {
+    if (Busy)
+      return {SHT1x_FAIL};
+    return {SHT1x_SetResolution(Handler, Resolution)};
+  }
+#endif
+
+  SHT1x_Handler_t *GetHandler() const noexcept { return Handler; }
+
+private:
+  SHT1x_Handler_t *Handler;
+  Executor &Exec;
+  Wake     Mode;
+  uint8_t  Busy;
+};
+
+} // namespace co
+} // namespace sht1x
+
+
+#endif //! _SHT1X_CO_HPP_
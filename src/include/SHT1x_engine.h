@@ -0,0 +1,174 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_engine.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Timer-driven SHT1x transfer engine
+ *         Functionalities of the this file:
+ *          + Measurement and status register transfers advanced by one
+ *            half-clock per timer tick, with no busy-wait
+ *          + Conversion wait on the same timer (sleep, then poll DATA)
+ *          + Completion callback from the timer context
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_ENGINE_H_
+#define _SHT1X_ENGINE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  Default time between two ticks of a transfer (us), half of the SCK
+ *         period
+ */
+#ifndef SHT1X_ENGINE_HALF_PERIOD_US
+#define SHT1X_ENGINE_HALF_PERIOD_US  4
+#endif
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Arm the timer to call SHT1x_Engine_Tick once after DelayUs.
+ *         DelayUs is 0 when the transfer is over and the timer may stop.
+ */
+typedef void (*SHT1x_EngineSchedule_t)(uint32_t DelayUs);
+
+/**
+ * @brief  Called from the timer context when a transfer is over
+ */
+typedef void (*SHT1x_EngineDone_t)(void *Context, SHT1x_Result_t Result);
+
+/**
+ * @brief  Transfer engine
+ * @note   The handler must be initialized with SHT1x_Init and must not be
+ *         used by other functions while a transfer runs.
+ */
+typedef struct SHT1x_Engine_s
+{
+  // Parameters
+  SHT1x_Handler_t *Handler;
+  SHT1x_EngineSchedule_t Schedule;
+  SHT1x_EngineDone_t Done;      // Optional
+  void *Context;
+  uint16_t HalfPeriodUs;        // Time between two ticks of a transfer
+
+  // Result of the last transfer
+  volatile SHT1x_Result_t Result;
+  uint16_t Raw;                 // Measurement result
+  uint8_t Status;               // Status register
+
+  // Private state
+  volatile uint8_t Busy;
+  uint8_t Phase;
+  uint8_t Step;
+  uint8_t Bit;
+  uint8_t Byte;
+  uint8_t Bytes;                // Bytes to read
+  uint8_t Cmd;
+  uint8_t Rx[3];
+  uint16_t WaitedMs;
+  uint16_t StepMs;
+  uint16_t TimeoutMs;
+} SHT1x_Engine_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the engine
+ * @param  Engine: Pointer to engine
+ * @param  Handler: Pointer to initialized handler
+ * @param  Schedule: Timer glue of the port
+ * @retval None
+ */
+void
+SHT1x_Engine_Init(SHT1x_Engine_t *Engine, SHT1x_Handler_t *Handler,
+                  SHT1x_EngineSchedule_t Schedule);
+
+
+/**
+ * @brief  Start a measurement. The result is in Engine->Raw when Done is
+ *         called or SHT1x_Engine_IsBusy returns 0.
+ * @param  Engine: Pointer to engine
+ * @param  Measurement: Temperature or humidity
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: A transfer is in progress.
+ */
+SHT1x_Result_t
+SHT1x_Engine_Measure(SHT1x_Engine_t *Engine, SHT1x_Measurement_t Measurement);
+
+
+/**
+ * @brief  Start a status register read. The result is in Engine->Status.
+ * @param  Engine: Pointer to engine
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: A transfer is in progress.
+ */
+SHT1x_Result_t
+SHT1x_Engine_ReadStatus(SHT1x_Engine_t *Engine);
+
+
+/**
+ * @brief  Advance the transfer by one step. Call it from the timer interrupt
+ *         armed by Schedule.
+ * @param  Engine: Pointer to engine
+ * @retval None
+ */
+void
+SHT1x_Engine_Tick(SHT1x_Engine_t *Engine);
+
+
+/**
+ * @brief  Check if a transfer is in progress
+ * @param  Engine: Pointer to engine
+ * @retval 1: Busy, 0: Idle (Engine->Result holds the result)
+ */
+uint8_t
+SHT1x_Engine_IsBusy(SHT1x_Engine_t *Engine);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_ENGINE_H_
@@ -0,0 +1,256 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_rollup.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Fixed-memory rollup store of SHT1x samples
+ *         Functionalities of the this file:
+ *          + Minute, hour and day buckets with min, max, sum and count of the
+ *            raw values, updated in O(1) per sample without allocation
+ *          + Summary of the newest buckets of a level (e.g. last hour min/max)
+ *          + Compact serialization of a level for uplink, and its decoder
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_ROLLUP_H_
+#define _SHT1X_ROLLUP_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  Number of buckets of each level. A level covers its number of buckets
+ *         times its width, including the bucket that is being filled.
+ */
+#ifndef SHT1X_ROLLUP_MINUTES
+#define SHT1X_ROLLUP_MINUTES  60
+#endif
+
+#ifndef SHT1X_ROLLUP_HOURS
+#define SHT1X_ROLLUP_HOURS    24
+#endif
+
+#ifndef SHT1X_ROLLUP_DAYS
+#define SHT1X_ROLLUP_DAYS     30
+#endif
+
+
+/* Exported Constants -----------------------------------------------------------*/
+/**
+ * @brief  Worst-case size of a serialized level of N buckets (bytes)
+ */
+#define SHT1X_ROLLUP_SERIAL_SIZE(N)  (6 + (N) * 21)
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Levels of the store
+ */
+typedef enum SHT1x_RollupLevel_e
+{
+  SHT1x_RollupMinute = 0,
+  SHT1x_RollupHour = 1,
+  SHT1x_RollupDay = 2,
+  SHT1x_RollupLevels
+} SHT1x_RollupLevel_t;
+
+/**
+ * @brief  Aggregate of the samples of one bucket (raw domain)
+ * @note   32-bit sums hold a day of back-to-back 14-bit samples. Merged
+ *         buckets are summed in 64 bits (SHT1x_RollupSummary_t).
+ */
+typedef struct SHT1x_RollupBucket_s
+{
+  uint32_t Count;
+  uint32_t TempSum;
+  uint32_t HumSum;
+  uint16_t TempMin;
+  uint16_t TempMax;
+  uint16_t HumMin;
+  uint16_t HumMax;
+} SHT1x_RollupBucket_t;
+
+/**
+ * @brief  Merged buckets of SHT1x_Rollup_Summary (raw domain)
+ * @note   64-bit sums, so a month of 1 Hz samples does not wrap.
+ */
+typedef struct SHT1x_RollupSummary_s
+{
+  uint32_t Count;
+  uint64_t TempSum;
+  uint64_t HumSum;
+  uint16_t TempMin;
+  uint16_t TempMax;
+  uint16_t HumMin;
+  uint16_t HumMax;
+  uint16_t TempAvg;           // Rounded averages (0 if Count is 0)
+  uint16_t HumAvg;
+} SHT1x_RollupSummary_t;
+
+/**
+ * @brief  Rollup store
+ * @note   Every level is a ring of buckets indexed by period number
+ *         (time / width), so a sample updates one bucket per level.
+ */
+typedef struct SHT1x_Rollup_s
+{
+  SHT1x_RollupBucket_t Minute[SHT1X_ROLLUP_MINUTES];
+  SHT1x_RollupBucket_t Hour[SHT1X_ROLLUP_HOURS];
+  SHT1x_RollupBucket_t Day[SHT1X_ROLLUP_DAYS];
+
+  // Private state
+  uint32_t Newest[SHT1x_RollupLevels];  // Period number of the newest bucket
+  uint8_t  Empty;                       // No sample added yet
+} SHT1x_Rollup_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize an empty store
+ * @param  Rollup: Pointer to store
+ * @retval None
+ */
+void
+SHT1x_Rollup_Init(SHT1x_Rollup_t *Rollup);
+
+
+/**
+ * @brief  Add raw values of one sample.
+ * @param  Rollup: Pointer to store
+ * @param  TimeS: Sample time (s). Older samples are accepted as long as their
+ *         buckets are still stored.
+ * @param  TempRaw: Raw temperature
+ * @param  HumRaw: Raw humidity
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The sample is older than every level.
+ */
+SHT1x_Result_t
+SHT1x_Rollup_AddRaw(SHT1x_Rollup_t *Rollup, uint32_t TimeS,
+                    uint16_t TempRaw, uint16_t HumRaw);
+
+
+/**
+ * @brief  Add a sample of SHT1x_ReadSample.
+ * @param  Rollup: Pointer to store
+ * @param  TimeS: Sample time (s)
+ * @param  Sample: Pointer to sample
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The sample is older than every level.
+ */
+SHT1x_Result_t
+SHT1x_Rollup_Add(SHT1x_Rollup_t *Rollup, uint32_t TimeS,
+                 const SHT1x_Sample_t *Sample);
+
+
+/**
+ * @brief  Get one bucket.
+ * @param  Rollup: Pointer to store
+ * @param  Level: Level of the bucket
+ * @param  Age: 0 for the newest bucket (being filled), 1 for the one before, ...
+ * @param  Bucket: Pointer to copy the bucket to
+ * @param  StartS: Pointer to start time of the bucket (s), may be NULL
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Age is out of range or the store is empty.
+ */
+SHT1x_Result_t
+SHT1x_Rollup_Get(SHT1x_Rollup_t *Rollup, SHT1x_RollupLevel_t Level, uint8_t Age,
+                 SHT1x_RollupBucket_t *Bucket, uint32_t *StartS);
+
+
+/**
+ * @brief  Merge the newest buckets of a level, e.g. 60 minute buckets for the
+ *         last hour.
+ * @param  Rollup: Pointer to store
+ * @param  Level: Level of the buckets
+ * @param  Buckets: Number of buckets to merge, including the newest one
+ * @param  Summary: Pointer to the merged buckets (Count is 0 if no sample)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Buckets is out of range.
+ */
+SHT1x_Result_t
+SHT1x_Rollup_Summary(SHT1x_Rollup_t *Rollup, SHT1x_RollupLevel_t Level,
+                     uint8_t Buckets, SHT1x_RollupSummary_t *Summary);
+
+
+/**
+ * @brief  Serialize the newest buckets of a level, newest first. An empty
+ *         bucket takes 1 byte. Others hold the count, the minimums, and the
+ *         maximums and averages as offsets from the minimums in base-128
+ *         varints, typically 9 to 11 bytes.
+ * @param  Rollup: Pointer to store
+ * @param  Level: Level of the buckets
+ * @param  Buckets: Number of buckets
+ * @param  Buffer: Output buffer
+ * @param  Size: Size of Buffer, SHT1X_ROLLUP_SERIAL_SIZE(Buckets) is enough
+ * @retval Number of bytes written, 0 if Buffer is too small or Buckets is out
+ *         of range
+ */
+uint16_t
+SHT1x_Rollup_Serialize(SHT1x_Rollup_t *Rollup, SHT1x_RollupLevel_t Level,
+                       uint8_t Buckets, uint8_t *Buffer, uint16_t Size);
+
+
+/**
+ * @brief  Decode the output of SHT1x_Rollup_Serialize. Sums are rebuilt from
+ *         the averages.
+ * @param  Buffer: Serialized level
+ * @param  Length: Length of Buffer
+ * @param  Level: Pointer to level of the buckets
+ * @param  StartS: Pointer to start time of the newest bucket (s)
+ * @param  Buckets: Array of decoded buckets, newest first
+ * @param  MaxBuckets: Size of Buckets
+ * @retval Number of decoded buckets, 0 on a malformed buffer
+ */
+uint8_t
+SHT1x_Rollup_Deserialize(const uint8_t *Buffer, uint16_t Length,
+                         SHT1x_RollupLevel_t *Level, uint32_t *StartS,
+                         SHT1x_RollupBucket_t *Buckets, uint8_t MaxBuckets);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_ROLLUP_H_
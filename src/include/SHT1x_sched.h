@@ -0,0 +1,223 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_sched.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Conversion scheduler for several SHT1x sensors
+ *         Functionalities of the this file:
+ *          + Keep conversions of all sensors running at the same time
+ *          + Read results out in completion order
+ *          + Per-sensor sample period and missed deadline report
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)                          
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    
+ * of this software and associated documentation files (the "Software"), to deal   
+ * in the Software without restriction, including without limitation the rights    
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       
+ * copies of the Software, and to permit persons to whom the Software is           
+ * furnished to do so, subject to the following conditions:                        
+ *                                                                                 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_SCHED_H_
+#define _SHT1X_SCHED_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  Give up a conversion that does not finish within this percentage of
+ *         its maximum conversion time (see SHT1x_GetConversionTime)
+ */
+#ifndef SHT1X_SCHED_TIMEOUT_PERCENT
+#define SHT1X_SCHED_TIMEOUT_PERCENT 125
+#endif
+
+/**
+ * @brief  Sleep between two polls of SHT1x_Sched_Sweep while a conversion may
+ *         end any moment (in ms)
+ */
+#ifndef SHT1X_SCHED_POLL_MS
+#define SHT1X_SCHED_POLL_MS         1
+#endif
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  State of one scheduled sensor
+ */
+typedef enum SHT1x_SchedState_e
+{
+  SHT1x_SchedIdle = 0,
+  SHT1x_SchedHumidity = 1,    // Humidity conversion in progress
+  SHT1x_SchedTemperature = 2  // Temperature conversion in progress
+} SHT1x_SchedState_t;
+
+/**
+ * @brief  One sensor of the scheduler
+ * @note   Every sensor needs its own DATA line, and SCK must not be shared with
+ *         a sensor that is converting.
+ */
+typedef struct SHT1x_SchedSensor_s
+{
+  // Parameters
+  SHT1x_Handler_t *Handler;   // Initialized handler
+  uint32_t PeriodMs;          // Sample period (0: only on SHT1x_Sched_Trigger)
+
+  // Last completed sample
+  SHT1x_Sample_t Sample;
+  SHT1x_Result_t Result;
+
+  // Counters
+  uint32_t Samples;           // Completed samples
+  uint32_t Errors;            // Samples with Result != SHT1x_OK
+  uint32_t Missed;            // Samples completed after their deadline
+  uint32_t LateMs;            // Lateness of the last missed sample
+
+  // Private state
+  uint8_t  State;
+  uint8_t  Due;               // Sample is pending
+  uint8_t  Sweep;             // Waited for by SHT1x_Sched_Sweep
+  uint8_t  Retry;             // A failed transfer is done again
+  uint32_t DueAt;             // Scheduled start of the sample
+  uint32_t StartedAt;         // Start of the current conversion
+  uint16_t MinMs;             // Earliest end of the current conversion
+  uint16_t TimeoutMs;         // Timeout of the current conversion
+} SHT1x_SchedSensor_t;
+
+/**
+ * @brief  Scheduler
+ */
+typedef struct SHT1x_Sched_s
+{
+  SHT1x_SchedSensor_t *Sensors;
+  uint8_t Count;
+
+  // Millisecond time base
+  uint32_t (*GetTimeMs)(void);
+
+  // Called after every completed sample (optional)
+  void (*OnSample)(uint8_t Index, SHT1x_SchedSensor_t *Sensor);
+
+  // Private state
+  uint8_t Next;               // First sensor to service in the next poll
+} SHT1x_Sched_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the scheduler. Handlers must be initialized with SHT1x_Init
+ *         and PeriodMs of every sensor set before calling this function.
+ *         Periodic sensors are due immediately.
+ * @param  Sched: Pointer to scheduler
+ * @param  Sensors: Array of sensors
+ * @param  Count: Number of sensors
+ * @param  GetTimeMs: Millisecond time base
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters.
+ */
+SHT1x_Result_t
+SHT1x_Sched_Init(SHT1x_Sched_t *Sched, SHT1x_SchedSensor_t *Sensors,
+                 uint8_t Count, uint32_t (*GetTimeMs)(void));
+
+
+/**
+ * @brief  Request a sample from one sensor, regardless of its period.
+ * @param  Sched: Pointer to scheduler
+ * @param  Index: Index of the sensor
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index.
+ */
+SHT1x_Result_t
+SHT1x_Sched_Trigger(SHT1x_Sched_t *Sched, uint8_t Index);
+
+
+/**
+ * @brief  Change the sample period of one sensor. The next sample of a waiting
+ *         sensor moves to one new period after the start of the last one, so
+ *         it may be called from OnSample to adapt the period to every sample.
+ *         A sensor that was not periodic is due immediately; with 0, a sample
+ *         that is already due is still taken.
+ * @param  Sched: Pointer to scheduler
+ * @param  Index: Index of the sensor
+ * @param  PeriodMs: Sample period (0: only on SHT1x_Sched_Trigger)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index.
+ */
+SHT1x_Result_t
+SHT1x_Sched_SetPeriod(SHT1x_Sched_t *Sched, uint8_t Index, uint32_t PeriodMs);
+
+
+/**
+ * @brief  Service all sensors once without blocking: start conversions that are
+ *         due and read out the sensors whose result is ready.
+ * @param  Sched: Pointer to scheduler
+ * @retval Number of samples completed in this call
+ */
+uint8_t
+SHT1x_Sched_Poll(SHT1x_Sched_t *Sched);
+
+
+/**
+ * @brief  Time the caller may sleep before the next SHT1x_Sched_Poll.
+ * @param  Sched: Pointer to scheduler
+ * @retval 0: A conversion may be complete or a sample is due
+ *         0xFFFFFFFF: Nothing is scheduled
+ *         Otherwise: Milliseconds until the earliest end of a conversion or
+ *         until the next sample is due
+ */
+uint32_t
+SHT1x_Sched_IdleTime(SHT1x_Sched_t *Sched);
+
+
+/**
+ * @brief  Sample all sensors once and wait for the results. Conversions of all
+ *         sensors run concurrently. The delay function of the first sensor
+ *         is used while no result can be ready.
+ * @param  Sched: Pointer to scheduler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: All samples were successful.
+ *         - SHT1x_FAIL: At least one sample failed. Check Result of sensors.
+ */
+SHT1x_Result_t
+SHT1x_Sched_Sweep(SHT1x_Sched_t *Sched);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_SCHED_H_
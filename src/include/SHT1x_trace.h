@@ -0,0 +1,189 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_trace.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Bus waveform capture for SHT1x driver
+ *         Functionalities of the this file:
+ *          + Record SCK/DATA level and direction changes with timestamps
+ *          + Dump the capture as VCD or as compact binary
+ *          + Convert the compact binary to VCD (host side)
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)                          
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy    
+ * of this software and associated documentation files (the "Software"), to deal   
+ * in the Software without restriction, including without limitation the rights    
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell       
+ * copies of the Software, and to permit persons to whom the Software is           
+ * furnished to do so, subject to the following conditions:                        
+ *                                                                                 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_TRACE_H_
+#define _SHT1X_TRACE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+#if (SHT1X_CONFIG_STATIC_PORT)
+  #error "SHT1x_trace wraps the handler callbacks and needs SHT1X_CONFIG_STATIC_PORT = 0"
+#endif
+
+
+/* Exported Constants -----------------------------------------------------------*/
+/**
+ * @brief  Layout of one recorded event (32-bit word)
+ *         - Bit 0: SCK level
+ *         - Bit 1: DATA output latch
+ *         - Bit 2: DATA direction (1: output)
+ *         - Bit 3: DATA level of the last read
+ *         - Bit 4: DATA was sampled by this event
+ *         - Bit 5-31: Timestamp (units of GetTime, wraps around)
+ */
+#define SHT1X_TRACE_SCK         0x01
+#define SHT1X_TRACE_DATA_OUT    0x02
+#define SHT1X_TRACE_DATA_DIR    0x04
+#define SHT1X_TRACE_DATA_IN     0x08
+#define SHT1X_TRACE_SAMPLE      0x10
+#define SHT1X_TRACE_TIME_SHIFT  5
+
+/**
+ * @brief  Size of the compact binary header (bytes)
+ */
+#define SHT1X_TRACE_HEADER_SIZE 16
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Output function used by the dump functions
+ */
+typedef void (*SHT1x_TraceWrite_t)(const uint8_t *Data, uint16_t Len);
+
+/**
+ * @brief  Behavior when the buffer is full
+ */
+typedef enum SHT1x_TraceMode_e
+{
+  SHT1x_TraceStop = 0,      // Keep the first events
+  SHT1x_TraceRing = 1       // Overwrite the oldest events
+} SHT1x_TraceMode_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Insert the tracing shim between the driver and the platform callbacks
+ *         of Handler. Call after the platform part of Handler is initialized.
+ * @note   There is a single trace instance because the handler callbacks do not
+ *         carry a context pointer.
+ * @param  Handler: Pointer to handler
+ * @param  Buffer: Preallocated event buffer
+ * @param  Size: Number of events in Buffer
+ * @param  GetTime: Free-running timestamp counter
+ * @param  Mode: Behavior when the buffer is full
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters or trace already attached.
+ */
+SHT1x_Result_t
+SHT1x_Trace_Attach(SHT1x_Handler_t *Handler, uint32_t *Buffer, uint16_t Size,
+                   uint32_t (*GetTime)(void), SHT1x_TraceMode_t Mode);
+
+
+/**
+ * @brief  Restore the original callbacks of Handler.
+ * @param  Handler: Pointer to handler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_Trace_Detach(SHT1x_Handler_t *Handler);
+
+
+/**
+ * @brief  Discard the recorded events.
+ * @retval None
+ */
+void
+SHT1x_Trace_Clear(void);
+
+
+/**
+ * @brief  Number of recorded events.
+ * @param  Lost: Pointer to get the number of lost events (can be NULL)
+ * @retval Number of events in the buffer
+ */
+uint16_t
+SHT1x_Trace_Count(uint32_t *Lost);
+
+
+/**
+ * @brief  Write the recorded events as VCD.
+ * @param  Write: Output function
+ * @param  TickPs: Duration of one GetTime unit in picoseconds
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Trace is not attached.
+ */
+SHT1x_Result_t
+SHT1x_Trace_DumpVcd(SHT1x_TraceWrite_t Write, uint32_t TickPs);
+
+
+/**
+ * @brief  Write the recorded events as compact binary. Convert it to VCD with
+ *         SHT1x_Trace_BinaryToVcd.
+ * @param  Write: Output function
+ * @param  TickPs: Duration of one GetTime unit in picoseconds
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Trace is not attached.
+ */
+SHT1x_Result_t
+SHT1x_Trace_DumpBinary(SHT1x_TraceWrite_t Write, uint32_t TickPs);
+
+
+/**
+ * @brief  Convert a compact binary dump to VCD.
+ * @param  Data: Binary dump
+ * @param  Len: Length of Data
+ * @param  Write: Output function
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Data is not a valid dump.
+ */
+SHT1x_Result_t
+SHT1x_Trace_BinaryToVcd(const uint8_t *Data, uint32_t Len, SHT1x_TraceWrite_t Write);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_TRACE_H_
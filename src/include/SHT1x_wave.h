@@ -0,0 +1,112 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_wave.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Waveform player shared by the ports
+ *         Functionalities of the this file:
+ *          + Play a precompiled waveform on the SHT1x_Port_* pin primitives,
+ *            writing only the pins that change
+ **********************************************************************************
+ *
+ * Copyright (c) 2021 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_WAVE_H_
+#define _SHT1X_WAVE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Play a waveform. Only the pins that change are written.
+ * @note   Include this file after the SHT1x_Port_SckWrite, DataWrite, DataRead,
+ *         DataConfigDir and DelayUs primitives of the port (SHT1x_platform.h),
+ *         so they are inlined into the loop.
+ * @param  Steps: Waveform
+ * @param  Count: Number of steps
+ * @param  Samples: DATA samples, MSB first (zeroed by the caller)
+ * @retval None
+ */
+static inline void
+SHT1x_Wave_Play(const SHT1x_WaveStep_t *Steps, uint8_t Count, uint8_t *Samples)
+{
+  uint8_t Pins = (uint8_t)~Steps->Pins;   // the first step sets every pin
+  uint8_t Changed;
+  uint8_t Bit = 0;
+
+  for (; Count; Count--, Steps++)
+  {
+    Changed = Pins ^ Steps->Pins;
+    Pins = Steps->Pins;
+
+    if (Changed & SHT1X_WAVE_SCK)
+      SHT1x_Port_SckWrite(Pins & SHT1X_WAVE_SCK);
+
+    if (Pins & SHT1X_WAVE_RELEASE)
+    {
+      if (Changed & SHT1X_WAVE_RELEASE)
+        SHT1x_Port_DataConfigDir(0);
+    }
+    else
+    {
+      // latch the level before driving the pin
+      if (Changed & (SHT1X_WAVE_DATA | SHT1X_WAVE_RELEASE))
+        SHT1x_Port_DataWrite(Pins & SHT1X_WAVE_DATA);
+      if (Changed & SHT1X_WAVE_RELEASE)
+        SHT1x_Port_DataConfigDir(1);
+    }
+
+    SHT1x_Port_DelayUs(Steps->DelayUs);
+
+    if (Pins & SHT1X_WAVE_SAMPLE)
+    {
+      if (SHT1x_Port_DataRead())
+        Samples[Bit >> 3] |= (uint8_t)(0x80 >> (Bit & 7));
+      Bit++;
+    }
+  }
+}
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_WAVE_H_
@@ -0,0 +1,469 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_archive.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Time-indexed archive of raw SHT1x samples (host)
+ *         Functionalities of the this file:
+ *          + Raw sample archive with a sparse time index
+ *          + 1 min, 1 h and 1 day rollup blocks with min/max/sum
+ *          + Range queries that convert raw values only for the touched blocks
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "SHT1x_archive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+static const uint32_t SHT1x_Archive_PeriodS[SHT1x_ArchiveLevels] = {60, 3600, 86400};
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct SHT1x_ArchiveFile_s
+{
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t RecordCount;
+  uint32_t BlockCount[SHT1x_ArchiveLevels];
+} SHT1x_ArchiveFile_t;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static void
+SHT1x_Archive_BlockInit(SHT1x_ArchiveBlock_t *Block, uint32_t StartS)
+{
+  Block->StartS = StartS;
+  Block->Count = 0;
+  Block->TempMin = 0xFFFF;
+  Block->TempMax = 0;
+  Block->HumMin = 0xFFFF;
+  Block->HumMax = 0;
+  Block->TempSum = 0;
+  Block->HumSum = 0;
+}
+
+static void
+SHT1x_Archive_BlockAdd(SHT1x_ArchiveBlock_t *Block, uint16_t TempRaw, uint16_t HumRaw)
+{
+  if (TempRaw < Block->TempMin) Block->TempMin = TempRaw;
+  if (TempRaw > Block->TempMax) Block->TempMax = TempRaw;
+  if (HumRaw < Block->HumMin) Block->HumMin = HumRaw;
+  if (HumRaw > Block->HumMax) Block->HumMax = HumRaw;
+  Block->TempSum += TempRaw;
+  Block->HumSum += HumRaw;
+  Block->Count++;
+}
+
+static void
+SHT1x_Archive_BlockMerge(SHT1x_ArchiveBlock_t *Block, const SHT1x_ArchiveBlock_t *Other)
+{
+  if (Other->TempMin < Block->TempMin) Block->TempMin = Other->TempMin;
+  if (Other->TempMax > Block->TempMax) Block->TempMax = Other->TempMax;
+  if (Other->HumMin < Block->HumMin) Block->HumMin = Other->HumMin;
+  if (Other->HumMax > Block->HumMax) Block->HumMax = Other->HumMax;
+  Block->TempSum += Other->TempSum;
+  Block->HumSum += Other->HumSum;
+  Block->Count += Other->Count;
+}
+
+static int
+SHT1x_Archive_Grow(void **Array, uint32_t *Size, uint32_t Count, size_t Item)
+{
+  uint32_t NewSize;
+  void *New;
+
+  if (Count < *Size)
+    return 0;
+
+  NewSize = *Size ? (*Size * 2) : 1024;
+  New = realloc(*Array, (size_t)NewSize * Item);
+  if (!New)
+    return -1;
+
+  *Array = New;
+  *Size = NewSize;
+  return 0;
+}
+
+static uint32_t
+SHT1x_Archive_FindBlock(const SHT1x_Archive_t *Archive, uint8_t Level, uint64_t Ms)
+{
+  const SHT1x_ArchiveBlock_t *Blocks = Archive->Blocks[Level];
+  uint32_t Low = 0, High = Archive->BlockCount[Level], Mid;
+
+  while (Low < High)
+  {
+    Mid = Low + (High - Low) / 2;
+    if ((uint64_t)Blocks[Mid].StartS * 1000 < Ms)
+      Low = Mid + 1;
+    else
+      High = Mid;
+  }
+
+  return Low;
+}
+
+static uint32_t
+SHT1x_Archive_FindRecord(const SHT1x_Archive_t *Archive, uint64_t Ms)
+{
+  uint32_t Low = 0, High = Archive->RecordCount, Mid;
+
+  while (Low < High)
+  {
+    Mid = Low + (High - Low) / 2;
+    if (Archive->Records[Mid].TimestampMs < Ms)
+      Low = Mid + 1;
+    else
+      High = Mid;
+  }
+
+  return Low;
+}
+
+/*
+ * Aggregate [FromMs, ToMs) into Acc: whole blocks of Level in the middle, the
+ * edges with the next finer level, and raw records below one minute.
+ */
+static void
+SHT1x_Archive_Cover(const SHT1x_Archive_t *Archive, int8_t Level, uint64_t FromMs,
+                    uint64_t ToMs, SHT1x_ArchiveBlock_t *Acc)
+{
+  uint64_t PeriodMs, Begin, End;
+  uint32_t i;
+
+  if (FromMs >= ToMs)
+    return;
+
+  if (Level < 0)
+  {
+    for (i = SHT1x_Archive_FindRecord(Archive, FromMs);
+         i < Archive->RecordCount && Archive->Records[i].TimestampMs < ToMs; i++)
+    {
+      if (!(Archive->Records[i].Flags & SHT1X_HISTORY_FLAG_ERROR))
+        SHT1x_Archive_BlockAdd(Acc, Archive->Records[i].TempRaw,
+                               Archive->Records[i].HumRaw);
+    }
+    return;
+  }
+
+  PeriodMs = (uint64_t)SHT1x_Archive_PeriodS[Level] * 1000;
+  Begin = (FromMs + PeriodMs - 1) / PeriodMs * PeriodMs;
+  End = ToMs / PeriodMs * PeriodMs;
+  if (Begin >= End)
+  {
+    SHT1x_Archive_Cover(Archive, Level - 1, FromMs, ToMs, Acc);
+    return;
+  }
+
+  SHT1x_Archive_Cover(Archive, Level - 1, FromMs, Begin, Acc);
+  for (i = SHT1x_Archive_FindBlock(Archive, (uint8_t)Level, Begin);
+       i < Archive->BlockCount[Level] &&
+       (uint64_t)Archive->Blocks[Level][i].StartS * 1000 < End; i++)
+    SHT1x_Archive_BlockMerge(Acc, &Archive->Blocks[Level][i]);
+  SHT1x_Archive_Cover(Archive, Level - 1, End, ToMs, Acc);
+}
+
+/*
+ * Convert fractional raw values with the driver math. Temperature is linear in
+ * TempRaw and humidity is interpolated between neighbouring raw values.
+ */
+static void
+SHT1x_Archive_Convert(const SHT1x_Archive_t *Archive, double TempRaw, double HumRaw,
+                      float *TempC, float *HumP)
+{
+  SHT1x_Handler_t *Handler = (SHT1x_Handler_t *)&Archive->Conversion;
+  SHT1x_Sample_t S00 = {0}, S10 = {0}, S01 = {0};
+  double T0 = floor(TempRaw), H0 = floor(HumRaw);
+  double Ft = TempRaw - T0, Fh = HumRaw - H0;
+
+  S00.TempRaw = (uint16_t)T0;
+  S00.HumRaw = (uint16_t)H0;
+  S10 = S00;
+  S10.TempRaw++;
+  S01 = S00;
+  S01.HumRaw++;
+  SHT1x_ConvertSample(Handler, &S00);
+  SHT1x_ConvertSample(Handler, &S10);
+  SHT1x_ConvertSample(Handler, &S01);
+
+  if (TempC)
+    *TempC = (float)(S00.TempCelsius + Ft * (S10.TempCelsius - S00.TempCelsius));
+  if (HumP)
+    *HumP = (float)(S00.HumidityPercent +
+                    Fh * (S01.HumidityPercent - S00.HumidityPercent) +
+                    Ft * (S10.HumidityPercent - S00.HumidityPercent));
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize an empty archive.
+ * @param  Archive: Pointer to archive
+ * @param  Conversion: Handler whose resolution and supply voltage settings are
+ *         used to convert the raw values (a handler after SHT1x_Init)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_Archive_Init(SHT1x_Archive_t *Archive, const SHT1x_Handler_t *Conversion)
+{
+  memset(Archive, 0, sizeof(*Archive));
+  Archive->Conversion = *Conversion;
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Release the memory of the archive.
+ * @param  Archive: Pointer to archive
+ * @retval None
+ */
+void
+SHT1x_Archive_Free(SHT1x_Archive_t *Archive)
+{
+  free(Archive->Records);
+  for (uint8_t i = 0; i < SHT1x_ArchiveLevels; i++)
+    free(Archive->Blocks[i]);
+  memset(Archive, 0, sizeof(*Archive));
+}
+
+
+/**
+ * @brief  Add a record. Records must come in timestamp order.
+ * @param  Archive: Pointer to archive
+ * @param  Record: Raw record
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Record is older than the last one, or out of memory.
+ */
+SHT1x_Result_t
+SHT1x_Archive_Append(SHT1x_Archive_t *Archive, const SHT1x_HistoryRecord_t *Record)
+{
+  SHT1x_ArchiveBlock_t *Block;
+  uint32_t StartS;
+
+  if (Archive->RecordCount &&
+      Record->TimestampMs < Archive->Records[Archive->RecordCount - 1].TimestampMs)
+  {
+    Archive->Rejected++;
+    return SHT1x_FAIL;
+  }
+
+  if (SHT1x_Archive_Grow((void **)&Archive->Records, &Archive->RecordSize,
+                         Archive->RecordCount, sizeof(SHT1x_HistoryRecord_t)))
+    return SHT1x_FAIL;
+  Archive->Records[Archive->RecordCount++] = *Record;
+
+  if (Record->Flags & SHT1X_HISTORY_FLAG_ERROR)
+    return SHT1x_OK;
+
+  for (uint8_t Level = 0; Level < SHT1x_ArchiveLevels; Level++)
+  {
+    StartS = (uint32_t)(Record->TimestampMs / 1000 / SHT1x_Archive_PeriodS[Level] *
+                        SHT1x_Archive_PeriodS[Level]);
+
+    if (!Archive->BlockCount[Level] ||
+        Archive->Blocks[Level][Archive->BlockCount[Level] - 1].StartS != StartS)
+    {
+      if (SHT1x_Archive_Grow((void **)&Archive->Blocks[Level], &Archive->BlockSize[Level],
+                             Archive->BlockCount[Level], sizeof(SHT1x_ArchiveBlock_t)))
+        return SHT1x_FAIL;
+      SHT1x_Archive_BlockInit(&Archive->Blocks[Level][Archive->BlockCount[Level]++],
+                              StartS);
+    }
+
+    Block = &Archive->Blocks[Level][Archive->BlockCount[Level] - 1];
+    SHT1x_Archive_BlockAdd(Block, Record->TempRaw, Record->HumRaw);
+  }
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Min/max/average per bucket over [FromMs, ToMs). Every bucket is
+ *         covered with the coarsest rollup blocks that fit in it, and raw
+ *         records only at the sub-minute edges.
+ * @param  Archive: Pointer to archive
+ * @param  FromMs: Start of the range
+ * @param  ToMs: End of the range (exclusive)
+ * @param  BucketMs: Length of one bucket
+ * @param  Results: Array of results, one per bucket
+ * @param  MaxResults: Size of Results
+ * @retval Number of buckets written to Results
+ */
+uint32_t
+SHT1x_Archive_Query(const SHT1x_Archive_t *Archive, uint64_t FromMs, uint64_t ToMs,
+                    uint64_t BucketMs, SHT1x_ArchiveResult_t *Results,
+                    uint32_t MaxResults)
+{
+  SHT1x_ArchiveBlock_t Acc;
+  SHT1x_ArchiveResult_t *Result;
+  double TempAvg, HumAvg;
+  uint64_t Start, End;
+  uint32_t Count = 0;
+
+  if (!BucketMs)
+    return 0;
+
+  for (Start = FromMs; Start < ToMs && Count < MaxResults; Start += BucketMs)
+  {
+    End = (ToMs - Start > BucketMs) ? (Start + BucketMs) : ToMs;
+
+    SHT1x_Archive_BlockInit(&Acc, 0);
+    SHT1x_Archive_Cover(Archive, SHT1x_ArchiveLevels - 1, Start, End, &Acc);
+
+    Result = &Results[Count++];
+    memset(Result, 0, sizeof(*Result));
+    Result->StartMs = Start;
+    Result->Count = Acc.Count;
+    if (!Acc.Count)
+      continue;
+
+    // convert only the aggregates of this bucket
+    TempAvg = (double)Acc.TempSum / Acc.Count;
+    HumAvg = (double)Acc.HumSum / Acc.Count;
+    SHT1x_Archive_Convert(Archive, TempAvg, HumAvg, &Result->TempAvg, &Result->HumAvg);
+    SHT1x_Archive_Convert(Archive, Acc.TempMin, HumAvg, &Result->TempMin, NULL);
+    SHT1x_Archive_Convert(Archive, Acc.TempMax, HumAvg, &Result->TempMax, NULL);
+    SHT1x_Archive_Convert(Archive, TempAvg, Acc.HumMin, NULL, &Result->HumMin);
+    SHT1x_Archive_Convert(Archive, TempAvg, Acc.HumMax, NULL, &Result->HumMax);
+  }
+
+  return Count;
+}
+
+
+/**
+ * @brief  Write the archive to a file.
+ * @param  Archive: Pointer to archive
+ * @param  Path: File path
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: File error.
+ */
+SHT1x_Result_t
+SHT1x_Archive_Save(const SHT1x_Archive_t *Archive, const char *Path)
+{
+  SHT1x_ArchiveFile_t File = {0};
+  FILE *Stream;
+  int Error = 0;
+
+  Stream = fopen(Path, "wb");
+  if (!Stream)
+    return SHT1x_FAIL;
+
+  File.Magic = SHT1X_ARCHIVE_MAGIC;
+  File.Version = SHT1X_ARCHIVE_VERSION;
+  File.RecordCount = Archive->RecordCount;
+  for (uint8_t i = 0; i < SHT1x_ArchiveLevels; i++)
+    File.BlockCount[i] = Archive->BlockCount[i];
+
+  Error |= fwrite(&File, sizeof(File), 1, Stream) != 1;
+  Error |= fwrite(Archive->Records, sizeof(SHT1x_HistoryRecord_t),
+                  Archive->RecordCount, Stream) != Archive->RecordCount;
+  for (uint8_t i = 0; i < SHT1x_ArchiveLevels; i++)
+    Error |= fwrite(Archive->Blocks[i], sizeof(SHT1x_ArchiveBlock_t),
+                    Archive->BlockCount[i], Stream) != Archive->BlockCount[i];
+  Error |= fclose(Stream) != 0;
+
+  return Error ? SHT1x_FAIL : SHT1x_OK;
+}
+
+
+/**
+ * @brief  Read an archive written by SHT1x_Archive_Save.
+ * @param  Archive: Pointer to archive
+ * @param  Path: File path
+ * @param  Conversion: See SHT1x_Archive_Init
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: File error or invalid file.
+ */
+SHT1x_Result_t
+SHT1x_Archive_Load(SHT1x_Archive_t *Archive, const char *Path,
+                   const SHT1x_Handler_t *Conversion)
+{
+  SHT1x_ArchiveFile_t File;
+  FILE *Stream;
+  int Error = 0;
+
+  SHT1x_Archive_Init(Archive, Conversion);
+
+  Stream = fopen(Path, "rb");
+  if (!Stream)
+    return SHT1x_FAIL;
+
+  if (fread(&File, sizeof(File), 1, Stream) != 1 ||
+      File.Magic != SHT1X_ARCHIVE_MAGIC || File.Version != SHT1X_ARCHIVE_VERSION)
+  {
+    fclose(Stream);
+    return SHT1x_FAIL;
+  }
+
+  Archive->RecordCount = Archive->RecordSize = File.RecordCount;
+  Archive->Records = malloc((size_t)File.RecordCount * sizeof(SHT1x_HistoryRecord_t) + 1);
+  Error |= !Archive->Records;
+  if (!Error)
+    Error |= fread(Archive->Records, sizeof(SHT1x_HistoryRecord_t),
+                   File.RecordCount, Stream) != File.RecordCount;
+
+  for (uint8_t i = 0; i < SHT1x_ArchiveLevels && !Error; i++)
+  {
+    Archive->BlockCount[i] = Archive->BlockSize[i] = File.BlockCount[i];
+    Archive->Blocks[i] = malloc((size_t)File.BlockCount[i] * sizeof(SHT1x_ArchiveBlock_t) + 1);
+    Error |= !Archive->Blocks[i];
+    if (!Error)
+      Error |= fread(Archive->Blocks[i], sizeof(SHT1x_ArchiveBlock_t),
+                     File.BlockCount[i], Stream) != File.BlockCount[i];
+  }
+  fclose(Stream);
+
+  if (Error)
+  {
+    SHT1x_Archive_Free(Archive);
+    return SHT1x_FAIL;
+  }
+
+  return SHT1x_OK;
+}
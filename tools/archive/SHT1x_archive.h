@@ -0,0 +1,213 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_archive.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Time-indexed archive of raw SHT1x samples (host)
+ *         Functionalities of the this file:
+ *          + Raw sample archive with a sparse time index
+ *          + 1 min, 1 h and 1 day rollup blocks with min/max/sum
+ *          + Range queries that convert raw values only for the touched blocks
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_ARCHIVE_H_
+#define _SHT1X_ARCHIVE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+#include "SHT1x_history.h"
+
+
+/* Exported Constants -----------------------------------------------------------*/
+#define SHT1X_ARCHIVE_MAGIC     0x41315453  // "ST1A"
+#define SHT1X_ARCHIVE_VERSION   1
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Rollup levels
+ */
+typedef enum SHT1x_ArchiveLevel_e
+{
+  SHT1x_ArchiveMinute = 0,
+  SHT1x_ArchiveHour = 1,
+  SHT1x_ArchiveDay = 2,
+  SHT1x_ArchiveLevels
+} SHT1x_ArchiveLevel_t;
+
+/**
+ * @brief  Rollup of the valid samples of one minute, hour or day (32 bytes).
+ *         Only blocks that hold samples are stored, sorted by StartS; they are
+ *         the sparse time index of the level.
+ */
+typedef struct SHT1x_ArchiveBlock_s
+{
+  uint32_t StartS;          // Start of the block (s)
+  uint32_t Count;           // Number of valid samples
+  uint16_t TempMin;
+  uint16_t TempMax;
+  uint16_t HumMin;
+  uint16_t HumMax;
+  uint64_t TempSum;
+  uint64_t HumSum;
+} SHT1x_ArchiveBlock_t;
+
+/**
+ * @brief  Archive of one sensor
+ */
+typedef struct SHT1x_Archive_s
+{
+  // Raw records in timestamp order (errors included)
+  SHT1x_HistoryRecord_t *Records;
+  uint32_t RecordCount;
+  uint32_t RecordSize;
+
+  // Rollup blocks of every level
+  SHT1x_ArchiveBlock_t *Blocks[SHT1x_ArchiveLevels];
+  uint32_t BlockCount[SHT1x_ArchiveLevels];
+  uint32_t BlockSize[SHT1x_ArchiveLevels];
+
+  uint32_t Rejected;        // Records older than the last one
+
+  // Resolution and supply voltage used for conversion (see SHT1x_ConvertSample)
+  SHT1x_Handler_t Conversion;
+} SHT1x_Archive_t;
+
+/**
+ * @brief  One bucket of a query result
+ */
+typedef struct SHT1x_ArchiveResult_s
+{
+  uint64_t StartMs;
+  uint32_t Count;           // Number of valid samples (0: no data)
+  float    TempMin;         // Celsius
+  float    TempMax;
+  float    TempAvg;
+  float    HumMin;          // Percent
+  float    HumMax;
+  float    HumAvg;
+} SHT1x_ArchiveResult_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize an empty archive.
+ * @param  Archive: Pointer to archive
+ * @param  Conversion: Handler whose resolution and supply voltage settings are
+ *         used to convert the raw values (a handler after SHT1x_Init)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ */
+SHT1x_Result_t
+SHT1x_Archive_Init(SHT1x_Archive_t *Archive, const SHT1x_Handler_t *Conversion);
+
+
+/**
+ * @brief  Release the memory of the archive.
+ * @param  Archive: Pointer to archive
+ * @retval None
+ */
+void
+SHT1x_Archive_Free(SHT1x_Archive_t *Archive);
+
+
+/**
+ * @brief  Add a record. Records must come in timestamp order.
+ * @param  Archive: Pointer to archive
+ * @param  Record: Raw record
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Record is older than the last one, or out of memory.
+ */
+SHT1x_Result_t
+SHT1x_Archive_Append(SHT1x_Archive_t *Archive, const SHT1x_HistoryRecord_t *Record);
+
+
+/**
+ * @brief  Min/max/average per bucket over [FromMs, ToMs). Every bucket is
+ *         covered with the coarsest rollup blocks that fit in it, and raw
+ *         records only at the sub-minute edges.
+ * @param  Archive: Pointer to archive
+ * @param  FromMs: Start of the range
+ * @param  ToMs: End of the range (exclusive)
+ * @param  BucketMs: Length of one bucket
+ * @param  Results: Array of results, one per bucket
+ * @param  MaxResults: Size of Results
+ * @retval Number of buckets written to Results
+ */
+uint32_t
+SHT1x_Archive_Query(const SHT1x_Archive_t *Archive, uint64_t FromMs, uint64_t ToMs,
+                    uint64_t BucketMs, SHT1x_ArchiveResult_t *Results,
+                    uint32_t MaxResults);
+
+
+/**
+ * @brief  Write the archive to a file.
+ * @param  Archive: Pointer to archive
+ * @param  Path: File path
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: File error.
+ */
+SHT1x_Result_t
+SHT1x_Archive_Save(const SHT1x_Archive_t *Archive, const char *Path);
+
+
+/**
+ * @brief  Read an archive written by SHT1x_Archive_Save.
+ * @param  Archive: Pointer to archive
+ * @param  Path: File path
+ * @param  Conversion: See SHT1x_Archive_Init
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: File error or invalid file.
+ */
+SHT1x_Result_t
+SHT1x_Archive_Load(SHT1x_Archive_t *Archive, const char *Path,
+                   const SHT1x_Handler_t *Conversion);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_ARCHIVE_H_
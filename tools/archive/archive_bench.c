@@ -0,0 +1,285 @@
+/**
+ **********************************************************************************
+ * @file   archive_bench.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Build, query and benchmark SHT1x archives
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "SHT1x.h"
+#include "SHT1x_archive.h"
+#include "SHT1x_history.h"
+#include "SHT1x_platform.h"
+
+
+#define DAY_MS    86400000ULL
+#define HOUR_MS   3600000ULL
+
+
+static SHT1x_Handler_t Handler;
+
+
+static uint64_t
+MonoNs(void)
+{
+  struct timespec Ts;
+  clock_gettime(CLOCK_MONOTONIC, &Ts);
+  return (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
+
+static int
+Usage(void)
+{
+  fprintf(stderr,
+          "usage: sht1x_archive bench [sensors] [days] [period_s]\n"
+          "       sht1x_archive import RING ARCHIVE\n"
+          "       sht1x_archive query ARCHIVE from_ms to_ms bucket_ms\n");
+  return 2;
+}
+
+static void
+Print(const SHT1x_ArchiveResult_t *Results, uint32_t Count)
+{
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    if (!Results[i].Count)
+      continue;
+    printf("%llu: n %6u, T %6.2f .. %6.2f avg %6.2f °C, RH %6.2f .. %6.2f avg %6.2f %%\n",
+           (unsigned long long)Results[i].StartMs, (unsigned)Results[i].Count,
+           Results[i].TempMin, Results[i].TempMax, Results[i].TempAvg,
+           Results[i].HumMin, Results[i].HumMax, Results[i].HumAvg);
+  }
+}
+
+
+/*
+ * bench: synthetic raw samples (daily and yearly cycle plus noise) for every
+ * sensor, then the dashboard queries: hourly buckets of the last week for all
+ * sensors, and daily buckets over the whole range.
+ */
+static int
+Bench(uint32_t Sensors, uint32_t Days, uint32_t PeriodS)
+{
+  SHT1x_Archive_t *Archives;
+  SHT1x_ArchiveResult_t *Results;
+  SHT1x_HistoryRecord_t Record = {0};
+  uint64_t EndMs = 1700000000000ULL / DAY_MS * DAY_MS + (uint64_t)Days * DAY_MS;
+  uint64_t StartMs = EndMs - (uint64_t)Days * DAY_MS;
+  uint64_t WeekMs = EndMs - 7 * DAY_MS + 1234;  // not aligned to a minute
+  uint64_t Start, Ns, Records = 0, Buckets = 0, Blocks = 0;
+  uint32_t Seed = 1, Count, Mismatch = 0;
+  double Phase;
+
+  Archives = calloc(Sensors, sizeof(*Archives));
+  Results = calloc(Days + 1 > 24 * 7 + 1 ? Days + 1 : 24 * 7 + 1, sizeof(*Results));
+  if (!Archives || !Results)
+    return 1;
+
+  Start = MonoNs();
+  for (uint32_t s = 0; s < Sensors; s++)
+  {
+    SHT1x_Archive_Init(&Archives[s], &Handler);
+    for (uint64_t t = StartMs + s * 7; t < EndMs; t += (uint64_t)PeriodS * 1000)
+    {
+      Seed = Seed * 1103515245 + 12345;
+      Phase = (double)(t % DAY_MS) / DAY_MS * 2 * M_PI;
+      Record.TimestampMs = t;
+      Record.TempRaw = (uint16_t)(6400 + 100 * s + 500 * sin(Phase) +
+                                  300 * sin((double)t / (365.0 * DAY_MS) * 2 * M_PI) +
+                                  (Seed >> 16) % 40);
+      Record.HumRaw = (uint16_t)(1300 - 250 * sin(Phase) + (Seed >> 8) % 30);
+      Record.Flags = ((Seed >> 20) % 1000) ? 0 : SHT1X_HISTORY_FLAG_ERROR;
+      SHT1x_Archive_Append(&Archives[s], &Record);
+    }
+    Records += Archives[s].RecordCount;
+    for (uint8_t l = 0; l < SHT1x_ArchiveLevels; l++)
+      Blocks += Archives[s].BlockCount[l];
+  }
+  Ns = MonoNs() - Start;
+  printf("%u sensors, %u days, one sample every %u s: %llu records, %llu blocks, "
+         "build %.1f ns/record\n", (unsigned)Sensors, (unsigned)Days, (unsigned)PeriodS,
+         (unsigned long long)Records, (unsigned long long)Blocks, (double)Ns / Records);
+
+  // hourly min/max/avg of the last week, every sensor
+  Start = MonoNs();
+  for (uint32_t s = 0; s < Sensors; s++)
+    Buckets += SHT1x_Archive_Query(&Archives[s], WeekMs, EndMs, HOUR_MS, Results, 24 * 7 + 1);
+  Ns = MonoNs() - Start;
+  printf("last week, hourly, all sensors: %llu buckets in %.3f ms\n",
+         (unsigned long long)Buckets, Ns / 1e6);
+
+  // the same buckets from the raw records, for comparison
+  Start = MonoNs();
+  for (uint32_t s = 0; s < Sensors; s++)
+  {
+    Count = SHT1x_Archive_Query(&Archives[s], WeekMs, EndMs, HOUR_MS, Results, 24 * 7 + 1);
+    for (uint32_t b = 0; b < Count; b++)
+    {
+      uint64_t From = Results[b].StartMs, To = From + HOUR_MS;
+      uint32_t n = 0;
+      uint16_t TempMin = 0xFFFF, TempMax = 0;
+      SHT1x_Sample_t Sample = {0};
+
+      for (uint32_t i = 0; i < Archives[s].RecordCount; i++)
+      {
+        const SHT1x_HistoryRecord_t *R = &Archives[s].Records[i];
+        if (R->TimestampMs < From || R->TimestampMs >= To ||
+            (R->Flags & SHT1X_HISTORY_FLAG_ERROR))
+          continue;
+        n++;
+        if (R->TempRaw < TempMin) TempMin = R->TempRaw;
+        if (R->TempRaw > TempMax) TempMax = R->TempRaw;
+      }
+
+      Sample.TempRaw = TempMin;
+      SHT1x_ConvertSample(&Handler, &Sample);
+      if (n != Results[b].Count || (n && fabsf(Sample.TempCelsius - Results[b].TempMin) > 1e-3f))
+        Mismatch++;
+      Sample.TempRaw = TempMax;
+      SHT1x_ConvertSample(&Handler, &Sample);
+      if (n && fabsf(Sample.TempCelsius - Results[b].TempMax) > 1e-3f)
+        Mismatch++;
+    }
+  }
+  Ns = MonoNs() - Start;
+  printf("same query by scanning raw records: %.3f ms, mismatches %u\n", Ns / 1e6,
+         (unsigned)Mismatch);
+
+  // daily over the whole range, every sensor
+  Buckets = 0;
+  Start = MonoNs();
+  for (uint32_t s = 0; s < Sensors; s++)
+    Buckets += SHT1x_Archive_Query(&Archives[s], StartMs, EndMs, DAY_MS, Results, Days + 1);
+  Ns = MonoNs() - Start;
+  printf("whole range, daily, all sensors: %llu buckets in %.3f ms\n",
+         (unsigned long long)Buckets, Ns / 1e6);
+
+  printf("\nsensor 0, last day:\n");
+  Count = SHT1x_Archive_Query(&Archives[0], EndMs - DAY_MS, EndMs, 4 * HOUR_MS, Results, 6);
+  Print(Results, Count);
+
+  for (uint32_t s = 0; s < Sensors; s++)
+    SHT1x_Archive_Free(&Archives[s]);
+  free(Archives);
+  free(Results);
+  return Mismatch ? 1 : 0;
+}
+
+
+static int
+Import(const char *RingPath, const char *Path)
+{
+  SHT1x_History_t History;
+  SHT1x_HistorySpan_t Spans[2];
+  SHT1x_Archive_t Archive;
+  int Error;
+
+  if (SHT1x_History_Open(&History, RingPath) != SHT1x_OK)
+  {
+    fprintf(stderr, "cannot open %s\n", RingPath);
+    return 1;
+  }
+
+  // extend an existing archive with the records after its last one
+  if (SHT1x_Archive_Load(&Archive, Path, &Handler) != SHT1x_OK)
+    SHT1x_Archive_Init(&Archive, &Handler);
+
+  SHT1x_History_Find(&History, Archive.RecordCount ?
+                     Archive.Records[Archive.RecordCount - 1].TimestampMs + 1 : 0,
+                     ~0ULL, Spans, NULL);
+  for (uint8_t s = 0; s < 2; s++)
+  {
+    for (uint32_t i = 0; i < Spans[s].Count; i++)
+      SHT1x_Archive_Append(&Archive, &Spans[s].Records[i]);
+  }
+
+  Error = SHT1x_Archive_Save(&Archive, Path) != SHT1x_OK;
+  printf("%u records imported, %u in archive, %u rejected\n",
+         (unsigned)(Spans[0].Count + Spans[1].Count), (unsigned)Archive.RecordCount,
+         (unsigned)Archive.Rejected);
+
+  SHT1x_Archive_Free(&Archive);
+  SHT1x_History_Close(&History);
+  return Error;
+}
+
+
+static int
+Query(const char *Path, uint64_t FromMs, uint64_t ToMs, uint64_t BucketMs)
+{
+  SHT1x_Archive_t Archive;
+  SHT1x_ArchiveResult_t *Results;
+  uint32_t Max, Count;
+  uint64_t Start;
+
+  if (!BucketMs || ToMs <= FromMs ||
+      SHT1x_Archive_Load(&Archive, Path, &Handler) != SHT1x_OK)
+    return Usage();
+
+  Max = (uint32_t)((ToMs - FromMs + BucketMs - 1) / BucketMs);
+  Results = calloc(Max, sizeof(*Results));
+  if (!Results)
+    return 1;
+
+  Start = MonoNs();
+  Count = SHT1x_Archive_Query(&Archive, FromMs, ToMs, BucketMs, Results, Max);
+  fprintf(stderr, "%u buckets in %.3f ms\n", (unsigned)Count, (MonoNs() - Start) / 1e6);
+  Print(Results, Count);
+
+  free(Results);
+  SHT1x_Archive_Free(&Archive);
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+    return Usage();
+
+  // the conversion settings of a default 14-bit/12-bit, 5 V sensor
+  SHT1x_Platform_Init(&Handler);
+  SHT1x_Init(&Handler);
+
+  if (!strcmp(argv[1], "bench"))
+    return Bench((argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 100,
+                 (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 3 * 365,
+                 (argc > 4) ? (uint32_t)strtoul(argv[4], NULL, 0) : 600);
+  if (!strcmp(argv[1], "import") && argc > 3)
+    return Import(argv[2], argv[3]);
+  if (!strcmp(argv[1], "query") && argc > 5)
+    return Query(argv[2], strtoull(argv[3], NULL, 0), strtoull(argv[4], NULL, 0),
+                 strtoull(argv[5], NULL, 0));
+
+  return Usage();
+}
@@ -0,0 +1,435 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_evloop.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  epoll event loop of many SHT1x sensors (Linux)
+ *         Functionalities of the this file:
+ *          + One thread samples many sensors periodically
+ *          + Every pending conversion is a timerfd or a DATA edge fd in epoll
+ *          + Readouts run inline when a result is ready; samples go to a callback
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "SHT1x_evloop.h"
+#include <stddef.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+/**
+ * @brief  Events of an edge fd carry this flag in the upper half of their data
+ */
+#define SHT1X_LOOP_EDGE_EVENT  (1ULL << 32)
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Arm the timer of a sensor at an absolute time, rounded up to the
+ *         slack. A time in the past fires at once (0 would disarm the timer).
+ */
+static void
+SHT1x_Loop_ArmAt(SHT1x_LoopSensor_t *Sensor, uint64_t AtNs)
+{
+  const uint64_t SlackNs = SHT1X_LOOP_SLACK_MS * 1000000ULL;
+  struct itimerspec Spec = {0};
+
+  if (SlackNs)
+    AtNs += SlackNs - 1 - (AtNs + SlackNs - 1) % SlackNs;
+  if (!AtNs)
+    AtNs = 1;
+  Spec.it_value.tv_sec = (time_t)(AtNs / 1000000000ULL);
+  Spec.it_value.tv_nsec = (long)(AtNs % 1000000000ULL);
+  timerfd_settime(Sensor->TimerFd, TFD_TIMER_ABSTIME, &Spec, NULL);
+}
+
+static void
+SHT1x_Loop_Disarm(SHT1x_LoopSensor_t *Sensor)
+{
+  const struct itimerspec Spec = {0};
+
+  timerfd_settime(Sensor->TimerFd, 0, &Spec, NULL);
+}
+
+static void
+SHT1x_Loop_EdgeRelease(SHT1x_Loop_t *Loop, SHT1x_LoopSensor_t *Sensor)
+{
+  if (Sensor->EdgeFd < 0)
+    return;
+
+  epoll_ctl(Loop->EpollFd, EPOLL_CTL_DEL, Sensor->EdgeFd, NULL);
+  Sensor->EdgeDisarm(Sensor->EdgeContext);
+  Sensor->EdgeFd = -1;
+}
+
+static uint8_t
+SHT1x_Loop_Finish(SHT1x_Loop_t *Loop, uint16_t Index, SHT1x_Result_t Result,
+                  uint64_t Now)
+{
+  SHT1x_LoopSensor_t *Sensor = &Loop->Sensors[Index];
+  const uint64_t PeriodNs = (uint64_t)Sensor->PeriodMs * 1000000ULL;
+
+  SHT1x_Loop_EdgeRelease(Loop, Sensor);
+  Sensor->State = SHT1x_LoopIdle;
+  Sensor->Result = Result;
+  Sensor->Samples++;
+  if (Result != SHT1x_OK)
+    Sensor->Errors++;
+
+  if (PeriodNs)
+  {
+    // a sample must be completed before the next one is due
+    Sensor->DueAtNs += PeriodNs;
+    if (Now > Sensor->DueAtNs)
+    {
+      Sensor->Missed++;
+      Sensor->DueAtNs = Now; // do not try to catch up
+    }
+    SHT1x_Loop_ArmAt(Sensor, Sensor->DueAtNs);
+  }
+  else
+  {
+    SHT1x_Loop_Disarm(Sensor);
+  }
+
+  if (Loop->OnSample)
+    Loop->OnSample(Index, Sensor);
+
+  return 1;
+}
+
+static SHT1x_Result_t
+SHT1x_Loop_Start(SHT1x_Loop_t *Loop, SHT1x_LoopSensor_t *Sensor,
+                 SHT1x_Measurement_t Measurement, uint64_t Now)
+{
+  struct epoll_event Event;
+  uint16_t MinMs, MaxMs;
+
+  if (SHT1x_StartMeasurement(Sensor->Handler, Measurement) != SHT1x_OK)
+    return SHT1x_FAIL;
+
+  SHT1x_GetConversionTime(Sensor->Handler, Measurement, &MinMs, &MaxMs);
+  Sensor->TimeoutAtNs = Now + (uint64_t)MaxMs * SHT1X_LOOP_TIMEOUT_PERCENT * 10000ULL;
+  Sensor->StepNs = (uint32_t)MaxMs * 1000000 / SHT1X_LOOP_POLL_STEPS;
+  Sensor->State = (Measurement == SHT1x_MeasureHumidity) ?
+                  SHT1x_LoopHumidity : SHT1x_LoopTemperature;
+
+  if (Sensor->EdgeArm && Sensor->EdgeFd < 0)
+  {
+    Sensor->EdgeFd = Sensor->EdgeArm(Sensor->EdgeContext);
+    if (Sensor->EdgeFd >= 0)
+    {
+      Event.events = EPOLLIN | EPOLLET;
+      Event.data.u64 = SHT1X_LOOP_EDGE_EVENT | (uint64_t)(Sensor - Loop->Sensors);
+      if (epoll_ctl(Loop->EpollFd, EPOLL_CTL_ADD, Sensor->EdgeFd, &Event) != 0)
+      {
+        Sensor->EdgeDisarm(Sensor->EdgeContext);
+        Sensor->EdgeFd = -1;
+      }
+    }
+  }
+
+  // with an edge fd, the timer only catches a conversion that never ends
+  if (Sensor->EdgeFd >= 0)
+    SHT1x_Loop_ArmAt(Sensor, Sensor->TimeoutAtNs);
+  else
+    SHT1x_Loop_ArmAt(Sensor, Now + (uint64_t)MinMs * 1000000ULL);
+
+  return SHT1x_OK;
+}
+
+static uint8_t
+SHT1x_Loop_Service(SHT1x_Loop_t *Loop, uint16_t Index)
+{
+  SHT1x_LoopSensor_t *Sensor = &Loop->Sensors[Index];
+  uint64_t Now = SHT1x_Loop_NowNs();
+  uint16_t Raw;
+
+  switch (Sensor->State)
+  {
+  case SHT1x_LoopIdle:
+    if (Now < Sensor->DueAtNs)
+      break;
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+    Sensor->Sample.CommandTime = Sensor->Handler->GetTime();
+#endif
+    if (SHT1x_Loop_Start(Loop, Sensor, SHT1x_MeasureHumidity, Now) != SHT1x_OK)
+      return SHT1x_Loop_Finish(Loop, Index, SHT1x_FAIL, Now);
+    break;
+
+  case SHT1x_LoopHumidity:
+  case SHT1x_LoopTemperature:
+    if (!SHT1x_IsResultReady(Sensor->Handler))
+    {
+      if (Now >= Sensor->TimeoutAtNs)
+        return SHT1x_Loop_Finish(Loop, Index, SHT1x_TIME_OUT, Now);
+      if (Sensor->EdgeFd < 0)
+        SHT1x_Loop_ArmAt(Sensor, Now + Sensor->StepNs);
+      break;
+    }
+
+#if (SHT1X_CONFIG_TIMESTAMPS)
+    Sensor->Sample.ConversionTime = Sensor->Handler->GetTime();
+#endif
+    // DATA is driven again for the readout
+    SHT1x_Loop_EdgeRelease(Loop, Sensor);
+    if (SHT1x_ReadResult(Sensor->Handler, &Raw) != SHT1x_OK)
+      return SHT1x_Loop_Finish(Loop, Index, SHT1x_FAIL, Now);
+
+    if (Sensor->State == SHT1x_LoopHumidity)
+    {
+      Sensor->Sample.HumRaw = Raw;
+      if (SHT1x_Loop_Start(Loop, Sensor, SHT1x_MeasureTemperature,
+                           SHT1x_Loop_NowNs()) != SHT1x_OK)
+        return SHT1x_Loop_Finish(Loop, Index, SHT1x_FAIL, Now);
+      break;
+    }
+
+    Sensor->Sample.TempRaw = Raw;
+#if (SHT1X_CONFIG_TIMESTAMPS)
+    Sensor->Sample.ReadoutTime = Sensor->Handler->GetTime();
+    SHT1x_RecordHistogram(Sensor->Handler, &Sensor->Sample);
+#endif
+    SHT1x_ConvertSample(Sensor->Handler, &Sensor->Sample);
+    return SHT1x_Loop_Finish(Loop, Index, SHT1x_OK, SHT1x_Loop_NowNs());
+
+  default:
+    Sensor->State = SHT1x_LoopIdle;
+    break;
+  }
+
+  return 0;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the loop. Handlers must be initialized with SHT1x_Init
+ *         and the parameters of every sensor set before calling this function.
+ *         The first samples of periodic sensors are spread over one period.
+ * @param  Loop: Pointer to loop
+ * @param  Sensors: Array of sensors
+ * @param  Count: Number of sensors
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters, or epoll/timerfd creation failed
+ *           (e.g. RLIMIT_NOFILE is below one descriptor per sensor).
+ */
+SHT1x_Result_t
+SHT1x_Loop_Init(SHT1x_Loop_t *Loop, SHT1x_LoopSensor_t *Sensors, uint16_t Count)
+{
+  struct epoll_event Event;
+  SHT1x_LoopSensor_t *Sensor;
+  uint64_t Now;
+
+  if (!Loop || !Sensors || !Count)
+    return SHT1x_FAIL;
+
+  Loop->Sensors = Sensors;
+  Loop->Count = Count;
+  Loop->OnSample = NULL;
+  Loop->Wakeups = 0;
+  Loop->EpollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (Loop->EpollFd < 0)
+    return SHT1x_FAIL;
+
+  for (uint16_t i = 0; i < Count; i++)
+    Sensors[i].TimerFd = Sensors[i].EdgeFd = -1;
+
+  Now = SHT1x_Loop_NowNs();
+  for (uint16_t i = 0; i < Count; i++)
+  {
+    Sensor = &Sensors[i];
+    if (!Sensor->Handler || (Sensor->EdgeArm && !Sensor->EdgeDisarm))
+      goto fail;
+
+    Sensor->Result = SHT1x_OK;
+    Sensor->Samples = 0;
+    Sensor->Errors = 0;
+    Sensor->Missed = 0;
+    Sensor->Wakeups = 0;
+    Sensor->State = SHT1x_LoopIdle;
+    Sensor->DueAtNs = Now + (uint64_t)Sensor->PeriodMs * 1000000ULL * i / Count;
+    Sensor->TimeoutAtNs = 0;
+    Sensor->StepNs = 0;
+
+    Sensor->TimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (Sensor->TimerFd < 0)
+      goto fail;
+
+    Event.events = EPOLLIN;
+    Event.data.u64 = i;
+    if (epoll_ctl(Loop->EpollFd, EPOLL_CTL_ADD, Sensor->TimerFd, &Event) != 0)
+      goto fail;
+
+    if (Sensor->PeriodMs)
+      SHT1x_Loop_ArmAt(Sensor, Sensor->DueAtNs);
+  }
+
+  return SHT1x_OK;
+
+fail:
+  SHT1x_Loop_DeInit(Loop);
+  return SHT1x_FAIL;
+}
+
+
+/**
+ * @brief  Close every descriptor of the loop. Edge fds of pending conversions
+ *         are disarmed.
+ * @param  Loop: Pointer to loop
+ * @retval None
+ */
+void
+SHT1x_Loop_DeInit(SHT1x_Loop_t *Loop)
+{
+  SHT1x_LoopSensor_t *Sensor;
+
+  for (uint16_t i = 0; i < Loop->Count; i++)
+  {
+    Sensor = &Loop->Sensors[i];
+    SHT1x_Loop_EdgeRelease(Loop, Sensor);
+    if (Sensor->TimerFd >= 0)
+      close(Sensor->TimerFd);
+    Sensor->TimerFd = -1;
+    Sensor->State = SHT1x_LoopIdle;
+  }
+
+  if (Loop->EpollFd >= 0)
+    close(Loop->EpollFd);
+  Loop->EpollFd = -1;
+}
+
+
+/**
+ * @brief  Request a sample from one sensor, regardless of its period.
+ * @param  Loop: Pointer to loop
+ * @param  Index: Index of the sensor
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index.
+ */
+SHT1x_Result_t
+SHT1x_Loop_Trigger(SHT1x_Loop_t *Loop, uint16_t Index)
+{
+  SHT1x_LoopSensor_t *Sensor;
+
+  if (Index >= Loop->Count)
+    return SHT1x_FAIL;
+
+  Sensor = &Loop->Sensors[Index];
+  Sensor->DueAtNs = SHT1x_Loop_NowNs();
+  if (Sensor->State == SHT1x_LoopIdle)
+    SHT1x_Loop_ArmAt(Sensor, Sensor->DueAtNs);
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Wait for events and service the sensors that have one: start due
+ *         samples, read out finished conversions and re-arm the timers.
+ * @param  Loop: Pointer to loop
+ * @param  TimeoutMs: Timeout of epoll_wait (-1: no timeout, 0: do not block)
+ * @retval Number of samples completed in this call, -1 if epoll_wait failed
+ */
+int
+SHT1x_Loop_Dispatch(SHT1x_Loop_t *Loop, int TimeoutMs)
+{
+  struct epoll_event Events[SHT1X_LOOP_EVENTS];
+  SHT1x_LoopSensor_t *Sensor;
+  uint64_t Expirations;
+  uint16_t Index;
+  int Count;
+  int Completed = 0;
+
+  Count = epoll_wait(Loop->EpollFd, Events, SHT1X_LOOP_EVENTS, TimeoutMs);
+  if (Count < 0)
+    return (errno == EINTR) ? 0 : -1;
+  if (Count)
+    Loop->Wakeups++;
+
+  for (int i = 0; i < Count; i++)
+  {
+    Index = (uint16_t)Events[i].data.u64;
+    if (Index >= Loop->Count)
+      continue;
+
+    Sensor = &Loop->Sensors[Index];
+    Sensor->Wakeups++;
+    if (!(Events[i].data.u64 & SHT1X_LOOP_EDGE_EVENT) &&
+        read(Sensor->TimerFd, &Expirations, sizeof(Expirations)) < 0)
+      continue; // already re-armed while servicing an edge of this batch
+
+    Completed += SHT1x_Loop_Service(Loop, Index);
+  }
+
+  return Completed;
+}
+
+
+/**
+ * @brief  epoll descriptor of the loop. It is readable while an event is
+ *         pending, so the loop can be nested in another event loop.
+ * @param  Loop: Pointer to loop
+ * @retval File descriptor
+ */
+int
+SHT1x_Loop_Fd(SHT1x_Loop_t *Loop)
+{
+  return Loop->EpollFd;
+}
+
+
+/**
+ * @brief  CLOCK_MONOTONIC time used by the timers of the loop.
+ * @retval Time (ns)
+ */
+uint64_t
+SHT1x_Loop_NowNs(void)
+{
+  struct timespec Ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &Ts);
+  return (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
@@ -0,0 +1,231 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_evloop.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  epoll event loop of many SHT1x sensors (Linux)
+ *         Functionalities of the this file:
+ *          + One thread samples many sensors periodically
+ *          + Every pending conversion is a timerfd or a DATA edge fd in epoll
+ *          + Readouts run inline when a result is ready; samples go to a callback
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_EVLOOP_H_
+#define _SHT1X_EVLOOP_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include "SHT1x.h"
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  Give up a conversion that does not finish within this percentage of
+ *         its maximum conversion time (see SHT1x_GetConversionTime)
+ */
+#ifndef SHT1X_LOOP_TIMEOUT_PERCENT
+#define SHT1X_LOOP_TIMEOUT_PERCENT  125
+#endif
+
+/**
+ * @brief  Without an edge fd, DATA is polled from the earliest end of the
+ *         conversion in steps of the maximum conversion time / this value.
+ *         Every step is one wake-up; SHT1x_ReadSample uses 64 steps.
+ */
+#ifndef SHT1X_LOOP_POLL_STEPS
+#define SHT1X_LOOP_POLL_STEPS       16
+#endif
+
+/**
+ * @brief  Timers are rounded up to multiples of this time (ms), so the timers
+ *         of many sensors expire together and are handled in one wake-up.
+ *         0 disables the rounding.
+ */
+#ifndef SHT1X_LOOP_SLACK_MS
+#define SHT1X_LOOP_SLACK_MS         4
+#endif
+
+/**
+ * @brief  Maximum number of epoll events handled by one SHT1x_Loop_Dispatch
+ */
+#ifndef SHT1X_LOOP_EVENTS
+#define SHT1X_LOOP_EVENTS           64
+#endif
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  State of one sensor of the loop
+ */
+typedef enum SHT1x_LoopState_e
+{
+  SHT1x_LoopIdle = 0,
+  SHT1x_LoopHumidity = 1,     // Humidity conversion in progress
+  SHT1x_LoopTemperature = 2   // Temperature conversion in progress
+} SHT1x_LoopState_t;
+
+/**
+ * @brief  One sensor of the loop
+ * @note   Without EdgeArm, a conversion is polled with its timer: first at 70%
+ *         of the maximum conversion time, then in SHT1X_LOOP_POLL_STEPS steps.
+ */
+typedef struct SHT1x_LoopSensor_s
+{
+  // Parameters
+  SHT1x_Handler_t *Handler;   // Initialized handler
+  uint32_t PeriodMs;          // Sample period (0: only on SHT1x_Loop_Trigger)
+
+  // DATA falling-edge events (optional, e.g. SHT1x_Platform_EdgeArm of the
+  // Linux-GPIOD port with the SHT1x_GPIOD_t of the sensor). EdgeArm returns a file descriptor that becomes readable
+  // on the edge, or -1 to poll with the timer. EdgeDisarm releases it.
+  int  (*EdgeArm)(void *Context);
+  void (*EdgeDisarm)(void *Context);
+  void *EdgeContext;
+
+  // Last completed sample
+  SHT1x_Sample_t Sample;
+  SHT1x_Result_t Result;
+
+  // Counters
+  uint32_t Samples;           // Completed samples
+  uint32_t Errors;            // Samples with Result != SHT1x_OK
+  uint32_t Missed;            // Samples completed after their deadline
+  uint32_t Wakeups;           // Events of the sensor
+
+  // Private state
+  uint8_t  State;
+  int      TimerFd;
+  int      EdgeFd;            // -1: no edge fd armed
+  uint64_t DueAtNs;           // Scheduled start of the next sample
+  uint64_t TimeoutAtNs;       // Timeout of the current conversion
+  uint32_t StepNs;            // Poll interval of the current conversion
+} SHT1x_LoopSensor_t;
+
+/**
+ * @brief  Event loop
+ */
+typedef struct SHT1x_Loop_s
+{
+  SHT1x_LoopSensor_t *Sensors;
+  uint16_t Count;
+
+  // Called after every completed sample (optional)
+  void (*OnSample)(uint16_t Index, SHT1x_LoopSensor_t *Sensor);
+
+  // Counters
+  uint32_t Wakeups;           // SHT1x_Loop_Dispatch calls that got events
+
+  // Private state
+  int EpollFd;
+} SHT1x_Loop_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize the loop. Handlers must be initialized with SHT1x_Init
+ *         and the parameters of every sensor set before calling this function.
+ *         The first samples of periodic sensors are spread over one period.
+ * @param  Loop: Pointer to loop
+ * @param  Sensors: Array of sensors
+ * @param  Count: Number of sensors
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters, or epoll/timerfd creation failed
+ *           (e.g. RLIMIT_NOFILE is below one descriptor per sensor).
+ */
+SHT1x_Result_t
+SHT1x_Loop_Init(SHT1x_Loop_t *Loop, SHT1x_LoopSensor_t *Sensors, uint16_t Count);
+
+
+/**
+ * @brief  Close every descriptor of the loop. Edge fds of pending conversions
+ *         are disarmed.
+ * @param  Loop: Pointer to loop
+ * @retval None
+ */
+void
+SHT1x_Loop_DeInit(SHT1x_Loop_t *Loop);
+
+
+/**
+ * @brief  Request a sample from one sensor, regardless of its period.
+ * @param  Loop: Pointer to loop
+ * @param  Index: Index of the sensor
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index.
+ */
+SHT1x_Result_t
+SHT1x_Loop_Trigger(SHT1x_Loop_t *Loop, uint16_t Index);
+
+
+/**
+ * @brief  Wait for events and service the sensors that have one: start due
+ *         samples, read out finished conversions and re-arm the timers.
+ * @param  Loop: Pointer to loop
+ * @param  TimeoutMs: Timeout of epoll_wait (-1: no timeout, 0: do not block)
+ * @retval Number of samples completed in this call, -1 if epoll_wait failed
+ */
+int
+SHT1x_Loop_Dispatch(SHT1x_Loop_t *Loop, int TimeoutMs);
+
+
+/**
+ * @brief  epoll descriptor of the loop. It is readable while an event is
+ *         pending, so the loop can be nested in another event loop.
+ * @param  Loop: Pointer to loop
+ * @retval File descriptor
+ */
+int
+SHT1x_Loop_Fd(SHT1x_Loop_t *Loop);
+
+
+/**
+ * @brief  CLOCK_MONOTONIC time used by the timers of the loop.
+ * @retval Time (ns)
+ */
+uint64_t
+SHT1x_Loop_NowNs(void);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_EVLOOP_H_
@@ -0,0 +1,355 @@
+/**
+ **********************************************************************************
+ * @file   sht1x_evbench.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Scaling benchmark of SHT1x_evloop.c from 1 to 1000 simulated sensors
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/timerfd.h>
+#include "SHT1x.h"
+#include "SHT1x_sched.h"
+#include "SHT1x_evloop.h"
+#include "SHT1x_platform.h"
+
+
+/*
+ * The simulated sensors share one virtual clock that follows CLOCK_MONOTONIC,
+ * so conversions end in real time. Bus delays only advance the virtual clock;
+ * the CPU time is the time of the loop, the driver and the simulator.
+ */
+
+
+#define MAX_SENSORS  1000
+
+
+typedef struct Edge_s
+{
+  SHT1x_Sim_t *Sim;
+  int Fd;
+} Edge_t;
+
+typedef struct Result_s
+{
+  uint32_t Samples;
+  uint32_t Errors;
+  uint32_t Missed;
+  uint32_t Wakeups;
+  double   CpuS;
+  double   WallS;
+} Result_t;
+
+
+static SHT1x_Sim_t         Sims[MAX_SENSORS];
+static SHT1x_Handler_t     Handlers[MAX_SENSORS];
+static SHT1x_LoopSensor_t  LoopSensors[MAX_SENSORS];
+static SHT1x_SchedSensor_t SchedSensors[MAX_SENSORS];
+static Edge_t              Edges[MAX_SENSORS];
+static uint64_t            BaseNs;
+
+
+static uint64_t
+ClockNs(clockid_t Clock)
+{
+  struct timespec Ts;
+  clock_gettime(Clock, &Ts);
+  return (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
+
+static uint64_t
+RealTimeNs(void)
+{
+  return ClockNs(CLOCK_MONOTONIC) - BaseNs;
+}
+
+static uint32_t
+GetTimeMs(void)
+{
+  return (uint32_t)(SHT1x_Sim_Now(&Sims[0]) / 1000000);
+}
+
+
+/* Emulated DATA edges: a timerfd at the end of the simulated conversion --------*/
+static int
+EdgeArm(void *Context)
+{
+  Edge_t *Edge = (Edge_t *)Context;
+  struct itimerspec Spec = {0};
+  uint64_t At;
+
+  if (Edge->Fd < 0)
+    Edge->Fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (Edge->Fd < 0)
+    return -1;
+
+  At = Edge->Sim->DoneAt ? BaseNs + Edge->Sim->DoneAt : ClockNs(CLOCK_MONOTONIC);
+  Spec.it_value.tv_sec = (time_t)(At / 1000000000ULL);
+  Spec.it_value.tv_nsec = (long)(At % 1000000000ULL);
+  timerfd_settime(Edge->Fd, TFD_TIMER_ABSTIME, &Spec, NULL);
+
+  return Edge->Fd;
+}
+
+static void
+EdgeDisarm(void *Context)
+{
+  Edge_t *Edge = (Edge_t *)Context;
+  const struct itimerspec Spec = {0};
+
+  timerfd_settime(Edge->Fd, 0, &Spec, NULL);
+}
+
+
+/* Benchmark --------------------------------------------------------------------*/
+static int
+Setup(uint32_t Count)
+{
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    SHT1x_Sim_Init(&Sims[i], NULL);
+    Sims[i].AmbientC = 20.0f + (float)(i % 10);
+    Sims[i].HumidityP = 30.0f + 2.0f * (float)(i % 10);
+    if (SHT1x_Sim_Attach(&Sims[i], &Handlers[i]) != SHT1x_OK ||
+        SHT1x_Init(&Handlers[i]) != SHT1x_OK)
+      return -1;
+    Edges[i].Sim = &Sims[i];
+    Edges[i].Fd = -1;
+  }
+  Sims[0].Clock->RealTimeNs = RealTimeNs;
+
+  return 0;
+}
+
+static void
+Teardown(uint32_t Count)
+{
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    SHT1x_DeInit(&Handlers[i]);
+    SHT1x_Sim_Detach(&Sims[i]);
+    if (Edges[i].Fd >= 0)
+      close(Edges[i].Fd);
+  }
+}
+
+/**
+ * @brief  Sample every sensor with the event loop.
+ */
+static int
+RunLoop(uint32_t Count, uint32_t PeriodMs, uint32_t Seconds, uint8_t UseEdges,
+        Result_t *Result)
+{
+  SHT1x_Loop_t Loop;
+  uint64_t Cpu, Wall, End;
+
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    LoopSensors[i].Handler = &Handlers[i];
+    LoopSensors[i].PeriodMs = PeriodMs;
+    LoopSensors[i].EdgeArm = UseEdges ? EdgeArm : NULL;
+    LoopSensors[i].EdgeDisarm = UseEdges ? EdgeDisarm : NULL;
+    LoopSensors[i].EdgeContext = &Edges[i];
+  }
+  if (SHT1x_Loop_Init(&Loop, LoopSensors, (uint16_t)Count) != SHT1x_OK)
+    return -1;
+
+  // the first samples are spread over one period
+  End = ClockNs(CLOCK_MONOTONIC) + PeriodMs * 1000000ULL;
+  while (ClockNs(CLOCK_MONOTONIC) < End)
+    SHT1x_Loop_Dispatch(&Loop, 100);
+
+  *Result = (Result_t){0};
+  for (uint32_t i = 0; i < Count; i++)
+    Result->Samples -= LoopSensors[i].Samples;
+  Result->Wakeups -= Loop.Wakeups;
+
+  Cpu = ClockNs(CLOCK_PROCESS_CPUTIME_ID);
+  Wall = ClockNs(CLOCK_MONOTONIC);
+  End = Wall + Seconds * 1000000000ULL;
+  while (ClockNs(CLOCK_MONOTONIC) < End)
+  {
+    if (SHT1x_Loop_Dispatch(&Loop, 100) < 0)
+      break;
+  }
+  Result->CpuS = (ClockNs(CLOCK_PROCESS_CPUTIME_ID) - Cpu) / 1e9;
+  Result->WallS = (ClockNs(CLOCK_MONOTONIC) - Wall) / 1e9;
+
+  Result->Wakeups += Loop.Wakeups;
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    Result->Samples += LoopSensors[i].Samples;
+    Result->Errors += LoopSensors[i].Errors;
+    Result->Missed += LoopSensors[i].Missed;
+  }
+
+  SHT1x_Loop_DeInit(&Loop);
+  return 0;
+}
+
+/**
+ * @brief  Sample every sensor with SHT1x_Sched_Poll every millisecond, as
+ *         sht1xd does.
+ */
+static int
+RunPoll(uint32_t Count, uint32_t PeriodMs, uint32_t Seconds, Result_t *Result)
+{
+  SHT1x_Sched_t Sched;
+  struct timespec Sleep = {0};
+  uint64_t Cpu, Wall, End;
+  uint32_t Idle;
+
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    SchedSensors[i].Handler = &Handlers[i];
+    SchedSensors[i].PeriodMs = PeriodMs;
+  }
+  if (SHT1x_Sched_Init(&Sched, SchedSensors, (uint8_t)Count, GetTimeMs) != SHT1x_OK)
+    return -1;
+
+  *Result = (Result_t){0};
+  Cpu = ClockNs(CLOCK_PROCESS_CPUTIME_ID);
+  Wall = ClockNs(CLOCK_MONOTONIC);
+  End = Wall + Seconds * 1000000000ULL;
+  while (ClockNs(CLOCK_MONOTONIC) < End)
+  {
+    SHT1x_Sched_Poll(&Sched);
+    Result->Wakeups++;
+
+    Idle = SHT1x_Sched_IdleTime(&Sched);
+    if (Idle == 0)
+      Idle = 1;
+    if (Idle > 100)
+      Idle = 100;
+    Sleep.tv_nsec = (long)Idle * 1000000L;
+    nanosleep(&Sleep, NULL);
+  }
+  Result->CpuS = (ClockNs(CLOCK_PROCESS_CPUTIME_ID) - Cpu) / 1e9;
+  Result->WallS = (ClockNs(CLOCK_MONOTONIC) - Wall) / 1e9;
+
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    Result->Samples += SchedSensors[i].Samples;
+    Result->Errors += SchedSensors[i].Errors;
+    Result->Missed += SchedSensors[i].Missed;
+  }
+
+  return 0;
+}
+
+static void
+Print(uint32_t Count, const char *Mode, const Result_t *Result)
+{
+  printf("%7u  %-11s %9.1f %7u %7u %7.2f %10.2f %10.1f\n", (unsigned)Count, Mode,
+         Result->Samples / Result->WallS, (unsigned)Result->Errors,
+         (unsigned)Result->Missed, 100.0 * Result->CpuS / Result->WallS,
+         Result->Samples ? 1e6 * Result->CpuS / Result->Samples : 0.0,
+         Result->Wakeups / Result->WallS);
+}
+
+static void
+Usage(const char *Name)
+{
+  fprintf(stderr, "usage: %s [-n max_sensors] [-p period_ms] [-t seconds]\n", Name);
+}
+
+
+int main(int argc, char **argv)
+{
+  static const uint32_t Steps[] = {1, 10, 100, 250, 500, 1000};
+  static const char *const Modes[] = {"epoll/timer", "epoll/edge", "poll 1 ms"};
+  uint32_t MaxCount = MAX_SENSORS;
+  uint32_t PeriodMs = 1000;
+  uint32_t Seconds = 2;
+  uint32_t Errors = 0;
+  struct rlimit Limit;
+  Result_t Result;
+  int Opt;
+
+  while ((Opt = getopt(argc, argv, "n:p:t:")) != -1)
+  {
+    switch (Opt)
+    {
+    case 'n': MaxCount = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 'p': PeriodMs = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 't': Seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+    default: Usage(argv[0]); return 2;
+    }
+  }
+
+  if (!MaxCount || MaxCount > MAX_SENSORS || !PeriodMs || !Seconds)
+  {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  // two descriptors per sensor with emulated edges
+  if (getrlimit(RLIMIT_NOFILE, &Limit) == 0 && Limit.rlim_cur < Limit.rlim_max)
+  {
+    Limit.rlim_cur = Limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &Limit);
+  }
+
+  BaseNs = ClockNs(CLOCK_MONOTONIC);
+
+  printf("period %u ms, %u s per run\n\n", (unsigned)PeriodMs, (unsigned)Seconds);
+  printf("sensors  mode        samples/s  errors  missed   cpu %%  cpu us/smp  wakeups/s\n");
+
+  for (uint32_t s = 0; s < sizeof(Steps) / sizeof(Steps[0]) && Steps[s] <= MaxCount; s++)
+  {
+    const uint32_t Count = Steps[s];
+
+    for (uint8_t Mode = 0; Mode < 3; Mode++)
+    {
+      // SHT1x_sched.c handles up to 255 sensors
+      if (Mode == 2 && Count > 255)
+        break;
+
+      // fresh sensors, the previous run may have left conversions pending
+      if (Setup(Count) != 0)
+      {
+        fprintf(stderr, "sensor initialization failed\n");
+        return 1;
+      }
+      if ((Mode < 2 ? RunLoop(Count, PeriodMs, Seconds, Mode, &Result) :
+                      RunPoll(Count, PeriodMs, Seconds, &Result)) != 0)
+      {
+        perror("run");
+        return 1;
+      }
+      Teardown(Count);
+
+      Print(Count, Modes[Mode], &Result);
+      Errors += Result.Errors;
+    }
+  }
+
+  return Errors ? 1 : 0;
+}
@@ -0,0 +1,540 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_history.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Persistent raw sample history (Linux)
+ *         Functionalities of the this file:
+ *          + Append-only ring of fixed-size raw sample records in a mapped file
+ *          + Crash-consistent head/tail metadata with batched msync
+ *          + Zero-copy time range lookup
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "SHT1x_history.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+/**
+ * @brief  The two metadata copies live in different 512-byte sectors, so a torn
+ *         write can only damage the copy that is being written.
+ */
+#define SHT1X_HISTORY_META_OFFSET0  512
+#define SHT1X_HISTORY_META_OFFSET1  1024
+
+
+/* Private Data Types -----------------------------------------------------------*/
+typedef struct SHT1x_HistoryFile_s
+{
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t RecordSize;
+  uint32_t Capacity;
+  uint32_t Batch;
+} SHT1x_HistoryFile_t;
+
+typedef struct SHT1x_HistoryMeta_s
+{
+  uint64_t Seq;
+  uint64_t Head;
+  uint32_t Crc;
+  uint32_t Reserved;
+} SHT1x_HistoryMeta_t;
+
+_Static_assert(sizeof(SHT1x_HistoryRecord_t) == 16, "record must be 16 bytes");
+
+
+/* Private Macros ---------------------------------------------------------------*/
+#define SHT1X_HISTORY_FILE(History) \
+  ((SHT1x_HistoryFile_t *)(History)->Map)
+
+#define SHT1X_HISTORY_META(History, Index) \
+  ((SHT1x_HistoryMeta_t *)((History)->Map + ((Index) ? SHT1X_HISTORY_META_OFFSET1 : \
+                                                      SHT1X_HISTORY_META_OFFSET0)))
+
+#define SHT1X_HISTORY_RECORDS(History) \
+  ((SHT1x_HistoryRecord_t *)((History)->Map + SHT1X_HISTORY_HEADER_SIZE))
+
+#define SHT1X_HISTORY_RECORD(History, Number) \
+  (&SHT1X_HISTORY_RECORDS(History)[(Number) % (History)->Capacity])
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static uint32_t
+SHT1x_History_Crc(const SHT1x_HistoryMeta_t *Meta)
+{
+  const uint8_t *Data = (const uint8_t *)Meta;
+  uint32_t Crc = 0xFFFFFFFF;
+
+  for (size_t i = 0; i < offsetof(SHT1x_HistoryMeta_t, Crc); i++)
+  {
+    Crc ^= Data[i];
+    for (uint8_t Bit = 0; Bit < 8; Bit++)
+      Crc = (Crc >> 1) ^ (0xEDB88320 & (0 - (Crc & 1)));
+  }
+
+  return ~Crc;
+}
+
+static SHT1x_Result_t
+SHT1x_History_LoadMeta(SHT1x_History_t *History)
+{
+  SHT1x_HistoryMeta_t Meta[2];
+  uint8_t Valid[2];
+  uint8_t Use;
+
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    memcpy(&Meta[i], SHT1X_HISTORY_META(History, i), sizeof(Meta[i]));
+    Valid[i] = (Meta[i].Crc == SHT1x_History_Crc(&Meta[i])) ? 1 : 0;
+  }
+
+  if (!Valid[0] && !Valid[1])
+    return SHT1x_FAIL;
+
+  if (Valid[0] && Valid[1])
+    Use = (Meta[1].Seq > Meta[0].Seq) ? 1 : 0;
+  else
+    Use = Valid[1];
+
+  History->MetaSeq = Meta[Use].Seq;
+  History->DurableHead = Meta[Use].Head;
+  return SHT1x_OK;
+}
+
+static int
+SHT1x_History_SyncRecords(SHT1x_History_t *History, uint32_t First, uint32_t Count)
+{
+  long Page = sysconf(_SC_PAGESIZE);
+  uintptr_t Start, End;
+
+  Start = (uintptr_t)&SHT1X_HISTORY_RECORDS(History)[First];
+  End = Start + (uintptr_t)Count * sizeof(SHT1x_HistoryRecord_t);
+  Start &= ~(uintptr_t)(Page - 1);
+
+  return msync((void *)Start, End - Start, MS_SYNC);
+}
+
+static SHT1x_Result_t
+SHT1x_History_Map(SHT1x_History_t *History, int Fd, uint8_t Writer)
+{
+  SHT1x_HistoryFile_t *File;
+  struct stat St;
+  void *Map;
+
+  if (fstat(Fd, &St) != 0 || (size_t)St.st_size < SHT1X_HISTORY_HEADER_SIZE)
+    return SHT1x_FAIL;
+
+  Map = mmap(NULL, (size_t)St.st_size, Writer ? (PROT_READ | PROT_WRITE) : PROT_READ,
+             MAP_SHARED, Fd, 0);
+  if (Map == MAP_FAILED)
+    return SHT1x_FAIL;
+
+  History->Map = (uint8_t *)Map;
+  History->Size = (size_t)St.st_size;
+  History->Fd = Fd;
+  History->Writer = Writer;
+  History->Flushes = 0;
+  History->Rejected = 0;
+
+  File = SHT1X_HISTORY_FILE(History);
+  if (File->Magic != SHT1X_HISTORY_MAGIC ||
+      File->Version != SHT1X_HISTORY_VERSION ||
+      File->RecordSize != sizeof(SHT1x_HistoryRecord_t) ||
+      !File->Batch || File->Capacity <= File->Batch ||
+      SHT1X_HISTORY_HEADER_SIZE + (size_t)File->Capacity * sizeof(SHT1x_HistoryRecord_t) >
+      History->Size ||
+      SHT1x_History_LoadMeta(History) != SHT1x_OK)
+  {
+    munmap(Map, History->Size);
+    History->Map = NULL;
+    return SHT1x_FAIL;
+  }
+
+  History->Capacity = File->Capacity;
+  History->Batch = File->Batch;
+  History->Head = History->DurableHead;
+  return SHT1x_OK;
+}
+
+/**
+ * @brief  Build an empty file next to Path and rename it into place, so Path is
+ *         either missing or complete whatever point a crash hits.
+ */
+static SHT1x_Result_t
+SHT1x_History_Init(const char *Path, uint32_t Capacity)
+{
+  SHT1x_HistoryFile_t File = {0};
+  SHT1x_HistoryMeta_t Meta = {0};
+  uint8_t Header[SHT1X_HISTORY_HEADER_SIZE] = {0};
+  char Temp[PATH_MAX];
+  int Fd;
+
+  if (Capacity <= SHT1X_HISTORY_BATCH ||
+      snprintf(Temp, sizeof(Temp), "%s.tmp", Path) >= (int)sizeof(Temp))
+    return SHT1x_FAIL;
+
+  Fd = open(Temp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (Fd < 0)
+    return SHT1x_FAIL;
+
+  File.Magic = SHT1X_HISTORY_MAGIC;
+  File.Version = SHT1X_HISTORY_VERSION;
+  File.RecordSize = sizeof(SHT1x_HistoryRecord_t);
+  File.Capacity = Capacity;
+  File.Batch = SHT1X_HISTORY_BATCH;
+  memcpy(Header, &File, sizeof(File));
+  Meta.Crc = SHT1x_History_Crc(&Meta);
+  memcpy(&Header[SHT1X_HISTORY_META_OFFSET0], &Meta, sizeof(Meta));
+
+  if (ftruncate(Fd, (off_t)(SHT1X_HISTORY_HEADER_SIZE +
+                            (size_t)Capacity * sizeof(SHT1x_HistoryRecord_t))) != 0 ||
+      pwrite(Fd, Header, sizeof(Header), 0) != (ssize_t)sizeof(Header) ||
+      fsync(Fd) != 0)
+  {
+    close(Fd);
+    unlink(Temp);
+    return SHT1x_FAIL;
+  }
+  close(Fd);
+
+  if (rename(Temp, Path) != 0)
+  {
+    unlink(Temp);
+    return SHT1x_FAIL;
+  }
+
+  return SHT1x_OK;
+}
+
+static uint64_t
+SHT1x_History_LowerBound(const SHT1x_History_t *History, uint64_t Tail, uint64_t Head,
+                         uint64_t TimestampMs)
+{
+  uint64_t Mid;
+
+  while (Tail < Head)
+  {
+    Mid = Tail + (Head - Tail) / 2;
+    if (SHT1X_HISTORY_RECORD(History, Mid)->TimestampMs < TimestampMs)
+      Tail = Mid + 1;
+    else
+      Head = Mid;
+  }
+
+  return Tail;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Open a history file for appending. The file is created with room for
+ *         Capacity records if it does not exist or was never completed (no
+ *         magic); an existing file keeps its capacity and its records up to
+ *         the last durable head.
+ * @param  History: Pointer to history
+ * @param  Path: File path
+ * @param  Capacity: Number of records of a new file
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: File error or invalid file.
+ */
+SHT1x_Result_t
+SHT1x_History_Create(SHT1x_History_t *History, const char *Path, uint32_t Capacity)
+{
+  uint32_t Magic = 0;
+  struct stat St;
+  int Fd;
+
+  Fd = open(Path, O_RDWR);
+  if (Fd < 0 && errno != ENOENT)
+    return SHT1x_FAIL;
+
+  // a file without magic was never published (or is left over from a crash)
+  if (Fd >= 0 &&
+      (fstat(Fd, &St) != 0 ||
+       (St.st_size > 0 && pread(Fd, &Magic, sizeof(Magic), 0) != (ssize_t)sizeof(Magic))))
+    goto fail;
+
+  if (Fd < 0 || St.st_size == 0 || Magic == 0)
+  {
+    if (Fd >= 0)
+      close(Fd);
+    if (SHT1x_History_Init(Path, Capacity) != SHT1x_OK)
+      return SHT1x_FAIL;
+    Fd = open(Path, O_RDWR);
+    if (Fd < 0)
+      return SHT1x_FAIL;
+  }
+
+  if (SHT1x_History_Map(History, Fd, 1) != SHT1x_OK)
+    goto fail;
+
+  return SHT1x_OK;
+
+fail:
+  close(Fd);
+  return SHT1x_FAIL;
+}
+
+
+/**
+ * @brief  Open a history file read-only. A reader may run next to the writer;
+ *         call SHT1x_History_Refresh to see records flushed later.
+ * @param  History: Pointer to history
+ * @param  Path: File path
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: File error or invalid file.
+ */
+SHT1x_Result_t
+SHT1x_History_Open(SHT1x_History_t *History, const char *Path)
+{
+  int Fd;
+
+  Fd = open(Path, O_RDONLY);
+  if (Fd < 0)
+    return SHT1x_FAIL;
+
+  if (SHT1x_History_Map(History, Fd, 0) != SHT1x_OK)
+  {
+    close(Fd);
+    return SHT1x_FAIL;
+  }
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Flush (writer) and unmap the file.
+ * @param  History: Pointer to history
+ * @retval None
+ */
+void
+SHT1x_History_Close(SHT1x_History_t *History)
+{
+  if (!History->Map)
+    return;
+
+  if (History->Writer)
+    SHT1x_History_Flush(History);
+
+  munmap(History->Map, History->Size);
+  close(History->Fd);
+  History->Map = NULL;
+}
+
+
+/**
+ * @brief  Append one record, overwriting the oldest one when the ring is full.
+ *         Records must come in timestamp order. Flushes every
+ *         SHT1X_HISTORY_BATCH records.
+ * @param  History: Pointer to history
+ * @param  Record: Record to append
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Read-only history, record older than the last one or
+ *                       flush failed.
+ */
+SHT1x_Result_t
+SHT1x_History_Append(SHT1x_History_t *History, const SHT1x_HistoryRecord_t *Record)
+{
+  if (!History->Writer)
+    return SHT1x_FAIL;
+
+  // SHT1x_History_Find searches the ring by timestamp
+  if (History->Head &&
+      Record->TimestampMs < SHT1X_HISTORY_RECORD(History, History->Head - 1)->TimestampMs)
+  {
+    History->Rejected++;
+    return SHT1x_FAIL;
+  }
+
+  *SHT1X_HISTORY_RECORD(History, History->Head) = *Record;
+  History->Head++;
+
+  if ((History->Head - History->DurableHead) >= History->Batch)
+    return SHT1x_History_Flush(History);
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Make the appended records durable: sync the dirty record pages, then
+ *         publish the new head in the metadata and sync the header page.
+ * @param  History: Pointer to history
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Read-only history or msync failed.
+ */
+SHT1x_Result_t
+SHT1x_History_Flush(SHT1x_History_t *History)
+{
+  SHT1x_HistoryMeta_t Meta = {0};
+  uint64_t Dirty;
+  uint32_t First;
+  int Error;
+
+  if (!History->Writer)
+    return SHT1x_FAIL;
+
+  Dirty = History->Head - History->DurableHead;
+  if (!Dirty)
+    return SHT1x_OK;
+
+  // 1. records
+  First = (uint32_t)(History->DurableHead % History->Capacity);
+  if (Dirty >= History->Capacity)
+    Error = SHT1x_History_SyncRecords(History, 0, History->Capacity);
+  else if (First + Dirty <= History->Capacity)
+    Error = SHT1x_History_SyncRecords(History, First, (uint32_t)Dirty);
+  else
+    Error = SHT1x_History_SyncRecords(History, First, History->Capacity - First) |
+            SHT1x_History_SyncRecords(History, 0,
+                                      (uint32_t)(Dirty - (History->Capacity - First)));
+  if (Error)
+    return SHT1x_FAIL;
+
+  // 2. head, in the older metadata copy
+  Meta.Seq = History->MetaSeq + 1;
+  Meta.Head = History->Head;
+  Meta.Crc = SHT1x_History_Crc(&Meta);
+  memcpy(SHT1X_HISTORY_META(History, Meta.Seq & 1), &Meta, sizeof(Meta));
+  if (msync(History->Map, SHT1X_HISTORY_HEADER_SIZE, MS_SYNC) != 0)
+    return SHT1x_FAIL;
+
+  History->MetaSeq = Meta.Seq;
+  History->DurableHead = History->Head;
+  History->Flushes++;
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Reload the durable head from the metadata (readers).
+ * @param  History: Pointer to history
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No valid metadata.
+ */
+SHT1x_Result_t
+SHT1x_History_Refresh(SHT1x_History_t *History)
+{
+  if (History->Writer)
+    return SHT1x_OK;
+
+  if (SHT1x_History_LoadMeta(History) != SHT1x_OK)
+    return SHT1x_FAIL;
+
+  History->Head = History->DurableHead;
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Range of record numbers held by the ring: [Tail, Head).
+ * @param  History: Pointer to history
+ * @param  Tail: Pointer to get the oldest record number (can be NULL)
+ * @param  Head: Pointer to get the next record number (can be NULL)
+ * @retval Number of records
+ */
+uint32_t
+SHT1x_History_Count(const SHT1x_History_t *History, uint64_t *Tail, uint64_t *Head)
+{
+  // the writer may already have overwritten the oldest Batch records with
+  // records that are not durable yet
+  uint32_t Size = History->Capacity - History->Batch;
+  uint64_t First = (History->Head > Size) ? (History->Head - Size) : 0;
+
+  if (Tail)
+    *Tail = First;
+  if (Head)
+    *Head = History->Head;
+
+  return (uint32_t)(History->Head - First);
+}
+
+
+/**
+ * @brief  Find the records with FromMs <= TimestampMs < ToMs without copying
+ *         them. The result is at most two spans because the ring wraps.
+ * @note   The writer may overwrite the oldest records while a reader scans
+ *         them. Readers that run next to the writer check with
+ *         SHT1x_History_Count that the tail did not pass the first record.
+ * @param  History: Pointer to history
+ * @param  FromMs: Start of the range
+ * @param  ToMs: End of the range (exclusive)
+ * @param  Spans: Array of two spans
+ * @param  First: Pointer to get the record number of the first record (can be NULL)
+ * @retval Number of records in the range
+ */
+uint32_t
+SHT1x_History_Find(const SHT1x_History_t *History, uint64_t FromMs, uint64_t ToMs,
+                   SHT1x_HistorySpan_t Spans[2], uint64_t *First)
+{
+  uint64_t Tail, Head, Begin, End;
+  uint32_t Index, Count;
+
+  SHT1x_History_Count(History, &Tail, &Head);
+  Begin = SHT1x_History_LowerBound(History, Tail, Head, FromMs);
+  End = (ToMs > FromMs) ? SHT1x_History_LowerBound(History, Begin, Head, ToMs) : Begin;
+  Count = (uint32_t)(End - Begin);
+
+  Index = (uint32_t)(Begin % History->Capacity);
+  Spans[0].Records = &SHT1X_HISTORY_RECORDS(History)[Index];
+  Spans[0].Count = (Count < History->Capacity - Index) ? Count : (History->Capacity - Index);
+  Spans[1].Records = SHT1X_HISTORY_RECORDS(History);
+  Spans[1].Count = Count - Spans[0].Count;
+
+  if (First)
+    *First = Begin;
+
+  return Count;
+}
@@ -0,0 +1,239 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_history.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Persistent raw sample history (Linux)
+ *         Functionalities of the this file:
+ *          + Append-only ring of fixed-size raw sample records in a mapped file
+ *          + Crash-consistent head/tail metadata with batched msync
+ *          + Zero-copy time range lookup
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_HISTORY_H_
+#define _SHT1X_HISTORY_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "SHT1x.h"
+
+
+/* Exported Constants -----------------------------------------------------------*/
+#define SHT1X_HISTORY_MAGIC         0x48315453  // "ST1H"
+#define SHT1X_HISTORY_VERSION       1
+
+/**
+ * @brief  Size of the file header. Records start at this offset.
+ */
+#define SHT1X_HISTORY_HEADER_SIZE   4096
+
+/**
+ * @brief  Number of appended records that triggers SHT1x_History_Flush. The
+ *         oldest SHT1X_HISTORY_BATCH records of a full ring are not readable
+ *         because the writer may be overwriting them.
+ */
+#ifndef SHT1X_HISTORY_BATCH
+#define SHT1X_HISTORY_BATCH         64
+#endif
+
+/**
+ * @brief  Record flags
+ */
+#define SHT1X_HISTORY_FLAG_ERROR    0x01  // Sample failed, raw values are invalid
+#define SHT1X_HISTORY_FLAG_MISSED   0x02  // Sample completed after its deadline
+#define SHT1X_HISTORY_FLAG_LOW_RES  0x04  // 12-bit temperature, 8-bit humidity
+#define SHT1X_HISTORY_FLAG_HEATER   0x08  // Internal heater was on
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  One record (16 bytes). Records are appended in timestamp order.
+ */
+typedef struct SHT1x_HistoryRecord_s
+{
+  uint64_t TimestampMs;
+  uint16_t TempRaw;
+  uint16_t HumRaw;
+  uint8_t  Sensor;
+  uint8_t  Flags;
+  uint16_t Reserved;
+} SHT1x_HistoryRecord_t;
+
+/**
+ * @brief  Contiguous run of records inside the mapping
+ */
+typedef struct SHT1x_HistorySpan_s
+{
+  const SHT1x_HistoryRecord_t *Records;
+  uint32_t Count;
+} SHT1x_HistorySpan_t;
+
+/**
+ * @brief  Open history file
+ */
+typedef struct SHT1x_History_s
+{
+  uint8_t *Map;
+  size_t Size;
+  int Fd;
+  uint8_t Writer;
+  uint32_t Capacity;        // Number of records in the ring
+  uint32_t Batch;           // Records appended between two flushes (at most)
+  uint64_t Head;            // Number of records ever appended
+  uint64_t DurableHead;     // Head stored in the file metadata
+  uint64_t MetaSeq;
+  uint32_t Flushes;
+  uint32_t Rejected;        // Records older than the last one
+} SHT1x_History_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Open a history file for appending. The file is created with room for
+ *         Capacity records if it does not exist or was never completed (no
+ *         magic); an existing file keeps its capacity and its records up to
+ *         the last durable head.
+ * @param  History: Pointer to history
+ * @param  Path: File path
+ * @param  Capacity: Number of records of a new file (> SHT1X_HISTORY_BATCH)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: File error or invalid file.
+ */
+SHT1x_Result_t
+SHT1x_History_Create(SHT1x_History_t *History, const char *Path, uint32_t Capacity);
+
+
+/**
+ * @brief  Open a history file read-only. A reader may run next to the writer;
+ *         call SHT1x_History_Refresh to see records flushed later.
+ * @param  History: Pointer to history
+ * @param  Path: File path
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: File error or invalid file.
+ */
+SHT1x_Result_t
+SHT1x_History_Open(SHT1x_History_t *History, const char *Path);
+
+
+/**
+ * @brief  Flush (writer) and unmap the file.
+ * @param  History: Pointer to history
+ * @retval None
+ */
+void
+SHT1x_History_Close(SHT1x_History_t *History);
+
+
+/**
+ * @brief  Append one record, overwriting the oldest one when the ring is full.
+ *         Records must come in timestamp order. Flushes every
+ *         SHT1X_HISTORY_BATCH records.
+ * @param  History: Pointer to history
+ * @param  Record: Record to append
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Read-only history, record older than the last one or
+ *                       flush failed.
+ */
+SHT1x_Result_t
+SHT1x_History_Append(SHT1x_History_t *History, const SHT1x_HistoryRecord_t *Record);
+
+
+/**
+ * @brief  Make the appended records durable: sync the dirty record pages, then
+ *         publish the new head in the metadata and sync the header page.
+ * @param  History: Pointer to history
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Read-only history or msync failed.
+ */
+SHT1x_Result_t
+SHT1x_History_Flush(SHT1x_History_t *History);
+
+
+/**
+ * @brief  Reload the durable head from the metadata (readers).
+ * @param  History: Pointer to history
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: No valid metadata.
+ */
+SHT1x_Result_t
+SHT1x_History_Refresh(SHT1x_History_t *History);
+
+
+/**
+ * @brief  Range of record numbers held by the ring: [Tail, Head).
+ * @param  History: Pointer to history
+ * @param  Tail: Pointer to get the oldest record number (can be NULL)
+ * @param  Head: Pointer to get the next record number (can be NULL)
+ * @retval Number of records
+ */
+uint32_t
+SHT1x_History_Count(const SHT1x_History_t *History, uint64_t *Tail, uint64_t *Head);
+
+
+/**
+ * @brief  Find the records with FromMs <= TimestampMs < ToMs without copying
+ *         them. The result is at most two spans because the ring wraps.
+ * @note   The writer may overwrite the oldest records while a reader scans
+ *         them. Readers that run next to the writer check with
+ *         SHT1x_History_Count that the tail did not pass the first record.
+ * @param  History: Pointer to history
+ * @param  FromMs: Start of the range
+ * @param  ToMs: End of the range (exclusive)
+ * @param  Spans: Array of two spans
+ * @param  First: Pointer to get the record number of the first record (can be NULL)
+ * @retval Number of records in the range
+ */
+uint32_t
+SHT1x_History_Find(const SHT1x_History_t *History, uint64_t FromMs, uint64_t ToMs,
+                   SHT1x_HistorySpan_t Spans[2], uint64_t *First);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_HISTORY_H_
@@ -0,0 +1,343 @@
+/**
+ **********************************************************************************
+ * @file   history_tool.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Create, fill, inspect and scan SHT1x history files
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "SHT1x.h"
+#include "SHT1x_history.h"
+#include "SHT1x_platform.h"
+
+
+static uint64_t
+ClockNs(clockid_t Clock)
+{
+  struct timespec Ts;
+  clock_gettime(Clock, &Ts);
+  return (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
+
+static const SHT1x_HistoryRecord_t *
+LastRecord(const SHT1x_History_t *History)
+{
+  SHT1x_HistorySpan_t Spans[2];
+
+  if (!SHT1x_History_Find(History, 0, ~0ULL, Spans, NULL))
+    return NULL;
+
+  if (Spans[1].Count)
+    return &Spans[1].Records[Spans[1].Count - 1];
+  return &Spans[0].Records[Spans[0].Count - 1];
+}
+
+static int
+Usage(void)
+{
+  fprintf(stderr,
+          "usage: sht1x_history fill FILE [records] [period_ms] [capacity]\n"
+          "       sht1x_history info FILE\n"
+          "       sht1x_history scan FILE [from_ms] [to_ms]\n"
+          "       sht1x_history crash FILE [rounds]\n");
+  return 2;
+}
+
+
+/*
+ * fill: sample the simulated sensor every period_ms of virtual time, starting
+ * at the current wall time, and append the raw values.
+ */
+static int
+Fill(const char *Path, uint32_t Records, uint32_t PeriodMs, uint32_t Capacity)
+{
+  SHT1x_Handler_t Handler = {0};
+  SHT1x_Sample_t Sample = {0};
+  SHT1x_HistoryRecord_t Record = {0};
+  SHT1x_History_t History;
+  const SHT1x_HistoryRecord_t *Last;
+  SHT1x_Sim_t *Sim;
+  uint64_t TimestampMs, Start, Ns = 0;
+
+  if (SHT1x_History_Create(&History, Path, Capacity) != SHT1x_OK)
+  {
+    fprintf(stderr, "cannot create %s\n", Path);
+    return 1;
+  }
+
+  Sim = SHT1x_Platform_GetSim();
+  SHT1x_Platform_Init(&Handler);
+  SHT1x_Init(&Handler);
+
+  // continue after the last record of an existing file
+  TimestampMs = ClockNs(CLOCK_REALTIME) / 1000000;
+  Last = LastRecord(&History);
+  if (Last && Last->TimestampMs >= TimestampMs)
+    TimestampMs = Last->TimestampMs + PeriodMs;
+
+  for (uint32_t i = 0; i < Records; i++)
+  {
+    Sim->AmbientC = 22.0f + 3.0f * (float)((i / 600) % 7);
+    Sim->HumidityP = 40.0f + (float)((i / 60) % 20);
+
+    Record.TimestampMs = TimestampMs;
+    Record.Flags = 0;
+    if (SHT1x_ReadSample(&Handler, &Sample) == SHT1x_OK)
+    {
+      Record.TempRaw = Sample.TempRaw;
+      Record.HumRaw = Sample.HumRaw;
+    }
+    else
+    {
+      Record.Flags |= SHT1X_HISTORY_FLAG_ERROR;
+    }
+
+    Start = ClockNs(CLOCK_MONOTONIC);
+    if (SHT1x_History_Append(&History, &Record) != SHT1x_OK)
+    {
+      fprintf(stderr, "append failed\n");
+      return 1;
+    }
+    Ns += ClockNs(CLOCK_MONOTONIC) - Start;
+
+    SHT1x_Sim_Advance(Sim, (uint64_t)PeriodMs * 1000000);
+    TimestampMs += PeriodMs;
+  }
+
+  SHT1x_History_Flush(&History);
+  printf("appended %u records, %u flushes, %.1f ns/append (including msync)\n",
+         (unsigned)Records, (unsigned)History.Flushes, Records ? (double)Ns / Records : 0.0);
+
+  SHT1x_History_Close(&History);
+  SHT1x_DeInit(&Handler);
+  return 0;
+}
+
+
+static int
+Info(const char *Path)
+{
+  SHT1x_History_t History;
+  SHT1x_HistorySpan_t Spans[2];
+  uint64_t Tail, Head;
+  uint32_t Count;
+
+  if (SHT1x_History_Open(&History, Path) != SHT1x_OK)
+  {
+    fprintf(stderr, "cannot open %s\n", Path);
+    return 1;
+  }
+
+  Count = SHT1x_History_Count(&History, &Tail, &Head);
+  printf("capacity %u, records %u, tail %llu, head %llu\n", (unsigned)History.Capacity,
+         (unsigned)Count, (unsigned long long)Tail, (unsigned long long)Head);
+
+  if (SHT1x_History_Find(&History, 0, ~0ULL, Spans, NULL))
+    printf("first %llu ms, last %llu ms\n",
+           (unsigned long long)Spans[0].Records[0].TimestampMs,
+           (unsigned long long)LastRecord(&History)->TimestampMs);
+
+  SHT1x_History_Close(&History);
+  return 0;
+}
+
+
+static int
+Scan(const char *Path, uint64_t FromMs, uint64_t ToMs)
+{
+  SHT1x_History_t History;
+  SHT1x_HistorySpan_t Spans[2];
+  uint16_t TempMin = 0xFFFF, TempMax = 0, HumMin = 0xFFFF, HumMax = 0;
+  uint32_t Count, Errors = 0;
+  uint64_t Start, Ns;
+
+  if (SHT1x_History_Open(&History, Path) != SHT1x_OK)
+  {
+    fprintf(stderr, "cannot open %s\n", Path);
+    return 1;
+  }
+
+  Start = ClockNs(CLOCK_MONOTONIC);
+  Count = SHT1x_History_Find(&History, FromMs, ToMs, Spans, NULL);
+  for (uint8_t s = 0; s < 2; s++)
+  {
+    const SHT1x_HistoryRecord_t *Record = Spans[s].Records;
+    for (uint32_t i = 0; i < Spans[s].Count; i++, Record++)
+    {
+      if (Record->Flags & SHT1X_HISTORY_FLAG_ERROR)
+      {
+        Errors++;
+        continue;
+      }
+      if (Record->TempRaw < TempMin) TempMin = Record->TempRaw;
+      if (Record->TempRaw > TempMax) TempMax = Record->TempRaw;
+      if (Record->HumRaw < HumMin) HumMin = Record->HumRaw;
+      if (Record->HumRaw > HumMax) HumMax = Record->HumRaw;
+    }
+  }
+  Ns = ClockNs(CLOCK_MONOTONIC) - Start;
+
+  printf("records %u (errors %u), TempRaw %u..%u, HumRaw %u..%u, %.3f ms\n",
+         (unsigned)Count, (unsigned)Errors, Count ? TempMin : 0, TempMax,
+         Count ? HumMin : 0, HumMax, Ns / 1e6);
+
+  SHT1x_History_Close(&History);
+  return 0;
+}
+
+
+/*
+ * crash: a child appends records whose timestamp equals their record number
+ * and is killed (SIGKILL) at a random time. Every reopen must find a head
+ * whose records are all present and intact. SIGKILL keeps the page cache, so
+ * this checks the metadata protocol, not power loss. Afterwards, an older
+ * record must be rejected and a file with a zeroed header must be rebuilt.
+ */
+static int
+Crash(const char *Path, uint32_t Rounds)
+{
+  SHT1x_History_t History;
+  SHT1x_HistoryRecord_t Record = {0};
+  SHT1x_HistorySpan_t Spans[2];
+  uint64_t First, Number;
+  uint32_t Errors = 0;
+  pid_t Pid;
+
+  unlink(Path);
+  srand((unsigned)getpid());
+
+  for (uint32_t Round = 0; Round < Rounds; Round++)
+  {
+    Pid = fork();
+    if (Pid == 0)
+    {
+      if (SHT1x_History_Create(&History, Path, 10000) != SHT1x_OK)
+        _exit(1);
+      for (;;)
+      {
+        Record.TimestampMs = History.Head;
+        Record.TempRaw = (uint16_t)(History.Head & 0x3FFF);
+        Record.HumRaw = (uint16_t)(History.Head >> 14 & 0x0FFF);
+        SHT1x_History_Append(&History, &Record);
+      }
+    }
+
+    usleep(1000 + rand() % 20000);
+    kill(Pid, SIGKILL);
+    waitpid(Pid, NULL, 0);
+
+    if (SHT1x_History_Open(&History, Path) != SHT1x_OK)
+    {
+      Errors++;
+      continue;
+    }
+
+    SHT1x_History_Find(&History, 0, ~0ULL, Spans, &First);
+    Number = First;
+    for (uint8_t s = 0; s < 2; s++)
+    {
+      for (uint32_t i = 0; i < Spans[s].Count; i++, Number++)
+      {
+        const SHT1x_HistoryRecord_t *R = &Spans[s].Records[i];
+        if (R->TimestampMs != Number || R->TempRaw != (Number & 0x3FFF) ||
+            R->HumRaw != (Number >> 14 & 0x0FFF))
+          Errors++;
+      }
+    }
+    if (Number != History.Head)
+      Errors++;
+
+    SHT1x_History_Close(&History);
+  }
+
+  SHT1x_History_Open(&History, Path);
+  printf("%u kills, %llu records survived, %u errors\n", (unsigned)Rounds,
+         (unsigned long long)History.Head, (unsigned)Errors);
+  SHT1x_History_Close(&History);
+
+  // timestamps must not go backwards
+  if (SHT1x_History_Create(&History, Path, 10000) == SHT1x_OK)
+  {
+    Record.TimestampMs = History.Head - 2;
+    if (History.Head > 1 && SHT1x_History_Append(&History, &Record) == SHT1x_OK)
+      Errors++;
+    Record.TimestampMs = History.Head;
+    if (SHT1x_History_Append(&History, &Record) != SHT1x_OK)
+      Errors++;
+    printf("out of order: %u rejected\n", (unsigned)History.Rejected);
+    SHT1x_History_Close(&History);
+  }
+  else
+  {
+    Errors++;
+  }
+
+  // header lost between ftruncate and the first header write
+  if (truncate(Path, 0) != 0 || truncate(Path, 64 * 1024) != 0 ||
+      SHT1x_History_Create(&History, Path, 10000) != SHT1x_OK)
+  {
+    Errors++;
+  }
+  else
+  {
+    printf("zeroed header: rebuilt, %llu records\n", (unsigned long long)History.Head);
+    SHT1x_History_Close(&History);
+  }
+
+  return Errors ? 1 : 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+    return Usage();
+
+  if (!strcmp(argv[1], "fill"))
+    return Fill(argv[2],
+                (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 86400,
+                (argc > 4) ? (uint32_t)strtoul(argv[4], NULL, 0) : 1000,
+                (argc > 5) ? (uint32_t)strtoul(argv[5], NULL, 0) : 30 * 86400);
+  if (!strcmp(argv[1], "info"))
+    return Info(argv[2]);
+  if (!strcmp(argv[1], "scan"))
+    return Scan(argv[2],
+                (argc > 3) ? strtoull(argv[3], NULL, 0) : 0,
+                (argc > 4) ? strtoull(argv[4], NULL, 0) : ~0ULL);
+  if (!strcmp(argv[1], "crash"))
+    return Crash(argv[2], (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 20);
+
+  return Usage();
+}
@@ -0,0 +1,527 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_sampler.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Parallel sampler of SHT1x sensors on several buses (Linux, pthreads)
+ *         Functionalities of the this file:
+ *          + One acquisition thread per bus (e.g. per gpiochip), pinned to a core
+ *          + Raw samples are handed off through a lock-free queue per bus
+ *          + Processing threads convert and filter them, stealing from the
+ *            queues of other buses when their own are empty
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "SHT1x_sampler.h"
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+
+
+/* Private Constants ------------------------------------------------------------*/
+#if (SHT1X_SAMPLER_QUEUE_SIZE & (SHT1X_SAMPLER_QUEUE_SIZE - 1))
+#error "SHT1X_SAMPLER_QUEUE_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief  Longest sleep of an acquisition thread (ms), so it sees a stop
+ *         request in time
+ */
+#define SHT1X_SAMPLER_MAX_SLEEP_MS  50
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static void
+SHT1x_Sampler_Sleep(uint32_t Us)
+{
+  struct timespec Ts;
+
+  Ts.tv_sec = Us / 1000000;
+  Ts.tv_nsec = (long)(Us % 1000000) * 1000;
+  nanosleep(&Ts, NULL);
+}
+
+static uint64_t
+SHT1x_Sampler_ThreadCpuNs(void)
+{
+  struct timespec Ts;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &Ts);
+  return (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
+
+static void
+SHT1x_Sampler_QueueInit(SHT1x_SamplerQueue_t *Queue)
+{
+  for (uint32_t i = 0; i < SHT1X_SAMPLER_QUEUE_SIZE; i++)
+    atomic_init(&Queue->Cells[i].Seq, i);
+  atomic_init(&Queue->Head, 0);
+  atomic_init(&Queue->Tail, 0);
+}
+
+/**
+ * @brief  Add a sample to the queue.
+ * @retval 1: Added
+ *         0: The queue is full
+ */
+static uint8_t
+SHT1x_Sampler_Push(SHT1x_SamplerQueue_t *Queue, const SHT1x_SamplerSample_t *Sample)
+{
+  uint32_t Pos = atomic_load_explicit(&Queue->Tail, memory_order_relaxed);
+  uint32_t Seq;
+  int32_t  Diff;
+
+  for (;;)
+  {
+    Seq = atomic_load_explicit(&Queue->Cells[Pos & (SHT1X_SAMPLER_QUEUE_SIZE - 1)].Seq,
+                               memory_order_acquire);
+    Diff = (int32_t)(Seq - Pos);
+    if (Diff == 0)
+    {
+      // the cell is free: claim the position
+      if (atomic_compare_exchange_weak_explicit(&Queue->Tail, &Pos, Pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed))
+        break;
+    }
+    else if (Diff < 0)
+    {
+      // the cell still holds the sample of the previous round
+      return 0;
+    }
+    else
+    {
+      Pos = atomic_load_explicit(&Queue->Tail, memory_order_relaxed);
+    }
+  }
+
+  Queue->Cells[Pos & (SHT1X_SAMPLER_QUEUE_SIZE - 1)].Sample = *Sample;
+  atomic_store_explicit(&Queue->Cells[Pos & (SHT1X_SAMPLER_QUEUE_SIZE - 1)].Seq,
+                        Pos + 1, memory_order_release);
+  return 1;
+}
+
+/**
+ * @brief  Take a sample from the queue.
+ * @retval 1: Taken
+ *         0: The queue is empty
+ */
+static uint8_t
+SHT1x_Sampler_Pop(SHT1x_SamplerQueue_t *Queue, SHT1x_SamplerSample_t *Sample)
+{
+  uint32_t Pos = atomic_load_explicit(&Queue->Head, memory_order_relaxed);
+  uint32_t Seq;
+  int32_t  Diff;
+
+  for (;;)
+  {
+    Seq = atomic_load_explicit(&Queue->Cells[Pos & (SHT1X_SAMPLER_QUEUE_SIZE - 1)].Seq,
+                               memory_order_acquire);
+    Diff = (int32_t)(Seq - (Pos + 1));
+    if (Diff == 0)
+    {
+      // the cell is full: claim the position
+      if (atomic_compare_exchange_weak_explicit(&Queue->Head, &Pos, Pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed))
+        break;
+    }
+    else if (Diff < 0)
+    {
+      return 0;
+    }
+    else
+    {
+      Pos = atomic_load_explicit(&Queue->Head, memory_order_relaxed);
+    }
+  }
+
+  *Sample = Queue->Cells[Pos & (SHT1X_SAMPLER_QUEUE_SIZE - 1)].Sample;
+  atomic_store_explicit(&Queue->Cells[Pos & (SHT1X_SAMPLER_QUEUE_SIZE - 1)].Seq,
+                        Pos + SHT1X_SAMPLER_QUEUE_SIZE, memory_order_release);
+  return 1;
+}
+
+static uint8_t
+SHT1x_Sampler_IsEmpty(SHT1x_SamplerQueue_t *Queue)
+{
+  return atomic_load(&Queue->Head) == atomic_load(&Queue->Tail);
+}
+
+static void
+SHT1x_Sampler_PinTo(int Cpu)
+{
+  cpu_set_t Set;
+
+  CPU_ZERO(&Set);
+  CPU_SET(Cpu, &Set);
+  pthread_setaffinity_np(pthread_self(), sizeof(Set), &Set);
+}
+
+/**
+ * @brief  Hand off the samples completed by the last poll of a bus.
+ */
+static void
+SHT1x_Sampler_Collect(SHT1x_Sampler_t *Sampler, uint8_t BusIndex)
+{
+  SHT1x_SamplerBus_t *Bus = &Sampler->Buses[BusIndex];
+  SHT1x_SamplerSample_t Sample = {0};
+
+  Sample.Bus = BusIndex;
+  Sample.TimeMs = Sampler->GetTimeMs();
+
+  for (uint8_t i = 0; i < Bus->Count; i++)
+  {
+    SHT1x_SchedSensor_t *Sensor = &Bus->Sensors[i];
+
+    if (Sensor->Samples == Bus->Seen[i])
+      continue;
+    Bus->Seen[i] = Sensor->Samples;
+
+    Sample.Sensor = i;
+    Sample.Result = Sensor->Result;
+    Sample.TempRaw = Sensor->Sample.TempRaw;
+    Sample.HumRaw = Sensor->Sample.HumRaw;
+    if (SHT1x_Sampler_Push(&Bus->Queue, &Sample))
+      atomic_fetch_add_explicit(&Bus->Samples, 1, memory_order_relaxed);
+    else
+      atomic_fetch_add_explicit(&Bus->Dropped, 1, memory_order_relaxed);
+  }
+}
+
+static void *
+SHT1x_Sampler_Worker(void *Argument)
+{
+  SHT1x_SamplerThread_t *Thread = (SHT1x_SamplerThread_t *)Argument;
+  SHT1x_Sampler_t *Sampler = Thread->Sampler;
+  uint32_t Idle, BusIdle;
+  uint8_t  Completed;
+
+  if (Thread->Cpu >= 0)
+    SHT1x_Sampler_PinTo(Thread->Cpu);
+
+  while (atomic_load_explicit(&Sampler->Acquire, memory_order_relaxed))
+  {
+    Idle = 0xFFFFFFFF;
+    Completed = 0;
+
+    for (uint8_t b = Thread->Index; b < Sampler->BusCount; b += Sampler->Workers)
+    {
+      if (SHT1x_Sched_Poll(&Sampler->Buses[b].Sched))
+      {
+        SHT1x_Sampler_Collect(Sampler, b);
+        Completed = 1;
+      }
+      BusIdle = SHT1x_Sched_IdleTime(&Sampler->Buses[b].Sched);
+      if (BusIdle < Idle)
+        Idle = BusIdle;
+    }
+
+    // poll finishing conversions at SHT1X_SAMPLER_POLL_US
+    if (Idle > SHT1X_SAMPLER_MAX_SLEEP_MS)
+      Idle = SHT1X_SAMPLER_MAX_SLEEP_MS;
+    if (Idle)
+      SHT1x_Sampler_Sleep(Idle * 1000);
+    else if (!Completed)
+      SHT1x_Sampler_Sleep(SHT1X_SAMPLER_POLL_US);
+  }
+
+  Thread->CpuNs = SHT1x_Sampler_ThreadCpuNs();
+  return NULL;
+}
+
+/**
+ * @brief  Convert a raw sample and update the filtered values of its sensor.
+ */
+static void
+SHT1x_Sampler_ProcessSample(SHT1x_Sampler_t *Sampler, SHT1x_SamplerSample_t *Sample)
+{
+  SHT1x_SamplerBus_t *Bus = &Sampler->Buses[Sample->Bus];
+  _Atomic uint64_t *Filter = &Bus->Filter[Sample->Sensor];
+  SHT1x_Sample_t Converted = {0};
+  uint64_t Old, New;
+  float    Values[2];
+
+  if (Sample->Result == SHT1x_OK)
+  {
+    Converted.TempRaw = Sample->TempRaw;
+    Converted.HumRaw = Sample->HumRaw;
+    SHT1x_ConvertSample(Bus->Sensors[Sample->Sensor].Handler, &Converted);
+    Sample->TempCelsius = Converted.TempCelsius;
+    Sample->HumidityPercent = Converted.HumidityPercent;
+
+    // both values of a sensor are updated at once, even when two threads
+    // process samples of the same sensor
+    Old = atomic_load_explicit(Filter, memory_order_relaxed);
+    do
+    {
+      memcpy(Values, &Old, sizeof(Values));
+      if (!Old)
+      {
+        Values[0] = Sample->TempCelsius;
+        Values[1] = Sample->HumidityPercent;
+      }
+      else
+      {
+        Values[0] += (Sample->TempCelsius - Values[0]) / (1 << SHT1X_SAMPLER_FILTER_SHIFT);
+        Values[1] += (Sample->HumidityPercent - Values[1]) / (1 << SHT1X_SAMPLER_FILTER_SHIFT);
+      }
+      memcpy(&New, Values, sizeof(New));
+      if (!New)
+        New = 1;  // 0 marks a sensor without samples
+    } while (!atomic_compare_exchange_weak_explicit(Filter, &Old, New,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+    Sample->TempFiltered = Values[0];
+    Sample->HumFiltered = Values[1];
+  }
+
+  atomic_fetch_add_explicit(&Sampler->Processed, 1, memory_order_relaxed);
+  if (Sampler->OnSample)
+    Sampler->OnSample(Sample, Sampler->Context);
+  else if (!SHT1x_Sampler_Push(&Sampler->Output, Sample))
+    atomic_fetch_add_explicit(&Sampler->Dropped, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief  Process up to SHT1X_SAMPLER_BATCH samples of one bus.
+ * @retval Number of processed samples
+ */
+static uint32_t
+SHT1x_Sampler_Drain(SHT1x_Sampler_t *Sampler, uint8_t BusIndex)
+{
+  SHT1x_SamplerSample_t Sample;
+  uint32_t Count = 0;
+
+  while (Count < SHT1X_SAMPLER_BATCH &&
+         SHT1x_Sampler_Pop(&Sampler->Buses[BusIndex].Queue, &Sample))
+  {
+    SHT1x_Sampler_ProcessSample(Sampler, &Sample);
+    Count++;
+  }
+
+  return Count;
+}
+
+static void *
+SHT1x_Sampler_Processor(void *Argument)
+{
+  SHT1x_SamplerThread_t *Thread = (SHT1x_SamplerThread_t *)Argument;
+  SHT1x_Sampler_t *Sampler = Thread->Sampler;
+  uint32_t Count, Stolen;
+  uint8_t  Stopping, b;
+
+  if (Thread->Cpu >= 0)
+    SHT1x_Sampler_PinTo(Thread->Cpu);
+
+  for (;;)
+  {
+    Stopping = !atomic_load_explicit(&Sampler->Process, memory_order_acquire);
+    Count = 0;
+
+    for (b = Thread->Index; b < Sampler->BusCount; b += Sampler->Processors)
+      Count += SHT1x_Sampler_Drain(Sampler, b);
+
+    // nothing at home: steal from the other buses, beginning with the next one
+    if (!Count)
+    {
+      for (uint8_t i = 0; i < Sampler->BusCount && !Count; i++)
+      {
+        b = (uint8_t)((Thread->Index + 1 + i) % Sampler->BusCount);
+        if (b % Sampler->Processors == Thread->Index)
+          continue;
+        Stolen = SHT1x_Sampler_Drain(Sampler, b);
+        atomic_fetch_add_explicit(&Sampler->Stolen, Stolen, memory_order_relaxed);
+        Count += Stolen;
+      }
+    }
+
+    if (Count)
+      continue;
+
+    // the acquisition threads are stopped before Process is cleared, so the
+    // queues do not fill again once they are seen empty
+    if (Stopping)
+      break;
+    SHT1x_Sampler_Sleep(SHT1X_SAMPLER_POLL_US);
+  }
+
+  Thread->CpuNs = SHT1x_Sampler_ThreadCpuNs();
+  return NULL;
+}
+
+static SHT1x_Result_t
+SHT1x_Sampler_Spawn(SHT1x_Sampler_t *Sampler, SHT1x_SamplerThread_t *Thread,
+                    uint8_t Index, void *(*Function)(void *))
+{
+  const long Cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+  Thread->Sampler = Sampler;
+  Thread->Index = Index;
+  Thread->Cpu = (Sampler->Pin && Cores > 0) ? (int)(Index % Cores) : -1;
+  Thread->CpuNs = 0;
+  Thread->Started = (pthread_create(&Thread->Thread, NULL, Function, Thread) == 0);
+
+  return Thread->Started ? SHT1x_OK : SHT1x_FAIL;
+}
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start the threads of the sampler. Handlers must be initialized with
+ *         SHT1x_Init and the parameters of the sampler and of every bus and
+ *         sensor set before calling this function. The handlers of a bus must
+ *         not be used by other threads until SHT1x_Sampler_Stop returns.
+ * @param  Sampler: Pointer to sampler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters, or a thread could not be created.
+ */
+SHT1x_Result_t
+SHT1x_Sampler_Start(SHT1x_Sampler_t *Sampler)
+{
+  SHT1x_SamplerBus_t *Bus;
+
+  if (!Sampler || !Sampler->Buses || !Sampler->GetTimeMs ||
+      !Sampler->BusCount || Sampler->BusCount > SHT1X_SAMPLER_MAX_BUSES)
+    return SHT1x_FAIL;
+
+  if (!Sampler->Workers || Sampler->Workers > Sampler->BusCount)
+    Sampler->Workers = Sampler->BusCount;
+  if (!Sampler->Processors || Sampler->Processors > SHT1X_SAMPLER_MAX_BUSES)
+    Sampler->Processors = Sampler->Workers;
+
+  for (uint8_t b = 0; b < Sampler->BusCount; b++)
+  {
+    Bus = &Sampler->Buses[b];
+    if (SHT1x_Sched_Init(&Bus->Sched, Bus->Sensors, Bus->Count,
+                         Sampler->GetTimeMs) != SHT1x_OK)
+      return SHT1x_FAIL;
+    for (uint8_t i = 0; i < Bus->Count; i++)
+    {
+      Bus->Seen[i] = Bus->Sensors[i].Samples;
+      atomic_init(&Bus->Filter[i], 0);
+    }
+    atomic_init(&Bus->Samples, 0);
+    atomic_init(&Bus->Dropped, 0);
+    SHT1x_Sampler_QueueInit(&Bus->Queue);
+  }
+
+  SHT1x_Sampler_QueueInit(&Sampler->Output);
+  atomic_init(&Sampler->Processed, 0);
+  atomic_init(&Sampler->Stolen, 0);
+  atomic_init(&Sampler->Dropped, 0);
+  atomic_init(&Sampler->Acquire, 1);
+  atomic_init(&Sampler->Process, 1);
+  memset(Sampler->WorkerThreads, 0, sizeof(Sampler->WorkerThreads));
+  memset(Sampler->ProcessorThreads, 0, sizeof(Sampler->ProcessorThreads));
+
+  for (uint8_t i = 0; i < Sampler->Processors; i++)
+  {
+    if (SHT1x_Sampler_Spawn(Sampler, &Sampler->ProcessorThreads[i], i,
+                            SHT1x_Sampler_Processor) != SHT1x_OK)
+      goto Fail;
+  }
+  for (uint8_t i = 0; i < Sampler->Workers; i++)
+  {
+    if (SHT1x_Sampler_Spawn(Sampler, &Sampler->WorkerThreads[i], i,
+                            SHT1x_Sampler_Worker) != SHT1x_OK)
+      goto Fail;
+  }
+
+  return SHT1x_OK;
+
+Fail:
+  SHT1x_Sampler_Stop(Sampler);
+  return SHT1x_FAIL;
+}
+
+
+/**
+ * @brief  Stop sampling, process the samples left in the queues and join all
+ *         threads.
+ * @param  Sampler: Pointer to sampler
+ * @retval None
+ */
+void
+SHT1x_Sampler_Stop(SHT1x_Sampler_t *Sampler)
+{
+  SHT1x_SamplerThread_t *Thread;
+
+  atomic_store(&Sampler->Acquire, 0);
+  for (uint8_t i = 0; i < SHT1X_SAMPLER_MAX_BUSES; i++)
+  {
+    Thread = &Sampler->WorkerThreads[i];
+    if (Thread->Started)
+      pthread_join(Thread->Thread, NULL);
+    Thread->Started = 0;
+  }
+
+  atomic_store_explicit(&Sampler->Process, 0, memory_order_release);
+  for (uint8_t i = 0; i < SHT1X_SAMPLER_MAX_BUSES; i++)
+  {
+    Thread = &Sampler->ProcessorThreads[i];
+    if (Thread->Started)
+      pthread_join(Thread->Thread, NULL);
+    Thread->Started = 0;
+  }
+
+  // without processing threads (failed start), nothing is left behind either
+  for (uint8_t b = 0; b < Sampler->BusCount; b++)
+  {
+    while (!SHT1x_Sampler_IsEmpty(&Sampler->Buses[b].Queue))
+      SHT1x_Sampler_Drain(Sampler, b);
+  }
+}
+
+
+/**
+ * @brief  Take one processed sample from the output queue without blocking.
+ *         May be called from any thread.
+ * @param  Sampler: Pointer to sampler
+ * @param  Sample: Pointer to sample
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The queue is empty.
+ */
+SHT1x_Result_t
+SHT1x_Sampler_Read(SHT1x_Sampler_t *Sampler, SHT1x_SamplerSample_t *Sample)
+{
+  return SHT1x_Sampler_Pop(&Sampler->Output, Sample) ? SHT1x_OK : SHT1x_FAIL;
+}
@@ -0,0 +1,255 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_sampler.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Parallel sampler of SHT1x sensors on several buses (Linux, pthreads)
+ *         Functionalities of the this file:
+ *          + One acquisition thread per bus (e.g. per gpiochip), pinned to a core
+ *          + Raw samples are handed off through a lock-free queue per bus
+ *          + Processing threads convert and filter them, stealing from the
+ *            queues of other buses when their own are empty
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_SAMPLER_H_
+#define _SHT1X_SAMPLER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "SHT1x.h"
+#include "SHT1x_sched.h"
+
+
+/* Configurations ---------------------------------------------------------------*/
+/**
+ * @brief  Maximum number of buses, acquisition threads and processing threads
+ */
+#ifndef SHT1X_SAMPLER_MAX_BUSES
+#define SHT1X_SAMPLER_MAX_BUSES     8
+#endif
+
+/**
+ * @brief  Capacity of the queue of every bus and of the output queue.
+ *         Must be a power of two.
+ */
+#ifndef SHT1X_SAMPLER_QUEUE_SIZE
+#define SHT1X_SAMPLER_QUEUE_SIZE    1024
+#endif
+
+/**
+ * @brief  Sleep of a thread that has nothing to do (us). Acquisition threads
+ *         poll DATA of finishing conversions at this interval.
+ */
+#ifndef SHT1X_SAMPLER_POLL_US
+#define SHT1X_SAMPLER_POLL_US       500
+#endif
+
+/**
+ * @brief  Samples a processing thread takes from one queue before it looks at
+ *         the next one
+ */
+#ifndef SHT1X_SAMPLER_BATCH
+#define SHT1X_SAMPLER_BATCH         16
+#endif
+
+/**
+ * @brief  Weight of a new sample in the filtered values is 1 / 2^this value
+ *         (exponential moving average). 0 disables the filter.
+ */
+#ifndef SHT1X_SAMPLER_FILTER_SHIFT
+#define SHT1X_SAMPLER_FILTER_SHIFT  2
+#endif
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  One sample passing through the sampler
+ */
+typedef struct SHT1x_SamplerSample_s
+{
+  // Set by the acquisition thread
+  uint32_t TimeMs;            // Completion time (GetTimeMs of the sampler)
+  uint8_t  Bus;               // Index of the bus
+  uint8_t  Sensor;            // Index of the sensor on its bus
+  SHT1x_Result_t Result;
+  uint16_t TempRaw;
+  uint16_t HumRaw;
+
+  // Set by the processing thread (only when Result is SHT1x_OK)
+  float TempCelsius;
+  float HumidityPercent;
+  float TempFiltered;         // Moving average of TempCelsius
+  float HumFiltered;          // Moving average of HumidityPercent
+} SHT1x_SamplerSample_t;
+
+/**
+ * @brief  Bounded lock-free queue, safe for any number of producers and
+ *         consumers. Every cell has a sequence number that tells whether it
+ *         is free or full for the current position.
+ */
+typedef struct SHT1x_SamplerQueue_s
+{
+  _Alignas(64) _Atomic uint32_t Head;   // Next position to take
+  _Alignas(64) _Atomic uint32_t Tail;   // Next position to fill
+  struct
+  {
+    _Atomic uint32_t Seq;
+    SHT1x_SamplerSample_t Sample;
+  } Cells[SHT1X_SAMPLER_QUEUE_SIZE];
+} SHT1x_SamplerQueue_t;
+
+/**
+ * @brief  One bus: a set of sensors that only one thread may clock, e.g. the
+ *         lines of one gpiochip
+ * @note   On Linux-GPIOD, bind every handler to its own SHT1x_GPIOD_t with
+ *         SHT1x_GPIOD_Attach before SHT1x_Sampler_Start.
+ */
+typedef struct SHT1x_SamplerBus_s
+{
+  // Parameters
+  SHT1x_SchedSensor_t *Sensors;   // Handler and PeriodMs of every sensor set
+  uint8_t Count;
+
+  // Counters
+  _Atomic uint32_t Samples;       // Samples handed off to the queue
+  _Atomic uint32_t Dropped;       // Samples lost because the queue was full
+
+  // Private state
+  SHT1x_Sched_t Sched;
+  uint32_t Seen[255];             // Samples of every sensor already handed off
+  _Atomic uint64_t Filter[255];   // Filtered values of every sensor
+  SHT1x_SamplerQueue_t Queue;
+} SHT1x_SamplerBus_t;
+
+/**
+ * @brief  Context of one thread of the sampler
+ */
+typedef struct SHT1x_SamplerThread_s
+{
+  struct SHT1x_Sampler_s *Sampler;
+  pthread_t Thread;
+  uint8_t  Index;
+  uint8_t  Started;
+  int      Cpu;               // Core the thread runs on (-1: not pinned)
+  uint64_t CpuNs;             // CPU time of the thread, set when it stops
+} SHT1x_SamplerThread_t;
+
+/**
+ * @brief  Sampler
+ * @note   Bus b is sampled by acquisition thread b % Workers; processing
+ *         thread p takes samples of the buses with b % Processors == p first.
+ *         With Pin, thread i of both kinds runs on core i % (number of cores),
+ *         so a bus and its home processing thread share a core.
+ */
+typedef struct SHT1x_Sampler_s
+{
+  // Parameters
+  SHT1x_SamplerBus_t *Buses;
+  uint8_t BusCount;
+  uint8_t Workers;            // Acquisition threads (0: one per bus)
+  uint8_t Processors;         // Processing threads (0: one per worker)
+  uint8_t Pin;                // Pin the threads to cores
+
+  // Millisecond time base, called from every acquisition thread
+  uint32_t (*GetTimeMs)(void);
+
+  // Called by the processing threads for every sample (optional). Without
+  // it, samples are stored in the output queue (see SHT1x_Sampler_Read).
+  void (*OnSample)(const SHT1x_SamplerSample_t *Sample, void *Context);
+  void *Context;
+
+  // Counters
+  _Atomic uint32_t Processed;     // Samples processed
+  _Atomic uint32_t Stolen;        // Samples processed by a thread of another bus
+  _Atomic uint32_t Dropped;       // Samples lost because the output queue was full
+
+  // Private state
+  _Atomic uint8_t Acquire;
+  _Atomic uint8_t Process;
+  SHT1x_SamplerThread_t WorkerThreads[SHT1X_SAMPLER_MAX_BUSES];
+  SHT1x_SamplerThread_t ProcessorThreads[SHT1X_SAMPLER_MAX_BUSES];
+  SHT1x_SamplerQueue_t Output;
+} SHT1x_Sampler_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start the threads of the sampler. Handlers must be initialized with
+ *         SHT1x_Init and the parameters of the sampler and of every bus and
+ *         sensor set before calling this function. The handlers of a bus must
+ *         not be used by other threads until SHT1x_Sampler_Stop returns.
+ * @param  Sampler: Pointer to sampler
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid parameters, or a thread could not be created.
+ */
+SHT1x_Result_t
+SHT1x_Sampler_Start(SHT1x_Sampler_t *Sampler);
+
+
+/**
+ * @brief  Stop sampling, process the samples left in the queues and join all
+ *         threads.
+ * @param  Sampler: Pointer to sampler
+ * @retval None
+ */
+void
+SHT1x_Sampler_Stop(SHT1x_Sampler_t *Sampler);
+
+
+/**
+ * @brief  Take one processed sample from the output queue without blocking.
+ *         May be called from any thread.
+ * @param  Sampler: Pointer to sampler
+ * @param  Sample: Pointer to sample
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: The queue is empty.
+ */
+SHT1x_Result_t
+SHT1x_Sampler_Read(SHT1x_Sampler_t *Sampler, SHT1x_SamplerSample_t *Sample);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_SAMPLER_H_
@@ -0,0 +1,281 @@
+/**
+ **********************************************************************************
+ * @file   sht1x_mpbench.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Scaling benchmark of SHT1x_sampler.c over 1 to 8 simulated buses
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "SHT1x.h"
+#include "SHT1x_sampler.h"
+#include "SHT1x_platform.h"
+
+
+/*
+ * Every bus has its own virtual clock that follows CLOCK_MONOTONIC, so
+ * conversions end in real time. Bus delays busy-wait in real time, as the
+ * bit-banging ports do, so the bus transfers cost CPU time like on hardware.
+ * The sensors sample back to back in low resolution, which keeps every
+ * acquisition thread busy with transfers.
+ *
+ * The driver releases DATA after the falling edge of the 8th command bit, and
+ * the sensor acknowledges within tV of that edge. A thread preempted between
+ * the two steps drives DATA high against the ACK for a moment; open-drain ports
+ * are not affected. These contentions are counted apart from the violations.
+ */
+
+
+#define MAX_BUSES        SHT1X_SAMPLER_MAX_BUSES
+#define MAX_SENSORS      1000
+#define FILTER_CHECK_C   0.5f
+
+
+static SHT1x_Sim_Clock_t   Clocks[MAX_BUSES];
+static SHT1x_Sim_t         Sims[MAX_SENSORS];
+static SHT1x_Handler_t     Handlers[MAX_SENSORS];
+static SHT1x_SchedSensor_t Sensors[MAX_SENSORS];
+static SHT1x_SamplerBus_t  Buses[MAX_BUSES];
+static SHT1x_Sampler_t     Sampler;
+static uint64_t            BaseNs;
+static _Atomic uint32_t    FilterErrors;
+static uint32_t            Contentions;
+
+
+static uint64_t
+ClockNs(clockid_t Clock)
+{
+  struct timespec Ts;
+  clock_gettime(Clock, &Ts);
+  return (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
+
+static uint64_t
+RealTimeNs(void)
+{
+  return ClockNs(CLOCK_MONOTONIC) - BaseNs;
+}
+
+static uint32_t
+GetTimeMs(void)
+{
+  return (uint32_t)(RealTimeNs() / 1000000);
+}
+
+static void
+SpinDelayUs(uint8_t Delay)
+{
+  const uint64_t End = ClockNs(CLOCK_MONOTONIC) + Delay * 1000ULL;
+
+  while (ClockNs(CLOCK_MONOTONIC) < End)
+    ;
+}
+
+/**
+ * @brief  Check the processed samples: the filtered values of a sensor at a
+ *         constant environment stay close to the converted ones.
+ */
+static void
+OnSample(const SHT1x_SamplerSample_t *Sample, void *Context)
+{
+  (void)Context;
+
+  if (Sample->Result != SHT1x_OK)
+    return;
+  if (Sample->TempFiltered - Sample->TempCelsius > FILTER_CHECK_C ||
+      Sample->TempCelsius - Sample->TempFiltered > FILTER_CHECK_C)
+    FilterErrors++;
+}
+
+
+/* Benchmark --------------------------------------------------------------------*/
+static int
+Setup(uint8_t BusCount, uint8_t PerBus)
+{
+  uint32_t n = 0;
+
+  for (uint8_t b = 0; b < BusCount; b++)
+  {
+    Clocks[b] = (SHT1x_Sim_Clock_t){0};
+    Clocks[b].RealTimeNs = RealTimeNs;
+    Buses[b] = (SHT1x_SamplerBus_t){0};
+    Buses[b].Sensors = &Sensors[n];
+    Buses[b].Count = PerBus;
+
+    for (uint8_t i = 0; i < PerBus; i++, n++)
+    {
+      SHT1x_Sim_Init(&Sims[n], &Clocks[b]);
+      Sims[n].AmbientC = 20.0f + (float)(n % 10);
+      Sims[n].HumidityP = 30.0f + 2.0f * (float)(n % 10);
+      Sims[n].ActiveRiseC = 0;
+      if (SHT1x_Sim_Attach(&Sims[n], &Handlers[n]) != SHT1x_OK)
+        return -1;
+      Handlers[n].DelayUs = SpinDelayUs;
+      if (SHT1x_Init(&Handlers[n]) != SHT1x_OK ||
+          SHT1x_SetResolution(&Handlers[n], SHT1x_LowResolution) != SHT1x_OK)
+        return -1;
+      Sensors[n] = (SHT1x_SchedSensor_t){0};
+      Sensors[n].Handler = &Handlers[n];
+      Sensors[n].PeriodMs = 1;    // back to back
+    }
+  }
+
+  return 0;
+}
+
+static uint32_t
+Teardown(uint8_t BusCount, uint8_t PerBus)
+{
+  uint32_t Violations = 0;
+
+  for (uint32_t n = 0; n < (uint32_t)BusCount * PerBus; n++)
+  {
+    Contentions += Sims[n].Stats.Violations[SHT1x_Sim_Contention];
+    Violations += SHT1x_Sim_Violations(&Sims[n]) -
+                  Sims[n].Stats.Violations[SHT1x_Sim_Contention];
+    SHT1x_DeInit(&Handlers[n]);
+    SHT1x_Sim_Detach(&Sims[n]);
+  }
+
+  return Violations;
+}
+
+static int
+Run(uint8_t BusCount, uint8_t PerBus, uint8_t Workers, uint32_t Seconds)
+{
+  uint32_t Processed, Errors = 0, Dropped = 0, Violations;
+  uint64_t Cpu, Wall;
+  double   AcquireCpu = 0, WallS;
+
+  if (Setup(BusCount, PerBus) != 0)
+  {
+    fprintf(stderr, "sensor initialization failed\n");
+    return -1;
+  }
+
+  Sampler = (SHT1x_Sampler_t){0};
+  Sampler.Buses = Buses;
+  Sampler.BusCount = BusCount;
+  Sampler.Workers = Workers;
+  Sampler.Pin = 1;
+  Sampler.GetTimeMs = GetTimeMs;
+  Sampler.OnSample = OnSample;
+
+  Cpu = ClockNs(CLOCK_PROCESS_CPUTIME_ID);
+  Wall = ClockNs(CLOCK_MONOTONIC);
+  if (SHT1x_Sampler_Start(&Sampler) != SHT1x_OK)
+  {
+    fprintf(stderr, "sampler start failed\n");
+    return -1;
+  }
+  sleep(Seconds);
+  SHT1x_Sampler_Stop(&Sampler);
+  WallS = (ClockNs(CLOCK_MONOTONIC) - Wall) / 1e9;
+  Cpu = ClockNs(CLOCK_PROCESS_CPUTIME_ID) - Cpu;
+
+  Processed = Sampler.Processed;
+  for (uint8_t w = 0; w < Sampler.Workers; w++)
+    AcquireCpu += Sampler.WorkerThreads[w].CpuNs / 1e9;
+  for (uint32_t n = 0; n < (uint32_t)BusCount * PerBus; n++)
+    Errors += Sensors[n].Errors;
+  for (uint8_t b = 0; b < BusCount; b++)
+    Dropped += Buses[b].Dropped;
+  Violations = Teardown(BusCount, PerBus);
+
+  printf("%5u %8u %10.1f %10.1f %7.1f %10.1f %7u %7u %5u %5u\n", (unsigned)BusCount,
+         (unsigned)Sampler.Workers, Processed / WallS, Processed / WallS / BusCount,
+         100.0 * Cpu / 1e9 / WallS,
+         Processed ? 1e6 * AcquireCpu / Processed : 0.0,
+         (unsigned)Sampler.Stolen, (unsigned)Errors,
+         (unsigned)(Dropped + Sampler.Dropped), (unsigned)Violations);
+
+  return (Errors || Dropped || Violations || !Processed) ? 1 : 0;
+}
+
+static void
+Usage(const char *Name)
+{
+  fprintf(stderr, "usage: %s [-b max_buses] [-n sensors_per_bus] [-t seconds]\n", Name);
+}
+
+
+int main(int argc, char **argv)
+{
+  uint32_t MaxBuses = 4;
+  uint32_t PerBus = 100;
+  uint32_t Seconds = 2;
+  uint32_t Failures = 0;
+  long     Cores = sysconf(_SC_NPROCESSORS_ONLN);
+  int      Opt, Result;
+
+  while ((Opt = getopt(argc, argv, "b:n:t:")) != -1)
+  {
+    switch (Opt)
+    {
+    case 'b': MaxBuses = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 'n': PerBus = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 't': Seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+    default: Usage(argv[0]); return 2;
+    }
+  }
+
+  if (!MaxBuses || MaxBuses > MAX_BUSES || !PerBus || PerBus > 255 ||
+      MaxBuses * PerBus > MAX_SENSORS || !Seconds)
+  {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  BaseNs = ClockNs(CLOCK_MONOTONIC);
+
+  printf("%ld cores, %u sensors per bus in low resolution, %u s per run\n",
+         Cores, (unsigned)PerBus, (unsigned)Seconds);
+  if (Cores < (long)MaxBuses * 2)
+    printf("fewer cores than threads: the runs share the CPU and cannot scale\n");
+  printf("\nbuses  workers  samples/s  per bus/s   cpu %%  acq us/smp  stolen  errors  lost  viol\n");
+
+  for (uint32_t b = 1; b <= MaxBuses; b *= 2)
+  {
+    // all buses on one thread, then one thread per bus
+    Result = Run((uint8_t)b, (uint8_t)PerBus, 1, Seconds);
+    if (Result < 0)
+      return 1;
+    Failures += (uint32_t)Result;
+    if (b == 1)
+      continue;
+    Result = Run((uint8_t)b, (uint8_t)PerBus, (uint8_t)b, Seconds);
+    if (Result < 0)
+      return 1;
+    Failures += (uint32_t)Result;
+  }
+
+  printf("\nFilter errors: %u, ACK contentions of preempted threads: %u\n",
+         (unsigned)FilterErrors, (unsigned)Contentions);
+  return (Failures || FilterErrors) ? 1 : 0;
+}
@@ -0,0 +1,294 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_shm.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Shared-memory publication of the latest SHT1x samples (Linux)
+ *         Functionalities of the this file:
+ *          + Create the segment and publish samples (daemon)
+ *          + Wait-free, syscall-free read of the latest sample (clients)
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "SHT1x_shm.h"
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/* Private Macros ---------------------------------------------------------------*/
+_Static_assert((sizeof(SHT1x_ShmSample_t) % sizeof(uint64_t)) == 0,
+               "SHT1x_ShmSample_t must be a multiple of 8 bytes");
+
+#define SHT1X_SHM_SIZE(Count) \
+  (sizeof(SHT1x_ShmHeader_t) + (size_t)(Count) * sizeof(SHT1x_ShmSlot_t))
+
+
+
+/**
+ ==================================================================================
+                            ##### Public Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Create (or replace) the segment. Used by the daemon.
+ * @param  Shm: Pointer to mapping
+ * @param  Name: Name of the segment, e.g. SHT1X_SHM_DEFAULT_NAME
+ * @param  Count: Number of sensors (1 ... SHT1X_SHM_MAX_SENSORS)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Failed to create or map the segment.
+ */
+SHT1x_Result_t
+SHT1x_Shm_Create(SHT1x_Shm_t *Shm, const char *Name, uint32_t Count)
+{
+  struct timespec Ts;
+  size_t Size;
+  void *Map;
+  int Fd;
+
+  if (!Count || Count > SHT1X_SHM_MAX_SENSORS)
+    return SHT1x_FAIL;
+
+  // readers may still map the old segment; they keep their copy until reopen
+  shm_unlink(Name);
+  Fd = shm_open(Name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (Fd < 0)
+    return SHT1x_FAIL;
+
+  Size = SHT1X_SHM_SIZE(Count);
+  if (ftruncate(Fd, (off_t)Size) != 0)
+  {
+    close(Fd);
+    shm_unlink(Name);
+    return SHT1x_FAIL;
+  }
+
+  Map = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+  close(Fd);
+  if (Map == MAP_FAILED)
+  {
+    shm_unlink(Name);
+    return SHT1x_FAIL;
+  }
+
+  Shm->Header = (SHT1x_ShmHeader_t *)Map;
+  Shm->Size = Size;
+  Shm->Writer = 1;
+
+  clock_gettime(CLOCK_REALTIME, &Ts);
+  Shm->Header->Version = SHT1X_SHM_VERSION;
+  Shm->Header->Count = Count;
+  Shm->Header->SlotSize = sizeof(SHT1x_ShmSlot_t);
+  Shm->Header->WriterPid = (int32_t)getpid();
+  Shm->Header->StartedNs = (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+
+  // readers check Magic last
+  __atomic_store_n(&Shm->Header->Magic, SHT1X_SHM_MAGIC, __ATOMIC_RELEASE);
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Map an existing segment read-only. Used by clients.
+ * @param  Shm: Pointer to mapping
+ * @param  Name: Name of the segment
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Segment does not exist or has another layout.
+ */
+SHT1x_Result_t
+SHT1x_Shm_Open(SHT1x_Shm_t *Shm, const char *Name)
+{
+  SHT1x_ShmHeader_t *Header;
+  struct stat St;
+  void *Map;
+  int Fd;
+
+  Fd = shm_open(Name, O_RDONLY, 0);
+  if (Fd < 0)
+    return SHT1x_FAIL;
+
+  if (fstat(Fd, &St) != 0 || (size_t)St.st_size < sizeof(SHT1x_ShmHeader_t))
+  {
+    close(Fd);
+    return SHT1x_FAIL;
+  }
+
+  Map = mmap(NULL, (size_t)St.st_size, PROT_READ, MAP_SHARED, Fd, 0);
+  close(Fd);
+  if (Map == MAP_FAILED)
+    return SHT1x_FAIL;
+
+  Header = (SHT1x_ShmHeader_t *)Map;
+  if (__atomic_load_n(&Header->Magic, __ATOMIC_ACQUIRE) != SHT1X_SHM_MAGIC ||
+      Header->Version != SHT1X_SHM_VERSION ||
+      Header->SlotSize != sizeof(SHT1x_ShmSlot_t) ||
+      Header->Count > SHT1X_SHM_MAX_SENSORS ||
+      SHT1X_SHM_SIZE(Header->Count) > (size_t)St.st_size)
+  {
+    munmap(Map, (size_t)St.st_size);
+    return SHT1x_FAIL;
+  }
+
+  Shm->Header = Header;
+  Shm->Size = (size_t)St.st_size;
+  Shm->Writer = 0;
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Unmap the segment. The writer also removes its name.
+ * @param  Shm: Pointer to mapping
+ * @param  Name: Name of the segment
+ * @retval None
+ */
+void
+SHT1x_Shm_Close(SHT1x_Shm_t *Shm, const char *Name)
+{
+  if (!Shm->Header)
+    return;
+
+  munmap(Shm->Header, Shm->Size);
+  if (Shm->Writer && Name)
+    shm_unlink(Name);
+
+  Shm->Header = NULL;
+  Shm->Size = 0;
+}
+
+
+/**
+ * @brief  Publish the latest sample of a sensor (single writer).
+ * @param  Shm: Pointer to mapping
+ * @param  Index: Index of the sensor
+ * @param  Sample: Sample to publish
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index or mapping is read-only.
+ */
+SHT1x_Result_t
+SHT1x_Shm_Publish(SHT1x_Shm_t *Shm, uint32_t Index, const SHT1x_ShmSample_t *Sample)
+{
+  SHT1x_ShmSlot_t *Slot;
+  uint64_t Words[SHT1X_SHM_SAMPLE_WORDS];
+  uint32_t Seq;
+
+  if (!Shm->Writer || Index >= Shm->Header->Count)
+    return SHT1x_FAIL;
+
+  Slot = &Shm->Header->Slots[Index];
+  memcpy(Words, Sample, sizeof(Words));
+
+  Seq = __atomic_load_n(&Slot->Seq, __ATOMIC_RELAXED);
+  __atomic_store_n(&Slot->Seq, Seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  for (uint32_t i = 0; i < SHT1X_SHM_SAMPLE_WORDS; i++)
+    __atomic_store_n(&Slot->Data[i], Words[i], __ATOMIC_RELAXED);
+
+  __atomic_store_n(&Slot->Seq, Seq + 2, __ATOMIC_RELEASE);
+
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Read a consistent copy of the latest sample of a sensor. Never blocks
+ *         the writer and makes no system call; retries while the writer is
+ *         updating the slot.
+ * @param  Shm: Pointer to mapping
+ * @param  Index: Index of the sensor
+ * @param  Sample: Pointer to get the sample
+ * @param  Retries: Pointer to get the number of retries (can be NULL)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index or no sample published yet.
+ */
+SHT1x_Result_t
+SHT1x_Shm_Read(const SHT1x_Shm_t *Shm, uint32_t Index, SHT1x_ShmSample_t *Sample,
+               uint32_t *Retries)
+{
+  const SHT1x_ShmSlot_t *Slot;
+  uint64_t Words[SHT1X_SHM_SAMPLE_WORDS];
+  uint32_t Seq1, Seq2;
+  uint32_t Tries = 0;
+
+  if (Index >= Shm->Header->Count)
+    return SHT1x_FAIL;
+
+  Slot = &Shm->Header->Slots[Index];
+
+  for (;;)
+  {
+    Seq1 = __atomic_load_n(&Slot->Seq, __ATOMIC_ACQUIRE);
+    if (!(Seq1 & 1))
+    {
+      for (uint32_t i = 0; i < SHT1X_SHM_SAMPLE_WORDS; i++)
+        Words[i] = __atomic_load_n(&Slot->Data[i], __ATOMIC_RELAXED);
+
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      Seq2 = __atomic_load_n(&Slot->Seq, __ATOMIC_RELAXED);
+      if (Seq1 == Seq2)
+        break;
+    }
+
+    Tries++;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  }
+
+  if (Retries)
+    *Retries = Tries;
+
+  if (!Seq1)
+    return SHT1x_FAIL;
+
+  memcpy(Sample, Words, sizeof(Words));
+  return SHT1x_OK;
+}
+
+
+/**
+ * @brief  Number of sensors in the segment.
+ * @param  Shm: Pointer to mapping
+ * @retval Number of sensors
+ */
+uint32_t
+SHT1x_Shm_Count(const SHT1x_Shm_t *Shm)
+{
+  return Shm->Header->Count;
+}
@@ -0,0 +1,206 @@
+/**
+ **********************************************************************************
+ * @file   SHT1x_shm.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Shared-memory publication of the latest SHT1x samples (Linux)
+ *         Functionalities of the this file:
+ *          + Create the segment and publish samples (daemon)
+ *          + Wait-free, syscall-free read of the latest sample (clients)
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _SHT1X_SHM_H_
+#define _SHT1X_SHM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "SHT1x.h"
+
+
+/* Exported Constants -----------------------------------------------------------*/
+#define SHT1X_SHM_MAGIC         0x31544853  // "SHT1"
+#define SHT1X_SHM_VERSION       1
+#define SHT1X_SHM_MAX_SENSORS   64
+
+/**
+ * @brief  Default name of the segment (/dev/shm/sht1x)
+ */
+#define SHT1X_SHM_DEFAULT_NAME  "/sht1x"
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Published sample. The layout does not depend on the driver
+ *         configuration.
+ */
+typedef struct SHT1x_ShmSample_s
+{
+  uint64_t TimestampNs;     // Wall clock of the readout (never goes backwards)
+  uint32_t Count;           // Number of samples of this sensor
+  uint32_t Missed;          // Number of missed deadlines of this sensor
+  uint16_t TempRaw;
+  uint16_t HumRaw;
+  float    TempCelsius;
+  float    HumidityPercent;
+  int32_t  Result;          // SHT1x_Result_t of the sample
+} SHT1x_ShmSample_t;
+
+#define SHT1X_SHM_SAMPLE_WORDS  (sizeof(SHT1x_ShmSample_t) / sizeof(uint64_t))
+
+/**
+ * @brief  One sensor in the segment. Seq is odd while the writer updates Data,
+ *         which holds a SHT1x_ShmSample_t that is copied word by word with
+ *         atomic accesses. Every slot has its own cache line.
+ */
+typedef struct SHT1x_ShmSlot_s
+{
+  uint32_t Seq;
+  uint32_t Reserved;
+  uint64_t Data[SHT1X_SHM_SAMPLE_WORDS];
+} __attribute__((aligned(64))) SHT1x_ShmSlot_t;
+
+/**
+ * @brief  Segment layout
+ */
+typedef struct SHT1x_ShmHeader_s
+{
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t Count;           // Number of sensors
+  uint32_t SlotSize;        // sizeof(SHT1x_ShmSlot_t) of the writer
+  int32_t  WriterPid;
+  uint32_t Reserved;
+  uint64_t StartedNs;       // CLOCK_REALTIME of the daemon start
+  SHT1x_ShmSlot_t Slots[];
+} __attribute__((aligned(64))) SHT1x_ShmHeader_t;
+
+/**
+ * @brief  Mapping of the segment
+ */
+typedef struct SHT1x_Shm_s
+{
+  SHT1x_ShmHeader_t *Header;
+  size_t Size;
+  uint8_t Writer;
+} SHT1x_Shm_t;
+
+
+
+/**
+ ==================================================================================
+                               ##### Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Create (or replace) the segment. Used by the daemon.
+ * @param  Shm: Pointer to mapping
+ * @param  Name: Name of the segment, e.g. SHT1X_SHM_DEFAULT_NAME
+ * @param  Count: Number of sensors (1 ... SHT1X_SHM_MAX_SENSORS)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Failed to create or map the segment.
+ */
+SHT1x_Result_t
+SHT1x_Shm_Create(SHT1x_Shm_t *Shm, const char *Name, uint32_t Count);
+
+
+/**
+ * @brief  Map an existing segment read-only. Used by clients.
+ * @param  Shm: Pointer to mapping
+ * @param  Name: Name of the segment
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Segment does not exist or has another layout.
+ */
+SHT1x_Result_t
+SHT1x_Shm_Open(SHT1x_Shm_t *Shm, const char *Name);
+
+
+/**
+ * @brief  Unmap the segment. The writer also removes its name.
+ * @param  Shm: Pointer to mapping
+ * @param  Name: Name of the segment
+ * @retval None
+ */
+void
+SHT1x_Shm_Close(SHT1x_Shm_t *Shm, const char *Name);
+
+
+/**
+ * @brief  Publish the latest sample of a sensor (single writer).
+ * @param  Shm: Pointer to mapping
+ * @param  Index: Index of the sensor
+ * @param  Sample: Sample to publish
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index or mapping is read-only.
+ */
+SHT1x_Result_t
+SHT1x_Shm_Publish(SHT1x_Shm_t *Shm, uint32_t Index, const SHT1x_ShmSample_t *Sample);
+
+
+/**
+ * @brief  Read a consistent copy of the latest sample of a sensor. Never blocks
+ *         the writer and makes no system call; retries while the writer is
+ *         updating the slot.
+ * @param  Shm: Pointer to mapping
+ * @param  Index: Index of the sensor
+ * @param  Sample: Pointer to get the sample
+ * @param  Retries: Pointer to get the number of retries (can be NULL)
+ * @retval SHT1x_Result_t
+ *         - SHT1x_OK: Operation was successful.
+ *         - SHT1x_FAIL: Invalid index or no sample published yet.
+ */
+SHT1x_Result_t
+SHT1x_Shm_Read(const SHT1x_Shm_t *Shm, uint32_t Index, SHT1x_ShmSample_t *Sample,
+               uint32_t *Retries);
+
+
+/**
+ * @brief  Number of sensors in the segment.
+ * @param  Shm: Pointer to mapping
+ * @retval Number of sensors
+ */
+uint32_t
+SHT1x_Shm_Count(const SHT1x_Shm_t *Shm);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _SHT1X_SHM_H_
@@ -0,0 +1,93 @@
+/**
+ **********************************************************************************
+ * @file   sht1x_read.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Print the latest samples published by sht1xd
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "SHT1x_shm.h"
+
+
+int main(int argc, char **argv)
+{
+  const char *Name = SHT1X_SHM_DEFAULT_NAME;
+  uint32_t Rounds = 1;
+  uint32_t Interval = 1;
+  SHT1x_ShmSample_t Sample;
+  SHT1x_Shm_t Shm;
+  int Opt;
+
+  while ((Opt = getopt(argc, argv, "s:n:i:")) != -1)
+  {
+    switch (Opt)
+    {
+    case 's': Name = optarg; break;
+    case 'n': Rounds = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 'i': Interval = (uint32_t)strtoul(optarg, NULL, 0); break;
+    default:
+      fprintf(stderr, "usage: %s [-s shm_name] [-n rounds] [-i seconds]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (SHT1x_Shm_Open(&Shm, Name) != SHT1x_OK)
+  {
+    fprintf(stderr, "cannot open %s (is sht1xd running?)\n", Name);
+    return 1;
+  }
+
+  for (uint32_t Round = 0; Round < Rounds; Round++)
+  {
+    if (Round)
+      sleep(Interval);
+
+    for (uint32_t i = 0; i < SHT1x_Shm_Count(&Shm); i++)
+    {
+      if (SHT1x_Shm_Read(&Shm, i, &Sample, NULL) != SHT1x_OK)
+      {
+        printf("sensor %2u: no sample\n", (unsigned)i);
+        continue;
+      }
+
+      printf("sensor %2u: #%u %d, Temperature: %6.2f°C, Humidity: %6.2f%% "
+             "(raw %5u %5u, missed %u, at %llu.%03llu)\n",
+             (unsigned)i, (unsigned)Sample.Count, (int)Sample.Result,
+             Sample.TempCelsius, Sample.HumidityPercent, Sample.TempRaw,
+             Sample.HumRaw, (unsigned)Sample.Missed,
+             (unsigned long long)(Sample.TimestampNs / 1000000000ULL),
+             (unsigned long long)(Sample.TimestampNs / 1000000ULL % 1000));
+    }
+  }
+
+  SHT1x_Shm_Close(&Shm, NULL);
+  return 0;
+}
@@ -0,0 +1,297 @@
+/**
+ **********************************************************************************
+ * @file   sht1x_stress.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Stress test of the shared-memory publication: one writer driven by
+ *         simulated sensors and many concurrent readers that check every
+ *         sample for torn reads
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "SHT1x.h"
+#include "SHT1x_sched.h"
+#include "SHT1x_shm.h"
+#include "SHT1x_platform.h"
+
+
+#define MAX_READERS   256
+#define BATCH         1024
+
+
+typedef struct Reader_s
+{
+  pthread_t Thread;
+  uint64_t  Reads;
+  uint64_t  Retries;
+  uint64_t  Torn;
+  uint64_t  Ns;
+  uint64_t  MaxBatchNs;
+} Reader_t;
+
+
+static SHT1x_Sim_t         Sims[SHT1X_SHM_MAX_SENSORS];
+static SHT1x_Handler_t     Handlers[SHT1X_SHM_MAX_SENSORS];
+static SHT1x_SchedSensor_t Sensors[SHT1X_SHM_MAX_SENSORS];
+static SHT1x_ShmSample_t   Latest[SHT1X_SHM_MAX_SENSORS];
+static SHT1x_Handler_t     RefHandler;
+static SHT1x_Shm_t         Shm;
+static Reader_t            Readers[MAX_READERS];
+static char                Name[64];
+static uint32_t            Count = 12;
+static uint64_t            Publishes;
+static volatile int        Running = 1;
+static uint32_t            Rand = 1;
+
+
+static uint64_t
+MonoNs(void)
+{
+  struct timespec Ts;
+  clock_gettime(CLOCK_MONOTONIC, &Ts);
+  return (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
+
+static uint32_t
+GetTimeMs(void)
+{
+  return (uint32_t)(SHT1x_Sim_Now(&Sims[0]) / 1000000);
+}
+
+static void
+OnSample(uint8_t Index, SHT1x_SchedSensor_t *Sensor)
+{
+  SHT1x_ShmSample_t *Sample = &Latest[Index];
+
+  Sample->Count = Sensor->Samples;
+  Sample->Missed = Sensor->Missed;
+  Sample->TempRaw = Sensor->Sample.TempRaw;
+  Sample->HumRaw = Sensor->Sample.HumRaw;
+  Sample->TempCelsius = Sensor->Sample.TempCelsius;
+  Sample->HumidityPercent = Sensor->Sample.HumidityPercent;
+  Sample->Result = Sensor->Result;
+
+  // random walk, so that consecutive samples differ
+  Rand = Rand * 1103515245 + 12345;
+  Sims[Index].AmbientC += ((Rand >> 16) & 1) ? 0.37f : -0.37f;
+  Sims[Index].HumidityP += ((Rand >> 17) & 1) ? 1.3f : -1.3f;
+  if (Sims[Index].HumidityP < 5.0f || Sims[Index].HumidityP > 95.0f)
+    Sims[Index].HumidityP = 50.0f;
+}
+
+static void *
+Writer(void *Arg)
+{
+  SHT1x_Sched_t *Sched = (SHT1x_Sched_t *)Arg;
+
+  // the virtual clock runs as fast as possible; every step republishes all
+  // sensors to keep the writer busy on the slots the readers are reading
+  while (Running)
+  {
+    SHT1x_Sched_Poll(Sched);
+    SHT1x_Sim_Advance(&Sims[0], 1000000);
+
+    for (uint32_t i = 0; i < Count; i++)
+    {
+      if (!Latest[i].Count)
+        continue;
+      Latest[i].TimestampNs = SHT1x_Sim_Now(&Sims[0]);
+      SHT1x_Shm_Publish(&Shm, i, &Latest[i]);
+      Publishes++;
+    }
+  }
+
+  return NULL;
+}
+
+static int
+Check(const SHT1x_ShmSample_t *Sample, const SHT1x_ShmSample_t *Last)
+{
+  SHT1x_Sample_t Ref = {0};
+
+  Ref.TempRaw = Sample->TempRaw;
+  Ref.HumRaw = Sample->HumRaw;
+  SHT1x_ConvertSample(&RefHandler, &Ref);
+
+  // a torn read mixes the raw values of one sample with the physical values,
+  // counters or timestamp of another one
+  if (memcmp(&Ref.TempCelsius, &Sample->TempCelsius, sizeof(float)) ||
+      memcmp(&Ref.HumidityPercent, &Sample->HumidityPercent, sizeof(float)))
+    return 1;
+  if (Sample->Count < Last->Count || Sample->TimestampNs < Last->TimestampNs)
+    return 1;
+  if (Sample->Result != SHT1x_OK)
+    return 1;
+
+  return 0;
+}
+
+static void *
+ReaderThread(void *Arg)
+{
+  Reader_t *Reader = (Reader_t *)Arg;
+  SHT1x_ShmSample_t Last[SHT1X_SHM_MAX_SENSORS] = {0};
+  SHT1x_ShmSample_t Samples[BATCH];
+  uint32_t Index[BATCH];
+  SHT1x_Shm_t Mapping;
+  uint32_t Retries;
+  uint64_t Start, Ns;
+  uint32_t Next = (uint32_t)(Reader - Readers);
+  uint32_t n;
+
+  // every reader maps the segment itself, as a client process would
+  if (SHT1x_Shm_Open(&Mapping, Name) != SHT1x_OK)
+  {
+    Reader->Torn = ~0ULL;
+    return NULL;
+  }
+
+  while (Running)
+  {
+    Start = MonoNs();
+    for (n = 0; n < BATCH; n++)
+    {
+      Index[n] = Next;
+      if (SHT1x_Shm_Read(&Mapping, Next, &Samples[n], &Retries) != SHT1x_OK)
+        break;
+      Reader->Retries += Retries;
+      if (++Next >= Count)
+        Next = 0;
+    }
+    Ns = MonoNs() - Start;
+
+    Reader->Reads += n;
+    Reader->Ns += Ns;
+    if (n == BATCH && Ns > Reader->MaxBatchNs)
+      Reader->MaxBatchNs = Ns;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+      Reader->Torn += Check(&Samples[i], &Last[Index[i]]);
+      Last[Index[i]] = Samples[i];
+    }
+  }
+
+  SHT1x_Shm_Close(&Mapping, NULL);
+  return NULL;
+}
+
+
+int main(int argc, char **argv)
+{
+  uint32_t ReaderCount = 16;
+  uint32_t Seconds = 3;
+  SHT1x_Sched_t Sched;
+  pthread_t WriterThread;
+  uint64_t Reads = 0, Retries = 0, Torn = 0, Ns = 0, MaxBatchNs = 0;
+  uint64_t Samples = 0;
+  int Opt;
+
+  while ((Opt = getopt(argc, argv, "n:r:t:")) != -1)
+  {
+    switch (Opt)
+    {
+    case 'n': Count = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 'r': ReaderCount = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 't': Seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+    default:
+      fprintf(stderr, "usage: %s [-n sensors] [-r readers] [-t seconds]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (!Count || Count > SHT1X_SHM_MAX_SENSORS || !ReaderCount ||
+      ReaderCount > MAX_READERS)
+    return 2;
+
+  snprintf(Name, sizeof(Name), "/sht1x-stress-%d", (int)getpid());
+
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    SHT1x_Sim_Init(&Sims[i], NULL);
+    Sims[i].AmbientC = 25.0f;
+    Sims[i].HumidityP = 50.0f;
+    SHT1x_Sim_Attach(&Sims[i], &Handlers[i]);
+    SHT1x_Init(&Handlers[i]);
+    Sensors[i].Handler = &Handlers[i];
+    Sensors[i].PeriodMs = 100;
+  }
+  RefHandler = Handlers[0];
+
+  if (SHT1x_Shm_Create(&Shm, Name, Count) != SHT1x_OK)
+  {
+    perror("shm");
+    return 1;
+  }
+
+  // publish a first sample of every sensor before the readers start
+  SHT1x_Sched_Init(&Sched, Sensors, (uint8_t)Count, GetTimeMs);
+  Sched.OnSample = OnSample;
+  SHT1x_Sched_Sweep(&Sched);
+  for (uint32_t i = 0; i < Count; i++)
+    SHT1x_Shm_Publish(&Shm, i, &Latest[i]);
+
+  pthread_create(&WriterThread, NULL, Writer, &Sched);
+  for (uint32_t i = 0; i < ReaderCount; i++)
+    pthread_create(&Readers[i].Thread, NULL, ReaderThread, &Readers[i]);
+
+  sleep(Seconds);
+  Running = 0;
+
+  pthread_join(WriterThread, NULL);
+  for (uint32_t i = 0; i < ReaderCount; i++)
+  {
+    pthread_join(Readers[i].Thread, NULL);
+    Reads += Readers[i].Reads;
+    Retries += Readers[i].Retries;
+    Torn += Readers[i].Torn;
+    Ns += Readers[i].Ns;
+    if (Readers[i].MaxBatchNs > MaxBatchNs)
+      MaxBatchNs = Readers[i].MaxBatchNs;
+  }
+  for (uint32_t i = 0; i < Count; i++)
+    Samples += Sensors[i].Samples;
+
+  printf("sensors %u, readers %u, %u s\n", (unsigned)Count, (unsigned)ReaderCount,
+         (unsigned)Seconds);
+  printf("writer: %llu sensor samples, %llu publishes\n",
+         (unsigned long long)Samples, (unsigned long long)Publishes);
+  printf("readers: %llu reads, %.1f ns/read, worst batch %.1f ns/read, "
+         "retries %llu\n", (unsigned long long)Reads,
+         Reads ? (double)Ns / Reads : 0.0, (double)MaxBatchNs / BATCH,
+         (unsigned long long)Retries);
+  printf("torn reads: %llu\n", (unsigned long long)Torn);
+
+  SHT1x_Shm_Close(&Shm, Name);
+  return Torn ? 1 : 0;
+}
@@ -0,0 +1,373 @@
+/**
+ **********************************************************************************
+ * @file   sht1xd.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  SHT1x acquisition daemon: samples the sensors with the scheduler and
+ *         publishes the latest sample of each one in shared memory
+ **********************************************************************************
+ *
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ **********************************************************************************
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include "SHT1x.h"
+#include "SHT1x_sched.h"
+#include "SHT1x_shm.h"
+#include "SHT1x_history.h"
+#include "SHT1x_platform.h"
+
+
+/*
+ * Backend, chosen by the makefile (BACKEND=sim or BACKEND=gpiod):
+ * - sim: simulated sensors (port/Host-Sim) whose virtual clock follows
+ *   CLOCK_MONOTONIC.
+ * - gpiod: sensors on GPIO lines (port/Linux-GPIOD), one -g chip:sck:data
+ *   per sensor.
+ * A backend provides InitSensors(), StartClock(), SyncClock() and GetTimeMs().
+ */
+#ifndef SHT1XD_BACKEND_GPIOD
+#define SHT1XD_BACKEND_GPIOD 0
+#endif
+
+
+#if (SHT1XD_BACKEND_GPIOD)
+static SHT1x_GPIOD_t       Ports[SHT1X_SHM_MAX_SENSORS];
+static uint32_t            PortCount;
+#else
+static SHT1x_Sim_t         Sims[SHT1X_SHM_MAX_SENSORS];
+#endif
+static SHT1x_Handler_t     Handlers[SHT1X_SHM_MAX_SENSORS];
+static SHT1x_SchedSensor_t Sensors[SHT1X_SHM_MAX_SENSORS];
+static SHT1x_Shm_t         Shm;
+static SHT1x_History_t     Histories[SHT1X_SHM_MAX_SENSORS];
+static uint32_t            MissedLogged[SHT1X_SHM_MAX_SENSORS];
+static const char          *HistoryDir;
+static uint64_t            StartNs;
+static uint64_t            WallNs;
+static int                 Verbose;
+static volatile sig_atomic_t Running = 1;
+
+
+static uint64_t
+ClockNs(clockid_t Clock)
+{
+  struct timespec Ts;
+  clock_gettime(Clock, &Ts);
+  return (uint64_t)Ts.tv_sec * 1000000000ULL + Ts.tv_nsec;
+}
+
+// wall clock at start moved by CLOCK_MONOTONIC: never goes backwards, so the
+// history stays in timestamp order when the system time is set back
+static uint64_t
+WallClockNs(void)
+{
+  return WallNs + ClockNs(CLOCK_MONOTONIC);
+}
+
+#if (SHT1XD_BACKEND_GPIOD)
+static uint32_t
+GetTimeMs(void)
+{
+  return (uint32_t)((ClockNs(CLOCK_MONOTONIC) - StartNs) / 1000000);
+}
+
+static void
+StartClock(void)
+{
+  StartNs = ClockNs(CLOCK_MONOTONIC);
+}
+
+static void
+SyncClock(void)
+{
+}
+
+// chip:sck:data, e.g. gpiochip0:17:18 (the chip name stays in argv)
+static int
+AddPort(char *Spec)
+{
+  char *Sck = strchr(Spec, ':');
+  char *Data = Sck ? strchr(Sck + 1, ':') : NULL;
+
+  if (!Data || Sck == Spec || PortCount >= SHT1X_SHM_MAX_SENSORS)
+    return -1;
+
+  *Sck++ = '\0';
+  *Data++ = '\0';
+  SHT1x_GPIOD_Init(&Ports[PortCount++], Spec, (unsigned int)strtoul(Sck, NULL, 0),
+                   (unsigned int)strtoul(Data, NULL, 0));
+  return 0;
+}
+
+static int
+InitSensors(uint32_t Count)
+{
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    // the port leaves ChipHandle NULL when the chip cannot be opened
+    if (SHT1x_GPIOD_Attach(&Ports[i], &Handlers[i]) != SHT1x_OK ||
+        SHT1x_Init(&Handlers[i]) != SHT1x_OK || !Ports[i].ChipHandle)
+    {
+      fprintf(stderr, "sensor %u: cannot open %s:%u:%u\n", (unsigned)i,
+              Ports[i].Chip, Ports[i].SckLine, Ports[i].DataLine);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+#else
+static uint32_t
+GetTimeMs(void)
+{
+  return (uint32_t)(SHT1x_Sim_Now(&Sims[0]) / 1000000);
+}
+
+static void
+StartClock(void)
+{
+  StartNs = ClockNs(CLOCK_MONOTONIC) - SHT1x_Sim_Now(&Sims[0]);
+}
+
+static void
+SyncClock(void)
+{
+  uint64_t Target = ClockNs(CLOCK_MONOTONIC) - StartNs;
+  uint64_t Now = SHT1x_Sim_Now(&Sims[0]);
+
+  if (Target > Now)
+    SHT1x_Sim_Advance(&Sims[0], Target - Now);
+}
+
+static int
+InitSensors(uint32_t Count)
+{
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    SHT1x_Sim_Init(&Sims[i], NULL);
+    Sims[i].AmbientC = 20.0f + (float)i;
+    Sims[i].HumidityP = 30.0f + 2.0f * (float)i;
+    if (SHT1x_Sim_Attach(&Sims[i], &Handlers[i]) != SHT1x_OK ||
+        SHT1x_Init(&Handlers[i]) != SHT1x_OK)
+      return -1;
+  }
+
+  return 0;
+}
+#endif
+
+static void
+OnSample(uint8_t Index, SHT1x_SchedSensor_t *Sensor)
+{
+  SHT1x_ShmSample_t Sample = {0};
+
+  Sample.TimestampNs = WallClockNs();
+  Sample.Count = Sensor->Samples;
+  Sample.Missed = Sensor->Missed;
+  Sample.TempRaw = Sensor->Sample.TempRaw;
+  Sample.HumRaw = Sensor->Sample.HumRaw;
+  Sample.TempCelsius = Sensor->Sample.TempCelsius;
+  Sample.HumidityPercent = Sensor->Sample.HumidityPercent;
+  Sample.Result = Sensor->Result;
+  SHT1x_Shm_Publish(&Shm, Index, &Sample);
+
+  if (HistoryDir)
+  {
+    SHT1x_HistoryRecord_t Record = {0};
+
+    Record.TimestampMs = Sample.TimestampNs / 1000000;
+    Record.TempRaw = Sample.TempRaw;
+    Record.HumRaw = Sample.HumRaw;
+    Record.Sensor = Index;
+    if (Sensor->Result != SHT1x_OK)
+      Record.Flags |= SHT1X_HISTORY_FLAG_ERROR;
+    if (Sensor->Missed != MissedLogged[Index])
+      Record.Flags |= SHT1X_HISTORY_FLAG_MISSED;
+    MissedLogged[Index] = Sensor->Missed;
+    SHT1x_History_Append(&Histories[Index], &Record);
+  }
+
+  if (Verbose)
+    printf("sensor %2u: %d, %6.2f°C, %6.2f%%\n", Index, Sensor->Result,
+           Sensor->Sample.TempCelsius, Sensor->Sample.HumidityPercent);
+}
+
+static void
+OnSignal(int Signal)
+{
+  (void)Signal;
+  Running = 0;
+}
+
+static void
+Usage(const char *Name)
+{
+#if (SHT1XD_BACKEND_GPIOD)
+  fprintf(stderr,
+          "usage: %s [-g chip:sck:data]... [-p period_ms] [-s shm_name] [-t seconds] "
+          "[-H history_dir] [-d history_days] [-v]\n"
+          "  one -g per sensor, default %s:%u:%u\n",
+          Name, SHT1x_GPIO_CHIP, SHT1x_SCK_LINE, SHT1x_DATA_LINE);
+#else
+  fprintf(stderr,
+          "usage: %s [-n sensors] [-p period_ms] [-s shm_name] [-t seconds] "
+          "[-H history_dir] [-d history_days] [-v]\n",
+          Name);
+#endif
+}
+
+
+int main(int argc, char **argv)
+{
+  const char *Name = SHT1X_SHM_DEFAULT_NAME;
+  uint32_t Count = 12;
+  uint32_t PeriodMs = 1000;
+  uint32_t Seconds = 0;
+  uint32_t Days = 30;
+  char Path[4096];
+  uint32_t Idle;
+  SHT1x_Sched_t Sched;
+  struct timespec Sleep;
+  int Opt;
+
+  while ((Opt = getopt(argc, argv, SHT1XD_BACKEND_GPIOD ? "g:p:s:t:H:d:v" :
+                                                          "n:p:s:t:H:d:v")) != -1)
+  {
+    switch (Opt)
+    {
+#if (SHT1XD_BACKEND_GPIOD)
+    case 'g':
+      if (AddPort(optarg) != 0)
+      {
+        Usage(argv[0]);
+        return 2;
+      }
+      break;
+#else
+    case 'n': Count = (uint32_t)strtoul(optarg, NULL, 0); break;
+#endif
+    case 'p': PeriodMs = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 's': Name = optarg; break;
+    case 't': Seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 'H': HistoryDir = optarg; break;
+    case 'd': Days = (uint32_t)strtoul(optarg, NULL, 0); break;
+    case 'v': Verbose = 1; break;
+    default: Usage(argv[0]); return 2;
+    }
+  }
+
+#if (SHT1XD_BACKEND_GPIOD)
+  if (!PortCount)
+    SHT1x_GPIOD_Init(&Ports[PortCount++], SHT1x_GPIO_CHIP, SHT1x_SCK_LINE,
+                     SHT1x_DATA_LINE);
+  Count = PortCount;
+#endif
+
+  if (!Count || Count > SHT1X_SHM_MAX_SENSORS || !PeriodMs || !Days)
+  {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  if (InitSensors(Count) != 0)
+  {
+    fprintf(stderr, "sensor initialization failed\n");
+    return 1;
+  }
+
+  if (SHT1x_Shm_Create(&Shm, Name, Count) != SHT1x_OK)
+  {
+    perror("shm");
+    return 1;
+  }
+
+  // one ring per sensor, holding Days of samples
+  for (uint32_t i = 0; HistoryDir && i < Count; i++)
+  {
+    snprintf(Path, sizeof(Path), "%s/sensor%02u.ring", HistoryDir, (unsigned)i);
+    if (SHT1x_History_Create(&Histories[i], Path,
+                             (uint32_t)((uint64_t)Days * 86400000 / PeriodMs) +
+                             SHT1X_HISTORY_BATCH + 1) != SHT1x_OK)
+    {
+      fprintf(stderr, "cannot open history %s\n", Path);
+      return 1;
+    }
+  }
+
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    Sensors[i].Handler = &Handlers[i];
+    Sensors[i].PeriodMs = PeriodMs;
+  }
+  StartClock();
+  WallNs = ClockNs(CLOCK_REALTIME) - ClockNs(CLOCK_MONOTONIC);
+  SHT1x_Sched_Init(&Sched, Sensors, (uint8_t)Count, GetTimeMs);
+  Sched.OnSample = OnSample;
+
+  signal(SIGINT, OnSignal);
+  signal(SIGTERM, OnSignal);
+
+  fprintf(stderr, "sht1xd: %u sensors, period %u ms, publishing to /dev/shm%s\n",
+          (unsigned)Count, (unsigned)PeriodMs, Name);
+
+  while (Running)
+  {
+    SyncClock();
+    SHT1x_Sched_Poll(&Sched);
+
+    if (Seconds && GetTimeMs() >= Seconds * 1000)
+      break;
+
+    // poll conversions every millisecond, otherwise sleep until the next sample
+    Idle = SHT1x_Sched_IdleTime(&Sched);
+    if (Idle == 0)
+      Idle = 1;
+    if (Idle > 100)
+      Idle = 100;
+    Sleep.tv_sec = 0;
+    Sleep.tv_nsec = (long)Idle * 1000000L;
+    nanosleep(&Sleep, NULL);
+  }
+
+  for (uint32_t i = 0; i < Count; i++)
+  {
+    if (Sensors[i].Missed || Sensors[i].Errors)
+      fprintf(stderr, "sensor %2u: samples %u, errors %u, missed %u\n", (unsigned)i,
+              (unsigned)Sensors[i].Samples, (unsigned)Sensors[i].Errors,
+              (unsigned)Sensors[i].Missed);
+    SHT1x_DeInit(&Handlers[i]);
+    if (HistoryDir)
+      SHT1x_History_Close(&Histories[i]);
+  }
+
+  SHT1x_Shm_Close(&Shm, Name);
+  return 0;
+}